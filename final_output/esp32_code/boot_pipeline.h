@@ -0,0 +1,261 @@
+/*
+ * Boot Pipeline - Dependency-ordered startup stages with a boot profile
+ *
+ * setup() used to run every init step in a fixed sequence with fixed waits
+ * in between. Here each stage names the stages it needs; step() starts
+ * every stage whose dependencies are done and polls the running ones. A
+ * stage starts the moment its inputs are ready (readiness, not delays),
+ * and independent stages overlap. The pipeline is stepped from setup()
+ * and then from loop(), so slow network stages finish while sampling and
+ * prediction are already running.
+ *
+ * Stages are cooperative: a stage function is called once with start=true,
+ * then polled with start=false until it returns DONE or FAILED. Time spent
+ * inside the function is recorded separately ("busy") - that is the time
+ * the stage held up loop().
+ *
+ * Features:
+ * - Up to BOOT_MAX_STAGES stages, dependencies as a bitmask of stage ids
+ *   (a stage may only depend on stages added before it)
+ * - Per-stage timeout; a failed stage skips everything that depends on it
+ * - Boot profile: start, end and busy time per stage, milestones (e.g.
+ *   first prediction) in ms since power-on, JSON export
+ * - No Arduino dependencies: the caller provides the clock (millis)
+ *
+ * Usage:
+ *   BootPipeline boot(bootClock);
+ *   int wifi = boot.addStage("wifi", wifiStage);
+ *   boot.addStage("firebase", firebaseStage, BOOT_DEP(wifi), 20000);
+ *   boot.step();                                  // setup() and every loop()
+ *   boot.mark("first_prediction");
+ */
+
+#ifndef BOOT_PIPELINE_H
+#define BOOT_PIPELINE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define BOOT_MAX_STAGES 12
+#define BOOT_MAX_MARKS 4
+#define BOOT_DEP(id) ((id) >= 0 ? (1u << (id)) : 0u)
+
+enum BootStatus {
+    BOOT_STAGE_PENDING = 0,   // Waiting for dependencies
+    BOOT_STAGE_RUNNING,
+    BOOT_STAGE_DONE,
+    BOOT_STAGE_FAILED,        // Returned FAILED or timed out
+    BOOT_STAGE_SKIPPED,       // A dependency failed
+    BOOT_STAGE_STATUS_COUNT
+};
+
+static const char* const BOOT_STAGE_STATUS_NAMES[BOOT_STAGE_STATUS_COUNT] = {
+    "pending", "running", "done", "failed", "skipped"
+};
+
+// start = true on the first call; return RUNNING, DONE or FAILED
+typedef BootStatus (*BootStageFn)(bool start);
+typedef uint32_t (*BootClockFn)();
+
+struct BootStage {
+    const char* name;
+    BootStageFn run;
+    uint32_t dependencies;    // BOOT_DEP() bits
+    uint32_t timeoutMs;       // 0 = no limit
+    BootStatus status;
+    uint32_t startMs;         // Since power-on
+    uint32_t endMs;
+    uint32_t busyMs;          // Time spent inside run()
+    bool timedOut;
+};
+
+struct BootMark {
+    const char* name;
+    uint32_t atMs;
+};
+
+class BootPipeline {
+private:
+    BootClockFn clock;
+    BootStage stages[BOOT_MAX_STAGES];
+    int stageCount;
+    BootMark marks[BOOT_MAX_MARKS];
+    int markCount;
+    uint32_t completedMs;     // All stages settled (0 = not yet)
+
+public:
+    BootPipeline(BootClockFn clockFn) : clock(clockFn), stageCount(0), markCount(0), completedMs(0) {}
+
+    // Returns the stage id, or -1 if the table is full or a dependency is
+    // not an earlier stage
+    int addStage(const char* name, BootStageFn run, uint32_t dependencies = 0, uint32_t timeoutMs = 0) {
+        if (stageCount >= BOOT_MAX_STAGES || (dependencies >> stageCount) != 0) {
+            return -1;
+        }
+        BootStage& s = stages[stageCount];
+        s.name = name;
+        s.run = run;
+        s.dependencies = dependencies;
+        s.timeoutMs = timeoutMs;
+        s.status = BOOT_STAGE_PENDING;
+        s.startMs = s.endMs = s.busyMs = 0;
+        s.timedOut = false;
+        return stageCount++;
+    }
+
+    // Start ready stages, poll running ones. Returns true once every stage
+    // has settled (done, failed or skipped). One pass is enough: stages
+    // unblocked by this pass start in the same call.
+    bool step() {
+        if (completedMs != 0) {
+            return true;
+        }
+        bool settled = true;
+        for (int i = 0; i < stageCount; i++) {
+            BootStage& s = stages[i];
+            if (s.status == BOOT_STAGE_PENDING) {
+                BootStatus deps = dependencyStatus(s);
+                if (deps == BOOT_STAGE_SKIPPED) {
+                    s.status = BOOT_STAGE_SKIPPED;
+                    s.startMs = s.endMs = clock();
+                } else if (deps == BOOT_STAGE_DONE) {
+                    s.status = BOOT_STAGE_RUNNING;
+                    s.startMs = clock();
+                    call(s, true);
+                }
+            } else if (s.status == BOOT_STAGE_RUNNING) {
+                call(s, false);
+            }
+            if (s.status == BOOT_STAGE_PENDING || s.status == BOOT_STAGE_RUNNING) {
+                settled = false;
+            }
+        }
+        if (settled) {
+            completedMs = clock();
+            if (completedMs == 0) completedMs = 1;
+        }
+        return settled;
+    }
+
+    // Run step() until `id` has settled or `timeoutMs` passed (boot only:
+    // for the few things setup() cannot continue without)
+    BootStatus waitFor(int id, uint32_t timeoutMs, void (*idle)() = nullptr) {
+        uint32_t start = clock();
+        while (id >= 0 && id < stageCount && (stages[id].status == BOOT_STAGE_PENDING ||
+                                              stages[id].status == BOOT_STAGE_RUNNING)) {
+            step();
+            if (clock() - start >= timeoutMs) break;
+            if (idle) idle();
+        }
+        return status(id);
+    }
+
+    // Milestone (first call per name counts)
+    void mark(const char* name) {
+        if (markTime(name) != 0 || markCount >= BOOT_MAX_MARKS) return;
+        marks[markCount].name = name;
+        marks[markCount].atMs = clock();
+        if (marks[markCount].atMs == 0) marks[markCount].atMs = 1;
+        markCount++;
+    }
+
+    // ms since power-on, 0 = not reached
+    uint32_t markTime(const char* name) const {
+        for (int i = 0; i < markCount; i++) {
+            if (strcmp(marks[i].name, name) == 0) return marks[i].atMs;
+        }
+        return 0;
+    }
+
+    BootStatus status(int id) const {
+        return id >= 0 && id < stageCount ? stages[id].status : BOOT_STAGE_SKIPPED;
+    }
+    bool isDone(int id) const { return status(id) == BOOT_STAGE_DONE; }
+    bool isComplete() const { return completedMs != 0; }
+    uint32_t getCompletedMs() const { return completedMs; }
+    int getStageCount() const { return stageCount; }
+    const BootStage& getStage(int id) const { return stages[id]; }
+    int getMarkCount() const { return markCount; }
+    const BootMark& getMark(int i) const { return marks[i]; }
+
+    // Sum of stage durations - what the same stages cost back to back
+    uint32_t sequentialMs() const {
+        uint32_t total = 0;
+        for (int i = 0; i < stageCount; i++) {
+            if (stages[i].endMs > stages[i].startMs) total += stages[i].endMs - stages[i].startMs;
+        }
+        return total;
+    }
+
+    // Time loop() was held up by stage functions
+    uint32_t busyMs() const {
+        uint32_t total = 0;
+        for (int i = 0; i < stageCount; i++) total += stages[i].busyMs;
+        return total;
+    }
+
+    // {"complete_ms":n,"busy_ms":n,"stages":{"wifi":{"status":"done","start":n,"ms":n,"busy":n},...},
+    //  "marks":{"first_prediction":n}}
+    int encodeJson(char* out, size_t size) const {
+        size_t used = 0;
+        int written = snprintf(out, size, "{\"complete_ms\":%lu,\"busy_ms\":%lu,\"stages\":{",
+                               (unsigned long)completedMs, (unsigned long)busyMs());
+        if (!advance(written, size, used)) return -1;
+        for (int i = 0; i < stageCount; i++) {
+            const BootStage& s = stages[i];
+            written = snprintf(out + used, size - used,
+                               "%s\"%s\":{\"status\":\"%s\",\"start\":%lu,\"ms\":%lu,\"busy\":%lu}",
+                               i ? "," : "", s.name, BOOT_STAGE_STATUS_NAMES[s.status],
+                               (unsigned long)s.startMs, (unsigned long)(s.endMs - s.startMs),
+                               (unsigned long)s.busyMs);
+            if (!advance(written, size, used)) return -1;
+        }
+        written = snprintf(out + used, size - used, "},\"marks\":{");
+        if (!advance(written, size, used)) return -1;
+        for (int i = 0; i < markCount; i++) {
+            written = snprintf(out + used, size - used, "%s\"%s\":%lu", i ? "," : "", marks[i].name,
+                               (unsigned long)marks[i].atMs);
+            if (!advance(written, size, used)) return -1;
+        }
+        written = snprintf(out + used, size - used, "}}");
+        if (!advance(written, size, used)) return -1;
+        return (int)used;
+    }
+
+private:
+    // DONE when all dependencies are done, SKIPPED if any failed, else PENDING
+    BootStatus dependencyStatus(const BootStage& s) const {
+        BootStatus result = BOOT_STAGE_DONE;
+        for (int d = 0; d < stageCount; d++) {
+            if (!(s.dependencies & (1u << d))) continue;
+            BootStatus dep = stages[d].status;
+            if (dep == BOOT_STAGE_FAILED || dep == BOOT_STAGE_SKIPPED) return BOOT_STAGE_SKIPPED;
+            if (dep != BOOT_STAGE_DONE) result = BOOT_STAGE_PENDING;
+        }
+        return result;
+    }
+
+    void call(BootStage& s, bool start) {
+        uint32_t before = clock();
+        BootStatus result = s.run(start);
+        uint32_t after = clock();
+        s.busyMs += after - before;
+        if (result == BOOT_STAGE_DONE || result == BOOT_STAGE_FAILED) {
+            s.status = result;
+            s.endMs = after;
+        } else if (s.timeoutMs > 0 && after - s.startMs >= s.timeoutMs) {
+            s.status = BOOT_STAGE_FAILED;
+            s.timedOut = true;
+            s.endMs = after;
+        }
+    }
+
+    static bool advance(int written, size_t size, size_t& used) {
+        if (written < 0 || used + (size_t)written >= size) return false;
+        used += (size_t)written;
+        return true;
+    }
+};
+
+#endif // BOOT_PIPELINE_H
@@ -0,0 +1,197 @@
+/*
+ * Circuit Breaker - Stops calling a backend that keeps failing
+ *
+ * One breaker per cloud sink. While the backend answers, the breaker is
+ * CLOSED and every request goes through. After BREAKER_FAILURE_THRESHOLD
+ * consecutive failures it OPENS: requests are refused locally (no DNS, no
+ * TLS handshake, no radio time, no blocking timeouts in loop()). Once the
+ * open period has passed it goes HALF-OPEN and lets exactly one probe
+ * request through; success closes it, failure re-opens it for twice as
+ * long (capped at BREAKER_MAX_OPEN_MS).
+ *
+ * Features:
+ * - Automatic recovery: no reboot needed after an outage
+ * - Exponential open period while the backend stays down
+ * - Single probe in half-open (a dead backend costs one request per period)
+ * - Transition counters and an optional listener for logging; counters
+ *   export as JSON next to the sink's latency histograms
+ * - No Arduino dependencies: callers pass millis()
+ *
+ * Usage:
+ *   CircuitBreaker breaker("ThingSpeak");
+ *   if (breaker.allowRequest(millis())) {
+ *       bool ok = upload();
+ *       ok ? breaker.onSuccess(millis()) : breaker.onFailure(millis());
+ *   }
+ */
+
+#ifndef CIRCUIT_BREAKER_H
+#define CIRCUIT_BREAKER_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define BREAKER_FAILURE_THRESHOLD 3     // Consecutive failures that open the breaker
+#define BREAKER_OPEN_MS 30000           // First open period
+#define BREAKER_MAX_OPEN_MS 600000      // Open period cap (10 minutes)
+
+enum BreakerState {
+    BREAKER_CLOSED = 0,
+    BREAKER_OPEN,
+    BREAKER_HALF_OPEN,
+    BREAKER_STATE_COUNT
+};
+
+static const char* const BREAKER_STATE_NAMES[BREAKER_STATE_COUNT] = { "closed", "open", "half-open" };
+
+struct BreakerStats {
+    uint32_t transitions[BREAKER_STATE_COUNT];   // Times each state was entered
+    uint32_t requests;                           // Allowed through (probes included)
+    uint32_t rejected;                           // Refused while open
+    uint32_t probes;                             // Half-open trial requests
+    uint32_t failures;
+    uint32_t openTimeMs;                         // Time spent not closed (finished outages)
+};
+
+class CircuitBreaker;
+
+// Called on every state change (from, to) - e.g. to log it
+typedef void (*BreakerListener)(const CircuitBreaker& breaker, BreakerState from, BreakerState to);
+
+class CircuitBreaker {
+private:
+    const char* breakerName;
+    uint8_t failureThreshold;
+    uint32_t baseOpenMs;
+    uint32_t maxOpenMs;
+
+    BreakerState currentState;
+    uint8_t consecutiveFailures;
+    uint32_t openForMs;           // Current open period (doubles per failed probe)
+    uint32_t openedAtMs;          // Entered OPEN
+    uint32_t trippedAtMs;         // Left CLOSED (for openTimeMs)
+    bool probeInFlight;
+
+    BreakerListener listener;
+    BreakerStats stats;
+
+public:
+    CircuitBreaker(const char* name = "", uint8_t threshold = BREAKER_FAILURE_THRESHOLD,
+                   uint32_t openMs = BREAKER_OPEN_MS, uint32_t maxMs = BREAKER_MAX_OPEN_MS)
+        : breakerName(name), listener(nullptr) {
+        configure(threshold, openMs, maxMs);
+    }
+
+    // Resets the breaker to CLOSED
+    void configure(uint8_t threshold, uint32_t openMs, uint32_t maxMs) {
+        failureThreshold = threshold > 0 ? threshold : 1;
+        baseOpenMs = openMs;
+        maxOpenMs = maxMs > openMs ? maxMs : openMs;
+        reset();
+    }
+
+    void reset() {
+        currentState = BREAKER_CLOSED;
+        consecutiveFailures = 0;
+        openForMs = baseOpenMs;
+        openedAtMs = 0;
+        trippedAtMs = 0;
+        probeInFlight = false;
+        stats = BreakerStats();
+    }
+
+    void setListener(BreakerListener callback) { listener = callback; }
+
+    // Ask before every request. In OPEN this is the only cost of a dead
+    // backend; once the open period is over the caller gets the probe.
+    bool allowRequest(uint32_t now) {
+        if (currentState == BREAKER_OPEN && (uint32_t)(now - openedAtMs) >= openForMs) {
+            transition(BREAKER_HALF_OPEN);
+        }
+        if (currentState == BREAKER_OPEN || (currentState == BREAKER_HALF_OPEN && probeInFlight)) {
+            stats.rejected++;
+            return false;
+        }
+        if (currentState == BREAKER_HALF_OPEN) {
+            probeInFlight = true;
+            stats.probes++;
+        }
+        stats.requests++;
+        return true;
+    }
+
+    // Same decision as allowRequest() without taking the probe (readiness checks)
+    bool wouldAllow(uint32_t now) const {
+        if (currentState == BREAKER_OPEN) return (uint32_t)(now - openedAtMs) >= openForMs;
+        return !(currentState == BREAKER_HALF_OPEN && probeInFlight);
+    }
+
+    void onSuccess(uint32_t now) {
+        consecutiveFailures = 0;
+        probeInFlight = false;
+        if (currentState != BREAKER_CLOSED) {
+            stats.openTimeMs += now - trippedAtMs;
+            openForMs = baseOpenMs;
+            transition(BREAKER_CLOSED);
+        }
+    }
+
+    void onFailure(uint32_t now) {
+        stats.failures++;
+        probeInFlight = false;
+        if (currentState == BREAKER_HALF_OPEN) {
+            // Probe failed: back off further
+            openForMs = openForMs > maxOpenMs / 2 ? maxOpenMs : openForMs * 2;
+            trip(now);
+        } else if (currentState == BREAKER_CLOSED && ++consecutiveFailures >= failureThreshold) {
+            trippedAtMs = now;
+            trip(now);
+        }
+    }
+
+    BreakerState state() const { return currentState; }
+    const char* name() const { return breakerName; }
+    const char* stateName() const { return BREAKER_STATE_NAMES[currentState]; }
+    bool isClosed() const { return currentState == BREAKER_CLOSED; }
+    uint32_t getOpenPeriod() const { return openForMs; }
+    uint8_t getConsecutiveFailures() const { return consecutiveFailures; }
+    const BreakerStats& getStats() const { return stats; }
+
+    // Milliseconds until the next probe is allowed (0 unless OPEN)
+    uint32_t msUntilProbe(uint32_t now) const {
+        if (currentState != BREAKER_OPEN) return 0;
+        uint32_t elapsed = now - openedAtMs;
+        return elapsed >= openForMs ? 0 : openForMs - elapsed;
+    }
+
+    // {"state":"open","opened":n,"half_open":n,"closed":n,"rejected":n,"probes":n,"open_ms":n}
+    int encodeJson(char* out, size_t size) const {
+        int written = snprintf(out, size,
+                               "{\"state\":\"%s\",\"opened\":%lu,\"half_open\":%lu,\"closed\":%lu,"
+                               "\"rejected\":%lu,\"probes\":%lu,\"open_ms\":%lu}",
+                               stateName(), (unsigned long)stats.transitions[BREAKER_OPEN],
+                               (unsigned long)stats.transitions[BREAKER_HALF_OPEN],
+                               (unsigned long)stats.transitions[BREAKER_CLOSED],
+                               (unsigned long)stats.rejected, (unsigned long)stats.probes,
+                               (unsigned long)stats.openTimeMs);
+        return (written < 0 || (size_t)written >= size) ? -1 : written;
+    }
+
+private:
+    void trip(uint32_t now) {
+        openedAtMs = now;
+        consecutiveFailures = 0;
+        transition(BREAKER_OPEN);
+    }
+
+    void transition(BreakerState to) {
+        BreakerState from = currentState;
+        currentState = to;
+        stats.transitions[to]++;
+        if (listener != nullptr) {
+            listener(*this, from, to);
+        }
+    }
+};
+
+#endif // CIRCUIT_BREAKER_H
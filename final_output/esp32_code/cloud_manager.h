@@ -2,6 +2,13 @@
  * Cloud Manager - ThingSpeak Integration
  * 
  * Handles ThingSpeak connection testing and data upload
+ * Upload payloads are pre-encoded by telemetry_record.h (shared by all sinks)
+ * Uploads speak HTTP directly over WiFiClient so every phase (DNS, connect,
+ * send, server, read) is timed into net_latency.h histograms
+ * A circuit breaker (circuit_breaker.h) stops uploads while ThingSpeak is
+ * unreachable and probes it once per open period instead of retrying
+ * Upload outcomes go to deferred_log.h (one record each, no UART time on
+ * the network task)
  */
 
 #ifndef CLOUD_MANAGER_H
@@ -9,16 +16,26 @@
 
 #include <HTTPClient.h>
 #include <WiFi.h>
+#include "net_latency.h"
+#include "circuit_breaker.h"
+#include "deferred_log.h"
+
+// ThingSpeak free tier accepts one update per 15 s (paced by the telemetry scheduler)
+#define THINGSPEAK_MIN_INTERVAL_MS 15000
+#define THINGSPEAK_HOST "api.thingspeak.com"
+#define THINGSPEAK_HTTP_TIMEOUT_MS 10000
 
 class CloudManager {
 private:
     String apiKey;
     String channelId;
     bool connected;
+    NetLatencyStats latency;
+    CircuitBreaker breaker;
     
 public:
     CloudManager(const char* apiKey, const char* channelId) 
-        : apiKey(apiKey), channelId(channelId), connected(false) {}
+        : apiKey(apiKey), channelId(channelId), connected(false), breaker("ThingSpeak") {}
     
     bool testConnection() {
         Serial.println("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
@@ -81,123 +98,153 @@ public:
             Serial.println("   System will continue WITHOUT cloud upload");
         }
         
+        // end() closes the socket before returning: uploads can follow at once
         http.end();
         Serial.println();
-        delay(1000);
         
         return connected;
     }
     
-    bool uploadData(float temp, float humid, float pressure, float lux, float gas) {
-        Serial.println("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
-        Serial.println("☁️  Uploading to ThingSpeak...");
-        Serial.println("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
-        
+    // Upload pre-encoded ThingSpeak fields ("field1=..&...", see telemetry_record.h).
+    // One attempt per call: failures are retried by the telemetry scheduler
+    // on its next token, and the breaker stops attempts while ThingSpeak is down.
+    bool uploadFields(const char* fields) {
         // CRITICAL: Revalidate WiFi connection state before upload
+        // (no WiFi is a local problem, not a ThingSpeak failure)
         if (WiFi.status() != WL_CONNECTED) {
-            Serial.println("   ❌ WiFi not connected! Skipping upload.");
-            Serial.println();
+            LOG(LOG_MSG_TS_NO_WIFI);
             return false;
         }
         
-        // CRITICAL: Re-test DNS resolution before upload (ESP32 DNS can fail intermittently)
-        Serial.println("   🔍 Validating connection...");
-        IPAddress serverIP;
-        if (!WiFi.hostByName("api.thingspeak.com", serverIP)) {
-            Serial.println("   ❌ DNS resolution failed!");
-            Serial.println("   Possible causes:");
-            Serial.println("      • Router lost internet connection");
-            Serial.println("      • DNS server temporarily unavailable");
-            Serial.println("   Waiting 2 seconds before retry...");
-            Serial.println();
-            delay(2000);
+        if (!breaker.allowRequest(millis())) {
+            LOG(LOG_MSG_TS_OPEN, (unsigned long)breaker.msUntilProbe(millis()) / 1000);
             return false;
         }
-        Serial.printf("   ✅ DNS OK: %s\n", serverIP.toString().c_str());
-        
-        // Build ThingSpeak URL
-        String url = "http://api.thingspeak.com/update?api_key=" + apiKey;
-        url += "&field1=" + String(temp, 2);
-        url += "&field2=" + String(humid, 2);
-        url += "&field3=" + String(pressure/100.0, 2);
-        url += "&field4=" + String(lux, 2);
-        url += "&field5=" + String(gas, 0);
-        
-        Serial.println("   📡 Sending data...");
-        
-        HTTPClient http;
-        http.begin(url);
-        http.setReuse(false);  // CRITICAL: Disable connection reuse to prevent ESP32 HTTP issues
-        http.setTimeout(10000);
         
-        int httpCode = http.GET();
-        
-        bool success = false;
+        LOG(LOG_MSG_TS_UPLOAD, breaker.isClosed() ? "" : " (probe)");
         
-        if (httpCode > 0) {
-            Serial.printf("   📥 Response: HTTP %d\n", httpCode);
-            
-            if (httpCode == 200) {
-                String response = http.getString();
-                Serial.println("   ✅ Data uploaded successfully!");
-                Serial.printf("   Entry ID: %s\n", response.c_str());
-                success = true;
-            } else {
-                Serial.printf("   ⚠️  Unexpected response code: %d\n", httpCode);
-            }
+        bool success = sendFields(fields);
+        if (success) {
+            breaker.onSuccess(millis());
         } else {
-            Serial.printf("   ❌ Connection failed: %s\n", http.errorToString(httpCode).c_str());
-            Serial.println("   Possible causes:");
-            Serial.println("      • No internet access (check router)");
-            Serial.println("      • ThingSpeak server down");
-            Serial.println("      • DNS resolution failed");
-            Serial.println("      • Firewall blocking port 80");
-            Serial.println("      • HTTP client not fully released from previous request");
+            breaker.onFailure(millis());
         }
-        
-        http.end();
-        Serial.println();
-        
         return success;
     }
     
+    const NetLatencyStats& getLatencyStats() {
+        return latency;
+    }
+    
+    // Sees every upload's total time (telemetry latency window)
+    void setLatencyListener(NetOperationListener fn, void* context) {
+        latency.setListener(fn, context);
+    }
+    
+    CircuitBreaker& getBreaker() {
+        return breaker;
+    }
+    
     bool isConnected() {
         return connected;
     }
     
-    // Upload with retry logic and exponential backoff
-    bool uploadWithRetry(float temp, float humid, float pressure, float lux, float gas) {
-        const int MAX_RETRIES = 3;
+    // True unless the breaker is open (readiness check, takes no probe)
+    bool isAvailable() {
+        return breaker.wouldAllow(millis());
+    }
+
+private:
+    // One HTTP GET /update, every phase timed
+    bool sendFields(const char* fields) {
+        NetPhaseTimer timer(&latency);
+        timer.start(micros());
         
-        for (int attempt = 1; attempt <= MAX_RETRIES; attempt++) {
-            if (attempt > 1) {
-                Serial.printf("   🔄 Retry attempt %d/%d...\n", attempt, MAX_RETRIES);
+        // CRITICAL: Re-test DNS resolution before upload (ESP32 DNS can fail intermittently)
+        IPAddress serverIP;
+        if (!WiFi.hostByName(THINGSPEAK_HOST, serverIP)) {
+            timer.finish(false, micros());
+            LOG(LOG_MSG_TS_DNS_FAILED);
+            return false;
+        }
+        timer.mark(NET_PHASE_DNS, micros());
+        
+        // New connection per update (same as HTTPClient with setReuse(false))
+        WiFiClient client;
+        if (!client.connect(serverIP, 80)) {
+            timer.finish(false, micros());
+            LOG(LOG_MSG_TS_CONNECT_FAILED);
+            return false;
+        }
+        timer.mark(NET_PHASE_CONNECT, micros());
+        
+        char request[512];
+        int requestLength = snprintf(request, sizeof(request),
+            "GET /update?api_key=%s&%s HTTP/1.1\r\n"
+            "Host: " THINGSPEAK_HOST "\r\n"
+            "User-Agent: ESP32HTTPClient\r\n"
+            "Connection: close\r\n"
+            "\r\n", apiKey.c_str(), fields);
+        if (requestLength <= 0 || requestLength >= (int)sizeof(request) ||
+            client.write((const uint8_t*)request, requestLength) != (size_t)requestLength) {
+            timer.finish(false, micros());
+            client.stop();
+            LOG(LOG_MSG_TS_SEND_FAILED);
+            return false;
+        }
+        timer.mark(NET_PHASE_SEND, micros());
+        
+        // Server phase: wait for the first response byte
+        unsigned long waitStart = millis();
+        while (!client.available()) {
+            if (!client.connected() || millis() - waitStart > THINGSPEAK_HTTP_TIMEOUT_MS) {
+                timer.finish(false, micros());
+                client.stop();
+                LOG(LOG_MSG_TS_NO_RESPONSE);
+                return false;
             }
-            
-            // Attempt upload
-            bool success = uploadData(temp, humid, pressure, lux, gas);
-            
-            if (success) {
-                if (attempt > 1) {
-                    Serial.printf("   ✅ Upload succeeded on attempt %d\n", attempt);
-                    Serial.println();
-                }
-                return true;
+            delay(1);
+        }
+        timer.mark(NET_PHASE_SERVER, micros());
+        
+        // Read phase: whole response (server closes the connection)
+        char response[256];
+        size_t responseLength = 0;
+        while ((client.connected() || client.available()) &&
+               millis() - waitStart <= THINGSPEAK_HTTP_TIMEOUT_MS) {
+            int available = client.available();
+            if (available <= 0) {
+                delay(1);
+                continue;
             }
-            
-            // Failed - wait before retry (exponential backoff)
-            if (attempt < MAX_RETRIES) {
-                unsigned long backoffDelay = 2000 * attempt;  // 2s, 4s, 6s
-                Serial.printf("   ⏳ Waiting %lu seconds before retry...\n", backoffDelay / 1000);
-                Serial.println();
-                delay(backoffDelay);
+            uint8_t chunk[128];
+            int n = client.read(chunk, available < (int)sizeof(chunk) ? available : (int)sizeof(chunk));
+            for (int i = 0; i < n && responseLength < sizeof(response) - 1; i++) {
+                response[responseLength++] = (char)chunk[i];
             }
         }
+        response[responseLength] = '\0';
+        client.stop();
+        timer.mark(NET_PHASE_READ, micros());
         
-        Serial.println("   ❌ All upload attempts failed!");
-        Serial.println("   System will continue, data not uploaded to cloud.");
-        Serial.println();
-        return false;
+        // "HTTP/1.1 200 OK\r\n...\r\n\r\n<entry id>"
+        int httpCode = responseLength > 12 ? atoi(response + 9) : 0;
+        const char* body = strstr(response, "\r\n\r\n");
+        body = body ? body + 4 : "";
+        
+        bool success = false;
+        
+        if (httpCode == 200) {
+            LOG(LOG_MSG_TS_OK, body);
+            success = true;
+        } else if (httpCode > 0) {
+            LOG(LOG_MSG_TS_HTTP, httpCode);
+        } else {
+            LOG(LOG_MSG_TS_MALFORMED);
+        }
+        timer.finish(success, micros());
+        
+        return success;
     }
 };
 
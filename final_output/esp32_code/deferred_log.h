@@ -0,0 +1,439 @@
+/*
+ * Deferred Log - Binary log records in a ring, drained off the hot path
+ *
+ * A prediction used to print ~25 box-drawn lines, each sensor reading one
+ * more, each upload ~15: several kB of printf float formatting per cycle
+ * pushed through a 115200 baud UART, which blocks the caller once the TX
+ * buffer is full. LOG() instead copies the message id and its raw
+ * arguments (10-40 bytes) into a RAM ring and returns; a low-priority task
+ * drains the ring and either sends each record as a small frame for
+ * host_tools/log_decoder.cpp to format, or formats it itself.
+ *
+ * Features:
+ * - Compile-time levels: LOG(id, ...) compiles to nothing (arguments are
+ *   not evaluated) when the message's level in log_messages.h is above
+ *   LOG_LEVEL (define it before including this header)
+ * - Records: u32 timestamp (µs), u16 message id, tagged arguments (int32,
+ *   int64, uint32, uint64, float, string); no heap, no formatting on the
+ *   caller's side
+ * - Ring shared by both cores under a PortLock; a full ring drops the new
+ *   record and counts it; the drain reports the count as LOG_MSG_DROPPED
+ * - Time spent inside LOG() is summed per core; takeSpentUs() hands the
+ *   sum to the caller once per cycle (loop iteration, network pass)
+ * - Wire frame (binary output):
+ *     0x00 'L' | u8 length | record (length bytes) | CRC-16 over length + record
+ *   0x00 never appears in the sketch's text, so the decoder passes text
+ *   through unchanged and picks the frames out of the same serial stream
+ * - log_format_line(): the one formatter, used by the decoder and by the
+ *   drain task in text mode
+ * - No Arduino dependencies (host tools reuse all of it)
+ *
+ * Usage:
+ *   #define LOG_LEVEL LOG_LEVEL_INFO
+ *   #include "deferred_log.h"
+ *   LOG(LOG_MSG_PREDICTION, totalPredictions, name, classId, inferenceUs);
+ *   deferred_log().drain(writeToSerial, nullptr, true, 16);   // Low-priority task
+ */
+
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "log_messages.h"
+#include "task_port.h"
+#include "telemetry_codec.h"
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define LOG_BUFFER_SIZE 4096        // Ring bytes (~150 records)
+#define LOG_MAX_RECORD 120          // Record bytes (timestamp + id + arguments)
+#define LOG_MAX_STRING 32           // Longer %s arguments are cut
+#define LOG_FRAME_MAGIC0 0x00
+#define LOG_FRAME_MAGIC1 'L'
+#define LOG_FRAME_OVERHEAD 5        // Magic, length, CRC
+#define LOG_MAX_LINE 192
+
+#define LOG_ARG_INT32 'i'
+#define LOG_ARG_INT64 'I'
+#define LOG_ARG_UINT32 'u'
+#define LOG_ARG_UINT64 'U'
+#define LOG_ARG_FLOAT 'f'
+#define LOG_ARG_STRING 's'
+
+#define LOG_FIRST(first, ...) first
+#define LOG(...)                                                                                                  \
+    do {                                                                                                          \
+        if (log_message_level(LOG_FIRST(__VA_ARGS__, 0)) <= LOG_LEVEL) deferred_log().write(__VA_ARGS__);       \
+    } while (0)
+
+// ==================== RECORD ENCODING ====================
+struct LogRecordWriter {
+    uint8_t* p;
+    uint8_t* end;
+    bool overflow;
+
+    LogRecordWriter(uint8_t* out, size_t size) : p(out), end(out + size), overflow(false) {}
+
+    void raw(const void* data, size_t length) {
+        if ((size_t)(end - p) < length) {
+            overflow = true;
+            return;
+        }
+        memcpy(p, data, length);
+        p += length;
+    }
+
+    void tagged(char tag, const void* data, size_t length) {
+        uint8_t t = (uint8_t)tag;
+        raw(&t, 1);
+        raw(data, length);
+    }
+
+    size_t length(const uint8_t* start) const { return (size_t)(p - start); }
+};
+
+inline void log_arg(LogRecordWriter& w, int v) { int32_t x = v; w.tagged(LOG_ARG_INT32, &x, 4); }
+inline void log_arg(LogRecordWriter& w, unsigned int v) { uint32_t x = v; w.tagged(LOG_ARG_UINT32, &x, 4); }
+inline void log_arg(LogRecordWriter& w, long long v) { int64_t x = v; w.tagged(LOG_ARG_INT64, &x, 8); }
+inline void log_arg(LogRecordWriter& w, unsigned long long v) { uint64_t x = v; w.tagged(LOG_ARG_UINT64, &x, 8); }
+inline void log_arg(LogRecordWriter& w, long v) {
+    if (sizeof(long) > 4) log_arg(w, (long long)v);
+    else log_arg(w, (int)v);
+}
+inline void log_arg(LogRecordWriter& w, unsigned long v) {
+    if (sizeof(long) > 4) log_arg(w, (unsigned long long)v);
+    else log_arg(w, (unsigned int)v);
+}
+inline void log_arg(LogRecordWriter& w, bool v) { log_arg(w, (unsigned int)v); }
+inline void log_arg(LogRecordWriter& w, double v) { float x = (float)v; w.tagged(LOG_ARG_FLOAT, &x, 4); }
+inline void log_arg(LogRecordWriter& w, const char* s) {
+    size_t n = s ? strnlen(s, LOG_MAX_STRING) : 0;
+    uint8_t length = (uint8_t)n;
+    uint8_t tag = LOG_ARG_STRING;
+    w.raw(&tag, 1);
+    w.raw(&length, 1);
+    w.raw(s, n);
+}
+
+inline void log_args(LogRecordWriter&) {}
+
+template <typename T, typename... Rest>
+inline void log_args(LogRecordWriter& w, const T& first, const Rest&... rest) {
+    log_arg(w, first);
+    log_args(w, rest...);
+}
+
+// ==================== FORMATTER ====================
+// One record (timestamp, id, arguments) as
+//   "[   12.345678] I predict: #3 Sunny (class 4) in 812 us"
+// Returns false if the id is unknown or the arguments do not match the
+// format (the line then shows "<?>" where they diverge).
+inline bool log_format_line(const uint8_t* record, size_t length, char* out, size_t size) {
+    if (size == 0) return false;
+    out[0] = '\0';
+    if (length < 6) return false;
+    uint32_t timestamp;
+    uint16_t id;
+    memcpy(&timestamp, record, 4);
+    memcpy(&id, record + 4, 2);
+    const uint8_t* arg = record + 6;
+    const uint8_t* end = record + length;
+
+    size_t used = 0;
+    auto append = [&](int n) {
+        if (n > 0) used += (size_t)n;
+        if (used >= size) used = size - 1;
+    };
+    if (id >= LOG_MESSAGE_COUNT) {
+        append(snprintf(out, size, "[%7lu.%06lu] ? unknown message %u", (unsigned long)(timestamp / 1000000),
+                        (unsigned long)(timestamp % 1000000), id));
+        return false;
+    }
+    append(snprintf(out, size, "[%7lu.%06lu] %s ", (unsigned long)(timestamp / 1000000),
+                    (unsigned long)(timestamp % 1000000), LOG_LEVEL_NAMES[LOG_MESSAGE_LEVELS[id]]));
+
+    bool ok = true;
+    const char* f = LOG_MESSAGE_FORMATS[id];
+    while (*f && used < size - 1) {
+        if (*f != '%') {
+            out[used++] = *f++;
+            out[used] = '\0';
+            continue;
+        }
+        if (f[1] == '%') {
+            out[used++] = '%';
+            out[used] = '\0';
+            f += 2;
+            continue;
+        }
+        // %[flags][width][.precision][length]conversion, rebuilt without
+        // the length so the value can be passed at its decoded width
+        char spec[24];
+        size_t s = 0;
+        spec[s++] = *f++;
+        while (*f && strchr("-+ #0123456789.", *f) && s < sizeof(spec) - 4) spec[s++] = *f++;
+        while (*f && strchr("hljztL", *f)) f++;
+        char conversion = *f ? *f++ : '\0';
+
+        char tag = arg < end ? (char)*arg++ : '\0';
+        bool integer = tag == LOG_ARG_INT32 || tag == LOG_ARG_INT64 || tag == LOG_ARG_UINT32 || tag == LOG_ARG_UINT64;
+        if (integer && strchr("diuxXoc", conversion) && conversion) {
+            size_t bytes = (tag == LOG_ARG_INT64 || tag == LOG_ARG_UINT64) ? 8 : 4;
+            if (end - arg < (ptrdiff_t)bytes) {
+                ok = false;
+                break;
+            }
+            long long signedValue = 0;
+            unsigned long long unsignedValue = 0;
+            if (tag == LOG_ARG_INT32) {
+                int32_t v;
+                memcpy(&v, arg, 4);
+                signedValue = v;
+                unsignedValue = (uint32_t)v;
+            } else if (tag == LOG_ARG_UINT32) {
+                uint32_t v;
+                memcpy(&v, arg, 4);
+                signedValue = v;
+                unsignedValue = v;
+            } else if (tag == LOG_ARG_INT64) {
+                int64_t v;
+                memcpy(&v, arg, 8);
+                signedValue = v;
+                unsignedValue = (uint64_t)v;
+            } else {
+                uint64_t v;
+                memcpy(&v, arg, 8);
+                signedValue = (long long)v;
+                unsignedValue = v;
+            }
+            arg += bytes;
+            if (conversion == 'c') {
+                spec[s++] = 'c';
+                spec[s] = '\0';
+                append(snprintf(out + used, size - used, spec, (int)signedValue));
+            } else {
+                spec[s++] = 'l';
+                spec[s++] = 'l';
+                spec[s++] = conversion;
+                spec[s] = '\0';
+                if (conversion == 'd' || conversion == 'i') {
+                    append(snprintf(out + used, size - used, spec, signedValue));
+                } else {
+                    append(snprintf(out + used, size - used, spec, unsignedValue));
+                }
+            }
+        } else if (tag == LOG_ARG_FLOAT && conversion && strchr("feEgGaA", conversion)) {
+            if (end - arg < 4) {
+                ok = false;
+                break;
+            }
+            float v;
+            memcpy(&v, arg, 4);
+            arg += 4;
+            spec[s++] = conversion;
+            spec[s] = '\0';
+            append(snprintf(out + used, size - used, spec, (double)v));
+        } else if (tag == LOG_ARG_STRING && conversion == 's') {
+            if (arg >= end || end - arg - 1 < (ptrdiff_t)*arg) {
+                ok = false;
+                break;
+            }
+            char text[LOG_MAX_STRING + 1];
+            size_t n = *arg++;
+            memcpy(text, arg, n);
+            text[n] = '\0';
+            arg += n;
+            spec[s++] = 's';
+            spec[s] = '\0';
+            append(snprintf(out + used, size - used, spec, text));
+        } else {
+            ok = false;
+            break;
+        }
+    }
+    if (!ok || arg != end) {
+        append(snprintf(out + used, size - used, " <?>"));
+        return false;
+    }
+    return true;
+}
+
+// ==================== RING ====================
+typedef void (*LogOutputFn)(const uint8_t* data, size_t length, void* context);
+
+struct LogStats {
+    uint32_t records;       // Accepted into the ring
+    uint32_t dropped;       // Ring full
+    uint32_t truncated;     // Arguments did not fit LOG_MAX_RECORD (record dropped)
+    uint32_t bytes;         // Record bytes accepted
+    uint32_t highWater;     // Most ring bytes in use
+    uint32_t drained;       // Records written out
+    uint32_t outputBytes;   // Bytes handed to the output (frames or text)
+    uint32_t drainBusyUs;   // Time in drain(), output included
+    uint32_t drainMaxUs;
+};
+
+class DeferredLog {
+private:
+    uint8_t ring[LOG_BUFFER_SIZE];
+    uint32_t head;          // Bytes ever written (mod 2^32)
+    uint32_t tail;          // Bytes ever read
+    uint32_t spentUs[2];    // Time inside write() per core since takeSpentUs()
+    uint32_t reportedDrops;
+    LogStats stats;
+    PortLock lock;
+
+public:
+    DeferredLog() : head(0), tail(0), reportedDrops(0) {
+        spentUs[0] = spentUs[1] = 0;
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    template <typename... Args>
+    void write(LogMessageId id, const Args&... args) {
+        uint32_t start = port_micros();
+        uint8_t record[1 + LOG_MAX_RECORD];
+        LogRecordWriter w(record + 1, LOG_MAX_RECORD);
+        uint16_t message = (uint16_t)id;
+        w.raw(&start, 4);
+        w.raw(&message, 2);
+        log_args(w, args...);
+        size_t length = w.length(record + 1);
+        record[0] = (uint8_t)length;
+        int slot = port_current_core() == 0 ? 0 : 1;
+
+        lock.lock();
+        if (w.overflow) {
+            stats.truncated++;
+        } else if (LOG_BUFFER_SIZE - (head - tail) < length + 1) {
+            stats.dropped++;
+        } else {
+            copyIn(record, length + 1);
+            stats.records++;
+            stats.bytes += (uint32_t)length;
+            if (head - tail > stats.highWater) stats.highWater = head - tail;
+        }
+        spentUs[slot] += port_micros() - start;
+        lock.unlock();
+    }
+
+    // Write out up to maxRecords records (frames, or text lines ending in
+    // CR LF when !binary). Runs on the drain task: output may block.
+    size_t drain(LogOutputFn output, void* context, bool binary, size_t maxRecords) {
+        uint32_t start = port_micros();
+        size_t count = 0;
+        uint8_t record[1 + LOG_MAX_RECORD];
+
+        lock.lock();
+        uint32_t drops = stats.dropped + stats.truncated;
+        lock.unlock();
+        if (drops != reportedDrops) {
+            LogRecordWriter w(record + 1, LOG_MAX_RECORD);
+            uint16_t message = LOG_MSG_DROPPED;
+            w.raw(&start, 4);
+            w.raw(&message, 2);
+            log_arg(w, (unsigned long)(drops - reportedDrops));
+            record[0] = (uint8_t)w.length(record + 1);
+            reportedDrops = drops;
+            emit(record, output, context, binary);
+        }
+
+        while (count < maxRecords) {
+            lock.lock();
+            if (head == tail) {
+                lock.unlock();
+                break;
+            }
+            size_t length = ring[tail % LOG_BUFFER_SIZE];
+            copyOut(record, length + 1);
+            lock.unlock();
+            emit(record, output, context, binary);
+            count++;
+        }
+
+        uint32_t busy = port_micros() - start;
+        lock.lock();
+        stats.drained += (uint32_t)count;
+        if (count > 0) {
+            stats.drainBusyUs += busy;
+            if (busy > stats.drainMaxUs) stats.drainMaxUs = busy;
+        }
+        lock.unlock();
+        return count;
+    }
+
+    // Time spent in write() on this core since the last call
+    uint32_t takeSpentUs(int core) {
+        int slot = core == 0 ? 0 : 1;
+        lock.lock();
+        uint32_t spent = spentUs[slot];
+        spentUs[slot] = 0;
+        lock.unlock();
+        return spent;
+    }
+
+    LogStats getStats() {
+        lock.lock();
+        LogStats copy = stats;
+        lock.unlock();
+        return copy;
+    }
+
+    uint32_t getDepth() {
+        lock.lock();
+        uint32_t depth = head - tail;
+        lock.unlock();
+        return depth;
+    }
+
+    static size_t capacity() { return LOG_BUFFER_SIZE; }
+
+private:
+    // Caller holds the lock
+    void copyIn(const uint8_t* data, size_t length) {
+        for (size_t i = 0; i < length; i++) ring[(head + i) % LOG_BUFFER_SIZE] = data[i];
+        head += (uint32_t)length;
+    }
+
+    void copyOut(uint8_t* data, size_t length) {
+        for (size_t i = 0; i < length; i++) data[i] = ring[(tail + i) % LOG_BUFFER_SIZE];
+        tail += (uint32_t)length;
+    }
+
+    // record[0] is the length, the record follows
+    void emit(uint8_t* record, LogOutputFn output, void* context, bool binary) {
+        size_t length = record[0];
+        if (binary) {
+            uint8_t frame[LOG_FRAME_OVERHEAD + LOG_MAX_RECORD];
+            frame[0] = LOG_FRAME_MAGIC0;
+            frame[1] = LOG_FRAME_MAGIC1;
+            memcpy(frame + 2, record, length + 1);
+            uint16_t crc = telemetry_crc16(frame + 2, length + 1);
+            frame[3 + length] = (uint8_t)crc;
+            frame[4 + length] = (uint8_t)(crc >> 8);
+            output(frame, length + LOG_FRAME_OVERHEAD, context);
+            stats.outputBytes += (uint32_t)(length + LOG_FRAME_OVERHEAD);
+        } else {
+            char line[LOG_MAX_LINE + 2];
+            log_format_line(record + 1, length, line, LOG_MAX_LINE);
+            size_t n = strlen(line);
+            line[n++] = '\r';
+            line[n++] = '\n';
+            output((const uint8_t*)line, n, context);
+            stats.outputBytes += (uint32_t)n;
+        }
+    }
+};
+
+// The log every LOG() call writes to
+inline DeferredLog& deferred_log() {
+    static DeferredLog instance;
+    return instance;
+}
+
+#endif // DEFERRED_LOG_H
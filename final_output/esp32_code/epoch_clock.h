@@ -0,0 +1,110 @@
+/*
+ * Epoch Clock - Maps the boot-relative millis() clock to Unix epoch time
+ *
+ * Records are stamped with millis(); this clock turns those stamps into
+ * epoch milliseconds once a time source (SNTP) has been seen, so cloud keys
+ * and timestamps are wall-clock based and never collide across reboots.
+ *
+ * Features:
+ * - Anchor (millis, epoch) pair refreshed on every sync
+ * - Drift tracking: the crystal's frequency error (ppm) is estimated from
+ *   consecutive syncs and applied between them
+ * - Small errors are absorbed into the drift estimate, large ones (clock
+ *   set, first NTP answer after a bad guess) step the anchor
+ * - Wrap-safe for millis() as long as syncs are less than 24 days apart
+ * - Converts stamps taken before the latest sync too (signed offsets)
+ * - No Arduino dependencies: callers pass millis() and the epoch time
+ */
+
+#ifndef EPOCH_CLOCK_H
+#define EPOCH_CLOCK_H
+
+#include <stdint.h>
+
+#define EPOCH_CLOCK_STEP_MS 2000         // Errors above this step the anchor
+#define EPOCH_CLOCK_MAX_DRIFT_PPM 500    // Crystal tolerance clamp
+#define EPOCH_CLOCK_MIN_SPAN_MS 60000    // Shortest sync interval used for drift
+#define EPOCH_CLOCK_VALID_AFTER_S 1700000000UL   // Anything earlier is "not set yet"
+
+struct EpochClockStats {
+    uint32_t syncs;
+    uint32_t steps;
+    int32_t lastErrorMs;     // Measured minus predicted at the latest sync
+    float driftPpm;          // Positive: millis() runs slow
+};
+
+class EpochClock {
+private:
+    uint32_t anchorMs;       // millis() at the anchor
+    uint64_t anchorEpochMs;  // Epoch time at the anchor
+    float driftPpm;
+    bool synced;
+    EpochClockStats stats;
+
+public:
+    EpochClock() { reset(); }
+
+    void reset() {
+        anchorMs = 0;
+        anchorEpochMs = 0;
+        driftPpm = 0.0f;
+        synced = false;
+        stats = EpochClockStats();
+    }
+
+    bool isSynced() const { return synced; }
+
+    // Feed one (millis, epoch ms) observation from the time source.
+    // Returns false if the epoch time is implausible (source not set yet).
+    bool sync(uint32_t monoMs, uint64_t epochMs) {
+        if (epochMs / 1000 < EPOCH_CLOCK_VALID_AFTER_S) {
+            return false;
+        }
+        stats.syncs++;
+        if (!synced) {
+            anchor(monoMs, epochMs);
+            synced = true;
+            return true;
+        }
+
+        int32_t span = (int32_t)(monoMs - anchorMs);
+        int64_t error = (int64_t)epochMs - (int64_t)toEpochMs(monoMs);
+        stats.lastErrorMs = (int32_t)error;
+        if (error > EPOCH_CLOCK_STEP_MS || error < -EPOCH_CLOCK_STEP_MS) {
+            // Clock was set: start over, the old drift estimate is meaningless
+            stats.steps++;
+            driftPpm = 0.0f;
+        } else if (span >= EPOCH_CLOCK_MIN_SPAN_MS) {
+            // Residual error over the span is the remaining frequency error
+            driftPpm += (float)((double)error * 1e6 / span);
+            if (driftPpm > EPOCH_CLOCK_MAX_DRIFT_PPM) driftPpm = EPOCH_CLOCK_MAX_DRIFT_PPM;
+            if (driftPpm < -EPOCH_CLOCK_MAX_DRIFT_PPM) driftPpm = -EPOCH_CLOCK_MAX_DRIFT_PPM;
+        } else {
+            return true;     // Too close to the anchor to learn anything
+        }
+        stats.driftPpm = driftPpm;
+        anchor(monoMs, epochMs);
+        return true;
+    }
+
+    // Epoch ms for a millis() stamp (before or after the anchor), 0 before
+    // the first sync
+    uint64_t toEpochMs(uint32_t monoMs) const {
+        if (!synced) {
+            return 0;
+        }
+        int32_t delta = (int32_t)(monoMs - anchorMs);
+        int64_t corrected = (int64_t)delta + (int64_t)((double)delta * driftPpm / 1e6);
+        return (uint64_t)((int64_t)anchorEpochMs + corrected);
+    }
+
+    const EpochClockStats& getStats() const { return stats; }
+
+private:
+    void anchor(uint32_t monoMs, uint64_t epochMs) {
+        anchorMs = monoMs;
+        anchorEpochMs = epochMs;
+    }
+};
+
+#endif // EPOCH_CLOCK_H
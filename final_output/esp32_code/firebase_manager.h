@@ -6,8 +6,17 @@
 * - Unique device ID (MAC address based)
 * - Separate fields for each sensor reading
 * - Prediction history storage with timestamps
-* - Device metadata tracking
+* - Device metadata tracking (info node rewritten only when its content
+*   hash changes; the hash is kept in NVS across reboots)
 * - Configurable backup intervals
+* - Readings batched into one multi-path PATCH (REST) with the status node
+* - Zero heap allocations per backup (json_stream_writer.h into fixed buffers)
+* - Per-reading and per-flush lines go to deferred_log.h
+* - Minute/hour/day rollups (rollup_aggregator.h) ride along in the same PATCH
+* - Circuit breaker (circuit_breaker.h): a dead backend is probed once per
+*   open period instead of disabling backup until reboot
+* - Non-blocking init: initialize() starts token generation,
+*   finishInitialize() is polled by the boot pipeline (boot_pipeline.h)
 * - Failure handling and statistics
 *
 * Database Structure:
@@ -22,16 +31,48 @@
 *   ├─ status/ (Current status)
 *   │  ├─ online
 *   │  └─ last_seen
-*   └─ readings/{timestamp}/ (Sensor readings)
+*   ├─ latency/{start}/ (Per-window latency summaries, latency_window.h)
+*   │  ├─ start, window_s
+*   │  └─ inference, loop, upload ({n, p50, p90, p99, max} µs)
+*   ├─ aggregates/{minute|hour|day}/{start}/{segment}/ (Rollups of every record,
+*   │  │                                        one segment per boot; readers merge them)
+*   │  ├─ start, n
+*   │  ├─ temperature, humidity, pressure, lux, gas_ppm ([min, max, mean])
+*   │  └─ classes ([count per class_id])
+*   └─ readings/{epoch_ms}/ (Sensor readings, 13-digit keys: sorted by time)
 *      ├─ temperature
 *      ├─ humidity
 *      ├─ pressure
 *      ├─ lux
-*      ├─ gas_ppm (optional)
-*      ├─ gas_quality (optional)
+*      ├─ gas_ppm
 *      ├─ prediction
+*      ├─ class_id
+*      ├─ votes
 *      ├─ inference_time
-*      └─ timestamp
+*      ├─ rssi
+*      ├─ timestamp
+*      └─ device_id
+*
+* Batched Writes:
+*   Readings are queued in RAM and flushed as a single multi-location update
+*     PATCH /devices/{device_id}.json?auth={token}&print=silent
+*     {"readings/{t1}":{...},...,"status":{...},"aggregates/hour/{h}/{seg}":{...},...,
+*      "latency/{start}":{...}}
+*   when FIREBASE_BATCH_SIZE readings are queued or the oldest one has waited
+*   FIREBASE_BATCH_FLUSH_MS. One TLS connection is kept alive between flushes.
+*   A failed flush keeps the batch; a full batch refuses new readings (the
+*   telemetry scheduler keeps them pending). While the breaker is open,
+*   readings keep queueing until the batch is full and nothing is sent;
+*   the first flush after the open period is the probe. Unflushed readings are lost on
+*   reboot - the local LittleFS log keeps every record. Dirty rollups are
+*   flushed on the same interval even when no reading is queued.
+*
+* Boot Heartbeat:
+*   No separate status/info writes at boot. The first reading after boot is
+*   flushed at once and its PATCH also carries
+*     "info":{...}         when the info content hash differs from NVS, or
+*     "info/last_boot":t   when only the boot time changed
+*   Every later PATCH refreshes status/last_seen.
 *
 * Library Required:
 * - "Firebase Arduino Client Library for ESP8266 and ESP32" by Mobizt
@@ -42,6 +83,14 @@
 #define FIREBASE_MANAGER_H
 
 #include <Arduino.h>
+#include "telemetry_record.h"
+#include "net_latency.h"
+#include "json_stream_writer.h"
+#include "rollup_aggregator.h"
+#include "latency_window.h"
+#include "epoch_clock.h"
+#include "circuit_breaker.h"
+#include "deferred_log.h"
 
 // ==================== CONFIGURATION ====================
 // Firebase project credentials
@@ -53,20 +102,41 @@
 #define FIREBASE_USER_PASSWORD "esp32test123"
 
 // Backup settings
+#ifndef FIREBASE_ENABLED                 // Sketches may set it before including this header
 #define FIREBASE_ENABLED true      // ✅ ENABLED - Library installed
-#define BACKUP_INTERVAL 15000      // Backup every 15 seconds for testing (was 300000 = 5 min)
-#define MAX_FAILED_UPLOADS 10      // Stop trying after 10 failures
+#endif
+#define BACKUP_INTERVAL 15000      // Min spacing between backups, enforced by the telemetry scheduler
+#define FIREBASE_INIT_TIMEOUT_MS 20000     // Give up on the first auth token after this
+
+// Batched writes (multi-path PATCH over the REST API)
+#define FIREBASE_BATCH_SIZE 16             // Readings per PATCH (max; see setBatching)
+#define FIREBASE_BATCH_FLUSH_MS 300000     // Flush a partial batch after 5 minutes
+#define FIREBASE_REST_PORT 443
+#define FIREBASE_HTTP_TIMEOUT_MS 10000
+#define FIREBASE_STATUS_RESERVE 64         // ,"status":{...}} appended at flush time
+#define FIREBASE_INFO_RESERVE 400          // ,"info":{...} on the first flush after boot
+#define FIREBASE_AGGREGATE_NODES 8         // Rollup nodes per PATCH (the rest wait for the next)
+#define FIREBASE_AGGREGATE_NODE_SIZE 464   // ,"aggregates/minute/{start}/{segment}":{...}
+#define FIREBASE_LATENCY_NODES 4           // Closed latency windows waiting for a flush (oldest dropped)
+#define FIREBASE_LATENCY_NODE_SIZE (LATENCY_JSON_SIZE + 24)   // ,"latency/{start}":{...}
+#define FIREBASE_BATCH_BODY_SIZE (FIREBASE_BATCH_SIZE * (TELEMETRY_MAX_PAYLOAD + 24) + FIREBASE_STATUS_RESERVE + \
+                                  FIREBASE_INFO_RESERVE + FIREBASE_AGGREGATE_NODES * FIREBASE_AGGREGATE_NODE_SIZE + \
+                                  FIREBASE_LATENCY_NODES * FIREBASE_LATENCY_NODE_SIZE)
+#define FIREBASE_NODE_SIZE 384             // Info/status nodes
+#define FIREBASE_HEADER_SIZE 1536          // Request line + headers (ID token is ~1 KB)
+#define FIREBASE_PREFS_NAMESPACE "firebase"  // NVS: info_hash
 
 // Firebase library includes
 #include <Firebase_ESP_Client.h>
 #include <addons/TokenHelper.h>
 #include <addons/RTDBHelper.h>
+#include <WiFiClientSecure.h>
+#include <Preferences.h>
 
 // ==================== FIREBASE MANAGER ====================
 class FirebaseManager {
 private:
-  // Firebase objects
-  FirebaseData fbdo;
+  // Firebase objects (the library only handles sign-in; writes go over REST)
   FirebaseAuth auth;
   FirebaseConfig config;
   
@@ -76,7 +146,6 @@ private:
   bool initialized;
   bool connected;
   unsigned long backupInterval;
-  unsigned long maxConsecutiveFailures;
   
   // Timing
   unsigned long lastBackupTime;
@@ -87,21 +156,101 @@ private:
   unsigned long successfulBackups;
   unsigned long failedBackups;
   unsigned long consecutiveFailures;
+  
+  // Stops flushes while Firebase keeps failing, probes it periodically
+  CircuitBreaker breaker;
+  
+  // Upload timing (every REST phase)
+  NetLatencyStats latency;
+  
+  // Info/status node and request header scratch (reused, no heap)
+  char nodeBuffer[FIREBASE_NODE_SIZE];
+  char headerBuffer[FIREBASE_HEADER_SIZE];
+  
+  // Batched readings: the body of the next PATCH, built in place
+  char batchBody[FIREBASE_BATCH_BODY_SIZE];
+  size_t batchLength;
+  unsigned int batchCount;
+  unsigned int batchSize;
+  unsigned long flushInterval;
+  unsigned long batchStartedAt;
+  unsigned long lastFlushAttempt;
+  unsigned long flushedReadings;
+  unsigned long bytesSent;
+  
+  // Minute/hour/day rollups of every record (dirty ones go out with the batch)
+  RollupAggregator rollups;
+  
+  // Closed latency windows, pre-encoded as ,"latency/{start}":{...} (oldest first)
+  char latencyNodes[FIREBASE_LATENCY_NODES][FIREBASE_LATENCY_NODE_SIZE];
+  uint16_t latencyLengths[FIREBASE_LATENCY_NODES];
+  uint8_t latencyCount;
+  uint8_t latencyStaged;       // Nodes carried by the PATCH in flight
+  unsigned long latencyWritten;
+  unsigned long latencyDropped;
+  
+  // Device info, sent with the first flush after boot (see Boot Heartbeat)
+  DeviceInfo deviceInfo;
+  char macAddress[18];
+  uint32_t infoHash;           // Content hash of deviceInfo (without last_boot)
+  bool infoChanged;            // Hash differs from the one stored in NVS
+  bool bootPending;            // last_boot not written yet this boot
+  bool bootStaged;             // The PATCH in flight carries info
+  
+  // REST round trips (every restRequest call)
+  unsigned long restRequests;
+  unsigned long bootRequests;  // Round trips until the boot heartbeat landed
+  
+  // Token generation started by initialize(), not settled yet
+  bool initPending;
+  unsigned long initStartedAt;
+  
+  // Wall clock (time_service.h) for status times; last key keeps keys unique
+  const EpochClock* epochClock;
+  uint64_t lastReadingKey;
+  
+  // REST connection (kept alive between flushes)
+  WiFiClientSecure restClient;
+  char restHost[96];
 
 public:
-  FirebaseManager() {
+  FirebaseManager() : breaker("Firebase") {
     deviceID = "";
     enabled = FIREBASE_ENABLED;
     initialized = false;
     connected = false;
     backupInterval = BACKUP_INTERVAL;
-    maxConsecutiveFailures = MAX_FAILED_UPLOADS;
     lastBackupTime = 0;
     readingCount = 0;
     totalBackups = 0;
     successfulBackups = 0;
     failedBackups = 0;
     consecutiveFailures = 0;
+    batchLength = 0;
+    batchCount = 0;
+    batchSize = FIREBASE_BATCH_SIZE;
+    flushInterval = FIREBASE_BATCH_FLUSH_MS;
+    batchStartedAt = 0;
+    lastFlushAttempt = 0;
+    flushedReadings = 0;
+    bytesSent = 0;
+    latencyCount = 0;
+    latencyStaged = 0;
+    latencyWritten = 0;
+    latencyDropped = 0;
+    epochClock = nullptr;
+    lastReadingKey = 0;
+    initPending = false;
+    initStartedAt = 0;
+    memset(&deviceInfo, 0, sizeof(deviceInfo));
+    macAddress[0] = '\0';
+    infoHash = 0;
+    infoChanged = false;
+    bootPending = false;
+    bootStaged = false;
+    restRequests = 0;
+    bootRequests = 0;
+    restHost[0] = '\0';
   }
 
   // ==================== INITIALIZATION ====================
@@ -111,10 +260,11 @@ public:
     Serial.println("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
     
     // Generate unique device ID from MAC address
-    deviceID = generateDeviceID();
+    getDeviceIDCStr();
     Serial.printf("   Device ID: %s\n", deviceID.c_str());
     Serial.printf("   Database: %s\n", FIREBASE_HOST);
     Serial.printf("   Interval: %lu seconds\n", backupInterval / 1000);
+    Serial.printf("   Batching: %u readings or %lu s per PATCH\n", batchSize, flushInterval / 1000);
     
     if (!enabled) {
       // Run in simulated mode (shows messages without actual Firebase connection)
@@ -124,7 +274,6 @@ public:
       Serial.println("   Action: Set FIREBASE_ENABLED = true to activate real Firebase");
       Serial.println("   Note: Backup messages will appear every 15 seconds");
       Serial.println();
-      delay(500);
       return;
     }
 
@@ -132,6 +281,15 @@ public:
     config.api_key = FIREBASE_API_KEY;
     config.database_url = FIREBASE_HOST;
     
+    // REST host for batched PATCHes ("https://name.region.firebasedatabase.app/")
+    const char* host = strstr(FIREBASE_HOST, "://");
+    snprintf(restHost, sizeof(restHost), "%s", host ? host + 3 : FIREBASE_HOST);
+    size_t hostLength = strlen(restHost);
+    if (hostLength > 0 && restHost[hostLength - 1] == '/') {
+      restHost[hostLength - 1] = '\0';
+    }
+    restClient.setInsecure();
+    
     // Authentication (REQUIRED for Firebase)
     auth.user.email = FIREBASE_USER_EMAIL;
     auth.user.password = FIREBASE_USER_PASSWORD;
@@ -144,203 +302,341 @@ public:
     Firebase.begin(&config, &auth);
     Firebase.reconnectWiFi(true);
     
-    // Wait for token generation (increased timeout)
-    Serial.print("   Connecting");
-    int attempts = 0;
-    while (!Firebase.ready() && attempts < 40) {  // Increased from 20 to 40
-      Serial.print(".");
-      delay(500);
-      attempts++;
-    }
-    
+    // Token generation continues in finishInitialize() (no waiting here)
+    initPending = true;
+    initStartedAt = millis();
+    Serial.printf("   Status: ⏳ Requesting auth token (up to %d s, in the background)\n",
+                  FIREBASE_INIT_TIMEOUT_MS / 1000);
     Serial.println();
-    
+  }
+  
+  // Poll the token started by initialize(). Returns true once settled:
+  // ready (isInitialized()) or FIREBASE_INIT_TIMEOUT_MS passed.
+  bool finishInitialize() {
+    if (!initPending) {
+      return true;
+    }
     if (Firebase.ready()) {
+      initPending = false;
       initialized = true;
       connected = true;
-      Serial.println("   Status: ✅ Connected to Firebase");
-      Serial.println("   Action: Backups will occur every 15 seconds during simulation");
+      Serial.printf("\n💾 Firebase: ✅ Connected (token after %.1f s)\n", (millis() - initStartedAt) / 1000.0f);
+      Serial.println("   Action: Readings will be batched during simulation");
       
-      // Save device info on startup
-      saveDeviceInfo("v3.0", "RandomForest-250trees");
-      updateDeviceStatus(true);
-    } else {
-      Serial.println("   Status: ❌ Connection failed");
+      // Device info and online status go out with the first reading
+      prepareDeviceInfo("v3.0", "RandomForest-250trees");
+      return true;
+    }
+    if (millis() - initStartedAt >= FIREBASE_INIT_TIMEOUT_MS) {
+      initPending = false;
+      Serial.println("\n💾 Firebase: ❌ Connection failed (no auth token)");
       Serial.println("   Action: Check credentials and network");
       Serial.println("   Help: Verify Firebase library installed and WiFi connected");
       Serial.println("   Note: Make sure Firebase rules allow writes (test with public rules)");
+      Serial.println();
+      return true;
     }
-    
-    Serial.println();
-    delay(500);
+    return false;
   }
 
   // ==================== DATA BACKUP ====================
-  // Backup sensor data and prediction to Firebase
-  bool backupData(float temperature, float humidity, float pressure, float lux, 
-                  const char* prediction, unsigned long inferenceTime) {
+  // Queue one telemetry record for the next batched PATCH. `json` is the
+  // record's pre-encoded reading node (TELEMETRY_FORMAT_FIREBASE_JSON),
+  // shared with the other sinks. Returns false when the record was refused
+  // (backup disabled, or the batch is full and could not be flushed).
+  bool backupRecord(const TelemetryRecord& record, const char* json) {
     if (!shouldBackup()) {
       return false;
     }
     
-    lastBackupTime = millis();
-    totalBackups++;
-    readingCount++;
-    
-    // Generate timestamp (seconds since boot)
-    unsigned long timestamp = millis() / 1000;
-    
-    Serial.println("\n💾 Firebase Backup:");
-    Serial.println("─────────────────────────────────────────────────────────");
-    Serial.printf("   Reading #%lu | Timestamp: %lu\n", readingCount, timestamp);
-    Serial.printf("   Temperature: %.2f °C\n", temperature);
-    Serial.printf("   Humidity: %.2f %%\n", humidity);
-    Serial.printf("   Pressure: %.2f Pa\n", pressure);
-    Serial.printf("   Lux: %.2f\n", lux);
-    Serial.printf("   Prediction: %s\n", prediction);
-    Serial.printf("   Inference: %lu µs\n", inferenceTime);
+    if (batchCount >= batchSize && !flush()) {
+      return false;
+    }
     
-    if (!Firebase.ready()) {
-      Serial.println("   Status: ❌ Firebase not ready");
-      Serial.println("─────────────────────────────────────────────────────────");
-      onBackupFailed();
+    // Epoch-ms key: unique across reboots, ordered like the dashboard's
+    // range queries. Records from before the first NTP sync have no key
+    // (FirebaseSink reports offline until then; see hasClock).
+    if (record.epochMs == 0) {
       return false;
     }
+    uint64_t key = record.epochMs > lastReadingKey ? record.epochMs : lastReadingKey + 1;
     
-    // Create path: /devices/{device_id}/readings/{timestamp}
-    String basePath = "/devices/" + deviceID + "/readings/" + String(timestamp);
+    int written = snprintf(batchBody + batchLength, sizeof(batchBody) - batchLength,
+                           "%s\"readings/%llu\":%s", batchCount == 0 ? "{" : ",",
+                           (unsigned long long)key, json);
+    size_t readingsLimit = sizeof(batchBody) - FIREBASE_STATUS_RESERVE - FIREBASE_INFO_RESERVE -
+                           FIREBASE_AGGREGATE_NODES * FIREBASE_AGGREGATE_NODE_SIZE;
+    if (written < 0 || batchLength + (size_t)written >= readingsLimit) {
+      batchBody[batchLength] = '\0';
+      return false;
+    }
+    if (batchCount == 0) {
+      batchStartedAt = millis();
+    }
+    batchLength += (size_t)written;
+    batchCount++;
+    readingCount++;
+    lastReadingKey = key;
     
-    // Create JSON object for the reading
-    FirebaseJson json;
-    json.set("temperature", temperature);
-    json.set("humidity", humidity);
-    json.set("pressure", pressure);
-    json.set("lux", lux);
-    json.set("prediction", prediction);
-    json.set("inference_time", inferenceTime);
-    json.set("timestamp", timestamp);
-    json.set("device_id", deviceID.c_str());
+    LOG(LOG_MSG_FB_QUEUED, readingCount, telemetry_class_name(record.predictedClass), (unsigned long long)key,
+        batchCount, batchSize);
     
-    // Upload to Firebase
-    if (Firebase.RTDB.setJSON(&fbdo, basePath.c_str(), &json)) {
-      Serial.println("   Status: ✅ Backup successful");
-      Serial.println("─────────────────────────────────────────────────────────");
-      onBackupSuccess();
-      return true;
-    } else {
-      Serial.println("   Status: ❌ Backup failed");
-      Serial.printf("   Error: %s\n", fbdo.errorReason().c_str());
-      Serial.println("─────────────────────────────────────────────────────────");
-      onBackupFailed();
-      return false;
+    if (batchCount >= batchSize) {
+      flush();
     }
+    return true;
   }
 
-  // Backup data with gas sensor readings
-  bool backupDataWithGas(float temperature, float humidity, float pressure, float lux,
-                         float gasPPM, String gasQuality,
-                         const char* prediction, unsigned long inferenceTime) {
-    if (!shouldBackup()) {
+  // Fold a record into the minute/hour/day rollups. Called for every
+  // record, including the ones report-by-exception keeps off the cloud.
+  void aggregate(const TelemetryRecord& record) {
+    if (enabled) {
+      uint32_t dropped = rollups.getStats().nodesDropped;
+      rollups.add(record);
+      const RollupStats& stats = rollups.getStats();
+      if (stats.nodesDropped != dropped) {
+        LOG(LOG_MSG_FB_ROLLUP_DROPPED, (unsigned long)stats.nodesDropped, (unsigned long)stats.recordsDropped);
+      }
+    }
+  }
+
+  // Flush a partial batch once its oldest reading has waited long enough,
+  // or dirty rollups once per interval. The first batch after boot goes
+  // at once (it carries the boot heartbeat). Also the retry path after a
+  // failed flush: once per interval, or as soon as the open breaker allows
+  // a probe.
+  void poll() {
+    if (batchCount == 0 && !rollups.hasDirty() && latencyCount == 0) {
+      return;
+    }
+    unsigned long now = millis();
+    bool batchDue = batchCount == 0 || batchCount >= batchSize || bootPending ||
+                    now - batchStartedAt >= flushInterval;
+    bool retryDue = lastFlushAttempt == 0 || now - lastFlushAttempt >= flushInterval ||
+                    (!breaker.isClosed() && breaker.wouldAllow(now));
+    if (batchDue && retryDue) {
+      flush();
+    }
+  }
+
+  // Send every queued reading, the status node, the boot heartbeat (first
+  // flush only), dirty rollups and closed latency windows in one PATCH
+  bool flush() {
+    if (batchCount == 0 && !rollups.hasDirty() && latencyCount == 0) {
+      return true;
+    }
+    if (!enabled || !initialized || WiFi.status() != WL_CONNECTED) {
+      return false;
+    }
+    // Open breaker: keep the batch, send nothing (no TLS, no timeouts)
+    if (!breaker.allowRequest(millis())) {
       return false;
     }
     
-    lastBackupTime = millis();
+    lastFlushAttempt = millis();
     totalBackups++;
-    readingCount++;
-    unsigned long timestamp = millis() / 1000;
-    
-    Serial.println("\n💾 Firebase Backup (with gas):");
-    Serial.println("─────────────────────────────────────────────────────────");
-    Serial.printf("   Reading #%lu | Timestamp: %lu\n", readingCount, timestamp);
-    Serial.printf("   Temperature: %.2f °C\n", temperature);
-    Serial.printf("   Humidity: %.2f %%\n", humidity);
-    Serial.printf("   Pressure: %.2f Pa\n", pressure);
-    Serial.printf("   Lux: %.2f\n", lux);
-    Serial.printf("   Gas: %.1f PPM (%s)\n", gasPPM, gasQuality.c_str());
-    Serial.printf("   Prediction: %s\n", prediction);
-    Serial.printf("   Inference: %lu µs\n", inferenceTime);
     
     if (!Firebase.ready()) {
-      Serial.println("   Status: ❌ Firebase not ready");
-      Serial.println("─────────────────────────────────────────────────────────");
+      LOG(LOG_MSG_FB_NOT_READY);
       onBackupFailed();
       return false;
     }
     
-    String basePath = "/devices/" + deviceID + "/readings/" + String(timestamp);
+    // Close the object with the status node, boot info, dirty rollups and
+    // latency windows (removed again if the PATCH fails)
+    size_t readingsLength = batchLength;
+    static const JsonField STATUS_KEY = JSON_FIELD("status");
+    batchBody[batchLength++] = batchCount == 0 ? '{' : ',';
+    memcpy(batchBody + batchLength, STATUS_KEY.key, STATUS_KEY.length);
+    batchLength += STATUS_KEY.length;
+    JsonStreamWriter status(batchBody + batchLength, sizeof(batchBody) - batchLength);
+    json_write_status(status, true, epochNowMs());
+    batchLength += (size_t)status.length();
+    appendBootInfo();
+    int rollupNodes = rollups.writeDirty(batchBody, sizeof(batchBody) - 1, batchLength);
+    appendLatencyNodes();
+    batchBody[batchLength++] = '}';
+    batchBody[batchLength] = '\0';
+    
+    char path[48];
+    snprintf(path, sizeof(path), "/devices/%s.json", deviceID.c_str());
     
-    FirebaseJson json;
-    json.set("temperature", temperature);
-    json.set("humidity", humidity);
-    json.set("pressure", pressure);
-    json.set("lux", lux);
-    json.set("gas_ppm", gasPPM);
-    json.set("gas_quality", gasQuality.c_str());
-    json.set("prediction", prediction);
-    json.set("inference_time", inferenceTime);
-    json.set("timestamp", timestamp);
-    json.set("device_id", deviceID.c_str());
+    unsigned long start = millis();
+    int httpCode = restRequest("PATCH", path, batchBody, batchLength);
+    unsigned long elapsed = millis() - start;
     
-    if (Firebase.RTDB.setJSON(&fbdo, basePath.c_str(), &json)) {
-      Serial.println("   Status: ✅ Backup successful");
-      Serial.println("─────────────────────────────────────────────────────────");
+    LOG(LOG_MSG_FB_FLUSH, breaker.isClosed() ? "" : " (probe)", batchCount, rollupNodes,
+        (unsigned int)batchLength, elapsed, httpCode > 0 ? "HTTP" : "error", httpCode);
+    if (bootStaged) {
+      LOG(LOG_MSG_FB_BOOT, infoChanged ? "info node (changed)" : "last_boot only (info unchanged)");
+    }
+    
+    if (httpCode >= 200 && httpCode < 300) {
+      bytesSent += batchLength;
+      flushedReadings += batchCount;
+      rollups.commit();
+      commitLatencyNodes();
+      if (bootStaged) {
+        onBootInfoWritten();
+      }
+      batchLength = 0;
+      batchCount = 0;
+      batchBody[0] = '\0';
       onBackupSuccess();
       return true;
-    } else {
-      Serial.println("   Status: ❌ Backup failed");
-      Serial.printf("   Error: %s\n", fbdo.errorReason().c_str());
-      Serial.println("─────────────────────────────────────────────────────────");
-      onBackupFailed();
+    }
+    
+    batchLength = readingsLength;
+    batchBody[batchLength] = '\0';
+    bootStaged = false;
+    latencyStaged = 0;
+    onBackupFailed();
+    return false;
+  }
+
+  // Network diagnostics (net_latency.h JSON) at /devices/{device_id}/netstats
+  // (skipped while the breaker is not closed: probes carry readings only)
+  bool uploadDiagnostics(const char* json) {
+    if (!enabled || !initialized || !breaker.isClosed() || !Firebase.ready()) {
       return false;
     }
+    char path[64];
+    snprintf(path, sizeof(path), "/devices/%s/netstats.json", deviceID.c_str());
+    int httpCode = restRequest("PUT", path, json, strlen(json));
+    return httpCode >= 200 && httpCode < 300;
+  }
+
+  // Closed latency window (latency_window.h) for the next flush, at
+  // /devices/{device_id}/latency/{start}. Skipped until the clock is
+  // synced (start is the key); the oldest waiting window is dropped when
+  // FIREBASE_LATENCY_NODES are already waiting.
+  void queueLatencyWindow(const LatencyWindowReport& report) {
+    if (!enabled || report.startS == 0) {
+      return;
+    }
+    if (latencyCount >= FIREBASE_LATENCY_NODES) {
+      memmove(latencyNodes[0], latencyNodes[1], (FIREBASE_LATENCY_NODES - 1) * FIREBASE_LATENCY_NODE_SIZE);
+      memmove(latencyLengths, latencyLengths + 1, (FIREBASE_LATENCY_NODES - 1) * sizeof(latencyLengths[0]));
+      latencyCount--;
+      latencyDropped++;
+    }
+    char key[32];
+    snprintf(key, sizeof(key), "latency/%lu", (unsigned long)report.startS);
+    char* node = latencyNodes[latencyCount];
+    node[0] = ',';
+    JsonStreamWriter w(node + 1, FIREBASE_LATENCY_NODE_SIZE - 1);
+    w.key(key);
+    json_write_latency_window(w, report);
+    if (!w.ok()) {
+      latencyDropped++;
+      return;
+    }
+    latencyLengths[latencyCount++] = (uint16_t)(1 + w.length());
+  }
+
+  // Backup sensor data and prediction (convenience wrapper around backupRecord)
+  bool backupData(float temperature, float humidity, float pressure, float lux, 
+                  const char* prediction, unsigned long inferenceTime) {
+    return backupDataWithGas(temperature, humidity, pressure, lux, 0.0f,
+                             prediction, inferenceTime);
+  }
+
+  // Backup data with gas sensor reading (convenience wrapper around backupRecord)
+  bool backupDataWithGas(float temperature, float humidity, float pressure, float lux,
+                         float gasPPM, const char* prediction, unsigned long inferenceTime) {
+    TelemetryRecord record;
+    memset(&record, 0, sizeof(record));
+    record.timestampMs = millis();
+    record.epochMs = epochNowMs();
+    record.temperature = temperature;
+    record.humidity = humidity;
+    record.pressure = pressure;
+    record.lux = lux;
+    record.gas = gasPPM;
+    record.inferenceTime = inferenceTime;
+    for (uint8_t i = 0; i < TELEMETRY_NUM_CLASSES; i++) {
+      if (strcmp(prediction, TELEMETRY_CLASS_NAMES[i]) == 0) {
+        record.predictedClass = i;
+      }
+    }
+    
+    char json[TELEMETRY_MAX_PAYLOAD];
+    telemetry_encode_firebase_json(record, deviceID.c_str(), json, sizeof(json));
+    return backupRecord(record, json);
   }
 
   // ==================== DEVICE MANAGEMENT ====================
-  // Save device metadata (called once on startup)
-  bool saveDeviceInfo(const char* firmwareVersion, const char* modelType) {
-    if (!initialized || !enabled) {
-      return false;
+  // Describe this device (called once on startup). The info node is only
+  // rewritten when its content hash differs from the last one written
+  // (kept in NVS); otherwise the first flush only updates last_boot.
+  void prepareDeviceInfo(const char* firmwareVersion, const char* modelType) {
+    uint8_t mac[6];
+    WiFi.macAddress(mac);
+    snprintf(macAddress, sizeof(macAddress), "%02X:%02X:%02X:%02X:%02X:%02X",
+             mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    
+    deviceInfo.deviceId = deviceID.c_str();
+    deviceInfo.firmwareVersion = firmwareVersion;
+    deviceInfo.modelType = modelType;
+    deviceInfo.chipModel = ESP.getChipModel();
+    deviceInfo.chipCores = (uint32_t)ESP.getChipCores();
+    deviceInfo.cpuFreqMHz = (uint32_t)ESP.getCpuFreqMHz();
+    deviceInfo.flashSizeMB = ESP.getFlashChipSize() / (1024.0f * 1024.0f);
+    deviceInfo.macAddress = macAddress;
+    deviceInfo.lastBootMs = 0;
+    infoHash = json_info_hash(deviceInfo, nodeBuffer, sizeof(nodeBuffer));
+    
+    Preferences prefs;
+    uint32_t storedHash = 0;
+    if (prefs.begin(FIREBASE_PREFS_NAMESPACE, true)) {
+      storedHash = prefs.getUInt("info_hash", 0);
+      prefs.end();
     }
+    infoChanged = infoHash == 0 || infoHash != storedHash;
+    bootPending = true;
     
-    Serial.println("\n💾 Saving Device Info:");
+    Serial.println("\n💾 Device Info:");
     Serial.println("─────────────────────────────────────────────────────────");
     Serial.printf("   Device ID: %s\n", deviceID.c_str());
     Serial.printf("   Firmware: %s\n", firmwareVersion);
     Serial.printf("   Model: %s\n", modelType);
-    Serial.printf("   Chip: %s (%d cores @ %d MHz)\n",
-                  ESP.getChipModel(), ESP.getChipCores(), ESP.getCpuFreqMHz());
-    Serial.printf("   Flash: %.2f MB\n", ESP.getFlashChipSize() / (1024.0 * 1024.0));
-    Serial.printf("   MAC: %s\n", WiFi.macAddress().c_str());
-    
-    if (!Firebase.ready()) {
-      Serial.println("   Status: ❌ Firebase not ready");
-      Serial.println("─────────────────────────────────────────────────────────");
+    Serial.printf("   Chip: %s (%lu cores @ %lu MHz)\n",
+                  deviceInfo.chipModel, (unsigned long)deviceInfo.chipCores,
+                  (unsigned long)deviceInfo.cpuFreqMHz);
+    Serial.printf("   Flash: %.2f MB\n", deviceInfo.flashSizeMB);
+    Serial.printf("   MAC: %s\n", macAddress);
+    Serial.printf("   Hash: %08lx (%s)\n", (unsigned long)infoHash,
+                  infoChanged ? "changed, node rewritten with the first reading" : "unchanged, last_boot only");
+    Serial.println("─────────────────────────────────────────────────────────");
+  }
+
+  // Write the info node right away (one PUT), e.g. after changing it
+  bool saveDeviceInfo(const char* firmwareVersion, const char* modelType) {
+    if (!initialized || !enabled) {
+      return false;
+    }
+    prepareDeviceInfo(firmwareVersion, modelType);
+    uint64_t bootMs = bootEpochMs();
+    if (!Firebase.ready() || bootMs == 0) {
+      Serial.println("   Status: ⏳ Not ready, info goes out with the next flush");
       return false;
     }
     
-    String basePath = "/devices/" + deviceID + "/info";
+    deviceInfo.lastBootMs = bootMs;
+    JsonStreamWriter json(nodeBuffer, sizeof(nodeBuffer));
+    json_write_info(json, deviceInfo);
     
-    FirebaseJson json;
-    json.set("device_id", deviceID.c_str());
-    json.set("firmware_version", firmwareVersion);
-    json.set("model_type", modelType);
-    json.set("chip_model", ESP.getChipModel());
-    json.set("chip_cores", ESP.getChipCores());
-    json.set("cpu_freq_mhz", ESP.getCpuFreqMHz());
-    json.set("flash_size_mb", ESP.getFlashChipSize() / (1024.0 * 1024.0));
-    json.set("mac_address", WiFi.macAddress().c_str());
-    json.set("last_boot", millis() / 1000);
+    char path[64];
+    snprintf(path, sizeof(path), "/devices/%s/info.json", deviceID.c_str());
+    int httpCode = json.ok() ? restRequest("PUT", path, nodeBuffer, (size_t)json.length()) : -1;
     
-    if (Firebase.RTDB.setJSON(&fbdo, basePath.c_str(), &json)) {
+    if (httpCode >= 200 && httpCode < 300) {
+      onBootInfoWritten();
       Serial.println("   Status: ✅ Device info saved");
-      Serial.println("─────────────────────────────────────────────────────────");
       return true;
-    } else {
-      Serial.println("   Status: ❌ Failed to save");
-      Serial.printf("   Error: %s\n", fbdo.errorReason().c_str());
-      Serial.println("─────────────────────────────────────────────────────────");
-      return false;
     }
+    Serial.printf("   Status: ❌ Failed to save (%s %d)\n", httpCode > 0 ? "HTTP" : "network", httpCode);
+    return false;
   }
 
   // Update device status (online/offline)
@@ -350,11 +646,11 @@ public:
     }
     
     if (Firebase.ready()) {
-      String path = "/devices/" + deviceID + "/status";
-      FirebaseJson json;
-      json.set("online", online);
-      json.set("last_seen", millis() / 1000);
-      Firebase.RTDB.setJSON(&fbdo, path.c_str(), &json);
+      JsonStreamWriter json(nodeBuffer, sizeof(nodeBuffer));
+      json_write_status(json, online, epochNowMs());
+      char path[64];
+      snprintf(path, sizeof(path), "/devices/%s/status.json", deviceID.c_str());
+      restRequest("PUT", path, nodeBuffer, (size_t)json.length());
     }
   }
 
@@ -370,8 +666,34 @@ public:
                   failedBackups,
                   totalBackups > 0 ? (failedBackups * 100.0 / totalBackups) : 0);
     Serial.printf("   Consecutive Failures: %lu\n", consecutiveFailures);
-    if (consecutiveFailures >= maxConsecutiveFailures) {
-      Serial.println("   Status: ⚠️  Backup temporarily disabled (too many failures)");
+    Serial.printf("   Readings: %lu queued, %lu flushed, %u waiting\n",
+                  readingCount, flushedReadings, batchCount);
+    Serial.printf("   Round trips: %lu (%.1f readings each), %lu B sent\n",
+                  successfulBackups,
+                  successfulBackups > 0 ? (float)flushedReadings / successfulBackups : 0.0f,
+                  bytesSent);
+    unsigned long uptimeMs = millis();
+    float requestsPerHour = uptimeMs > 0 ? restRequests * 3600000.0f / uptimeMs : 0.0f;
+    if (bootPending) {
+      Serial.printf("   REST requests: %lu (%.1f per hour), boot heartbeat pending\n",
+                    restRequests, requestsPerHour);
+    } else {
+      Serial.printf("   REST requests: %lu (%.1f per hour), boot heartbeat in %lu\n",
+                    restRequests, requestsPerHour, bootRequests);
+    }
+    const RollupStats& rollupStats = rollups.getStats();
+    Serial.printf("   Rollups: %lu records, %lu nodes written, %lu dropped (%lu records not uploaded)\n",
+                  (unsigned long)rollupStats.records, (unsigned long)rollupStats.nodesWritten,
+                  (unsigned long)rollupStats.nodesDropped, (unsigned long)rollupStats.recordsDropped);
+    Serial.printf("   Latency windows: %lu written, %u waiting, %lu dropped\n",
+                  latencyWritten, (unsigned)latencyCount, latencyDropped);
+    const BreakerStats& breakerStats = breaker.getStats();
+    Serial.printf("   Breaker: %s (opened %lu times, %lu flushes skipped)\n",
+                  breaker.stateName(), (unsigned long)breakerStats.transitions[BREAKER_OPEN],
+                  (unsigned long)breakerStats.rejected);
+    if (!breaker.isClosed()) {
+      Serial.printf("   Status: ⚠️  Backend unreachable, next probe in %lu s\n",
+                    (unsigned long)breaker.msUntilProbe(millis()) / 1000);
     }
     Serial.println("─────────────────────────────────────────────────────────");
   }
@@ -387,42 +709,294 @@ public:
     return String(deviceIDStr);
   }
 
-  // Check if ready for backup
-  bool shouldBackup() {
-    if (!enabled || !initialized) {
-      return false;
-    }
+  // Wall clock for status/info times (readings carry their own epochMs)
+  void setClock(const EpochClock* clock) {
+    epochClock = clock;
+  }
+
+  // Batch limits: size is capped at FIREBASE_BATCH_SIZE (buffer size)
+  void setBatching(unsigned int size, unsigned long intervalMs) {
+    batchSize = size < 1 ? 1 : (size > FIREBASE_BATCH_SIZE ? FIREBASE_BATCH_SIZE : size);
+    flushInterval = intervalMs;
+  }
+
+  // Send `body` to the REST API (`method` PUT or PATCH, `path` ending in
+  // .json); returns the HTTP status code or -1 on a network error. Every
+  // phase is recorded in the latency histograms.
+  int restRequest(const char* method, const char* path, const char* body, size_t bodyLength) {
+    restRequests++;
     
-    // Stop trying after too many failures
-    if (consecutiveFailures >= maxConsecutiveFailures) {
-      return false;
+    // Request line and headers, built once in the reused header buffer
+    int headerLength = snprintf(headerBuffer, sizeof(headerBuffer), "%s %s?auth=", method, path);
+    headerLength = appendText(headerLength, Firebase.getToken());
+    if (headerLength > 0 && headerLength < (int)sizeof(headerBuffer)) {
+      int written = snprintf(headerBuffer + headerLength, sizeof(headerBuffer) - headerLength,
+          "&print=silent HTTP/1.1\r\n"
+          "Host: %s\r\n"
+          "User-Agent: ESP32\r\n"
+          "Content-Type: application/json\r\n"
+          "Content-Length: %u\r\n"
+          "Connection: keep-alive\r\n"
+          "\r\n", restHost, (unsigned int)bodyLength);
+      headerLength = (written < 0 || written >= (int)sizeof(headerBuffer) - headerLength) ? -1 : headerLength + written;
+    }
+    if (headerLength <= 0) {
+      return -1;
     }
     
-    // Don't backup too frequently
-    return (millis() - lastBackupTime >= backupInterval);
+    // A kept-alive connection may have been closed by the server while idle:
+    // retry once on a fresh connection if the reused one fails
+    for (int attempt = 0; attempt < 2; attempt++) {
+      NetPhaseTimer timer(&latency);
+      timer.start(micros());
+      bool reused = restClient.connected();
+      
+      if (reused) {
+        timer.skipTo(NET_PHASE_SEND, micros());
+      } else {
+        IPAddress serverIP;
+        if (!WiFi.hostByName(restHost, serverIP)) {
+          timer.finish(false, micros());
+          return -1;
+        }
+        timer.mark(NET_PHASE_DNS, micros());
+        
+        // Connect by name so TLS sends SNI (lwIP caches the lookup above)
+        if (!restClient.connect(restHost, FIREBASE_REST_PORT)) {
+          timer.finish(false, micros());
+          return -1;
+        }
+        timer.mark(NET_PHASE_CONNECT, micros());
+      }
+      
+      if (restClient.write((const uint8_t*)headerBuffer, headerLength) != (size_t)headerLength ||
+          restClient.write((const uint8_t*)body, bodyLength) != bodyLength) {
+        timer.finish(false, micros());
+        restClient.stop();
+        if (reused) continue;
+        return -1;
+      }
+      timer.mark(NET_PHASE_SEND, micros());
+      
+      // Server phase: wait for the first response byte
+      unsigned long waitStart = millis();
+      while (!restClient.available()) {
+        if (!restClient.connected() || millis() - waitStart > FIREBASE_HTTP_TIMEOUT_MS) {
+          break;
+        }
+        delay(1);
+      }
+      if (!restClient.available()) {
+        timer.finish(false, micros());
+        restClient.stop();
+        if (reused) continue;
+        return -1;
+      }
+      timer.mark(NET_PHASE_SERVER, micros());
+      
+      // Read phase: headers, then Content-Length bytes of body (discarded).
+      // Headers are parsed line by line; only the status line and the
+      // Content-Length / Connection values are kept, so long headers
+      // (cookies, CORS, ...) cannot hide the blank line that ends them.
+      char line[96];
+      size_t lineLength = 0;
+      bool statusLine = true;
+      bool headersEnd = false;
+      bool connectionClose = false;
+      int httpCode = 0;
+      long remaining = 0;
+      uint32_t tail = 0;                      // Last four bytes received
+      while (!headersEnd && millis() - waitStart <= FIREBASE_HTTP_TIMEOUT_MS) {
+        int c = restClient.read();
+        if (c < 0) {
+          if (!restClient.connected()) break;
+          delay(1);
+          continue;
+        }
+        tail = (tail << 8) | (uint8_t)c;
+        if (tail == 0x0D0A0D0AUL) {
+          headersEnd = true;
+        } else if (c == '\n') {
+          line[lineLength] = '\0';
+          if (statusLine) {
+            httpCode = lineLength > 12 ? atoi(line + 9) : 0;
+            statusLine = false;
+          } else if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            remaining = atol(line + 15);
+          } else if (strncasecmp(line, "Connection:", 11) == 0) {
+            connectionClose = strstr(line + 11, "close") != nullptr;
+          }
+          lineLength = 0;
+        } else if (c != '\r' && lineLength < sizeof(line) - 1) {
+          line[lineLength++] = (char)c;   // Overlong lines are truncated
+        }
+      }
+      if (!headersEnd) {
+        timer.finish(false, micros());
+        restClient.stop();
+        return -1;
+      }
+      
+      while (remaining > 0 && millis() - waitStart <= FIREBASE_HTTP_TIMEOUT_MS) {
+        uint8_t chunk[128];
+        int n = restClient.read(chunk, remaining < (long)sizeof(chunk) ? (size_t)remaining : sizeof(chunk));
+        if (n > 0) {
+          remaining -= n;
+        } else if (!restClient.connected()) {
+          break;
+        } else {
+          delay(1);
+        }
+      }
+      if (remaining > 0 || connectionClose) {
+        restClient.stop();
+      }
+      timer.mark(NET_PHASE_READ, micros());
+      timer.finish(httpCode >= 200 && httpCode < 300, micros());
+      return httpCode;
+    }
+    return -1;
+  }
+
+  // Append the ID token to the header buffer (the library returns it as a
+  // C string or a String depending on version)
+  int appendText(int length, const char* text) {
+    if (length < 0 || length >= (int)sizeof(headerBuffer)) return -1;
+    size_t textLength = strlen(text);
+    if (length + textLength >= sizeof(headerBuffer)) return -1;
+    memcpy(headerBuffer + length, text, textLength + 1);
+    return length + (int)textLength;
+  }
+  int appendText(int length, const String& text) { return appendText(length, text.c_str()); }
+
+  // Epoch ms now (0 until the clock is synced)
+  uint64_t epochNowMs() {
+    return epochClock != nullptr ? epochClock->toEpochMs(millis()) : 0;
+  }
+
+  // Epoch ms of this boot (0 until the clock is synced)
+  uint64_t bootEpochMs() {
+    uint64_t now = epochNowMs();
+    return now != 0 ? now - millis() : 0;
+  }
+
+  // Boot heartbeat into the batch tail: the whole info node if its content
+  // changed, else just last_boot. Skipped (stays pending) if it does not fit
+  // or the clock is not synced yet.
+  void appendBootInfo() {
+    bootStaged = false;
+    uint64_t bootMs = bootEpochMs();
+    if (!bootPending || bootMs == 0) {
+      return;
+    }
+    static const JsonField INFO_KEY = JSON_FIELD("info");
+    static const JsonField LAST_BOOT_KEY = JSON_FIELD("info/last_boot");
+    const JsonField& key = infoChanged ? INFO_KEY : LAST_BOOT_KEY;
+    size_t available = sizeof(batchBody) - 1 - batchLength;
+    if (available < (size_t)key.length + 2) {
+      return;
+    }
+    deviceInfo.lastBootMs = bootMs;
+    JsonStreamWriter w(batchBody + batchLength + 1 + key.length, available - 1 - key.length);
+    if (infoChanged) {
+      json_write_info(w, deviceInfo);
+    } else {
+      w.value(bootMs);
+    }
+    if (!w.ok()) {
+      batchBody[batchLength] = '\0';
+      return;
+    }
+    batchBody[batchLength] = ',';
+    memcpy(batchBody + batchLength + 1, key.key, key.length);
+    batchLength += 1 + key.length + (size_t)w.length();
+    bootStaged = true;
+  }
+
+  // Waiting latency windows into the batch tail (those that fit)
+  void appendLatencyNodes() {
+    latencyStaged = 0;
+    for (uint8_t i = 0; i < latencyCount; i++) {
+      if (batchLength + latencyLengths[i] + 2 > sizeof(batchBody)) {
+        break;
+      }
+      memcpy(batchBody + batchLength, latencyNodes[i], latencyLengths[i]);
+      batchLength += latencyLengths[i];
+      latencyStaged++;
+    }
+    batchBody[batchLength] = '\0';
+  }
+
+  // The PATCH carrying the staged latency windows succeeded
+  void commitLatencyNodes() {
+    if (latencyStaged == 0) {
+      return;
+    }
+    uint8_t remaining = latencyCount - latencyStaged;
+    memmove(latencyNodes[0], latencyNodes[latencyStaged], remaining * FIREBASE_LATENCY_NODE_SIZE);
+    memmove(latencyLengths, latencyLengths + latencyStaged, remaining * sizeof(latencyLengths[0]));
+    latencyCount = remaining;
+    latencyWritten += latencyStaged;
+    latencyStaged = 0;
+  }
+
+  // Info node (or last_boot) landed: remember its hash for the next boot
+  void onBootInfoWritten() {
+    if (infoChanged) {
+      Preferences prefs;
+      if (prefs.begin(FIREBASE_PREFS_NAMESPACE, false)) {
+        prefs.putUInt("info_hash", infoHash);
+        prefs.end();
+      }
+      infoChanged = false;
+    }
+    bootPending = false;
+    bootStaged = false;
+    bootRequests = restRequests;
+  }
+
+  // Check if ready for backup
+  // (spacing between backups is handled by the telemetry scheduler,
+  // failures by the circuit breaker)
+  bool shouldBackup() {
+    return enabled && initialized;
   }
 
   // Success callback
   void onBackupSuccess() {
     successfulBackups++;
     consecutiveFailures = 0;
+    breaker.onSuccess(millis());
   }
 
   // Failure callback
   void onBackupFailed() {
     failedBackups++;
     consecutiveFailures++;
-    if (consecutiveFailures >= maxConsecutiveFailures) {
-      Serial.println("\n⚠️  Too many consecutive backup failures!");
-      Serial.println("   Firebase backup temporarily disabled.");
-      Serial.println("   Check Firebase configuration and WiFi connection.");
-    }
+    breaker.onFailure(millis());
   }
 
   // Getters
   String getDeviceID() { return deviceID; }
+  const char* getDeviceIDCStr() {
+    if (deviceID.length() == 0) {
+      deviceID = generateDeviceID();   // Needs WiFi.mode() (MAC) first
+    }
+    return deviceID.c_str();
+  }
+  bool isInitialized() { return initialized; }
   bool isEnabled() { return enabled; }
   bool isConnected() { return connected; }
+  // Readings are keyed by epoch ms: nothing can be batched before NTP sync
+  bool hasClock() { return epochClock != nullptr && epochClock->isSynced(); }
+  // False only when the batch is full and the breaker refuses a flush
+  bool canAccept() { return batchCount < batchSize || breaker.wouldAllow(millis()); }
+  CircuitBreaker& getBreaker() { return breaker; }
+  unsigned long getBackupInterval() { return backupInterval; }
+  unsigned int getBatchCount() { return batchCount; }
+  unsigned long getFlushedReadings() { return flushedReadings; }
+  const NetLatencyStats& getLatencyStats() { return latency; }
+  void setLatencyListener(NetOperationListener fn, void* context) { latency.setListener(fn, context); }
   unsigned long getTotalBackups() { return totalBackups; }
   unsigned long getSuccessfulBackups() { return successfulBackups; }
   unsigned long getFailedBackups() { return failedBackups; }
@@ -0,0 +1,384 @@
+/*
+ * Gorilla Block - Compressed time-series block for batched sensor samples
+ *
+ * Gorilla-style (Facebook TSDB) encoding of the 5-channel sensor series
+ * plus class labels. Meant for batches of raw samples (e.g. 1 Hz for a
+ * minute) where consecutive values are close and timestamps regular.
+ *
+ * Features:
+ * - Timestamps: delta-of-delta with variable-length prefixes
+ * - Values: per-channel XOR with the previous float, reusing the previous
+ *   leading/trailing-zero window when possible (lossless)
+ * - Class labels: 1 bit when unchanged
+ * - Caller-provided buffer, no heap; append() refuses a sample that might
+ *   not fit, so a block never overflows
+ * - No Arduino dependencies (ESP32 and host tools share it)
+ *
+ * Block Layout:
+ *   0   2   Magic 'G','B'
+ *   2   1   Version (1)
+ *   3   2   Sample count (little endian, patched by finish())
+ *   5   ... Bit stream (MSB first)
+ *
+ * Sample 0: 64-bit timestamp (ms), 5 × 32-bit floats, 3-bit class
+ * Sample n: timestamp Δ-of-Δ:
+ *             '0'                 Δ unchanged
+ *             '10'   + 7 bits     [-63, 64]
+ *             '110'  + 9 bits     [-255, 256]
+ *             '1110' + 12 bits    [-2047, 2048]
+ *             '1111' + 32 bits    anything else
+ *           each channel: '0' same value
+ *                         '10' + meaningful bits in previous window
+ *                         '11' + 5 bits leading zeros + 6 bits length + bits
+ *           class: '0' unchanged | '1' + 3 bits
+ */
+
+#ifndef GORILLA_BLOCK_H
+#define GORILLA_BLOCK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define GORILLA_CHANNELS 5
+#define GORILLA_HEADER_SIZE 5
+#define GORILLA_VERSION 1
+#define GORILLA_MAX_SAMPLE_BITS (4 + 32 + GORILLA_CHANNELS * (2 + 5 + 6 + 32) + 4)   // 265
+
+// ==================== BIT STREAM ====================
+class GorillaBitWriter {
+private:
+    uint8_t* buffer;
+    size_t capacityBits;
+    size_t bitPosition;
+
+public:
+    GorillaBitWriter() : buffer(nullptr), capacityBits(0), bitPosition(0) {}
+
+    void attach(uint8_t* out, size_t bytes) {
+        buffer = out;
+        capacityBits = bytes * 8;
+        bitPosition = 0;
+    }
+
+    void seek(size_t bit) { bitPosition = bit; }
+    size_t position() const { return bitPosition; }
+    size_t remaining() const { return capacityBits - bitPosition; }
+
+    // Write the low `count` bits of value (count ≤ 64), MSB first
+    void write(uint64_t value, int count) {
+        while (count > 0) {
+            size_t byteIndex = bitPosition >> 3;
+            int bitOffset = (int)(bitPosition & 7);
+            int room = 8 - bitOffset;
+            int take = count < room ? count : room;
+            uint8_t bits = (uint8_t)((value >> (count - take)) & ((1u << take) - 1));
+            if (bitOffset == 0) buffer[byteIndex] = 0;
+            buffer[byteIndex] |= (uint8_t)(bits << (room - take));
+            bitPosition += take;
+            count -= take;
+        }
+    }
+};
+
+class GorillaBitReader {
+private:
+    const uint8_t* buffer;
+    size_t lengthBits;
+    size_t bitPosition;
+
+public:
+    GorillaBitReader() : buffer(nullptr), lengthBits(0), bitPosition(0) {}
+
+    void attach(const uint8_t* in, size_t bytes, size_t startBit) {
+        buffer = in;
+        lengthBits = bytes * 8;
+        bitPosition = startBit;
+    }
+
+    bool overrun() const { return bitPosition > lengthBits; }
+
+    uint64_t read(int count) {
+        uint64_t value = 0;
+        while (count > 0) {
+            if (bitPosition >= lengthBits) {
+                bitPosition += count;   // Mark overrun, return zeros
+                return value << count;
+            }
+            size_t byteIndex = bitPosition >> 3;
+            int bitOffset = (int)(bitPosition & 7);
+            int room = 8 - bitOffset;
+            int take = count < room ? count : room;
+            uint8_t bits = (uint8_t)((buffer[byteIndex] >> (room - take)) & ((1u << take) - 1));
+            value = (value << take) | bits;
+            bitPosition += take;
+            count -= take;
+        }
+        return value;
+    }
+};
+
+inline uint32_t gorilla_float_bits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline float gorilla_bits_float(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline int gorilla_clz32(uint32_t v) { return v ? __builtin_clz(v) : 32; }
+inline int gorilla_ctz32(uint32_t v) { return v ? __builtin_ctz(v) : 32; }
+
+// ==================== ENCODER ====================
+class GorillaBlockEncoder {
+private:
+    uint8_t* buffer;
+    size_t capacity;
+    GorillaBitWriter bits;
+    uint16_t count;
+
+    uint64_t lastTimestamp;
+    int64_t lastDelta;
+    uint32_t lastValue[GORILLA_CHANNELS];
+    int lastLeading[GORILLA_CHANNELS];
+    int lastTrailing[GORILLA_CHANNELS];
+    uint8_t lastClass;
+
+public:
+    GorillaBlockEncoder(uint8_t* out, size_t size) : buffer(out), capacity(size), count(0) {
+        begin();
+    }
+
+    void begin() {
+        count = 0;
+        lastTimestamp = 0;
+        lastDelta = 0;
+        lastClass = 0;
+        for (int c = 0; c < GORILLA_CHANNELS; c++) {
+            lastValue[c] = 0;
+            lastLeading[c] = -1;   // No window yet
+            lastTrailing[c] = 0;
+        }
+        buffer[0] = 'G';
+        buffer[1] = 'B';
+        buffer[2] = GORILLA_VERSION;
+        buffer[3] = 0;
+        buffer[4] = 0;
+        bits.attach(buffer + GORILLA_HEADER_SIZE, capacity - GORILLA_HEADER_SIZE);
+    }
+
+    // Returns false (block unchanged) when the worst-case sample might not fit
+    bool append(uint64_t timestampMs, const float values[GORILLA_CHANNELS], uint8_t classId) {
+        size_t need = count == 0 ? 64 + 32 * GORILLA_CHANNELS + 3 : GORILLA_MAX_SAMPLE_BITS;
+        if (count == 0xFFFF || bits.remaining() < need) {
+            return false;
+        }
+
+        if (count == 0) {
+            bits.write(timestampMs, 64);
+            for (int c = 0; c < GORILLA_CHANNELS; c++) {
+                lastValue[c] = gorilla_float_bits(values[c]);
+                bits.write(lastValue[c], 32);
+            }
+            bits.write(classId & 0x7, 3);
+            lastTimestamp = timestampMs;
+            lastDelta = 0;
+            lastClass = classId & 0x7;
+            count = 1;
+            return true;
+        }
+
+        int64_t delta = (int64_t)(timestampMs - lastTimestamp);
+        int64_t dod = delta - lastDelta;
+        if (dod == 0) {
+            bits.write(0, 1);
+        } else if (dod >= -63 && dod <= 64) {
+            bits.write(0x2, 2);
+            bits.write((uint64_t)dod & 0x7F, 7);
+        } else if (dod >= -255 && dod <= 256) {
+            bits.write(0x6, 3);
+            bits.write((uint64_t)dod & 0x1FF, 9);
+        } else if (dod >= -2047 && dod <= 2048) {
+            bits.write(0xE, 4);
+            bits.write((uint64_t)dod & 0xFFF, 12);
+        } else {
+            bits.write(0xF, 4);
+            bits.write((uint64_t)dod & 0xFFFFFFFFULL, 32);
+        }
+        lastTimestamp = timestampMs;
+        lastDelta = delta;
+
+        for (int c = 0; c < GORILLA_CHANNELS; c++) {
+            writeValue(c, gorilla_float_bits(values[c]));
+        }
+
+        uint8_t cls = classId & 0x7;
+        if (cls == lastClass) {
+            bits.write(0, 1);
+        } else {
+            bits.write(1, 1);
+            bits.write(cls, 3);
+            lastClass = cls;
+        }
+        count++;
+        return true;
+    }
+
+    // Patch the sample count; returns the block length in bytes
+    size_t finish() {
+        buffer[3] = (uint8_t)count;
+        buffer[4] = (uint8_t)(count >> 8);
+        return size();
+    }
+
+    size_t size() const { return GORILLA_HEADER_SIZE + (bits.position() + 7) / 8; }
+    uint16_t sampleCount() const { return count; }
+
+private:
+    void writeValue(int c, uint32_t value) {
+        uint32_t x = value ^ lastValue[c];
+        lastValue[c] = value;
+        if (x == 0) {
+            bits.write(0, 1);
+            return;
+        }
+        int leading = gorilla_clz32(x);   // x != 0, so ≤ 31 (5-bit field)
+        int trailing = gorilla_ctz32(x);
+
+        if (lastLeading[c] >= 0 && leading >= lastLeading[c] && trailing >= lastTrailing[c]) {
+            // Fits in the previous window
+            int length = 32 - lastLeading[c] - lastTrailing[c];
+            bits.write(0x2, 2);
+            bits.write(x >> lastTrailing[c], length);
+        } else {
+            int length = 32 - leading - trailing;
+            bits.write(0x3, 2);
+            bits.write((uint64_t)leading, 5);
+            bits.write((uint64_t)(length - 1), 6);   // Stores length - 1 (1..32)
+            bits.write(x >> trailing, length);
+            lastLeading[c] = leading;
+            lastTrailing[c] = trailing;
+        }
+    }
+};
+
+// ==================== DECODER ====================
+class GorillaBlockDecoder {
+private:
+    GorillaBitReader bits;
+    uint16_t total;
+    uint16_t decoded;
+    bool valid;
+
+    uint64_t lastTimestamp;
+    int64_t lastDelta;
+    uint32_t lastValue[GORILLA_CHANNELS];
+    int lastLeading[GORILLA_CHANNELS];
+    int lastTrailing[GORILLA_CHANNELS];
+    uint8_t lastClass;
+
+public:
+    GorillaBlockDecoder(const uint8_t* block, size_t length) : total(0), decoded(0), valid(false),
+        lastTimestamp(0), lastDelta(0), lastClass(0) {
+        for (int c = 0; c < GORILLA_CHANNELS; c++) {
+            lastValue[c] = 0;
+            lastLeading[c] = 0;
+            lastTrailing[c] = 0;
+        }
+        if (length >= GORILLA_HEADER_SIZE && block[0] == 'G' && block[1] == 'B' &&
+            block[2] == GORILLA_VERSION) {
+            total = (uint16_t)(block[3] | (block[4] << 8));
+            bits.attach(block + GORILLA_HEADER_SIZE, length - GORILLA_HEADER_SIZE, 0);
+            valid = true;
+        }
+    }
+
+    bool isValid() const { return valid; }
+    uint16_t sampleCount() const { return total; }
+
+    // Next sample; false at the end of the block or on corrupt data
+    bool next(uint64_t& timestampMs, float values[GORILLA_CHANNELS], uint8_t& classId) {
+        if (!valid || decoded >= total) return false;
+
+        if (decoded == 0) {
+            lastTimestamp = bits.read(64);
+            for (int c = 0; c < GORILLA_CHANNELS; c++) {
+                lastValue[c] = (uint32_t)bits.read(32);
+            }
+            lastClass = (uint8_t)bits.read(3);
+        } else {
+            int64_t dod;
+            if (bits.read(1) == 0) {
+                dod = 0;
+            } else if (bits.read(1) == 0) {
+                dod = signExtend(bits.read(7), 7);
+            } else if (bits.read(1) == 0) {
+                dod = signExtend(bits.read(9), 9);
+            } else if (bits.read(1) == 0) {
+                dod = signExtend(bits.read(12), 12);
+            } else {
+                dod = signExtend(bits.read(32), 32);
+            }
+            lastDelta += dod;
+            lastTimestamp += (uint64_t)lastDelta;
+
+            for (int c = 0; c < GORILLA_CHANNELS; c++) {
+                readValue(c);
+            }
+            if (bits.read(1) == 1) {
+                lastClass = (uint8_t)bits.read(3);
+            }
+        }
+        if (bits.overrun()) {
+            valid = false;
+            return false;
+        }
+
+        timestampMs = lastTimestamp;
+        for (int c = 0; c < GORILLA_CHANNELS; c++) {
+            values[c] = gorilla_bits_float(lastValue[c]);
+        }
+        classId = lastClass;
+        decoded++;
+        return true;
+    }
+
+private:
+    static int64_t signExtend(uint64_t value, int width) {
+        // Encoder ranges are asymmetric ([-63, 64] in 7 bits): values above
+        // the positive limit wrap negative, the top value is exact
+        int64_t limit = (int64_t)1 << (width - 1);
+        int64_t v = (int64_t)value;
+        return v > limit ? v - ((int64_t)1 << width) : v;
+    }
+
+    void readValue(int c) {
+        if (bits.read(1) == 0) {
+            return;   // Unchanged
+        }
+        uint32_t x;
+        if (bits.read(1) == 0) {
+            int length = 32 - lastLeading[c] - lastTrailing[c];
+            x = (uint32_t)bits.read(length) << lastTrailing[c];
+        } else {
+            int leading = (int)bits.read(5);
+            int length = (int)bits.read(6) + 1;
+            int trailing = 32 - leading - length;
+            if (trailing < 0) {
+                trailing = 0;
+                length = 32 - leading;
+                valid = false;
+            }
+            x = (uint32_t)(bits.read(length) << trailing);
+            lastLeading[c] = leading;
+            lastTrailing[c] = trailing;
+        }
+        lastValue[c] ^= x;
+    }
+};
+
+#endif // GORILLA_BLOCK_H
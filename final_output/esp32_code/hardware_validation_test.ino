@@ -8,6 +8,8 @@
  * 2. Scan I2C bus and list all devices found
  * 3. Read sensors continuously
  * 
+ * Commands: scan (rescan I2C), pause / resume (sensor readings), help
+ * 
  * Hardware: ESP32-S3-DevKitC-1
  * I2C Pins: SDA=GPIO 8, SCL=GPIO 9
  * Analog: MQ2 Gas Sensor on GPIO 6
@@ -15,6 +17,7 @@
 
 #include <Wire.h>
 #include <WiFi.h>
+#include "serial_commands.h"
 
 // ==================== CONFIGURATION ====================
 
@@ -41,6 +44,10 @@
 byte i2cDevices[127];
 int numI2CDevices = 0;
 
+// Serial console (fixed line buffer, see serial_commands.h)
+SerialLineReader console;
+bool readingsPaused = false;
+
 // ==================== SETUP ====================
 
 void setup() {
@@ -87,6 +94,15 @@ void setup() {
 // ==================== MAIN LOOP ====================
 
 void loop() {
+    if (console.ready()) {
+        processCommand(console.line());
+        console.clear();
+    }
+    if (readingsPaused) {
+        delay(50);
+        return;
+    }
+    
     // Check WiFi status
     if (WiFi.status() == WL_CONNECTED) {
         Serial.printf("✅ WiFi: Connected | RSSI: %d dBm | IP: %s\n", 
@@ -117,6 +133,38 @@ void loop() {
     delay(SENSOR_READ_INTERVAL);
 }
 
+void serialEvent() {
+    console.pump(Serial);
+}
+
+// ==================== COMMANDS ====================
+
+void cmdScan(const char* args) { scanI2CDevices(); }
+void cmdPause(const char* args) { readingsPaused = true; Serial.println("⏸️  Readings paused"); }
+void cmdResume(const char* args) { readingsPaused = false; Serial.println("▶️  Readings resumed"); }
+void cmdHelp(const char* args);
+
+static const SerialCommand COMMANDS[] = {
+    { "scan", cmdScan, "Rescan the I2C bus" },
+    { "pause", cmdPause, "Stop the periodic sensor readings" },
+    { "resume", cmdResume, "Restart the periodic sensor readings" },
+    { "help", cmdHelp, "Show this help" },
+};
+
+void cmdHelp(const char* args) {
+    Serial.println("\n📋 Commands:");
+    for (size_t i = 0; i < SERIAL_COMMAND_COUNT(COMMANDS); i++) {
+        Serial.printf("   %-8s - %s\n", COMMANDS[i].name, COMMANDS[i].help);
+    }
+    Serial.println();
+}
+
+void processCommand(const char* line) {
+    if (!serial_dispatch(COMMANDS, SERIAL_COMMAND_COUNT(COMMANDS), line)) {
+        Serial.println("❌ Unknown command - type 'help'");
+    }
+}
+
 // ==================== I2C SCAN ====================
 
 void scanI2CDevices() {
@@ -0,0 +1,292 @@
+/*
+ * HIL Protocol - Binary framed batch predictions over serial
+ *
+ * Hardware-in-the-loop validation mode of the test sketch. The text mode
+ * takes one "temperature,humidity,pressure,lux" line per prediction and
+ * answers with ~30 decorated lines, so the ~104k-row test set takes
+ * hours. Here a host streams batches of raw feature vectors and gets back
+ * packed class IDs plus the CPU cycles each prediction took.
+ *
+ * Entering and leaving: the text command "binary" answers
+ * HIL_READY_LINE and switches the port to frames; an EXIT frame answers
+ * BYE and switches back.
+ *
+ * Frame Layout (little endian):
+ *   Offset  Size  Field
+ *   0       2     Magic 'W','B'
+ *   2       1     Type (HIL_FRAME_*)
+ *   3       1     Flags (BATCH: bit0 = features already scaled to [0, 1])
+ *   4       2     Sequence (echoed in the answer)
+ *   6       2     Payload length
+ *   8       n     Payload
+ *   8+n     2     CRC-16/CCITT over everything before it (telemetry_codec.h)
+ *
+ * Payloads:
+ *   BATCH   u16 count, count x 4 float32 (temperature, humidity, pressure, lux)
+ *   RESULT  u16 count, count x u8 class id, count x u32 cycles
+ *   ERROR   u8 code (HIL_ERROR_*)
+ *   PING/PONG/EXIT/BYE  empty
+ *
+ * A corrupt frame is answered with ERROR (bad CRC, oversized, unknown
+ * type) when its header was readable; the parser then resynchronises on
+ * the next magic. No Arduino dependencies: the sketch and the host
+ * emulator (host_tools/hil_driver.cpp) run the same HilSession.
+ */
+
+#ifndef HIL_PROTOCOL_H
+#define HIL_PROTOCOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "telemetry_codec.h"
+
+#define HIL_MAGIC0 'W'
+#define HIL_MAGIC1 'B'
+#define HIL_HEADER_SIZE 8
+#define HIL_CRC_SIZE 2
+#define HIL_FEATURES 4
+#define HIL_MAX_BATCH 64
+#define HIL_MAX_PAYLOAD (2 + HIL_MAX_BATCH * HIL_FEATURES * 4)
+#define HIL_MAX_FRAME (HIL_HEADER_SIZE + HIL_MAX_PAYLOAD + HIL_CRC_SIZE)
+#define HIL_READY_LINE "HIL BINARY v1"
+
+#define HIL_FLAG_SCALED 0x01
+
+enum HilFrameType {
+    HIL_FRAME_BATCH = 0x01,
+    HIL_FRAME_PING = 0x02,
+    HIL_FRAME_EXIT = 0x03,
+    HIL_FRAME_RESULT = 0x81,
+    HIL_FRAME_ERROR = 0x82,
+    HIL_FRAME_PONG = 0x83,
+    HIL_FRAME_BYE = 0x84
+};
+
+enum HilError {
+    HIL_ERROR_CRC = 1,
+    HIL_ERROR_TOO_LARGE = 2,
+    HIL_ERROR_BAD_TYPE = 3,
+    HIL_ERROR_BAD_BATCH = 4
+};
+
+// ==================== PRIMITIVES ====================
+inline void hil_put_u16(uint8_t* out, uint16_t v) {
+    out[0] = (uint8_t)v;
+    out[1] = (uint8_t)(v >> 8);
+}
+
+inline void hil_put_u32(uint8_t* out, uint32_t v) {
+    for (int i = 0; i < 4; i++) out[i] = (uint8_t)(v >> (8 * i));
+}
+
+inline uint16_t hil_get_u16(const uint8_t* in) { return (uint16_t)(in[0] | (in[1] << 8)); }
+
+inline uint32_t hil_get_u32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+// Frame around `payload` into out (HIL_HEADER_SIZE + length + HIL_CRC_SIZE bytes)
+inline size_t hil_write_frame(uint8_t* out, uint8_t type, uint8_t flags, uint16_t sequence, const uint8_t* payload,
+                              uint16_t length) {
+    out[0] = HIL_MAGIC0;
+    out[1] = HIL_MAGIC1;
+    out[2] = type;
+    out[3] = flags;
+    hil_put_u16(out + 4, sequence);
+    hil_put_u16(out + 6, length);
+    if (length > 0 && payload != out + HIL_HEADER_SIZE) memcpy(out + HIL_HEADER_SIZE, payload, length);
+    hil_put_u16(out + HIL_HEADER_SIZE + length, telemetry_crc16(out, HIL_HEADER_SIZE + length));
+    return HIL_HEADER_SIZE + length + HIL_CRC_SIZE;
+}
+
+// ==================== PARSER ====================
+struct HilFrame {
+    uint8_t type;
+    uint8_t flags;
+    uint16_t sequence;
+    uint16_t length;
+    const uint8_t* payload;
+};
+
+enum HilParseResult {
+    HIL_PARSE_MORE = 0,     // Need more bytes
+    HIL_PARSE_FRAME,        // frame() is valid until the next feed()
+    HIL_PARSE_ERROR         // error() says why; frame() has the header
+};
+
+class HilFrameParser {
+private:
+    uint8_t buffer[HIL_MAX_FRAME];
+    size_t used;
+    size_t needed;
+    HilFrame current;
+    uint8_t lastError;
+    uint32_t resyncBytes;   // Bytes skipped while hunting for the magic
+
+public:
+    HilFrameParser() { reset(); resyncBytes = 0; }
+
+    void reset() {
+        used = 0;
+        needed = HIL_HEADER_SIZE;
+        lastError = 0;
+    }
+
+    HilParseResult feed(uint8_t byte) {
+        if (used == 0 && byte != HIL_MAGIC0) {
+            resyncBytes++;
+            return HIL_PARSE_MORE;
+        }
+        if (used == 1 && byte != HIL_MAGIC1) {
+            resyncBytes++;
+            used = byte == HIL_MAGIC0 ? 1 : 0;
+            return HIL_PARSE_MORE;
+        }
+        buffer[used++] = byte;
+        if (used < needed) return HIL_PARSE_MORE;
+
+        if (used == HIL_HEADER_SIZE) {
+            current.type = buffer[2];
+            current.flags = buffer[3];
+            current.sequence = hil_get_u16(buffer + 4);
+            current.length = hil_get_u16(buffer + 6);
+            if (current.length > HIL_MAX_PAYLOAD) {
+                lastError = HIL_ERROR_TOO_LARGE;
+                used = 0;
+                needed = HIL_HEADER_SIZE;
+                return HIL_PARSE_ERROR;
+            }
+            needed = HIL_HEADER_SIZE + current.length + HIL_CRC_SIZE;
+            return HIL_PARSE_MORE;
+        }
+
+        size_t body = HIL_HEADER_SIZE + current.length;
+        bool crcOk = telemetry_crc16(buffer, body) == hil_get_u16(buffer + body);
+        current.payload = buffer + HIL_HEADER_SIZE;
+        used = 0;
+        needed = HIL_HEADER_SIZE;
+        if (!crcOk) {
+            lastError = HIL_ERROR_CRC;
+            return HIL_PARSE_ERROR;
+        }
+        return HIL_PARSE_FRAME;
+    }
+
+    const HilFrame& frame() const { return current; }
+    uint8_t error() const { return lastError; }
+    uint32_t getResyncBytes() const { return resyncBytes; }
+};
+
+// ==================== DEVICE SESSION ====================
+// features: 4 raw values (sensor units) or scaled ones if `scaled`
+typedef int (*HilPredictFn)(const float* features, bool scaled, void* context);
+typedef uint32_t (*HilCycleFn)();
+typedef void (*HilWriteFn)(const uint8_t* data, size_t length, void* context);
+
+struct HilSessionStats {
+    uint32_t batches;
+    uint32_t samples;
+    uint32_t errors;
+    uint64_t cycles;       // Sum over all predictions
+};
+
+class HilSession {
+private:
+    HilPredictFn predict;
+    HilCycleFn cycles;
+    HilWriteFn write;
+    void* context;
+    HilFrameParser parser;
+    uint8_t response[HIL_HEADER_SIZE + 2 + HIL_MAX_BATCH * 5 + HIL_CRC_SIZE];
+    HilSessionStats stats;
+    bool active;
+
+public:
+    HilSession(HilPredictFn predictFn, HilCycleFn cycleFn, HilWriteFn writeFn, void* ctx)
+        : predict(predictFn), cycles(cycleFn), write(writeFn), context(ctx), active(false) {
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    void begin() {
+        parser.reset();
+        memset(&stats, 0, sizeof(stats));
+        active = true;
+    }
+
+    bool isActive() const { return active; }
+    const HilSessionStats& getStats() const { return stats; }
+
+    // Feed bytes from the port; answers are written as frames complete.
+    // Returns false once an EXIT frame was handled (back to text mode).
+    bool feed(const uint8_t* data, size_t length) {
+        for (size_t i = 0; i < length && active; i++) {
+            HilParseResult result = parser.feed(data[i]);
+            if (result == HIL_PARSE_FRAME) {
+                handle(parser.frame());
+            } else if (result == HIL_PARSE_ERROR) {
+                sendError(parser.frame().sequence, parser.error());
+            }
+        }
+        return active;
+    }
+
+private:
+    void handle(const HilFrame& frame) {
+        switch (frame.type) {
+            case HIL_FRAME_BATCH:
+                handleBatch(frame);
+                break;
+            case HIL_FRAME_PING:
+                send(HIL_FRAME_PONG, frame.sequence, 0);
+                break;
+            case HIL_FRAME_EXIT:
+                send(HIL_FRAME_BYE, frame.sequence, 0);
+                active = false;
+                break;
+            default:
+                sendError(frame.sequence, HIL_ERROR_BAD_TYPE);
+                break;
+        }
+    }
+
+    void handleBatch(const HilFrame& frame) {
+        uint16_t count = frame.length >= 2 ? hil_get_u16(frame.payload) : 0;
+        if (frame.length < 2 || count > HIL_MAX_BATCH || frame.length != 2 + count * HIL_FEATURES * 4) {
+            sendError(frame.sequence, HIL_ERROR_BAD_BATCH);
+            return;
+        }
+        bool scaled = (frame.flags & HIL_FLAG_SCALED) != 0;
+        uint8_t* payload = response + HIL_HEADER_SIZE;
+        uint8_t* classes = payload + 2;
+        uint8_t* cycleOut = classes + count;
+        hil_put_u16(payload, count);
+        for (uint16_t i = 0; i < count; i++) {
+            float features[HIL_FEATURES];
+            memcpy(features, frame.payload + 2 + i * HIL_FEATURES * 4, sizeof(features));
+            uint32_t start = cycles();
+            int predicted = predict(features, scaled, context);
+            uint32_t spent = cycles() - start;
+            classes[i] = (uint8_t)predicted;
+            hil_put_u32(cycleOut + i * 4, spent);
+            stats.cycles += spent;
+        }
+        stats.batches++;
+        stats.samples += count;
+        send(HIL_FRAME_RESULT, frame.sequence, (uint16_t)(2 + count * 5));
+    }
+
+    void sendError(uint16_t sequence, uint8_t code) {
+        stats.errors++;
+        response[HIL_HEADER_SIZE] = code;
+        send(HIL_FRAME_ERROR, sequence, 1);
+    }
+
+    // Payload is already in place after the header
+    void send(uint8_t type, uint16_t sequence, uint16_t length) {
+        size_t size = hil_write_frame(response, type, 0, sequence, response + HIL_HEADER_SIZE, length);
+        write(response, size, context);
+    }
+};
+
+#endif // HIL_PROTOCOL_H
@@ -0,0 +1,427 @@
+/*
+ * Inference Bench - Latency distribution of the classifier over the whole
+ * scaled feature space
+ *
+ * Replaces "same six inputs for 20 s, min/avg/max" with a measurement
+ * that can be compared across model versions:
+ *
+ * - Inputs: a jittered Latin hypercube over the scaled space [0,1]^4
+ *   (every feature's range cut into INFERENCE_BENCH_SAMPLES strata, each
+ *   used exactly once), generated from a seed without storing the design,
+ *   so two runs with the same seed feed identical inputs
+ * - Per class: samples are grouped by the predicted class; classes with
+ *   fewer than INFERENCE_BENCH_CLASS_MIN samples get extra inputs jittered
+ *   around their own hypercube points until they reach it (top-ups count
+ *   for that class only, never for the overall distribution)
+ * - Warm: INFERENCE_BENCH_WARMUP predictions first, then every sample
+ *   back to back (flash cache as hot as steady operation gets)
+ * - Cold: caller's evict() before each of INFERENCE_BENCH_COLD_SAMPLES
+ *   predictions (cache-miss cost of a model that lives in flash)
+ * - Probes: small reference kernels (e.g. one in IRAM, the same one in
+ *   flash), each timed warm and cold: an IRAM kernel's cold/warm ratio
+ *   stays ~1, a flash kernel's shows the miss penalty per cache line
+ * - Timing: the CPU cycle counter, minus the counter's own read overhead
+ * - Exact percentiles (sorted samples): p50/p90/p99/p99.9, min/max/mean
+ * - Prediction digest (FNV-1a over the hypercube's predicted classes):
+ *   changes whenever the model decides differently somewhere in the grid
+ *
+ * Memory: ~46 KB of sample arrays inside the object (declare it static,
+ * never on a task stack), no heap. No Arduino dependencies: predictions,
+ * the cycle counter and cache eviction are callbacks (host tools reuse it
+ * with a nanosecond clock).
+ *
+ * Usage:
+ *   static InferenceBench bench(predictFn, cycleCountFn, nullptr);
+ *   bench.setEvict(evictCaches);
+ *   bench.addProbe("iram_ref", iramKernel);
+ *   bench.addProbe("flash_ref", flashKernel);
+ *   bench.run(1);
+ *   bench.encodeJson(buffer, sizeof(buffer), "rf250", 240);
+ */
+
+#ifndef INFERENCE_BENCH_H
+#define INFERENCE_BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "telemetry_record.h"
+
+#define INFERENCE_BENCH_FEATURES 4
+#define INFERENCE_BENCH_SAMPLES 4000        // Hypercube points (overall distribution)
+#define INFERENCE_BENCH_CLASS_MIN 200       // Samples per class before top-ups stop
+#define INFERENCE_BENCH_TOPUP_MAX 1000      // Extra samples for rare classes
+#define INFERENCE_BENCH_TOPUP_ATTEMPTS 5000 // Inputs tried for top-ups
+#define INFERENCE_BENCH_TOPUP_RADIUS 0.05f  // Jitter (scaled units) around a rare-class point
+#define INFERENCE_BENCH_WARMUP 256
+#define INFERENCE_BENCH_COLD_SAMPLES 500
+#define INFERENCE_BENCH_PROBE_SAMPLES 500
+#define INFERENCE_BENCH_MAX_PROBES 2
+#define INFERENCE_BENCH_CAPACITY (INFERENCE_BENCH_SAMPLES + INFERENCE_BENCH_TOPUP_MAX)
+
+typedef int (*InferencePredictFn)(const float* scaled, void* context);
+typedef uint32_t (*InferenceCycleFn)();
+typedef void (*InferenceEvictFn)(void* context);
+typedef void (*InferenceProbeFn)(const float* scaled);
+
+// Cycle counts (0 when no samples)
+struct InferenceLatency {
+    uint32_t count;
+    uint32_t min;
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p99;
+    uint32_t p999;
+    uint32_t max;
+    uint32_t mean;
+};
+
+struct InferenceProbe {
+    const char* name;
+    InferenceProbeFn fn;
+    InferenceLatency warm;
+    InferenceLatency cold;
+};
+
+class InferenceBench {
+private:
+    InferencePredictFn predict;
+    InferenceCycleFn cycles;
+    void* context;
+    InferenceEvictFn evict;
+
+    InferenceProbe probes[INFERENCE_BENCH_MAX_PROBES];
+    int probeCount;
+
+    // Raw samples: warm cycles and predicted class (hypercube first, then
+    // top-ups); scratch holds one series at a time for sorting
+    uint32_t samples[INFERENCE_BENCH_CAPACITY];
+    uint8_t classes[INFERENCE_BENCH_CAPACITY];
+    uint32_t scratch[INFERENCE_BENCH_CAPACITY];
+    uint32_t sampleCount;
+
+    InferenceLatency warmStats;
+    InferenceLatency coldStats;
+    InferenceLatency classStats[TELEMETRY_NUM_CLASSES];
+    uint32_t classHypercube[TELEMETRY_NUM_CLASSES];   // Hypercube samples per class
+    uint32_t topups;
+    uint32_t overhead;
+    uint32_t digest;
+    uint32_t seed;
+    uint32_t rng;
+
+public:
+    InferenceBench(InferencePredictFn predictFn, InferenceCycleFn cycleFn, void* predictContext)
+        : predict(predictFn), cycles(cycleFn), context(predictContext), evict(nullptr), probeCount(0),
+          sampleCount(0), topups(0), overhead(0), digest(0), seed(1), rng(1) {
+        clear(warmStats);
+        clear(coldStats);
+        for (int c = 0; c < TELEMETRY_NUM_CLASSES; c++) {
+            clear(classStats[c]);
+            classHypercube[c] = 0;
+        }
+    }
+
+    // Flushes the caches the model runs from (nullptr: no cold series)
+    void setEvict(InferenceEvictFn evictFn) { evict = evictFn; }
+
+    bool addProbe(const char* name, InferenceProbeFn fn) {
+        if (probeCount >= INFERENCE_BENCH_MAX_PROBES || fn == nullptr) return false;
+        probes[probeCount].name = name;
+        probes[probeCount].fn = fn;
+        clear(probes[probeCount].warm);
+        clear(probes[probeCount].cold);
+        probeCount++;
+        return true;
+    }
+
+    // Blocking: ~(SAMPLES + top-ups) predictions warm plus the cold and
+    // probe series (a few seconds at ~1 ms per prediction)
+    void run(uint32_t runSeed) {
+        seed = runSeed ? runSeed : 1;
+        measureOverhead();
+
+        // Warmup on the same inputs
+        float x[INFERENCE_BENCH_FEATURES];
+        for (uint32_t i = 0; i < INFERENCE_BENCH_WARMUP; i++) {
+            hypercubePoint(i % INFERENCE_BENCH_SAMPLES, x);
+            predict(x, context);
+        }
+
+        // Hypercube, back to back
+        rng = seed;
+        digest = 2166136261u;
+        sampleCount = 0;
+        for (int c = 0; c < TELEMETRY_NUM_CLASSES; c++) classHypercube[c] = 0;
+        for (uint32_t i = 0; i < INFERENCE_BENCH_SAMPLES; i++) {
+            hypercubePoint(i, x);
+            int predicted = 0;
+            uint32_t spent = timePredict(x, predicted);
+            store(spent, predicted);
+            classHypercube[classes[sampleCount - 1]]++;
+            digest = (digest ^ (uint8_t)predicted) * 16777619u;
+        }
+
+        // Rare classes: jitter around the hypercube points that landed in
+        // them (uniform inputs almost never hit a class that owns <1% of the
+        // space); keep a result only while its class is below the minimum
+        uint32_t perClass[TELEMETRY_NUM_CLASSES];
+        memcpy(perClass, classHypercube, sizeof(perClass));
+        topups = 0;
+        uint32_t anchor = 0;
+        for (uint32_t attempt = 0; attempt < INFERENCE_BENCH_TOPUP_ATTEMPTS && sampleCount < INFERENCE_BENCH_CAPACITY;
+             attempt++) {
+            if (!nextAnchor(perClass, anchor)) break;
+            hypercubePoint(anchor, x);
+            for (int f = 0; f < INFERENCE_BENCH_FEATURES; f++) {
+                float v = x[f] + (unit() - 0.5f) * INFERENCE_BENCH_TOPUP_RADIUS;
+                x[f] = v < 0.0f ? 0.0f : v > 1.0f ? 1.0f : v;
+            }
+            anchor++;
+            int predicted = 0;
+            uint32_t spent = timePredict(x, predicted);
+            int c = predicted >= 0 && predicted < TELEMETRY_NUM_CLASSES ? predicted : 0;
+            if (perClass[c] < INFERENCE_BENCH_CLASS_MIN) {
+                store(spent, c);
+                perClass[c]++;
+                topups++;
+            }
+        }
+
+        summarizeWarm();
+
+        // Cold: evenly spaced hypercube points, caches flushed before each
+        clear(coldStats);
+        if (evict != nullptr) {
+            uint32_t step = INFERENCE_BENCH_SAMPLES / INFERENCE_BENCH_COLD_SAMPLES;
+            for (uint32_t i = 0; i < INFERENCE_BENCH_COLD_SAMPLES; i++) {
+                hypercubePoint(i * step, x);
+                evict(context);
+                int predicted = 0;
+                scratch[i] = timePredict(x, predicted);
+            }
+            summarize(scratch, INFERENCE_BENCH_COLD_SAMPLES, coldStats);
+        }
+
+        for (int p = 0; p < probeCount; p++) {
+            runProbe(probes[p]);
+        }
+    }
+
+    const InferenceLatency& warm() const { return warmStats; }
+    const InferenceLatency& cold() const { return coldStats; }
+    const InferenceLatency& forClass(int c) const { return classStats[c]; }
+    uint32_t hypercubeCount(int c) const { return classHypercube[c]; }
+    int getProbeCount() const { return probeCount; }
+    const InferenceProbe& probe(int p) const { return probes[p]; }
+    uint32_t getTopups() const { return topups; }
+    uint32_t getOverhead() const { return overhead; }
+    uint32_t getDigest() const { return digest; }
+    uint32_t getSeed() const { return seed; }
+
+    // {"model":"..","cpu_mhz":n,"unit":"cycles","seed":n,"samples":n,"warmup":n,"topups":n,"overhead":n,
+    //  "digest":"xxxxxxxx","warm":{"n":..,"min":..,"p50":..,"p90":..,"p99":..,"p999":..,"max":..,"mean":..},
+    //  "cold":{..},"classes":{"Cloudy":{"share":x,"n":..,"p50":..,"p90":..,"p99":..,"max":..},..},
+    //  "probes":{"iram_ref":{"warm_p50":..,"warm_p99":..,"cold_p50":..,"cold_p99":..},..}}
+    // One line, keys in a fixed order: diff two runs line against line
+    int encodeJson(char* out, size_t size, const char* model, uint32_t cpuMhz) const {
+        size_t used = 0;
+        int written = snprintf(out, size,
+                               "{\"model\":\"%s\",\"cpu_mhz\":%lu,\"unit\":\"cycles\",\"seed\":%lu,\"samples\":%lu,"
+                               "\"warmup\":%lu,\"topups\":%lu,\"overhead\":%lu,\"digest\":\"%08lx\",\"warm\":",
+                               model, (unsigned long)cpuMhz, (unsigned long)seed,
+                               (unsigned long)INFERENCE_BENCH_SAMPLES, (unsigned long)INFERENCE_BENCH_WARMUP,
+                               (unsigned long)topups, (unsigned long)overhead, (unsigned long)digest);
+        if (!advance(written, size, used)) return -1;
+        if (!appendLatency(out, size, used, warmStats)) return -1;
+        written = snprintf(out + used, size - used, ",\"cold\":");
+        if (!advance(written, size, used)) return -1;
+        if (!appendLatency(out, size, used, coldStats)) return -1;
+
+        written = snprintf(out + used, size - used, ",\"classes\":{");
+        if (!advance(written, size, used)) return -1;
+        for (int c = 0; c < TELEMETRY_NUM_CLASSES; c++) {
+            const InferenceLatency& s = classStats[c];
+            written = snprintf(out + used, size - used,
+                               "%s\"%s\":{\"share\":%.4f,\"n\":%lu,\"p50\":%lu,\"p90\":%lu,\"p99\":%lu,\"max\":%lu}",
+                               c ? "," : "", telemetry_class_name((uint8_t)c),
+                               (double)classHypercube[c] / INFERENCE_BENCH_SAMPLES, (unsigned long)s.count,
+                               (unsigned long)s.p50, (unsigned long)s.p90, (unsigned long)s.p99,
+                               (unsigned long)s.max);
+            if (!advance(written, size, used)) return -1;
+        }
+
+        written = snprintf(out + used, size - used, "},\"probes\":{");
+        if (!advance(written, size, used)) return -1;
+        for (int p = 0; p < probeCount; p++) {
+            const InferenceProbe& probe = probes[p];
+            written = snprintf(out + used, size - used,
+                               "%s\"%s\":{\"warm_p50\":%lu,\"warm_p99\":%lu,\"cold_p50\":%lu,\"cold_p99\":%lu}",
+                               p ? "," : "", probe.name, (unsigned long)probe.warm.p50,
+                               (unsigned long)probe.warm.p99, (unsigned long)probe.cold.p50,
+                               (unsigned long)probe.cold.p99);
+            if (!advance(written, size, used)) return -1;
+        }
+        written = snprintf(out + used, size - used, "}}");
+        if (!advance(written, size, used)) return -1;
+        return (int)used;
+    }
+
+private:
+    static void clear(InferenceLatency& s) { memset(&s, 0, sizeof(s)); }
+
+    static bool advance(int written, size_t size, size_t& used) {
+        if (written < 0 || used + (size_t)written >= size) return false;
+        used += (size_t)written;
+        return true;
+    }
+
+    static bool appendLatency(char* out, size_t size, size_t& used, const InferenceLatency& s) {
+        int written = snprintf(out + used, size - used,
+                               "{\"n\":%lu,\"min\":%lu,\"p50\":%lu,\"p90\":%lu,\"p99\":%lu,\"p999\":%lu,\"max\":%lu,"
+                               "\"mean\":%lu}",
+                               (unsigned long)s.count, (unsigned long)s.min, (unsigned long)s.p50,
+                               (unsigned long)s.p90, (unsigned long)s.p99, (unsigned long)s.p999,
+                               (unsigned long)s.max, (unsigned long)s.mean);
+        return advance(written, size, used);
+    }
+
+    // xorshift32
+    uint32_t next() {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return rng;
+    }
+
+    float unit() { return (float)(next() >> 8) * (1.0f / 16777216.0f); }
+
+    // Position inside a stratum: a hash of (seed, point, feature), so
+    // point i is the same input wherever it is regenerated
+    uint32_t jitter(uint32_t i, int f) const {
+        uint32_t h = seed * 0x9e3779b9u ^ (i * INFERENCE_BENCH_FEATURES + (uint32_t)f) * 0x85ebca6bu;
+        h ^= h >> 16;
+        h *= 0x7feb352du;
+        h ^= h >> 15;
+        h *= 0x846ca68bu;
+        h ^= h >> 16;
+        return h;
+    }
+
+    // Point i of the hypercube: feature f uses stratum (i * STRIDE[f] +
+    // OFFSET[f]) mod N. Strides are coprime with N, so every stratum of
+    // every feature is used exactly once; the strides differ, so features
+    // are not correlated along i
+    void hypercubePoint(uint32_t i, float* x) const {
+        static const uint32_t STRIDE[INFERENCE_BENCH_FEATURES] = { 1, 1637, 2389, 3571 };
+        static const uint32_t OFFSET[INFERENCE_BENCH_FEATURES] = { 0, 977, 2113, 3203 };
+        for (int f = 0; f < INFERENCE_BENCH_FEATURES; f++) {
+            uint32_t stratum = (uint32_t)(((uint64_t)i * STRIDE[f] + OFFSET[f]) % INFERENCE_BENCH_SAMPLES);
+            float within = (float)(jitter(i, f) >> 8) * (1.0f / 16777216.0f);
+            x[f] = ((float)stratum + within) / INFERENCE_BENCH_SAMPLES;
+        }
+    }
+
+    void measureOverhead() {
+        uint32_t best = UINT32_MAX;
+        for (int i = 0; i < 64; i++) {
+            uint32_t start = cycles();
+            uint32_t spent = cycles() - start;
+            if (spent < best) best = spent;
+        }
+        overhead = best;
+    }
+
+    uint32_t timePredict(const float* x, int& predicted) {
+        uint32_t start = cycles();
+        predicted = predict(x, context);
+        uint32_t spent = cycles() - start;
+        return spent > overhead ? spent - overhead : 0;
+    }
+
+    void store(uint32_t spent, int predicted) {
+        samples[sampleCount] = spent;
+        classes[sampleCount] = (uint8_t)(predicted >= 0 && predicted < TELEMETRY_NUM_CLASSES ? predicted : 0);
+        sampleCount++;
+    }
+
+    // Next hypercube index (cyclic, from `anchor`) whose class is still
+    // below the minimum; false when no class needs more (or a class never
+    // appeared in the hypercube: nothing to jitter around)
+    bool nextAnchor(const uint32_t* perClass, uint32_t& anchor) const {
+        for (uint32_t k = 0; k < INFERENCE_BENCH_SAMPLES; k++) {
+            uint32_t i = (anchor + k) % INFERENCE_BENCH_SAMPLES;
+            if (perClass[classes[i]] < INFERENCE_BENCH_CLASS_MIN) {
+                anchor = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void summarizeWarm() {
+        memcpy(scratch, samples, INFERENCE_BENCH_SAMPLES * sizeof(uint32_t));
+        summarize(scratch, INFERENCE_BENCH_SAMPLES, warmStats);
+        for (int c = 0; c < TELEMETRY_NUM_CLASSES; c++) {
+            uint32_t n = 0;
+            for (uint32_t i = 0; i < sampleCount; i++) {
+                if (classes[i] == c) scratch[n++] = samples[i];
+            }
+            summarize(scratch, n, classStats[c]);
+        }
+    }
+
+    void runProbe(InferenceProbe& probe) {
+        float x[INFERENCE_BENCH_FEATURES];
+        for (uint32_t i = 0; i < INFERENCE_BENCH_WARMUP; i++) {
+            hypercubePoint(i, x);
+            probe.fn(x);
+        }
+        for (int series = 0; series < 2; series++) {
+            bool cold = series == 1;
+            if (cold && evict == nullptr) break;
+            for (uint32_t i = 0; i < INFERENCE_BENCH_PROBE_SAMPLES; i++) {
+                hypercubePoint(i, x);
+                if (cold) evict(context);
+                uint32_t start = cycles();
+                probe.fn(x);
+                uint32_t spent = cycles() - start;
+                scratch[i] = spent > overhead ? spent - overhead : 0;
+            }
+            summarize(scratch, INFERENCE_BENCH_PROBE_SAMPLES, cold ? probe.cold : probe.warm);
+        }
+    }
+
+    static int compareCycles(const void* a, const void* b) {
+        uint32_t x = *(const uint32_t*)a;
+        uint32_t y = *(const uint32_t*)b;
+        return x < y ? -1 : x > y ? 1 : 0;
+    }
+
+    // Nearest-rank percentile of a sorted series
+    static uint32_t rankValue(const uint32_t* sorted, uint32_t n, uint32_t perMille) {
+        uint32_t rank = (uint32_t)(((uint64_t)perMille * n + 999) / 1000);
+        if (rank < 1) rank = 1;
+        return sorted[rank - 1];
+    }
+
+    // Sorts `values` in place
+    static void summarize(uint32_t* values, uint32_t n, InferenceLatency& s) {
+        clear(s);
+        if (n == 0) return;
+        qsort(values, n, sizeof(uint32_t), compareCycles);
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i < n; i++) sum += values[i];
+        s.count = n;
+        s.min = values[0];
+        s.max = values[n - 1];
+        s.mean = (uint32_t)(sum / n);
+        s.p50 = rankValue(values, n, 500);
+        s.p90 = rankValue(values, n, 900);
+        s.p99 = rankValue(values, n, 990);
+        s.p999 = rankValue(values, n, 999);
+    }
+};
+
+#endif // INFERENCE_BENCH_H
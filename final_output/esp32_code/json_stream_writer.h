@@ -0,0 +1,327 @@
+/*
+ * JSON Stream Writer - Allocation-free JSON into a fixed buffer
+ *
+ * Features:
+ * - Writes straight into a caller-provided (reusable) buffer, no heap
+ * - Compile-time schemas: node keys are pre-quoted literals ("\"key\":")
+ *   with their lengths known at compile time, copied with memcpy
+ * - Fixed-point number formatting (no printf, no float library calls)
+ * - Automatic commas, nesting up to 16 levels
+ * - Overflow is sticky: once the buffer is full every call is a no-op and
+ *   length() returns -1 (same contract as the telemetry encoders)
+ * - No Arduino dependencies (host tools reuse it)
+ *
+ * Usage:
+ *   JsonStreamWriter w(buffer, sizeof(buffer));
+ *   w.beginObject();
+ *   w.field(JSON_STATUS_SCHEMA[JSON_STATUS_ONLINE]); w.value(true);
+ *   w.endObject();
+ *   int length = w.length();
+ *
+ * Node schemas for the Firebase status and info nodes live at the bottom;
+ * the reading node schema lives with its encoder in telemetry_record.h.
+ */
+
+#ifndef JSON_STREAM_WRITER_H
+#define JSON_STREAM_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define JSON_MAX_DEPTH 16
+
+// One schema entry: "\"name\":" and its length, both compile-time constants
+struct JsonField {
+    const char* key;
+    uint8_t length;
+};
+
+#define JSON_FIELD(name) { "\"" name "\":", (uint8_t)(sizeof("\"" name "\":") - 1) }
+#define JSON_SCHEMA_SIZE(schema) (sizeof(schema) / sizeof((schema)[0]))
+
+class JsonStreamWriter {
+private:
+    char* buffer;
+    size_t capacity;
+    size_t position;
+    bool overflow;
+    uint8_t depth;
+    uint16_t needsComma;   // Bit per nesting level: next element needs ','
+    bool afterKey;         // A key was just written: the value needs no comma
+
+public:
+    JsonStreamWriter(char* out, size_t size) { reset(out, size); }
+
+    void reset(char* out, size_t size) {
+        buffer = out;
+        capacity = size;
+        position = 0;
+        overflow = size == 0;
+        depth = 0;
+        needsComma = 0;
+        afterKey = false;
+        if (size > 0) buffer[0] = '\0';
+    }
+
+    // Characters written (excluding the terminator), or -1 after an overflow
+    int length() const { return overflow ? -1 : (int)position; }
+    bool ok() const { return !overflow; }
+    const char* c_str() const { return buffer; }
+
+    // ==================== STRUCTURE ====================
+    void beginObject() { open('{'); }
+    void endObject() { close('}'); }
+    void beginArray() { open('['); }
+    void endArray() { close(']'); }
+
+    // Schema key (pre-quoted, includes the colon)
+    void field(const JsonField& f) {
+        separator();
+        put(f.key, f.length);
+        afterKey = true;
+    }
+
+    // Runtime key (escaped)
+    void key(const char* name) {
+        separator();
+        string(name);
+        put(":", 1);
+        afterKey = true;
+    }
+
+    // ==================== VALUES ====================
+    void value(const char* text) {
+        element();
+        string(text ? text : "");
+    }
+
+    void value(bool b) {
+        element();
+        if (b) put("true", 4);
+        else put("false", 5);
+    }
+
+    void value(int32_t v) { element(); integer(v < 0, v < 0 ? (uint64_t)(-(int64_t)v) : (uint64_t)v); }
+    void value(uint32_t v) { element(); integer(false, v); }
+    void value(int64_t v) { element(); integer(v < 0, v < 0 ? (uint64_t)(-(v + 1)) + 1 : (uint64_t)v); }
+    void value(uint64_t v) { element(); integer(false, v); }
+
+    // Fixed-point decimal, same digits as printf("%.*f") for float inputs;
+    // NaN/Inf become null (not valid JSON)
+    void value(float v, uint8_t decimals) { value((double)v, decimals); }
+
+    void value(double v, uint8_t decimals) {
+        element();
+        if (v != v || v > 9.2e18 || v < -9.2e18) {
+            put("null", 4);
+            return;
+        }
+        static const uint32_t POW10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+        if (decimals > 6) decimals = 6;
+        bool negative = v < 0;
+        // float × 10^d is exact in a double, so ties are real ties: round
+        // half to even like printf
+        double scaled = (negative ? -v : v) * POW10[decimals];
+        uint64_t fixed = (uint64_t)scaled;
+        double remainder = scaled - (double)fixed;
+        if (remainder > 0.5 || (remainder == 0.5 && (fixed & 1))) fixed++;
+        uint64_t whole = fixed / POW10[decimals];
+        uint32_t fraction = (uint32_t)(fixed % POW10[decimals]);
+        integer(negative && fixed != 0, whole);
+        if (decimals > 0) {
+            char digits[8];
+            digits[0] = '.';
+            for (int i = decimals; i >= 1; i--) {
+                digits[i] = (char)('0' + fraction % 10);
+                fraction /= 10;
+            }
+            put(digits, (size_t)decimals + 1);
+        }
+    }
+
+    // Pre-encoded JSON (e.g. a node built by another writer)
+    void raw(const char* json, size_t length) {
+        element();
+        put(json, length);
+    }
+
+private:
+    void open(char c) {
+        element();
+        put(&c, 1);
+        if (depth < JSON_MAX_DEPTH) {
+            needsComma &= (uint16_t)~(1u << depth);
+            depth++;
+        } else {
+            overflow = true;
+        }
+    }
+
+    void close(char c) {
+        if (depth > 0) depth--;
+        put(&c, 1);
+        needsComma |= (uint16_t)(1u << depth);
+        afterKey = false;
+    }
+
+    // Comma before a key or array element, unless first in its container
+    void separator() {
+        if (depth > 0 && (needsComma & (1u << (depth - 1)))) put(",", 1);
+        if (depth > 0) needsComma |= (uint16_t)(1u << (depth - 1));
+    }
+
+    void element() {
+        if (afterKey) {
+            afterKey = false;
+        } else {
+            separator();
+        }
+    }
+
+    void integer(bool negative, uint64_t v) {
+        char digits[21];
+        int n = 0;
+        do {
+            digits[sizeof(digits) - 1 - n++] = (char)('0' + v % 10);
+            v /= 10;
+        } while (v > 0);
+        if (negative) digits[sizeof(digits) - 1 - n++] = '-';
+        put(digits + sizeof(digits) - n, (size_t)n);
+    }
+
+    void string(const char* text) {
+        put("\"", 1);
+        const char* run = text;
+        for (const char* p = text; *p; p++) {
+            unsigned char c = (unsigned char)*p;
+            if (c != '"' && c != '\\' && c >= 0x20) continue;
+            put(run, (size_t)(p - run));
+            char escaped[7] = { '\\', 0, 0, 0, 0, 0, 0 };
+            size_t length = 2;
+            if (c == '"' || c == '\\') escaped[1] = (char)c;
+            else if (c == '\n') escaped[1] = 'n';
+            else if (c == '\r') escaped[1] = 'r';
+            else if (c == '\t') escaped[1] = 't';
+            else {
+                static const char hexDigits[] = "0123456789abcdef";
+                memcpy(escaped + 1, "u00", 3);
+                escaped[4] = hexDigits[c >> 4];
+                escaped[5] = hexDigits[c & 0xF];
+                length = 6;
+            }
+            put(escaped, length);
+            run = p + 1;
+        }
+        put(run, strlen(run));
+        put("\"", 1);
+    }
+
+    void put(const char* data, size_t length) {
+        if (overflow) return;
+        if (position + length >= capacity) {
+            overflow = true;
+            buffer[0] = '\0';
+            return;
+        }
+        memcpy(buffer + position, data, length);
+        position += length;
+        buffer[position] = '\0';
+    }
+};
+
+// ==================== FIREBASE NODE SCHEMAS ====================
+// /devices/{id}/status
+enum JsonStatusField {
+    JSON_STATUS_ONLINE = 0,
+    JSON_STATUS_LAST_SEEN,
+    JSON_STATUS_FIELD_COUNT
+};
+
+static const JsonField JSON_STATUS_SCHEMA[] = {
+    JSON_FIELD("online"),
+    JSON_FIELD("last_seen"),
+};
+static_assert(JSON_SCHEMA_SIZE(JSON_STATUS_SCHEMA) == JSON_STATUS_FIELD_COUNT, "status schema");
+
+// lastSeenMs / lastBootMs: Unix epoch ms (0 = clock not synced yet)
+inline void json_write_status(JsonStreamWriter& w, bool online, uint64_t lastSeenMs) {
+    w.beginObject();
+    w.field(JSON_STATUS_SCHEMA[JSON_STATUS_ONLINE]);    w.value(online);
+    w.field(JSON_STATUS_SCHEMA[JSON_STATUS_LAST_SEEN]); w.value(lastSeenMs);
+    w.endObject();
+}
+
+// /devices/{id}/info
+struct DeviceInfo {
+    const char* deviceId;
+    const char* firmwareVersion;
+    const char* modelType;
+    const char* chipModel;
+    uint32_t chipCores;
+    uint32_t cpuFreqMHz;
+    float flashSizeMB;
+    const char* macAddress;
+    uint64_t lastBootMs;
+};
+
+enum JsonInfoField {
+    JSON_INFO_DEVICE_ID = 0,
+    JSON_INFO_FIRMWARE_VERSION,
+    JSON_INFO_MODEL_TYPE,
+    JSON_INFO_CHIP_MODEL,
+    JSON_INFO_CHIP_CORES,
+    JSON_INFO_CPU_FREQ_MHZ,
+    JSON_INFO_FLASH_SIZE_MB,
+    JSON_INFO_MAC_ADDRESS,
+    JSON_INFO_LAST_BOOT,
+    JSON_INFO_FIELD_COUNT
+};
+
+static const JsonField JSON_INFO_SCHEMA[] = {
+    JSON_FIELD("device_id"),
+    JSON_FIELD("firmware_version"),
+    JSON_FIELD("model_type"),
+    JSON_FIELD("chip_model"),
+    JSON_FIELD("chip_cores"),
+    JSON_FIELD("cpu_freq_mhz"),
+    JSON_FIELD("flash_size_mb"),
+    JSON_FIELD("mac_address"),
+    JSON_FIELD("last_boot"),
+};
+static_assert(JSON_SCHEMA_SIZE(JSON_INFO_SCHEMA) == JSON_INFO_FIELD_COUNT, "info schema");
+
+inline void json_write_info(JsonStreamWriter& w, const DeviceInfo& info) {
+    w.beginObject();
+    w.field(JSON_INFO_SCHEMA[JSON_INFO_DEVICE_ID]);        w.value(info.deviceId);
+    w.field(JSON_INFO_SCHEMA[JSON_INFO_FIRMWARE_VERSION]); w.value(info.firmwareVersion);
+    w.field(JSON_INFO_SCHEMA[JSON_INFO_MODEL_TYPE]);       w.value(info.modelType);
+    w.field(JSON_INFO_SCHEMA[JSON_INFO_CHIP_MODEL]);       w.value(info.chipModel);
+    w.field(JSON_INFO_SCHEMA[JSON_INFO_CHIP_CORES]);       w.value(info.chipCores);
+    w.field(JSON_INFO_SCHEMA[JSON_INFO_CPU_FREQ_MHZ]);     w.value(info.cpuFreqMHz);
+    w.field(JSON_INFO_SCHEMA[JSON_INFO_FLASH_SIZE_MB]);    w.value(info.flashSizeMB, 2);
+    w.field(JSON_INFO_SCHEMA[JSON_INFO_MAC_ADDRESS]);      w.value(info.macAddress);
+    w.field(JSON_INFO_SCHEMA[JSON_INFO_LAST_BOOT]);        w.value(info.lastBootMs);
+    w.endObject();
+}
+
+// 32-bit FNV-1a
+inline uint32_t json_fnv1a(const char* data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (uint8_t)data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Content hash of the info node, last_boot excluded (it changes every boot
+// and is written on its own). `scratch` holds the encoded node; 0 = overflow.
+inline uint32_t json_info_hash(const DeviceInfo& info, char* scratch, size_t size) {
+    DeviceInfo content = info;
+    content.lastBootMs = 0;
+    JsonStreamWriter w(scratch, size);
+    json_write_info(w, content);
+    return w.ok() ? json_fnv1a(scratch, (size_t)w.length()) : 0;
+}
+
+#endif // JSON_STREAM_WRITER_H
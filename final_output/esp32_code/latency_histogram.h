@@ -0,0 +1,119 @@
+/*
+ * Latency Histogram - Fixed-bucket log-linear histogram (µs)
+ *
+ * Features:
+ * - 4 sub-buckets per power of two (≤ 25% bucket width), 1 µs to ~536 s
+ * - Constant memory (112 × u32), O(1) record, no heap
+ * - p50/p95/p99 (any percentile), min/max/mean
+ * - No Arduino dependencies (host tools reuse it)
+ *
+ * Bucket layout:
+ *   values 0..7          → exact buckets 0..7
+ *   value v ≥ 8, e = ⌊log2 v⌋, s = next 2 bits below the MSB
+ *                        → bucket (e - 1) * 4 + s
+ */
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define LATENCY_HISTOGRAM_BUCKETS 112      // Covers up to 2^29 µs (~536 s, saturates beyond)
+
+class LatencyHistogram {
+private:
+    uint32_t buckets[LATENCY_HISTOGRAM_BUCKETS];
+    uint32_t total;
+    uint64_t sum;
+    uint32_t minValue;
+    uint32_t maxValue;
+
+public:
+    LatencyHistogram() { reset(); }
+
+    void reset() {
+        memset(buckets, 0, sizeof(buckets));
+        total = 0;
+        sum = 0;
+        minValue = UINT32_MAX;
+        maxValue = 0;
+    }
+
+    void record(uint32_t us) {
+        buckets[bucketFor(us)]++;
+        total++;
+        sum += us;
+        if (us < minValue) minValue = us;
+        if (us > maxValue) maxValue = us;
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (int i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) buckets[i] += other.buckets[i];
+        total += other.total;
+        sum += other.sum;
+        if (other.minValue < minValue) minValue = other.minValue;
+        if (other.maxValue > maxValue) maxValue = other.maxValue;
+    }
+
+    uint32_t count() const { return total; }
+    uint32_t min() const { return total ? minValue : 0; }
+    uint32_t max() const { return maxValue; }
+    uint32_t mean() const { return total ? (uint32_t)(sum / total) : 0; }
+
+    // Value at percentile p (0-100), reported as the bucket midpoint and
+    // clamped to the observed min/max
+    uint32_t percentile(float p) const {
+        if (total == 0) return 0;
+        uint32_t rank = (uint32_t)(p / 100.0f * total + 0.5f);
+        if (rank < 1) rank = 1;
+        if (rank > total) rank = total;
+
+        uint32_t seen = 0;
+        for (int i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                uint32_t value = (bucketLow(i) + bucketHigh(i)) / 2;
+                if (value < minValue) value = minValue;
+                if (value > maxValue) value = maxValue;
+                return value;
+            }
+        }
+        return maxValue;
+    }
+
+    uint32_t bucketCount(int index) const { return buckets[index]; }
+
+    // ==================== BUCKET MATH ====================
+    static int bucketFor(uint32_t us) {
+        if (us < 8) return (int)us;
+        int e = 31 - __builtin_clz(us);
+        int s = (int)((us >> (e - 2)) & 0x3);
+        int index = (e - 1) * 4 + s;
+        return index < LATENCY_HISTOGRAM_BUCKETS ? index : LATENCY_HISTOGRAM_BUCKETS - 1;
+    }
+
+    static uint32_t bucketLow(int index) {
+        if (index < 8) return (uint32_t)index;
+        int e = index / 4 + 1;
+        int s = index % 4;
+        return (1UL << e) + ((uint32_t)s << (e - 2));
+    }
+
+    static uint32_t bucketHigh(int index) {
+        if (index < 8) return (uint32_t)index;
+        int e = index / 4 + 1;
+        return bucketLow(index) + (1UL << (e - 2)) - 1;
+    }
+};
+
+// "12.3ms" / "850us" / "1.20s" for compact serial tables
+inline const char* latency_format_us(uint32_t us, char* out, size_t size) {
+    if (us >= 1000000UL) snprintf(out, size, "%.2fs", us / 1000000.0f);
+    else if (us >= 1000UL) snprintf(out, size, "%.1fms", us / 1000.0f);
+    else snprintf(out, size, "%luus", (unsigned long)us);
+    return out;
+}
+
+#endif // LATENCY_HISTOGRAM_H
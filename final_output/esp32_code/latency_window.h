@@ -0,0 +1,227 @@
+/*
+ * Latency Window - Rolling latency histograms per reporting window
+ *
+ * ThingSpeak field 7 and the reading's inference_time only show the one
+ * prediction that was uploaded. This keeps the whole distribution of each
+ * reporting window for three metrics:
+ * - inference: predict() µs of every record
+ * - loop:      loop() iterations that ran a task (sleep excluded)
+ * - upload:    every network operation of every sink (NET_PHASE_TOTAL,
+ *              failed attempts included)
+ *
+ * Features:
+ * - One LatencyHistogram (log-linear, latency_histogram.h) per metric for
+ *   the open window; windows are aligned to the monotonic clock
+ *   (window k = [k × windowMs, (k + 1) × windowMs))
+ * - Closing a window reduces it to a compact summary (n, p50, p90, p99,
+ *   max) that telemetry ships: ~220 bytes of JSON or ~90 characters of
+ *   ThingSpeak status text for all three metrics
+ * - Thread-safe by ownership: each metric is recorded and closed by one
+ *   core only; the closed summary is handed over under a PortLock
+ * - Fixed memory (~1.5 KB), no heap
+ * - No Arduino dependencies (task_port.h provides the lock)
+ *
+ * Usage:
+ *   LatencyWindow window;
+ *   window.record(LATENCY_METRIC_LOOP, busyUs, millis());   // Owner core
+ *   window.advance(LATENCY_METRIC_UPLOAD, millis());        // Owner core, periodically
+ *   LatencyWindowReport report;
+ *   if (window.takeReport(millis(), report)) { ... }         // Reporting core
+ */
+
+#ifndef LATENCY_WINDOW_H
+#define LATENCY_WINDOW_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "latency_histogram.h"
+#include "json_stream_writer.h"
+#include "task_port.h"
+
+#define LATENCY_WINDOW_MS 300000        // Reporting window (5 minutes)
+#define LATENCY_WINDOW_GRACE_MS 1000    // Owners get this long to close the previous window
+#define LATENCY_STATUS_SIZE 192         // ThingSpeak status text
+#define LATENCY_JSON_SIZE 384           // JSON summary, every value at 10 digits (~325 bytes)
+
+enum LatencyMetric {
+    LATENCY_METRIC_INFERENCE = 0,
+    LATENCY_METRIC_LOOP,
+    LATENCY_METRIC_UPLOAD,
+    LATENCY_METRIC_COUNT
+};
+
+static const char* const LATENCY_METRIC_NAMES[LATENCY_METRIC_COUNT] = { "inference", "loop", "upload" };
+static const char* const LATENCY_METRIC_SHORT[LATENCY_METRIC_COUNT] = { "inf", "loop", "up" };
+
+// µs; all zero for a metric with no samples in the window
+struct LatencySummary {
+    uint32_t count;
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p99;
+    uint32_t max;
+};
+
+struct LatencyWindowReport {
+    uint32_t startMs;                               // Monotonic (millis) window start
+    uint32_t startS;                                // Epoch seconds (0 = clock not synced; set by the caller)
+    uint32_t lengthMs;
+    LatencySummary metrics[LATENCY_METRIC_COUNT];
+};
+
+class LatencyWindow {
+private:
+    struct Slot {
+        LatencyHistogram open;      // Owner core only
+        uint32_t openIndex;         // Window the open histogram belongs to
+        LatencySummary closed;      // Guarded by lock
+        uint32_t closedIndex;
+        bool hasClosed;
+    };
+
+    Slot slots[LATENCY_METRIC_COUNT];
+    uint32_t windowMs;
+    uint32_t reportedIndex;         // Reporting core only
+    bool reported;
+    PortLock lock;
+
+public:
+    explicit LatencyWindow(uint32_t lengthMs = LATENCY_WINDOW_MS)
+        : windowMs(lengthMs ? lengthMs : LATENCY_WINDOW_MS), reportedIndex(0), reported(false) {
+        for (int m = 0; m < LATENCY_METRIC_COUNT; m++) {
+            slots[m].openIndex = 0;
+            memset(&slots[m].closed, 0, sizeof(LatencySummary));
+            slots[m].closedIndex = 0;
+            slots[m].hasClosed = false;
+        }
+    }
+
+    uint32_t getWindowMs() const { return windowMs; }
+
+    // Owner core of `metric` only
+    void record(LatencyMetric metric, uint32_t us, uint32_t nowMs) {
+        advance(metric, nowMs);
+        slots[metric].open.record(us);
+    }
+
+    // Owner core of `metric` only: closes the open window once nowMs has
+    // left it (call at least once per grace period, even with no samples)
+    void advance(LatencyMetric metric, uint32_t nowMs) {
+        Slot& s = slots[metric];
+        uint32_t index = nowMs / windowMs;
+        if (index == s.openIndex) return;
+
+        LatencySummary summary;
+        summarize(s.open, summary);
+        lock.lock();
+        s.closed = summary;
+        s.closedIndex = s.openIndex;
+        s.hasClosed = true;
+        lock.unlock();
+        s.open.reset();
+        s.openIndex = index;
+    }
+
+    // Reporting core: the window before the current one, once per window
+    // and only after the grace period. A metric whose owner closed an
+    // older window (no samples, owner not running) reports zeros.
+    bool takeReport(uint32_t nowMs, LatencyWindowReport& report) {
+        uint32_t current = nowMs / windowMs;
+        if (current == 0 || nowMs - current * windowMs < LATENCY_WINDOW_GRACE_MS) return false;
+        uint32_t index = current - 1;
+        if (reported && reportedIndex == index) return false;
+
+        report.startMs = index * windowMs;
+        report.startS = 0;
+        report.lengthMs = windowMs;
+        lock.lock();
+        for (int m = 0; m < LATENCY_METRIC_COUNT; m++) {
+            const Slot& s = slots[m];
+            if (s.hasClosed && s.closedIndex == index) {
+                report.metrics[m] = s.closed;
+            } else {
+                memset(&report.metrics[m], 0, sizeof(LatencySummary));
+            }
+        }
+        lock.unlock();
+        reportedIndex = index;
+        reported = true;
+        return true;
+    }
+
+    // Owner core of `metric` only: the window still filling up
+    const LatencyHistogram& open(LatencyMetric metric) const { return slots[metric].open; }
+
+    static void summarize(const LatencyHistogram& h, LatencySummary& out) {
+        out.count = h.count();
+        out.p50 = h.percentile(50);
+        out.p90 = h.percentile(90);
+        out.p99 = h.percentile(99);
+        out.max = h.max();
+    }
+};
+
+// ==================== ENCODERS ====================
+// {"start":1767225600,"window_s":300,"inference":{"n":20,"p50":1120,"p90":1180,"p99":1400,"max":1500},
+//  "loop":{...},"upload":{...}}  (µs; start in epoch seconds, 0 = clock not synced)
+enum JsonLatencyField {
+    JSON_LATENCY_START = 0,
+    JSON_LATENCY_WINDOW_S,
+    JSON_LATENCY_N,
+    JSON_LATENCY_P50,
+    JSON_LATENCY_P90,
+    JSON_LATENCY_P99,
+    JSON_LATENCY_MAX,
+    JSON_LATENCY_FIELD_COUNT
+};
+
+static const JsonField JSON_LATENCY_SCHEMA[] = {
+    JSON_FIELD("start"),
+    JSON_FIELD("window_s"),
+    JSON_FIELD("n"),
+    JSON_FIELD("p50"),
+    JSON_FIELD("p90"),
+    JSON_FIELD("p99"),
+    JSON_FIELD("max"),
+};
+static_assert(JSON_SCHEMA_SIZE(JSON_LATENCY_SCHEMA) == JSON_LATENCY_FIELD_COUNT, "latency schema");
+
+inline void json_write_latency_window(JsonStreamWriter& w, const LatencyWindowReport& r) {
+    const JsonField* f = JSON_LATENCY_SCHEMA;
+    w.beginObject();
+    w.field(f[JSON_LATENCY_START]);    w.value(r.startS);
+    w.field(f[JSON_LATENCY_WINDOW_S]); w.value(r.lengthMs / 1000);
+    for (int m = 0; m < LATENCY_METRIC_COUNT; m++) {
+        const LatencySummary& s = r.metrics[m];
+        w.key(LATENCY_METRIC_NAMES[m]);
+        w.beginObject();
+        w.field(f[JSON_LATENCY_N]);   w.value(s.count);
+        w.field(f[JSON_LATENCY_P50]); w.value(s.p50);
+        w.field(f[JSON_LATENCY_P90]); w.value(s.p90);
+        w.field(f[JSON_LATENCY_P99]); w.value(s.p99);
+        w.field(f[JSON_LATENCY_MAX]); w.value(s.max);
+        w.endObject();
+    }
+    w.endObject();
+}
+
+// ThingSpeak status text, query-safe without escaping:
+//   w:300;inf:20,1120,1180,1400,1500;loop:..;up:..   (n,p50,p90,p99,max µs)
+// Returns the length, or -1 if the buffer was too small
+inline int latency_encode_status(const LatencyWindowReport& r, char* out, size_t size) {
+    int written = snprintf(out, size, "w:%lu", (unsigned long)(r.lengthMs / 1000));
+    if (written < 0 || (size_t)written >= size) return -1;
+    size_t used = (size_t)written;
+    for (int m = 0; m < LATENCY_METRIC_COUNT; m++) {
+        const LatencySummary& s = r.metrics[m];
+        written = snprintf(out + used, size - used, ";%s:%lu,%lu,%lu,%lu,%lu", LATENCY_METRIC_SHORT[m],
+                           (unsigned long)s.count, (unsigned long)s.p50, (unsigned long)s.p90,
+                           (unsigned long)s.p99, (unsigned long)s.max);
+        if (written < 0 || (size_t)written >= size - used) return -1;
+        used += (size_t)written;
+    }
+    return (int)used;
+}
+
+#endif // LATENCY_WINDOW_H
@@ -0,0 +1,75 @@
+/*
+ * Log Messages - Format table for deferred_log.h
+ *
+ * Every deferred log line is one row here: id, level, printf format. The
+ * device only sends the id and the arguments; the format strings are
+ * needed where the text is produced (host_tools/log_decoder.cpp, or the
+ * drain task when LOG_OUTPUT_BINARY is false).
+ *
+ * Rules:
+ * - Append new rows at the end: ids are positions, and the decoder must
+ *   be built from the same table as the firmware it reads
+ * - Conversions: %d %i %u %x %X (any length modifier), %f %e %g, %s, %%;
+ *   widths and precisions are fine. The arguments must match in count
+ *   and kind (integer, float, string), which the decoder checks.
+ * - Strings are copied (at most LOG_MAX_STRING bytes), so %s can take
+ *   names from tables as well as text from a response buffer
+ */
+
+#ifndef LOG_MESSAGES_H
+#define LOG_MESSAGES_H
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+// X(id, level, format)
+#define LOG_MESSAGES(X)                                                                                          \
+    X(LOG_MSG_DROPPED, LOG_LEVEL_WARN, "log: %lu records dropped (ring full)")                                   \
+    X(LOG_MSG_PATTERN, LOG_LEVEL_INFO, "sim: weather pattern -> %s (sustained for 30 s)")                        \
+    X(LOG_MSG_READING, LOG_LEVEL_DEBUG,                                                                          \
+      "sim: reading #%lu  T %.1f C | H %.1f %% | P %.0f Pa | L %.0f lux | G %.0f ppm")                          \
+    X(LOG_MSG_AVERAGE, LOG_LEVEL_INFO,                                                                           \
+      "predict: avg T %.2f C | H %.2f %% | P %.2f Pa | L %.2f lux (%s) | G %.2f ppm (%s)")                      \
+    X(LOG_MSG_PREDICTION, LOG_LEVEL_INFO, "predict: #%lu %s (class %d) in %lu us")                               \
+    X(LOG_MSG_PIPELINE_FULL, LOG_LEVEL_WARN, "predict: pipeline full, oldest queued record dropped")             \
+    X(LOG_MSG_RBE_SUPPRESSED, LOG_LEVEL_INFO, "telemetry: record within deadband (cloud upload suppressed)")     \
+    X(LOG_MSG_SINK_RESULT, LOG_LEVEL_INFO, "telemetry: %s %s")                                                   \
+    X(LOG_MSG_SINK_WAITING, LOG_LEVEL_DEBUG, "telemetry: %s %s")                                                 \
+    X(LOG_MSG_TS_NO_WIFI, LOG_LEVEL_WARN, "thingspeak: WiFi not connected, upload skipped")                      \
+    X(LOG_MSG_TS_OPEN, LOG_LEVEL_WARN, "thingspeak: circuit open, next probe in %lu s")                          \
+    X(LOG_MSG_TS_UPLOAD, LOG_LEVEL_DEBUG, "thingspeak: uploading%s")                                             \
+    X(LOG_MSG_TS_DNS_FAILED, LOG_LEVEL_ERROR, "thingspeak: DNS resolution failed")                               \
+    X(LOG_MSG_TS_CONNECT_FAILED, LOG_LEVEL_ERROR, "thingspeak: TCP connect to port 80 failed")                   \
+    X(LOG_MSG_TS_SEND_FAILED, LOG_LEVEL_ERROR, "thingspeak: request not sent")                                   \
+    X(LOG_MSG_TS_NO_RESPONSE, LOG_LEVEL_ERROR, "thingspeak: no response from server")                            \
+    X(LOG_MSG_TS_MALFORMED, LOG_LEVEL_ERROR, "thingspeak: malformed HTTP response")                              \
+    X(LOG_MSG_TS_OK, LOG_LEVEL_INFO, "thingspeak: uploaded, entry %s")                                           \
+    X(LOG_MSG_TS_HTTP, LOG_LEVEL_WARN, "thingspeak: unexpected HTTP %d")                                         \
+    X(LOG_MSG_FB_QUEUED, LOG_LEVEL_DEBUG, "firebase: reading #%lu queued (%s, key %llu), batch %u/%u")          \
+    X(LOG_MSG_FB_NOT_READY, LOG_LEVEL_ERROR, "firebase: not ready, flush skipped")                               \
+    X(LOG_MSG_FB_FLUSH, LOG_LEVEL_INFO,                                                                          \
+      "firebase: PATCH%s %u readings, %d rollups, %u B in %lu ms -> %s %d")                                     \
+    X(LOG_MSG_FB_BOOT, LOG_LEVEL_INFO, "firebase: boot %s")                                                      \
+    X(LOG_MSG_FB_ROLLUP_DROPPED, LOG_LEVEL_WARN,                                                                 \
+      "firebase: rollup evicted before upload (%lu nodes, %lu records lost since boot)")
+
+#define LOG_MESSAGE_ID(id, level, format) id,
+enum LogMessageId { LOG_MESSAGES(LOG_MESSAGE_ID) LOG_MESSAGE_COUNT };
+#undef LOG_MESSAGE_ID
+
+#define LOG_MESSAGE_LEVEL(id, level, format) level,
+static constexpr unsigned char LOG_MESSAGE_LEVELS[] = { LOG_MESSAGES(LOG_MESSAGE_LEVEL) };
+#undef LOG_MESSAGE_LEVEL
+
+#define LOG_MESSAGE_FORMAT(id, level, format) format,
+static const char* const LOG_MESSAGE_FORMATS[] = { LOG_MESSAGES(LOG_MESSAGE_FORMAT) };
+#undef LOG_MESSAGE_FORMAT
+
+static const char* const LOG_LEVEL_NAMES[] = { "-", "E", "W", "I", "D" };
+
+constexpr unsigned char log_message_level(LogMessageId id) { return LOG_MESSAGE_LEVELS[id]; }
+
+#endif // LOG_MESSAGES_H
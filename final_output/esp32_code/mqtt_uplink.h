@@ -0,0 +1,506 @@
+/*
+ * MQTT Uplink - Persistent-session MQTT 3.1.1 publisher
+ *
+ * Alternative to one HTTP request per reading: a single long-lived TCP
+ * connection carries small PUBLISH packets.
+ *
+ * Features:
+ * - Persistent session (clean session = 0), automatic reconnect
+ * - QoS 0 and QoS 1 publishes
+ * - Publish batching: packets are coalesced in a TX buffer and written
+ *   together after MQTT_LINGER_MS or when the buffer fills
+ * - QoS 1 in-flight window (MQTT_INFLIGHT_WINDOW unacknowledged packets),
+ *   retransmitted with DUP after MQTT_RETRY_MS and after every reconnect
+ * - Keep-alive PINGREQ, PUBACK latency statistics
+ * - No Arduino dependencies: network and clock are injected, so host tools
+ *   run the exact same code against a local broker stand-in
+ *
+ * Usage:
+ *   MqttUplink mqtt(&transport, millisFn);
+ *   mqtt.configure("broker.local", 1883, "weather-ABC123");
+ *   mqtt.publish("weather/ABC123/reading", payload, length, 1);
+ *   mqtt.loop();   // call often: flushes, reads PUBACKs, retries, pings
+ */
+
+#ifndef MQTT_UPLINK_H
+#define MQTT_UPLINK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// ==================== CONFIGURATION ====================
+#define MQTT_KEEPALIVE_S 60
+#define MQTT_LINGER_MS 0                 // Batch window (0 = write on every publish)
+#define MQTT_TX_BUFFER_SIZE 2048         // Coalesced packets waiting to be written
+#define MQTT_RX_BUFFER_SIZE 64           // Only CONNACK/PUBACK/PINGRESP are expected
+#define MQTT_MAX_PACKET_SIZE 512         // Largest single PUBLISH (topic + payload)
+#define MQTT_INFLIGHT_WINDOW 8           // Unacknowledged QoS 1 packets
+#define MQTT_RETRY_MS 5000               // Retransmit unacknowledged QoS 1 after this
+#define MQTT_CONNECT_TIMEOUT_MS 5000
+#define MQTT_RECONNECT_MS 5000           // Minimum time between connect attempts
+
+// Packet types (upper nibble of the fixed header)
+#define MQTT_CONNECT     0x10
+#define MQTT_CONNACK     0x20
+#define MQTT_PUBLISH     0x30
+#define MQTT_PUBACK      0x40
+#define MQTT_PINGREQ     0xC0
+#define MQTT_PINGRESP    0xD0
+#define MQTT_DISCONNECT  0xE0
+#define MQTT_FLAG_DUP    0x08
+
+// ==================== TRANSPORT ====================
+// Byte stream to the broker (WiFiClient on the ESP32, a socket on the host)
+class MqttTransport {
+public:
+    virtual ~MqttTransport() {}
+    virtual bool open(const char* host, uint16_t port) = 0;
+    virtual bool isOpen() = 0;
+    // Returns bytes written (less than length = failure)
+    virtual size_t write(const uint8_t* data, size_t length) = 0;
+    // Returns bytes read, 0 if nothing is pending, -1 if the connection closed
+    virtual int read(uint8_t* data, size_t length) = 0;
+    virtual void close() = 0;
+};
+
+typedef uint32_t (*MqttClockFn)();
+
+struct MqttStats {
+    uint32_t connects;
+    uint32_t published;        // PUBLISH packets queued (QoS 0 + 1)
+    uint32_t acked;            // PUBACKs received
+    uint32_t retransmits;      // DUP resends
+    uint32_t rejected;         // Publishes refused (window full / too large)
+    uint32_t writes;           // Transport writes (batches)
+    uint32_t bytesSent;
+    uint32_t bytesReceived;
+    uint32_t ackLatencyTotalMs;
+    uint32_t ackLatencyMaxMs;
+};
+
+// ==================== UPLINK ====================
+class MqttUplink {
+private:
+    struct InflightSlot {
+        bool used;
+        uint16_t packetId;
+        uint32_t queuedMs;       // First queued (latency reference)
+        uint32_t sentMs;         // Last (re)transmission
+        uint16_t length;
+        uint8_t packet[MQTT_MAX_PACKET_SIZE];
+    };
+
+    MqttTransport* transport;
+    MqttClockFn clock;
+
+    const char* host;
+    uint16_t port;
+    const char* clientId;
+    const char* username;
+    const char* password;
+    uint16_t lingerMs;
+
+    bool sessionUp;
+    bool sessionPresent;
+    bool connectAttempted;
+    uint32_t lastConnectAttemptMs;
+    uint32_t lastTxMs;
+    uint32_t batchStartMs;
+    uint16_t nextPacketId;
+
+    uint8_t txBuffer[MQTT_TX_BUFFER_SIZE];
+    size_t txLength;
+    uint8_t rxBuffer[MQTT_RX_BUFFER_SIZE];
+    size_t rxLength;
+
+    InflightSlot inflight[MQTT_INFLIGHT_WINDOW];
+    int inflightCount;
+
+    MqttStats stats;
+
+public:
+    MqttUplink(MqttTransport* net, MqttClockFn clockFn)
+        : transport(net), clock(clockFn), host(""), port(1883), clientId(""),
+          username(nullptr), password(nullptr), lingerMs(MQTT_LINGER_MS),
+          sessionUp(false), sessionPresent(false), connectAttempted(false), lastConnectAttemptMs(0),
+          lastTxMs(0), batchStartMs(0), nextPacketId(1), txLength(0), rxLength(0),
+          inflightCount(0) {
+        memset(inflight, 0, sizeof(inflight));
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    // Strings must stay valid for the lifetime of the uplink
+    void configure(const char* brokerHost, uint16_t brokerPort, const char* id,
+                   const char* user = nullptr, const char* pass = nullptr) {
+        host = brokerHost;
+        port = brokerPort;
+        clientId = id;
+        username = user;
+        password = pass;
+    }
+
+    void setLinger(uint16_t ms) { lingerMs = ms; }
+
+    // ==================== SESSION ====================
+    // Open TCP, send CONNECT and wait for CONNACK. Unacknowledged QoS 1
+    // packets from the previous connection are resent with DUP.
+    bool connect() {
+        uint32_t now = clock();
+        lastConnectAttemptMs = now;
+        connectAttempted = true;
+        sessionUp = false;
+        rxLength = 0;
+        transport->close();
+
+        if (!transport->open(host, port)) {
+            return false;
+        }
+
+        uint8_t packet[256];
+        size_t n = buildConnect(packet, sizeof(packet));
+        if (n == 0 || transport->write(packet, n) != n) {
+            transport->close();
+            return false;
+        }
+        stats.bytesSent += n;
+        stats.writes++;
+        lastTxMs = now;
+
+        while ((uint32_t)(clock() - now) < MQTT_CONNECT_TIMEOUT_MS) {
+            if (!receive()) break;
+            if (sessionUp) {
+                stats.connects++;
+                resendInflight();
+                return true;
+            }
+        }
+        transport->close();
+        return false;
+    }
+
+    void disconnect() {
+        if (sessionUp) {
+            flush();
+            const uint8_t packet[2] = { MQTT_DISCONNECT, 0 };
+            transport->write(packet, 2);
+            stats.bytesSent += 2;
+        }
+        transport->close();
+        sessionUp = false;
+    }
+
+    bool isConnected() { return sessionUp && transport->isOpen(); }
+    bool wasSessionPresent() const { return sessionPresent; }
+
+    // ==================== PUBLISH ====================
+    // Queue one PUBLISH. QoS 1 packets are kept until PUBACK; returns false
+    // if the in-flight window is full or the packet does not fit.
+    bool publish(const char* topic, const uint8_t* payload, size_t length, uint8_t qos = 1) {
+        if (qos > 1) qos = 1;
+        size_t topicLength = strlen(topic);
+        size_t remaining = 2 + topicLength + (qos ? 2 : 0) + length;
+        if (remaining + 5 > MQTT_MAX_PACKET_SIZE) {
+            stats.rejected++;
+            return false;
+        }
+
+        InflightSlot* slot = nullptr;
+        if (qos == 1) {
+            if (inflightCount >= MQTT_INFLIGHT_WINDOW) {
+                receive();   // Maybe acks are already waiting
+            }
+            slot = freeSlot();
+            if (slot == nullptr) {
+                stats.rejected++;
+                return false;
+            }
+        }
+
+        uint8_t packet[MQTT_MAX_PACKET_SIZE];
+        size_t n = 0;
+        packet[n++] = MQTT_PUBLISH | (uint8_t)(qos << 1);
+        n += putRemainingLength(packet + n, remaining);
+        n += putString(packet + n, topic, topicLength);
+        uint16_t packetId = 0;
+        if (qos == 1) {
+            packetId = allocatePacketId();
+            packet[n++] = (uint8_t)(packetId >> 8);
+            packet[n++] = (uint8_t)packetId;
+        }
+        memcpy(packet + n, payload, length);
+        n += length;
+
+        uint32_t now = clock();
+        if (slot != nullptr) {
+            slot->used = true;
+            slot->packetId = packetId;
+            slot->queuedMs = now;
+            slot->sentMs = now;
+            slot->length = (uint16_t)n;
+            memcpy(slot->packet, packet, n);
+            inflightCount++;
+        }
+        stats.published++;
+
+        if (!sessionUp) {
+            return slot != nullptr;   // QoS 1 goes out after reconnect, QoS 0 is dropped
+        }
+        if (!enqueue(packet, n, now)) {
+            return slot != nullptr;
+        }
+        if (lingerMs == 0) {
+            flush();
+        }
+        return true;
+    }
+
+    bool publish(const char* topic, const char* text, uint8_t qos = 1) {
+        return publish(topic, (const uint8_t*)text, strlen(text), qos);
+    }
+
+    // Write all coalesced packets in one transport call
+    bool flush() {
+        if (txLength == 0) return true;
+        if (!sessionUp) {
+            txLength = 0;
+            return false;
+        }
+        size_t written = transport->write(txBuffer, txLength);
+        stats.writes++;
+        stats.bytesSent += written;
+        lastTxMs = clock();
+        bool ok = written == txLength;
+        txLength = 0;
+        if (!ok) {
+            dropConnection();
+        }
+        return ok;
+    }
+
+    // ==================== SERVICE ====================
+    // Call from loop(): reconnect, flush the batch, read acks, retransmit, ping
+    void loop() {
+        uint32_t now = clock();
+
+        if (!sessionUp || !transport->isOpen()) {
+            sessionUp = false;
+            if (!connectAttempted || (uint32_t)(now - lastConnectAttemptMs) >= MQTT_RECONNECT_MS) {
+                connect();
+            }
+            return;
+        }
+
+        if (txLength > 0 && (uint32_t)(now - batchStartMs) >= lingerMs) {
+            flush();
+        }
+
+        receive();
+        if (!sessionUp) return;
+
+        bool urgent = false;
+        for (int i = 0; i < MQTT_INFLIGHT_WINDOW; i++) {
+            InflightSlot& s = inflight[i];
+            if (s.used && (uint32_t)(now - s.sentMs) >= MQTT_RETRY_MS) {
+                retransmit(s, now);
+                urgent = true;
+            }
+        }
+
+        if (txLength == 0 && (uint32_t)(now - lastTxMs) >= MQTT_KEEPALIVE_S * 1000UL / 2) {
+            const uint8_t ping[2] = { MQTT_PINGREQ, 0 };
+            enqueue(ping, 2, now);
+            urgent = true;
+        }
+
+        if (urgent) {
+            flush();
+        }
+    }
+
+    // Block (servicing the session) until all QoS 1 packets are acknowledged
+    bool waitForAcks(uint32_t timeoutMs) {
+        uint32_t start = clock();
+        flush();
+        while (inflightCount > 0 && (uint32_t)(clock() - start) < timeoutMs) {
+            loop();
+        }
+        return inflightCount == 0;
+    }
+
+    int getInflightCount() const { return inflightCount; }
+    int getWindowSize() const { return MQTT_INFLIGHT_WINDOW; }
+    const MqttStats& getStats() const { return stats; }
+    void resetStats() { memset(&stats, 0, sizeof(stats)); }
+
+private:
+    // ==================== ENCODING ====================
+    static size_t putRemainingLength(uint8_t* out, size_t length) {
+        size_t n = 0;
+        do {
+            uint8_t digit = length % 128;
+            length /= 128;
+            if (length > 0) digit |= 0x80;
+            out[n++] = digit;
+        } while (length > 0);
+        return n;
+    }
+
+    static size_t putString(uint8_t* out, const char* text, size_t length) {
+        out[0] = (uint8_t)(length >> 8);
+        out[1] = (uint8_t)length;
+        memcpy(out + 2, text, length);
+        return 2 + length;
+    }
+
+    size_t buildConnect(uint8_t* out, size_t size) {
+        size_t idLength = strlen(clientId);
+        size_t userLength = username ? strlen(username) : 0;
+        size_t passLength = password ? strlen(password) : 0;
+        size_t remaining = 10 + 2 + idLength +
+                           (username ? 2 + userLength : 0) + (password ? 2 + passLength : 0);
+        if (remaining + 5 > size) return 0;
+
+        uint8_t flags = 0x00;              // Clean session = 0 → persistent session
+        if (username) flags |= 0x80;
+        if (password) flags |= 0x40;
+
+        size_t n = 0;
+        out[n++] = MQTT_CONNECT;
+        n += putRemainingLength(out + n, remaining);
+        n += putString(out + n, "MQTT", 4);
+        out[n++] = 4;                      // Protocol level 3.1.1
+        out[n++] = flags;
+        out[n++] = (uint8_t)(MQTT_KEEPALIVE_S >> 8);
+        out[n++] = (uint8_t)MQTT_KEEPALIVE_S;
+        n += putString(out + n, clientId, idLength);
+        if (username) n += putString(out + n, username, userLength);
+        if (password) n += putString(out + n, password, passLength);
+        return n;
+    }
+
+    uint16_t allocatePacketId() {
+        uint16_t id = nextPacketId++;
+        if (nextPacketId == 0) nextPacketId = 1;
+        return id;
+    }
+
+    InflightSlot* freeSlot() {
+        for (int i = 0; i < MQTT_INFLIGHT_WINDOW; i++) {
+            if (!inflight[i].used) return &inflight[i];
+        }
+        return nullptr;
+    }
+
+    // Append a packet to the TX batch (flushing first if it would overflow)
+    bool enqueue(const uint8_t* packet, size_t length, uint32_t now) {
+        if (txLength + length > sizeof(txBuffer) && !flush()) {
+            return false;
+        }
+        if (txLength == 0) batchStartMs = now;
+        memcpy(txBuffer + txLength, packet, length);
+        txLength += length;
+        return true;
+    }
+
+    void retransmit(InflightSlot& s, uint32_t now) {
+        s.packet[0] |= MQTT_FLAG_DUP;
+        s.sentMs = now;
+        stats.retransmits++;
+        enqueue(s.packet, s.length, now);
+    }
+
+    void resendInflight() {
+        uint32_t now = clock();
+        for (int i = 0; i < MQTT_INFLIGHT_WINDOW; i++) {
+            if (inflight[i].used) retransmit(inflight[i], now);
+        }
+        flush();
+    }
+
+    void dropConnection() {
+        transport->close();
+        sessionUp = false;
+        txLength = 0;
+        rxLength = 0;
+    }
+
+    // ==================== DECODING ====================
+    // Read pending bytes and handle every complete packet. Returns false if
+    // the connection dropped.
+    bool receive() {
+        for (;;) {
+            int n = transport->read(rxBuffer + rxLength, sizeof(rxBuffer) - rxLength);
+            if (n < 0) {
+                dropConnection();
+                return false;
+            }
+            if (n == 0) return true;
+            stats.bytesReceived += (uint32_t)n;
+            rxLength += (size_t)n;
+
+            size_t offset = 0;
+            while (offset < rxLength) {
+                size_t remaining = 0;
+                size_t headerLength = 1;
+                size_t multiplier = 1;
+                bool complete = false;
+                while (offset + headerLength < rxLength) {
+                    if (headerLength > 4) {
+                        dropConnection();   // Malformed remaining length
+                        return false;
+                    }
+                    uint8_t digit = rxBuffer[offset + headerLength++];
+                    remaining += (digit & 0x7F) * multiplier;
+                    multiplier *= 128;
+                    if ((digit & 0x80) == 0) { complete = true; break; }
+                }
+                if (!complete) break;
+                if (headerLength + remaining > sizeof(rxBuffer)) {
+                    dropConnection();   // Broker sent something we never subscribed to
+                    return false;
+                }
+                if (offset + headerLength + remaining > rxLength) break;
+                handlePacket(rxBuffer[offset], rxBuffer + offset + headerLength, remaining);
+                offset += headerLength + remaining;
+            }
+            memmove(rxBuffer, rxBuffer + offset, rxLength - offset);
+            rxLength -= offset;
+        }
+    }
+
+    void handlePacket(uint8_t type, const uint8_t* body, size_t length) {
+        switch (type & 0xF0) {
+            case MQTT_CONNACK:
+                if (length >= 2 && body[1] == 0) {
+                    sessionPresent = (body[0] & 0x01) != 0;
+                    sessionUp = true;
+                }
+                break;
+            case MQTT_PUBACK:
+                if (length >= 2) {
+                    acknowledge((uint16_t)((body[0] << 8) | body[1]));
+                }
+                break;
+            default:
+                break;   // PINGRESP and anything else: nothing to do
+        }
+    }
+
+    void acknowledge(uint16_t packetId) {
+        for (int i = 0; i < MQTT_INFLIGHT_WINDOW; i++) {
+            InflightSlot& s = inflight[i];
+            if (s.used && s.packetId == packetId) {
+                uint32_t latency = clock() - s.queuedMs;
+                stats.acked++;
+                stats.ackLatencyTotalMs += latency;
+                if (latency > stats.ackLatencyMaxMs) stats.ackLatencyMaxMs = latency;
+                s.used = false;
+                inflightCount--;
+                return;
+            }
+        }
+    }
+};
+
+#endif // MQTT_UPLINK_H
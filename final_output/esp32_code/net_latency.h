@@ -0,0 +1,159 @@
+/*
+ * Network Latency - Per-phase timing of cloud operations
+ *
+ * Every upload is split into phases and each phase feeds its own
+ * LatencyHistogram, so slow uploads can be blamed on the right layer.
+ *
+ * Phases:
+ *   DNS      hostname lookup
+ *   Connect  TCP (and TLS) handshake
+ *   Send     writing the request
+ *   Server   request sent → first response byte (server time + RTT)
+ *   Read     first byte → response complete
+ *   Total    whole operation (also recorded for failed attempts)
+ *
+ * Operations that run inside a library (no visibility into phases) only
+ * record Total.
+ *
+ * An optional listener sees every operation's total as it finishes (the
+ * telemetry dispatcher feeds its per-window upload histogram from it,
+ * latency_window.h).
+ *
+ * No Arduino dependencies: callers pass micros() readings.
+ */
+
+#ifndef NET_LATENCY_H
+#define NET_LATENCY_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "latency_histogram.h"
+
+enum NetPhase {
+    NET_PHASE_DNS = 0,
+    NET_PHASE_CONNECT,
+    NET_PHASE_SEND,
+    NET_PHASE_SERVER,
+    NET_PHASE_READ,
+    NET_PHASE_TOTAL,
+    NET_PHASE_COUNT
+};
+
+static const char* const NET_PHASE_NAMES[NET_PHASE_COUNT] = {
+    "dns", "connect", "send", "server", "read", "total"
+};
+
+// Called on the core that ran the operation
+typedef void (*NetOperationListener)(uint32_t totalUs, bool ok, void* context);
+
+// ==================== STATS ====================
+class NetLatencyStats {
+private:
+    LatencyHistogram phases[NET_PHASE_COUNT];
+    uint32_t failures[NET_PHASE_COUNT];   // Operations that failed in this phase
+    NetOperationListener listener;
+    void* listenerContext;
+
+public:
+    NetLatencyStats() : listener(nullptr), listenerContext(nullptr) { reset(); }
+
+    void setListener(NetOperationListener fn, void* context) {
+        listener = fn;
+        listenerContext = context;
+    }
+
+    void reset() {
+        for (int i = 0; i < NET_PHASE_COUNT; i++) {
+            phases[i].reset();
+            failures[i] = 0;
+        }
+    }
+
+    void record(NetPhase phase, uint32_t us) { phases[phase].record(us); }
+    void recordFailure(NetPhase phase) { failures[phase]++; }
+
+    // One finished operation: Total, the failed phase, the listener
+    void recordOperation(uint32_t totalUs, bool ok, NetPhase failedPhase) {
+        phases[NET_PHASE_TOTAL].record(totalUs);
+        if (!ok) failures[failedPhase]++;
+        if (listener) listener(totalUs, ok, listenerContext);
+    }
+
+    const LatencyHistogram& phase(NetPhase p) const { return phases[p]; }
+    uint32_t getFailures(NetPhase p) const { return failures[p]; }
+
+    uint32_t totalFailures() const {
+        uint32_t n = 0;
+        for (int i = 0; i < NET_PHASE_COUNT; i++) n += failures[i];
+        return n;
+    }
+
+    // {"dns":{"n":..,"p50":..,"p95":..,"p99":..,"max":..,"fail":..},...} (µs)
+    int encodeJson(char* out, size_t size) const {
+        size_t used = 0;
+        int written = snprintf(out, size, "{");
+        if (written < 0 || (size_t)written >= size) return -1;
+        used += (size_t)written;
+
+        bool first = true;
+        for (int i = 0; i < NET_PHASE_COUNT; i++) {
+            const LatencyHistogram& h = phases[i];
+            if (h.count() == 0 && failures[i] == 0) continue;
+            written = snprintf(out + used, size - used,
+                               "%s\"%s\":{\"n\":%lu,\"p50\":%lu,\"p95\":%lu,\"p99\":%lu,\"max\":%lu,\"fail\":%lu}",
+                               first ? "" : ",", NET_PHASE_NAMES[i],
+                               (unsigned long)h.count(), (unsigned long)h.percentile(50),
+                               (unsigned long)h.percentile(95), (unsigned long)h.percentile(99),
+                               (unsigned long)h.max(), (unsigned long)failures[i]);
+            if (written < 0 || (size_t)written >= size - used) return -1;
+            used += (size_t)written;
+            first = false;
+        }
+        written = snprintf(out + used, size - used, "}");
+        if (written < 0 || (size_t)written >= size - used) return -1;
+        return (int)(used + (size_t)written);
+    }
+};
+
+// ==================== PHASE TIMER ====================
+// One operation: start(), then mark() as each phase ends.
+//   timer.start(micros());
+//   ... dns ...      timer.mark(NET_PHASE_DNS, micros());
+//   ... connect ...  timer.mark(NET_PHASE_CONNECT, micros());
+//   timer.finish(ok, micros());
+class NetPhaseTimer {
+private:
+    NetLatencyStats* stats;
+    uint32_t startUs;
+    uint32_t lastUs;
+    NetPhase current;
+
+public:
+    NetPhaseTimer(NetLatencyStats* target) : stats(target), startUs(0), lastUs(0), current(NET_PHASE_DNS) {}
+
+    void start(uint32_t nowUs) {
+        startUs = nowUs;
+        lastUs = nowUs;
+        current = NET_PHASE_DNS;
+    }
+
+    // Close `phase` (time since previous mark)
+    void mark(NetPhase phase, uint32_t nowUs) {
+        if (stats) stats->record(phase, nowUs - lastUs);
+        lastUs = nowUs;
+        current = (NetPhase)(phase + 1 < NET_PHASE_TOTAL ? phase + 1 : NET_PHASE_TOTAL);
+    }
+
+    // Record total time; on failure blame the phase that was running
+    void finish(bool ok, uint32_t nowUs) {
+        if (stats) stats->recordOperation(nowUs - startUs, ok, current);
+    }
+
+    // For library calls where only the whole operation is visible
+    void skipTo(NetPhase phase, uint32_t nowUs) {
+        lastUs = nowUs;
+        current = phase;
+    }
+};
+
+#endif // NET_LATENCY_H
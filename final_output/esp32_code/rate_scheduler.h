@@ -0,0 +1,209 @@
+/*
+ * Rate Scheduler - Token buckets shared by all telemetry sinks
+ *
+ * Decides WHEN each sink may upload, so sampling/prediction rates no longer
+ * have to match the slowest cloud limit.
+ *
+ * Features:
+ * - Per-sink token bucket (one token per interval, configurable burst)
+ * - Global bucket shared by every rate-limited sink (caps back-to-back
+ *   blocking uploads on the single radio)
+ * - Priorities: when tokens are scarce, higher priority sinks go first
+ * - Latest-value coalescing: a newer record replaces one still waiting
+ * - Metrics: budget utilisation, deferrals, coalesced records, queue delay
+ * - No Arduino dependencies (time is passed in)
+ *
+ * Buckets count credit in milliseconds (cost of one token = interval),
+ * so refills are exact no matter how often service() runs.
+ */
+
+#ifndef RATE_SCHEDULER_H
+#define RATE_SCHEDULER_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define RATE_SCHEDULER_MAX_SLOTS 8
+
+enum RatePriority {
+    RATE_PRIORITY_HIGH = 0,
+    RATE_PRIORITY_NORMAL = 1,
+    RATE_PRIORITY_LOW = 2
+};
+
+// ==================== TOKEN BUCKET ====================
+class TokenBucket {
+private:
+    uint32_t intervalMs;     // 0 = unlimited
+    uint32_t capacityMs;     // burst * interval
+    uint32_t creditMs;
+    uint32_t lastRefillMs;
+
+public:
+    TokenBucket() : intervalMs(0), capacityMs(0), creditMs(0), lastRefillMs(0) {}
+
+    // Starts full so the first upload is not delayed
+    void configure(uint32_t interval, uint16_t burst, uint32_t now) {
+        intervalMs = interval;
+        capacityMs = interval * (burst > 0 ? burst : 1);
+        creditMs = capacityMs;
+        lastRefillMs = now;
+    }
+
+    bool isLimited() const { return intervalMs > 0; }
+    uint32_t getInterval() const { return intervalMs; }
+
+    bool available(uint32_t now) {
+        refill(now);
+        return intervalMs == 0 || creditMs >= intervalMs;
+    }
+
+    void consume() {
+        if (intervalMs > 0 && creditMs >= intervalMs) {
+            creditMs -= intervalMs;
+        }
+    }
+
+    // Time until the next token (0 = available now)
+    uint32_t msUntilAvailable(uint32_t now) {
+        refill(now);
+        return (intervalMs == 0 || creditMs >= intervalMs) ? 0 : intervalMs - creditMs;
+    }
+
+private:
+    void refill(uint32_t now) {
+        uint32_t elapsed = now - lastRefillMs;
+        lastRefillMs = now;
+        creditMs = (capacityMs - creditMs <= elapsed) ? capacityMs : creditMs + elapsed;
+    }
+};
+
+// ==================== SCHEDULER ====================
+struct RateSlotStats {
+    uint32_t offered;          // Records handed to the slot
+    uint32_t sent;             // Upload attempts (tokens used)
+    uint32_t deferred;         // Records that had to wait for a token
+    uint32_t coalesced;        // Records replaced by a newer one while waiting
+    uint32_t queueDelayTotalMs;
+    uint32_t queueDelayMaxMs;
+};
+
+class RateScheduler {
+private:
+    struct Slot {
+        TokenBucket bucket;
+        uint8_t priority = RATE_PRIORITY_NORMAL;
+        bool pending = false;
+        bool deferredCounted = false;
+        uint32_t pendingSinceMs = 0;
+        RateSlotStats stats = {};
+    };
+
+    Slot slots[RATE_SCHEDULER_MAX_SLOTS];
+    int slotCount;
+
+    TokenBucket global;
+    uint32_t globalSent;
+    uint32_t startMs;
+
+public:
+    RateScheduler() : slotCount(0), globalSent(0), startMs(0) {}
+
+    // Budget shared by every rate-limited slot (interval 0 = no global cap)
+    void setGlobalBudget(uint32_t intervalMs, uint16_t burst, uint32_t now) {
+        global.configure(intervalMs, burst, now);
+        startMs = now;
+    }
+
+    // Returns the slot index, or -1 when full
+    int addSlot(uint8_t priority, uint32_t intervalMs, uint16_t burst, uint32_t now) {
+        if (slotCount >= RATE_SCHEDULER_MAX_SLOTS) return -1;
+        Slot& s = slots[slotCount];
+        s = Slot();
+        s.bucket.configure(intervalMs, burst, now);
+        s.priority = priority;
+        if (slotCount == 0 && startMs == 0) startMs = now;
+        return slotCount++;
+    }
+
+    // A new record is available for this slot (replaces any waiting one)
+    void offer(int index, uint32_t now) {
+        Slot& s = slots[index];
+        s.stats.offered++;
+        if (s.pending) {
+            s.stats.coalesced++;
+            return;   // Keep the original wait start for queue-delay accounting
+        }
+        s.pending = true;
+        s.deferredCounted = false;
+        s.pendingSinceMs = now;
+    }
+
+    // Highest-priority pending slot that is ready and has tokens, or -1.
+    // `ready[i] == false` excludes a slot (sink offline, already tried).
+    int next(uint32_t now, const bool* ready) {
+        bool globalAvailable = global.available(now);
+        int best = -1;
+        for (int i = 0; i < slotCount; i++) {
+            Slot& s = slots[i];
+            if (!s.pending || !ready[i]) continue;
+
+            bool limited = s.bucket.isLimited();
+            if (!s.bucket.available(now) || (limited && !globalAvailable)) {
+                if (!s.deferredCounted) {
+                    s.stats.deferred++;
+                    s.deferredCounted = true;
+                }
+                continue;
+            }
+            if (best < 0 || s.priority < slots[best].priority) {
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    // Record an upload attempt. A failed upload keeps the record pending
+    // so it is retried when the next token arrives.
+    void complete(int index, uint32_t now, bool ok) {
+        Slot& s = slots[index];
+        s.stats.sent++;
+        if (s.bucket.isLimited()) {
+            s.bucket.consume();
+            global.consume();
+            globalSent++;
+        }
+        if (ok || !s.bucket.isLimited()) {
+            uint32_t delay = now - s.pendingSinceMs;
+            s.stats.queueDelayTotalMs += delay;
+            if (delay > s.stats.queueDelayMaxMs) s.stats.queueDelayMaxMs = delay;
+            s.pending = false;
+        }
+    }
+
+    bool isPending(int index) const { return slots[index].pending; }
+    uint32_t msUntilAvailable(int index, uint32_t now) { return slots[index].bucket.msUntilAvailable(now); }
+    const RateSlotStats& getStats(int index) const { return slots[index].stats; }
+    uint32_t getInterval(int index) const { return slots[index].bucket.getInterval(); }
+    uint8_t getPriority(int index) const { return slots[index].priority; }
+
+    // Fraction of the slot's token budget used since start (0 for unlimited)
+    float utilisation(int index, uint32_t now) const {
+        return budgetUsed(slots[index].stats.sent, slots[index].bucket.getInterval(), now);
+    }
+
+    float globalUtilisation(uint32_t now) const {
+        return budgetUsed(globalSent, global.getInterval(), now);
+    }
+
+    uint32_t getGlobalInterval() const { return global.getInterval(); }
+
+private:
+    float budgetUsed(uint32_t used, uint32_t intervalMs, uint32_t now) const {
+        if (intervalMs == 0) return 0.0f;
+        float budget = (float)(now - startMs) / intervalMs + 1.0f;   // +1 initial token
+        return budget > 0.0f ? used / budget : 0.0f;
+    }
+};
+
+#endif // RATE_SCHEDULER_H
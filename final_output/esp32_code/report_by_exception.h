@@ -0,0 +1,173 @@
+/*
+ * Report By Exception - Deadband / change-driven upload filter
+ *
+ * At steady state most records repeat the previous class and nearly the
+ * same sensor values. A record is only reported when:
+ * - it is the first one
+ * - the predicted class changed
+ * - any feature moved beyond its deadband since the last REPORTED record
+ * - the heartbeat interval expired (proves the device is alive)
+ *
+ * Reconstruction: a dashboard that holds the last reported value
+ * (sample-and-hold) is never further than one deadband from the true
+ * value of any feature, and always shows the true class.
+ *
+ * No Arduino dependencies (time is passed in; host tools replay traces).
+ */
+
+#ifndef REPORT_BY_EXCEPTION_H
+#define REPORT_BY_EXCEPTION_H
+
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+#include "telemetry_record.h"
+
+// Default deadbands (absolute units)
+#define RBE_DEADBAND_TEMPERATURE 0.3f    // °C
+#define RBE_DEADBAND_HUMIDITY 1.0f       // %
+#define RBE_DEADBAND_PRESSURE 50.0f      // Pa
+#define RBE_DEADBAND_LUX 25.0f           // lux
+#define RBE_DEADBAND_GAS 50.0f           // PPM
+#define RBE_HEARTBEAT_MS 300000          // Report at least every 5 minutes
+
+#define RBE_NUM_FEATURES 5
+
+enum RbeReason {
+    RBE_SUPPRESSED = 0,
+    RBE_FIRST,
+    RBE_CLASS_CHANGE,
+    RBE_DEADBAND,
+    RBE_HEARTBEAT,
+    RBE_REASON_COUNT
+};
+
+static const char* const RBE_REASON_NAMES[RBE_REASON_COUNT] = {
+    "suppressed", "first", "class change", "deadband", "heartbeat"
+};
+
+static const char* const RBE_FEATURE_NAMES[RBE_NUM_FEATURES] = {
+    "temperature", "humidity", "pressure", "lux", "gas"
+};
+
+struct RbeStats {
+    uint32_t evaluated;
+    uint32_t byReason[RBE_REASON_COUNT];       // [RBE_SUPPRESSED] = suppressed count
+    uint32_t deadbandHits[RBE_NUM_FEATURES];   // Which feature tripped the deadband
+    float maxSuppressedError[RBE_NUM_FEATURES]; // Largest |value - reported| hidden so far
+};
+
+class ReportByException {
+private:
+    float deadbands[RBE_NUM_FEATURES];
+    uint32_t heartbeatMs;
+
+    bool hasReference;
+    float reference[RBE_NUM_FEATURES];
+    uint8_t referenceClass;
+    uint32_t referenceMs;
+
+    RbeStats stats;
+
+public:
+    ReportByException() {
+        deadbands[0] = RBE_DEADBAND_TEMPERATURE;
+        deadbands[1] = RBE_DEADBAND_HUMIDITY;
+        deadbands[2] = RBE_DEADBAND_PRESSURE;
+        deadbands[3] = RBE_DEADBAND_LUX;
+        deadbands[4] = RBE_DEADBAND_GAS;
+        heartbeatMs = RBE_HEARTBEAT_MS;
+        reset();
+    }
+
+    void reset() {
+        hasReference = false;
+        referenceClass = 0;
+        referenceMs = 0;
+        memset(reference, 0, sizeof(reference));
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    // Deadbands in feature order: temperature, humidity, pressure, lux, gas
+    void setDeadbands(float temperature, float humidity, float pressure, float lux, float gas) {
+        deadbands[0] = temperature;
+        deadbands[1] = humidity;
+        deadbands[2] = pressure;
+        deadbands[3] = lux;
+        deadbands[4] = gas;
+    }
+
+    void setHeartbeat(uint32_t ms) { heartbeatMs = ms; }
+    float getDeadband(int feature) const { return deadbands[feature]; }
+    uint32_t getHeartbeat() const { return heartbeatMs; }
+
+    // Decide whether `record` must be reported; a reported record becomes
+    // the new reference.
+    RbeReason evaluate(const TelemetryRecord& record, uint32_t nowMs) {
+        stats.evaluated++;
+        float values[RBE_NUM_FEATURES];
+        features(record, values);
+
+        RbeReason reason = RBE_SUPPRESSED;
+        if (!hasReference) {
+            reason = RBE_FIRST;
+        } else if (record.predictedClass != referenceClass) {
+            reason = RBE_CLASS_CHANGE;
+        } else {
+            for (int i = 0; i < RBE_NUM_FEATURES; i++) {
+                if (fabsf(values[i] - reference[i]) > deadbands[i]) {
+                    stats.deadbandHits[i]++;
+                    reason = RBE_DEADBAND;
+                }
+            }
+            if (reason == RBE_SUPPRESSED && nowMs - referenceMs >= heartbeatMs) {
+                reason = RBE_HEARTBEAT;
+            }
+        }
+
+        stats.byReason[reason]++;
+        if (reason == RBE_SUPPRESSED) {
+            for (int i = 0; i < RBE_NUM_FEATURES; i++) {
+                float error = fabsf(values[i] - reference[i]);
+                if (error > stats.maxSuppressedError[i]) stats.maxSuppressedError[i] = error;
+            }
+        } else {
+            setReference(values, record.predictedClass, nowMs);
+        }
+        return reason;
+    }
+
+    // A suppressed record was sent anyway (it replaced a reported record that
+    // was still waiting for upload): the receiver now holds this one.
+    void rebase(const TelemetryRecord& record) {
+        float values[RBE_NUM_FEATURES];
+        features(record, values);
+        setReference(values, record.predictedClass, referenceMs);
+    }
+
+    const RbeStats& getStats() const { return stats; }
+
+    uint32_t reported() const { return stats.evaluated - stats.byReason[RBE_SUPPRESSED]; }
+
+    float suppressionRatio() const {
+        return stats.evaluated ? (float)stats.byReason[RBE_SUPPRESSED] / stats.evaluated : 0.0f;
+    }
+
+private:
+    static void features(const TelemetryRecord& r, float* out) {
+        out[0] = r.temperature;
+        out[1] = r.humidity;
+        out[2] = r.pressure;
+        out[3] = r.lux;
+        out[4] = r.gas;
+    }
+
+    void setReference(const float* values, uint8_t classId, uint32_t nowMs) {
+        memcpy(reference, values, sizeof(reference));
+        referenceClass = classId;
+        referenceMs = nowMs;
+        hasReference = true;
+    }
+};
+
+#endif // REPORT_BY_EXCEPTION_H
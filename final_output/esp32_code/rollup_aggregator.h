@@ -0,0 +1,295 @@
+/*
+ * Rollup Aggregator - Incremental minute/hour/day statistics on the device
+ *
+ * Every record updates the current minute, hour and day bucket (count,
+ * min/max/mean per sensor, class histogram). Buckets that changed since the
+ * last upload are "dirty" and written into the next Firebase PATCH as
+ *   aggregates/{minute|hour|day}/{start_s}/{segment}
+ * so dashboards read a few KB of rollups instead of the raw history.
+ *
+ * Buckets live in RAM, so each boot only knows the records it saw itself.
+ * The segment key (epoch seconds of this boot's first synced record) keeps
+ * one child per boot under a bucket: a reboot mid-hour adds a second child
+ * instead of overwriting the first, and readers merge the children (sum n
+ * and classes, min of mins, max of maxes, n-weighted mean).
+ *
+ * Features:
+ * - O(1) update per record, fixed memory (no heap)
+ * - Hour/day buckets are rewritten while open (partial stats are live)
+ * - Finished buckets wait in a small ring per level until uploaded; dirty
+ *   buckets are written day, hour, minute first so the long ones drain
+ *   first after an outage. If the minute ring overflows while offline the
+ *   oldest minute rollup is dropped (hour and day rollups stay exact
+ *   through outages of up to ROLLUP_HOUR_SLOTS - 1 hours); an evicted
+ *   bucket loses only the records since its last upload, counted in
+ *   RollupStats::recordsDropped
+ * - Sees every record (not only the reported ones), so report-by-exception
+ *   does not bias the statistics
+ * - No Arduino dependencies (host tools reuse it)
+ *
+ * Node Layout (per bucket and segment):
+ *   {"start":s,"n":count,"temperature":[min,max,mean],"humidity":[...],
+ *    "pressure":[...],"lux":[...],"gas_ppm":[...],"classes":[c0,c1,c2,c3,c4]}
+ */
+
+#ifndef ROLLUP_AGGREGATOR_H
+#define ROLLUP_AGGREGATOR_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "telemetry_record.h"
+#include "json_stream_writer.h"
+
+#define ROLLUP_SENSORS 5
+#define ROLLUP_MINUTE_SLOTS 8        // Open minute + finished minutes awaiting upload
+#define ROLLUP_HOUR_SLOTS 6          // Open hour + closed hours awaiting upload
+#define ROLLUP_DAY_SLOTS 2
+
+enum RollupLevel {
+    ROLLUP_MINUTE = 0,
+    ROLLUP_HOUR,
+    ROLLUP_DAY,
+    ROLLUP_LEVEL_COUNT
+};
+
+static const char* const ROLLUP_LEVEL_NAMES[ROLLUP_LEVEL_COUNT] = { "minute", "hour", "day" };
+static const uint32_t ROLLUP_PERIOD_S[ROLLUP_LEVEL_COUNT] = { 60, 3600, 86400 };
+
+// ==================== BUCKET ====================
+struct RollupBucket {
+    uint32_t startS;                        // Bucket start (epoch seconds, UTC)
+    uint32_t count;
+    float minValue[ROLLUP_SENSORS];
+    float maxValue[ROLLUP_SENSORS];
+    double sum[ROLLUP_SENSORS];
+    uint32_t classes[TELEMETRY_NUM_CLASSES];
+    uint32_t uploaded;                      // count at the last confirmed upload
+    bool used;
+    bool dirty;                             // Changed since last upload
+
+    void start(uint32_t s) {
+        memset(this, 0, sizeof(*this));
+        startS = s;
+        used = true;
+    }
+
+    void add(const float* values, uint8_t classId) {
+        for (int i = 0; i < ROLLUP_SENSORS; i++) {
+            if (count == 0 || values[i] < minValue[i]) minValue[i] = values[i];
+            if (count == 0 || values[i] > maxValue[i]) maxValue[i] = values[i];
+            sum[i] += values[i];
+        }
+        if (classId < TELEMETRY_NUM_CLASSES) classes[classId]++;
+        count++;
+        dirty = true;
+    }
+
+    float mean(int sensor) const { return count ? (float)(sum[sensor] / count) : 0.0f; }
+};
+
+// Aggregate node schema (sensor keys match the reading node)
+enum JsonAggregateField {
+    JSON_AGGREGATE_START = 0,
+    JSON_AGGREGATE_COUNT,
+    JSON_AGGREGATE_TEMPERATURE,
+    JSON_AGGREGATE_HUMIDITY,
+    JSON_AGGREGATE_PRESSURE,
+    JSON_AGGREGATE_LUX,
+    JSON_AGGREGATE_GAS_PPM,
+    JSON_AGGREGATE_CLASSES,
+    JSON_AGGREGATE_FIELD_COUNT
+};
+
+static const JsonField JSON_AGGREGATE_SCHEMA[] = {
+    JSON_FIELD("start"),
+    JSON_FIELD("n"),
+    JSON_FIELD("temperature"),
+    JSON_FIELD("humidity"),
+    JSON_FIELD("pressure"),
+    JSON_FIELD("lux"),
+    JSON_FIELD("gas_ppm"),
+    JSON_FIELD("classes"),
+};
+static_assert(JSON_SCHEMA_SIZE(JSON_AGGREGATE_SCHEMA) == JSON_AGGREGATE_FIELD_COUNT, "aggregate schema");
+
+inline void json_write_aggregate(JsonStreamWriter& w, const RollupBucket& b) {
+    const JsonField* f = JSON_AGGREGATE_SCHEMA;
+    w.beginObject();
+    w.field(f[JSON_AGGREGATE_START]); w.value(b.startS);
+    w.field(f[JSON_AGGREGATE_COUNT]); w.value(b.count);
+    for (int i = 0; i < ROLLUP_SENSORS; i++) {
+        w.field(f[JSON_AGGREGATE_TEMPERATURE + i]);
+        w.beginArray();
+        w.value(b.minValue[i], 2);
+        w.value(b.maxValue[i], 2);
+        w.value(b.mean(i), 2);
+        w.endArray();
+    }
+    w.field(f[JSON_AGGREGATE_CLASSES]);
+    w.beginArray();
+    for (int c = 0; c < TELEMETRY_NUM_CLASSES; c++) w.value(b.classes[c]);
+    w.endArray();
+    w.endObject();
+}
+
+// ==================== AGGREGATOR ====================
+struct RollupStats {
+    uint32_t records;
+    uint32_t nodesWritten;      // Buckets confirmed uploaded
+    uint32_t nodesDropped;      // Dirty buckets evicted before upload (ring overflow)
+    uint32_t recordsDropped;    // Records those buckets had not uploaded yet
+    uint32_t unsynced;          // Records skipped for lack of epoch time
+};
+
+class RollupAggregator {
+private:
+    RollupBucket minutes[ROLLUP_MINUTE_SLOTS];
+    RollupBucket hours[ROLLUP_HOUR_SLOTS];
+    RollupBucket days[ROLLUP_DAY_SLOTS];
+    RollupStats stats;
+    uint32_t segment;           // Child key of this boot's nodes (0 until the first record)
+
+    // Which buckets the last writeDirty() put in the body (cleared on commit)
+    bool staged[ROLLUP_LEVEL_COUNT][ROLLUP_MINUTE_SLOTS];
+
+public:
+    RollupAggregator() { reset(); }
+
+    void reset() {
+        memset(minutes, 0, sizeof(minutes));
+        memset(hours, 0, sizeof(hours));
+        memset(days, 0, sizeof(days));
+        memset(&stats, 0, sizeof(stats));
+        memset(staged, 0, sizeof(staged));
+        segment = 0;
+    }
+
+    // Records without wall-clock time (before the first NTP sync) are
+    // skipped: their buckets could not be placed
+    bool add(const TelemetryRecord& r) {
+        if (r.epochMs == 0) {
+            stats.unsynced++;
+            return false;
+        }
+        float values[ROLLUP_SENSORS] = { r.temperature, r.humidity, r.pressure, r.lux, r.gas };
+        uint32_t nowS = (uint32_t)(r.epochMs / 1000);
+        if (segment == 0) segment = nowS;
+        for (int l = 0; l < ROLLUP_LEVEL_COUNT; l++) {
+            RollupBucket* bucket = open((RollupLevel)l, nowS - nowS % ROLLUP_PERIOD_S[l]);
+            bucket->add(values, r.predictedClass);
+        }
+        stats.records++;
+        return true;
+    }
+
+    // Append every dirty bucket as ,"aggregates/{level}/{start}/{segment}":{...}
+    // at body[length] (inside an open PATCH object with at least one member),
+    // day buckets first. Buckets that do not fit stay dirty for the next
+    // upload. Returns the number of nodes written; commit() once the PATCH
+    // succeeded.
+    int writeDirty(char* body, size_t bodySize, size_t& length) {
+        int written = 0;
+        memset(staged, 0, sizeof(staged));
+        for (int l = ROLLUP_LEVEL_COUNT - 1; l >= 0; l--) {
+            RollupBucket* b = slots((RollupLevel)l);
+            for (int i = 0; i < slotCount((RollupLevel)l); i++) {
+                if (!b[i].used || !b[i].dirty) continue;
+                if (length + 2 >= bodySize) return written;
+                char key[48];
+                snprintf(key, sizeof(key), "aggregates/%s/%lu/%lu", ROLLUP_LEVEL_NAMES[l], (unsigned long)b[i].startS,
+                         (unsigned long)segment);
+                JsonStreamWriter w(body + length + 1, bodySize - length - 1);
+                w.key(key);
+                json_write_aggregate(w, b[i]);
+                if (!w.ok()) {
+                    body[length] = '\0';
+                    return written;
+                }
+                body[length] = ',';
+                length += 1 + (size_t)w.length();
+                staged[l][i] = true;
+                written++;
+            }
+        }
+        return written;
+    }
+
+    // The PATCH carrying the last writeDirty() succeeded
+    void commit() {
+        for (int l = 0; l < ROLLUP_LEVEL_COUNT; l++) {
+            RollupBucket* b = slots((RollupLevel)l);
+            for (int i = 0; i < slotCount((RollupLevel)l); i++) {
+                if (!staged[l][i]) continue;
+                b[i].dirty = false;
+                b[i].uploaded = b[i].count;
+                stats.nodesWritten++;
+            }
+        }
+        memset(staged, 0, sizeof(staged));
+    }
+
+    bool hasDirty() const {
+        for (int l = 0; l < ROLLUP_LEVEL_COUNT; l++) {
+            const RollupBucket* b = slots((RollupLevel)l);
+            for (int i = 0; i < slotCount((RollupLevel)l); i++) {
+                if (b[i].used && b[i].dirty) return true;
+            }
+        }
+        return false;
+    }
+
+    // Latest (open) bucket of a level, or nullptr before the first record
+    const RollupBucket* current(RollupLevel level) const {
+        const RollupBucket* b = slots(level);
+        const RollupBucket* latest = nullptr;
+        for (int i = 0; i < slotCount(level); i++) {
+            if (b[i].used && (!latest || b[i].startS > latest->startS)) latest = &b[i];
+        }
+        return latest;
+    }
+
+    const RollupStats& getStats() const { return stats; }
+    uint32_t getSegment() const { return segment; }
+
+private:
+    RollupBucket* slots(RollupLevel level) {
+        return level == ROLLUP_MINUTE ? minutes : (level == ROLLUP_HOUR ? hours : days);
+    }
+    const RollupBucket* slots(RollupLevel level) const {
+        return level == ROLLUP_MINUTE ? minutes : (level == ROLLUP_HOUR ? hours : days);
+    }
+    static int slotCount(RollupLevel level) {
+        return level == ROLLUP_MINUTE ? ROLLUP_MINUTE_SLOTS : (level == ROLLUP_HOUR ? ROLLUP_HOUR_SLOTS : ROLLUP_DAY_SLOTS);
+    }
+
+    // Bucket starting at `startS`: existing, a free slot, or the oldest
+    // slot (uploaded ones first; evicting a dirty one loses that rollup)
+    RollupBucket* open(RollupLevel level, uint32_t startS) {
+        RollupBucket* b = slots(level);
+        int n = slotCount(level);
+        int victim = -1;
+        for (int i = 0; i < n; i++) {
+            if (b[i].used && b[i].startS == startS) return &b[i];
+        }
+        for (int i = 0; i < n; i++) {
+            if (!b[i].used) {
+                victim = i;
+                break;
+            }
+            bool better = victim < 0 ||
+                          (b[victim].dirty && !b[i].dirty) ||
+                          (b[victim].dirty == b[i].dirty && b[i].startS < b[victim].startS);
+            if (better) victim = i;
+        }
+        if (b[victim].used && b[victim].dirty) {
+            stats.nodesDropped++;
+            stats.recordsDropped += b[victim].count - b[victim].uploaded;
+        }
+        staged[level][victim] = false;
+        b[victim].start(startS);
+        return &b[victim];
+    }
+};
+
+#endif // ROLLUP_AGGREGATOR_H
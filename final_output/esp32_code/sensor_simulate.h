@@ -6,9 +6,13 @@
  * - Random sensor value generation (Temperature, Humidity, Pressure, Light, Gas)
  * - 1-second sampling interval
  * - 15-second averaging for predictions (15 samples)
+ * - Sampling and prediction run as drift-free tasks on the loop's TaskScheduler
+ * - Optional hand-off to the network core through a TelemetryPipeline
  * - ML model prediction using averaged data
- * - Cloud upload (ThingSpeak) with all metrics
+ * - Telemetry record per prediction, dispatched to all sinks (ThingSpeak, Firebase, file)
  * - Continuous operation until stopped by user command
+ * - Readings and predictions logged through deferred_log.h (one binary
+ *   record each, formatted off the sampling path)
  * 
  * Features:
  * - Weather-pattern-based sensor generation (cyclic: all 5 classes equally, 30s each)
@@ -80,23 +84,30 @@
 #include <Arduino.h>
 #include "weather_model_250.h"
 #include "weather_scaling.h"
-#include <HTTPClient.h>
+#include "telemetry_dispatcher.h"
+#include "task_scheduler.h"
+#include "telemetry_pipeline.h"
+#include "deferred_log.h"
 #include <WiFi.h>
 
-// ThingSpeak Configuration
-#define THINGSPEAK_CHANNEL_ID "3108323"
-#define THINGSPEAK_API_KEY "J3GFLQKI0TVR6JC2"
-#define THINGSPEAK_SERVER "http://api.thingspeak.com"
-
 class SensorSimulator {
 private:
-    // External managers
-    class FirebaseManager* firebaseManager;
+    // Telemetry fan-out (ThingSpeak, Firebase, local file)
+    TelemetryDispatcher* telemetry;
+    
+    // Dual-core mode: records go to the network core instead of dispatch()
+    TelemetryPipeline* pipeline;
+    
+    // Loop scheduler that runs the sampling and prediction tasks
+    TaskScheduler* scheduler;
+    int sensorTask;
+    int predictionTask;
     
     // Timing constants
     static const unsigned long SENSOR_INTERVAL = 1000;      // 1 second
-    static const unsigned long PREDICTION_INTERVAL = 15000; // 15 seconds (ThingSpeak rate limit)
+    static const unsigned long PREDICTION_INTERVAL = 15000; // 15 seconds (averaging window; uploads are paced per sink by the telemetry scheduler)
     static const int BUFFER_SIZE = 15;                      // 15 readings for averaging
+    static const unsigned long SENSOR_DEADLINE = 100;       // A reading later than this counts as a miss
     
     // Sensor value ranges - MATCHED TO TRAINING DATA
     // These ranges MUST match the scaling parameters in weather_scaling.h
@@ -128,16 +139,11 @@ private:
     float currentGas;
     
     // Timing
-    unsigned long lastSensorRead;
-    unsigned long lastPrediction;
     unsigned long simulationStartTime;
     
     // Statistics
     unsigned long totalReadings;
     unsigned long totalPredictions;
-    unsigned long totalCloudUploads;
-    unsigned long successfulUploads;
-    unsigned long failedUploads;
     
     // Prediction tracking
     int predictionCounts[5];  // Count of each weather class
@@ -150,31 +156,28 @@ private:
     
     // Sustained weather pattern control
     int currentWeatherPattern;       // Current weather pattern (0-4)
-    unsigned long patternStartTime;  // When current pattern started
+    unsigned long patternReadings;   // Readings taken in the current pattern
     static const unsigned long PATTERN_DURATION = 30000; // 30 seconds per pattern
+    static const unsigned long PATTERN_READINGS = PATTERN_DURATION / SENSOR_INTERVAL;
     
     // ML Classifier
     Eloquent::ML::Port::RandomForest classifier;
     
-    // Cloud integration
-    HTTPClient http;
-    
 public:
     SensorSimulator() {
-        firebaseManager = nullptr;
+        telemetry = nullptr;
+        pipeline = nullptr;
+        scheduler = nullptr;
+        sensorTask = TASK_NONE;
+        predictionTask = TASK_NONE;
         bufferIndex = 0;
-        lastSensorRead = 0;
-        lastPrediction = 0;
         simulationStartTime = 0;
         totalReadings = 0;
         totalPredictions = 0;
-        totalCloudUploads = 0;
-        successfulUploads = 0;
-        failedUploads = 0;
         isRunning = false;
         wifiAvailable = false;
         currentWeatherPattern = -1;  // Will be set on first reading
-        patternStartTime = 0;
+        patternReadings = 0;
         
         // Initialize prediction counts
         for (int i = 0; i < 5; i++) {
@@ -201,8 +204,8 @@ public:
         Serial.println("─────────────────────────────────────────────────────────");
         Serial.println("   Sensor Reading:  Every 1 second");
         Serial.println("   Prediction:      Every 15 seconds (15 samples averaged)");
-        Serial.println("   Cloud Upload:    After each prediction");
-        Serial.println("   Rate Limit:      Complies with ThingSpeak (15s minimum)");
+        Serial.println("   Cloud Upload:    Latest prediction, paced per sink");
+        Serial.println("   Rate Limit:      Token buckets per sink (ThingSpeak 15s minimum)");
         Serial.println();
         Serial.println("📈 Sensor Value Ranges (from training data):");
         Serial.println("─────────────────────────────────────────────────────────");
@@ -227,9 +230,19 @@ public:
         wifiAvailable = available;
     }
     
-    // Set Firebase manager
-    void setFirebaseManager(class FirebaseManager* fbManager) {
-        firebaseManager = fbManager;
+    // Set telemetry dispatcher (cloud + local sinks)
+    void setTelemetryDispatcher(TelemetryDispatcher* dispatcher) {
+        telemetry = dispatcher;
+    }
+    
+    // Set pipeline to the network core (nullptr = dispatch on this core)
+    void setPipeline(TelemetryPipeline* handoff) {
+        pipeline = handoff;
+    }
+    
+    // Set loop scheduler (start() registers the sampling/prediction tasks)
+    void setScheduler(TaskScheduler* taskScheduler) {
+        scheduler = taskScheduler;
     }
     
     // Start simulation
@@ -238,6 +251,10 @@ public:
             Serial.println("⚠️  Simulation already running!");
             return;
         }
+        if (scheduler == nullptr) {
+            Serial.println("❌ Simulation needs a task scheduler (setScheduler)");
+            return;
+        }
         
         Serial.println("╔════════════════════════════════════════════════════════╗");
         Serial.println("║           🚀 STARTING SIMULATION                       ║");
@@ -246,7 +263,7 @@ public:
         Serial.println("🔄 Simulation Mode: CONTINUOUS");
         Serial.println("   • Sensor readings every 1 second");
         Serial.println("   • Predictions every 15 seconds (15 samples averaged)");
-        Serial.println("   • Cloud uploads after each prediction (ThingSpeak rate limit compliant)");
+        Serial.println("   • Cloud uploads scheduled per sink (ThingSpeak rate limit compliant)");
         Serial.println();
         Serial.println("⏹️  Press ANY KEY to stop simulation");
         Serial.println();
@@ -256,10 +273,8 @@ public:
         isRunning = true;
         simulationStartTime = millis();
         bufferIndex = 0;
-        lastSensorRead = 0;
-        lastPrediction = 0;
         currentWeatherPattern = -1;  // Will trigger first pattern selection
-        patternStartTime = 0;
+        patternReadings = 0;
         
         // Reset statistics
         totalReadings = 0;
@@ -267,6 +282,13 @@ public:
         for (int i = 0; i < 5; i++) {
             predictionCounts[i] = 0;
         }
+        
+        // First reading now, first prediction once the window is full;
+        // both stay on their ideal timeline from here on
+        unsigned long now = millis();
+        sensorTask = scheduler->every("sensor", SENSOR_INTERVAL, sensorTaskFn, this, now, SENSOR_DEADLINE, 0);
+        predictionTask = scheduler->every("predict", PREDICTION_INTERVAL, predictionTaskFn, this, now,
+                                          SENSOR_INTERVAL);
     }
     
     // Stop simulation
@@ -276,6 +298,9 @@ public:
         }
         
         isRunning = false;
+        scheduler->cancel(sensorTask);
+        scheduler->cancel(predictionTask);
+        sensorTask = predictionTask = TASK_NONE;
         unsigned long totalTime = (millis() - simulationStartTime) / 1000;
         
         Serial.println();
@@ -289,13 +314,8 @@ public:
         Serial.printf("   Runtime:         %lu seconds\n", totalTime);
         Serial.printf("   Sensor Readings: %lu\n", totalReadings);
         Serial.printf("   Predictions:     %lu\n", totalPredictions);
-        Serial.printf("   Cloud Uploads:   %lu (✅ %lu, ❌ %lu)\n", 
-                     totalCloudUploads, successfulUploads, failedUploads);
-        
-        if (totalCloudUploads > 0) {
-            float successRate = (successfulUploads * 100.0f) / totalCloudUploads;
-            Serial.printf("   Upload Success:  %.1f%%\n", successRate);
-        }
+        // Upload statistics belong to the network task: the sketch prints
+        // them from there ('telemetry' command) after stop()
         
         Serial.println();
         Serial.println("🌤️  Weather Prediction Distribution:");
@@ -304,7 +324,7 @@ public:
         for (int i = 0; i < 5; i++) {
             if (totalPredictions > 0) {
                 float percentage = (predictionCounts[i] * 100.0f) / totalPredictions;
-                Serial.printf("   %s %-8s: %3lu predictions (%.1f%%)\n", 
+                Serial.printf("   %s %-8s: %3d predictions (%.1f%%)\n", 
                              weatherEmojis[i], weatherClasses[i], 
                              predictionCounts[i], percentage);
             }
@@ -316,40 +336,30 @@ public:
         Serial.println();
     }
     
-    // Update simulation (call in loop)
-    void update() {
-        if (!isRunning) {
-            return;
-        }
-        
-        unsigned long currentTime = millis();
-        
-        // Read sensors every 1 second
-        if (currentTime - lastSensorRead >= SENSOR_INTERVAL) {
-            lastSensorRead = currentTime;
-            readSensors();
-        }
-        
-        // Make prediction every 5 seconds
-        if (currentTime - lastPrediction >= PREDICTION_INTERVAL) {
-            lastPrediction = currentTime;
-            makePrediction();
-        }
-    }
-    
     // Check if simulation is running
     bool running() {
         return isRunning;
     }
     
+    // Mean of one averaging window (host_tools/hotpath_bench.cpp times it)
+    static float windowAverage(const float* buffer, int count) {
+        float sum = 0;
+        for (int i = 0; i < count; i++) {
+            sum += buffer[i];
+        }
+        return sum / count;
+    }
+    
 private:
+    // Scheduler entry points (context = this)
+    static void sensorTaskFn(void* context) { static_cast<SensorSimulator*>(context)->readSensors(); }
+    static void predictionTaskFn(void* context) { static_cast<SensorSimulator*>(context)->makePrediction(); }
+    
     // Generate random sensor values with sustained weather patterns
     void readSensors() {
-        unsigned long currentTime = millis();
-        
-        // Check if we need to switch to a new weather pattern
-        if (currentWeatherPattern == -1 || 
-            (currentTime - patternStartTime) >= PATTERN_DURATION) {
+        // Check if we need to switch to a new weather pattern (counted in
+        // readings, which are on the scheduler's drift-free timeline)
+        if (currentWeatherPattern == -1 || patternReadings >= PATTERN_READINGS) {
             
             // Select new weather pattern (cycle through all 5 for demo diversity)
             if (currentWeatherPattern == -1) {
@@ -358,14 +368,10 @@ private:
                 currentWeatherPattern = (currentWeatherPattern + 1) % 5; // Cycle: 0→1→2→3→4→0
             }
             
-            patternStartTime = currentTime;
+            patternReadings = 0;
             
             // Announce pattern change
-            Serial.println();
-            Serial.printf("🔄 Weather Pattern Changed → %s %s (sustained for 30s)\n", 
-                         weatherEmojis[currentWeatherPattern], 
-                         weatherClasses[currentWeatherPattern]);
-            Serial.println();
+            LOG(LOG_MSG_PATTERN, weatherClasses[currentWeatherPattern]);
         }
         
         // Generate sensor values based on SUSTAINED weather pattern
@@ -441,46 +447,27 @@ private:
         
         bufferIndex = (bufferIndex + 1) % BUFFER_SIZE;
         totalReadings++;
+        patternReadings++;
         
-        // Display reading
-        unsigned long elapsed = (millis() - simulationStartTime) / 1000;
-        Serial.printf("[%02lu:%02lu] Reading #%lu: ", elapsed/60, elapsed%60, totalReadings);
-        Serial.printf("🌡️ %.1f°C | 💧 %.1f%% | 🌀 %.0fPa | 💡 %.0flux | 🌫️ %.0fppm\n",
-                     currentTemp, currentHumid, currentPressure, currentLux, currentGas);
+        // Log reading (LOG_LEVEL_DEBUG; stripped from INFO builds)
+        LOG(LOG_MSG_READING, totalReadings, currentTemp, currentHumid, currentPressure, currentLux, currentGas);
     }
     
-    // Make prediction using averaged data
+public:
+    // Make prediction using averaged data (the prediction task; public so
+    // host benchmarks can time it end to end)
     void makePrediction() {
-        // Calculate averages from buffer
-        float avgTemp = 0, avgHumid = 0, avgPressure = 0, avgLux = 0, avgGas = 0;
+        unsigned long acquireStart = micros();
         
-        for (int i = 0; i < BUFFER_SIZE; i++) {
-            avgTemp += tempBuffer[i];
-            avgHumid += humidBuffer[i];
-            avgPressure += pressureBuffer[i];
-            avgLux += luxBuffer[i];
-            avgGas += gasBuffer[i];
-        }
-        
-        avgTemp /= BUFFER_SIZE;
-        avgHumid /= BUFFER_SIZE;
-        avgPressure /= BUFFER_SIZE;
-        avgLux /= BUFFER_SIZE;
-        avgGas /= BUFFER_SIZE;
+        // Calculate averages from buffer
+        float avgTemp = windowAverage(tempBuffer, BUFFER_SIZE);
+        float avgHumid = windowAverage(humidBuffer, BUFFER_SIZE);
+        float avgPressure = windowAverage(pressureBuffer, BUFFER_SIZE);
+        float avgLux = windowAverage(luxBuffer, BUFFER_SIZE);
+        float avgGas = windowAverage(gasBuffer, BUFFER_SIZE);
         
-        // Display prediction header
-        Serial.println();
-        Serial.println("═══════════════════════════════════════════════════════════");
-        Serial.println("🔮 MAKING PREDICTION (15-second averaged data - 15 samples)");
-        Serial.println("═══════════════════════════════════════════════════════════");
-        Serial.println("📊 Averaged Sensor Data:");
-        Serial.println("─────────────────────────────────────────────────────────");
-        Serial.printf("   🌡️  Temperature: %.2f °C\n", avgTemp);
-        Serial.printf("   💧 Humidity:    %.2f %%\n", avgHumid);
-        Serial.printf("   🌀 Pressure:    %.2f Pa (%.2f hPa)\n", avgPressure, avgPressure/100.0f);
-        Serial.printf("   💡 Light (Lux): %.2f lux (%s)\n", avgLux, getLightCondition(avgLux));
-        Serial.printf("   🌫️  Gas (PPM):   %.2f ppm (%s)\n", avgGas, getAirQuality(avgGas));
-        Serial.println("─────────────────────────────────────────────────────────");
+        LOG(LOG_MSG_AVERAGE, avgTemp, avgHumid, avgPressure, avgLux, getLightCondition(avgLux), avgGas,
+            getAirQuality(avgGas));
         
         // Scale features for ML model
         float scaledFeatures[4];
@@ -490,8 +477,9 @@ private:
         scaledFeatures[3] = scale_lux(avgLux);
         
         // Make prediction and measure time
+        uint8_t votes[TELEMETRY_NUM_CLASSES];
         unsigned long startTime = micros();
-        int predictedClass = classifier.predict(scaledFeatures);
+        int predictedClass = classifier.predict(scaledFeatures, votes);
         unsigned long endTime = micros();
         unsigned long inferenceTime = endTime - startTime;
         
@@ -499,126 +487,33 @@ private:
         totalPredictions++;
         predictionCounts[predictedClass]++;
         
-        // Display prediction result
-        Serial.println();
-        Serial.println("🎯 Prediction Result:");
-        Serial.println("─────────────────────────────────────────────────────────");
-        Serial.printf("   Weather:    %s %s\n", 
-                     weatherEmojis[predictedClass], 
-                     weatherClasses[predictedClass]);
-        Serial.printf("   Class ID:   %d\n", predictedClass);
-        Serial.printf("   Inference:  %lu µs (%.3f ms)\n", 
-                     inferenceTime, inferenceTime/1000.0f);
-        Serial.printf("   Prediction: #%lu\n", totalPredictions);
-        Serial.println("─────────────────────────────────────────────────────────");
-        
-        // Upload to cloud
-        if (wifiAvailable) {
-            uploadToCloud(avgTemp, avgHumid, avgPressure, avgLux, avgGas, 
-                         predictedClass, inferenceTime);
+        LOG(LOG_MSG_PREDICTION, totalPredictions, weatherClasses[predictedClass], predictedClass, inferenceTime);
+        
+        // Build the canonical record once and hand it to every sink
+        if (telemetry != nullptr) {
+            TelemetryRecord record;
+            record.timestampMs = millis();
+            record.temperature = avgTemp;
+            record.humidity = avgHumid;
+            record.pressure = avgPressure;
+            record.lux = avgLux;
+            record.gas = avgGas;
+            record.predictedClass = (uint8_t)predictedClass;
+            memcpy(record.votes, votes, sizeof(record.votes));
+            record.inferenceTime = inferenceTime;
+            record.rssi = wifiAvailable ? (int8_t)WiFi.RSSI() : 0;
             
-            // Backup to Firebase (if configured)
-            if (firebaseManager != nullptr) {
-                firebaseManager->backupData(avgTemp, avgHumid, avgPressure, avgLux,
-                                           weatherClasses[predictedClass], inferenceTime);
-            }
-        } else {
-            Serial.println();
-            Serial.println("⚠️  Cloud Upload: SKIPPED (WiFi not connected)");
-        }
-        
-        Serial.println("═══════════════════════════════════════════════════════════");
-        Serial.println();
-    }
-    
-    // Upload data to ThingSpeak
-    void uploadToCloud(float temp, float humid, float pressure, float lux, float gas,
-                       int prediction, unsigned long inferenceTime) {
-        Serial.println();
-        Serial.println("☁️  Uploading to ThingSpeak...");
-        Serial.println("─────────────────────────────────────────────────────────");
-        
-        totalCloudUploads++;
-        
-        // CRITICAL: Validate WiFi connection state before upload
-        if (WiFi.status() != WL_CONNECTED) {
-            failedUploads++;
-            Serial.println("   Status:   ❌ WiFi NOT CONNECTED");
-            Serial.println("   Error:    WiFi connection lost during simulation");
-            Serial.println("─────────────────────────────────────────────────────────");
-            return;
-        }
-        
-        // CRITICAL: Validate DNS resolution before upload (ESP32 DNS can fail intermittently)
-        Serial.println("   🔍 Validating connection...");
-        IPAddress serverIP;
-        if (!WiFi.hostByName("api.thingspeak.com", serverIP)) {
-            failedUploads++;
-            Serial.println("   Status:   ❌ DNS RESOLUTION FAILED");
-            Serial.println("   Error:    Cannot resolve api.thingspeak.com");
-            Serial.println("   Hint:     Router may have lost internet connection");
-            Serial.println("─────────────────────────────────────────────────────────");
-            delay(2000);  // Wait before next attempt
-            return;
-        }
-        Serial.printf("   ✅ DNS OK: %s\n", serverIP.toString().c_str());
-        
-        // Build ThingSpeak URL with all fields
-        String url = String(THINGSPEAK_SERVER) + "/update?api_key=" + THINGSPEAK_API_KEY;
-        url += "&field1=" + String(temp, 2);           // Temperature
-        url += "&field2=" + String(humid, 2);          // Humidity
-        url += "&field3=" + String(pressure, 2);       // Pressure
-        url += "&field4=" + String(lux, 2);            // Lux
-        url += "&field5=" + String(gas, 2);            // Gas PPM
-        url += "&field6=" + String(prediction);        // Prediction class
-        url += "&field7=" + String(inferenceTime);     // Inference time
-        url += "&field8=" + String(WiFi.RSSI());       // WiFi signal
-        
-        Serial.println("   Target:   api.thingspeak.com");
-        Serial.printf("   Channel:  %s\n", THINGSPEAK_CHANNEL_ID);
-        Serial.println("   Data:");
-        Serial.printf("      Field 1 (Temp):      %.2f °C\n", temp);
-        Serial.printf("      Field 2 (Humid):     %.2f %%\n", humid);
-        Serial.printf("      Field 3 (Pressure):  %.2f Pa\n", pressure);
-        Serial.printf("      Field 4 (Lux):       %.2f lux\n", lux);
-        Serial.printf("      Field 5 (Gas):       %.2f ppm\n", gas);
-        Serial.printf("      Field 6 (Predict):   %d (%s)\n", prediction, weatherClasses[prediction]);
-        Serial.printf("      Field 7 (Inference): %lu µs\n", inferenceTime);
-        Serial.printf("      Field 8 (WiFi RSSI): %d dBm\n", WiFi.RSSI());
-        
-        // Make HTTP request with proper configuration
-        http.begin(url);
-        http.setReuse(false);  // CRITICAL: Disable connection reuse to prevent ESP32 HTTP issues
-        http.setTimeout(5000);
-        int httpCode = http.GET();
-        
-        if (httpCode > 0) {
-            if (httpCode == 200) {
-                String response = http.getString();
-                successfulUploads++;
-                Serial.println("   Status:   ✅ SUCCESS");
-                Serial.printf("   Response: Entry #%s created\n", response.c_str());
-                Serial.printf("   Stats:    %lu/%lu successful (%.1f%%)\n", 
-                             successfulUploads, totalCloudUploads,
-                             (successfulUploads * 100.0f) / totalCloudUploads);
+            if (pipeline != nullptr) {
+                if (!pipeline->submit(record, micros() - acquireStart)) {
+                    LOG(LOG_MSG_PIPELINE_FULL);
+                }
             } else {
-                failedUploads++;
-                Serial.printf("   Status:   ❌ HTTP %d\n", httpCode);
+                telemetry->dispatch(record);
             }
-        } else {
-            failedUploads++;
-            Serial.println("   Status:   ❌ CONNECTION FAILED");
-            Serial.printf("   Error:    %s\n", http.errorToString(httpCode).c_str());
-            Serial.println("   Possible causes:");
-            Serial.println("      • HTTP client not fully released from previous request");
-            Serial.println("      • Router lost internet connection");
-            Serial.println("      • ThingSpeak server temporarily unavailable");
         }
-        
-        http.end();
-        Serial.println("─────────────────────────────────────────────────────────");
     }
     
+private:
     // Generate random float in range
     float randomFloat(float min, float max) {
         return min + (random(0, 10000) / 10000.0f) * (max - min);
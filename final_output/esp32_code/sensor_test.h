@@ -8,7 +8,7 @@
  * - Multi-sample reading (15 readings over 15 seconds)
  * - Data averaging
  * - ML prediction
- * - Cloud upload
+ * - Telemetry dispatch (ThingSpeak, Firebase, local file)
  */
 
 #ifndef SENSOR_TEST_H
@@ -21,8 +21,8 @@
 #include "sensor_bme280.h"
 #include "sensor_bh1750.h"
 #include "sensor_mq2.h"
-#include "cloud_manager.h"
-#include "firebase_manager.h"
+#include "telemetry_dispatcher.h"
+#include <WiFi.h>
 
 class SensorTest {
 private:
@@ -36,9 +36,8 @@ private:
     BH1750Sensor* bh1750;
     MQ2Sensor* mq2;
     
-    // Managers
-    CloudManager* cloudManager;
-    FirebaseManager* firebaseManager;
+    // Telemetry fan-out
+    TelemetryDispatcher* telemetry;
     
     // ML Classifier
     Eloquent::ML::Port::RandomForest* classifier;
@@ -53,11 +52,11 @@ private:
 public:
     SensorTest(int sda, int scl, 
                AHT10Sensor* aht, BME280Sensor* bme, BH1750Sensor* bh, MQ2Sensor* mq,
-               CloudManager* cloud, FirebaseManager* firebase,
+               TelemetryDispatcher* dispatcher,
                Eloquent::ML::Port::RandomForest* clf) 
         : sdaPin(sda), sclPin(scl), 
           aht10(aht), bme280(bme), bh1750(bh), mq2(mq),
-          cloudManager(cloud), firebaseManager(firebase),
+          telemetry(dispatcher),
           classifier(clf), sensorsInitialized(false) {}
     
     // Run complete sensor test
@@ -121,19 +120,22 @@ public:
         Serial.printf("   🌫️  Gas (LPG):   %.2f PPM\n", avgGas);
         Serial.println();
         
-        // Make prediction
-        const char* prediction = makePrediction(avgTemp, avgHumid, avgPressure, avgLux);
+        // Make prediction into the canonical telemetry record
+        TelemetryRecord record;
+        record.timestampMs = millis();
+        record.temperature = avgTemp;
+        record.humidity = avgHumid;
+        record.pressure = avgPressure;
+        record.lux = avgLux;
+        record.gas = avgGas;
+        record.rssi = (WiFi.status() == WL_CONNECTED) ? (int8_t)WiFi.RSSI() : 0;
+        makePrediction(record);
         
-        // Upload to cloud with retry logic
-        if (cloudManager->isConnected()) {
-            cloudManager->uploadWithRetry(avgTemp, avgHumid, avgPressure, avgLux, avgGas);
+        // Upload to all sinks (ThingSpeak, Firebase, local file)
+        if (telemetry != nullptr) {
+            telemetry->dispatch(record);
         }
         
-        // Backup to Firebase (note: Firebase uses backupDataWithGas for gas sensor data)
-        // For now, use basic backupData since gas sensor not used in model
-        unsigned long inferenceTime = 0; // TODO: Get actual inference time from prediction
-        firebaseManager->backupData(avgTemp, avgHumid, avgPressure, avgLux, prediction, inferenceTime);
-        
         Serial.println("\n✅ Test complete! Type 'sensortest' to run again.\n");
     }
     
@@ -227,28 +229,29 @@ private:
         mq2->printReading();
     }
     
-    // Make ML prediction
-    const char* makePrediction(float temp, float humid, float pressure, float lux) {
+    // Make ML prediction (fills class, votes and inference time of the record)
+    void makePrediction(TelemetryRecord& record) {
         Serial.println("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
         Serial.println("🔮 Weather Prediction");
         Serial.println("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
         
         // Scale features
         float scaled[4];
-        scale_features(temp, humid, pressure, lux, scaled);
+        scale_features(record.temperature, record.humidity, record.pressure, record.lux, scaled);
         
         // Predict
         unsigned long startTime = micros();
-        int predictedClass = classifier->predict(scaled);
+        int predictedClass = classifier->predict(scaled, record.votes);
         unsigned long inferenceTime = micros() - startTime;
         
+        record.predictedClass = (uint8_t)predictedClass;
+        record.inferenceTime = inferenceTime;
+        
         const char* weather = weatherClasses[predictedClass];
         
         Serial.printf("   Prediction: %s %s\n", weatherEmojis[predictedClass], weather);
         Serial.printf("   Inference Time: %lu µs (%.3f ms)\n", inferenceTime, inferenceTime/1000.0);
         Serial.println();
-        
-        return weather;
     }
 };
 
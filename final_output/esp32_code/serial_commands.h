@@ -0,0 +1,247 @@
+/*
+ * Serial Commands - Fixed line buffer, dispatch table, numeric parser
+ *
+ * Shared by all three sketches. Replaces the String-based input path
+ * (inputString += c per byte, trim()/toLowerCase() copies, a chain of ==
+ * comparisons, substring() + toFloat() per field) with code that never
+ * touches the heap, so command latency does not depend on heap state and
+ * the firmware keeps up with thousands of lines per second from a host.
+ *
+ * Features:
+ * - SerialLineReader: fixed SERIAL_LINE_MAX buffer, CR/LF/CRLF, leading
+ *   and trailing blanks dropped while reading; overlong lines are
+ *   discarded whole and counted
+ * - SerialCommand tables: const arrays in flash, case-insensitive match
+ *   on whole words; the longest matching name wins ("boot json" before
+ *   "boot"); the rest of the line is passed to the handler as arguments
+ * - serial_parse_float()/serial_parse_floats(): decimal + exponent
+ *   parser, no copies, rejects trailing garbage
+ * - No Arduino dependencies (any object with available()/read() feeds the
+ *   reader; host tools reuse all of it)
+ *
+ * Usage:
+ *   static const SerialCommand COMMANDS[] = {
+ *       { "help", cmdHelp, "Show this help" },
+ *       { "boot json", cmdBootJson, "Boot profile as JSON" },
+ *   };
+ *   SerialLineReader console;
+ *   if (console.pump(Serial)) {
+ *       if (!serial_dispatch(COMMANDS, SERIAL_COMMAND_COUNT(COMMANDS), console.line())) { ... }
+ *       console.clear();
+ *   }
+ */
+
+#ifndef SERIAL_COMMANDS_H
+#define SERIAL_COMMANDS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SERIAL_LINE_MAX 128
+#define SERIAL_COMMAND_COUNT(table) (sizeof(table) / sizeof((table)[0]))
+
+// ==================== LINE READER ====================
+class SerialLineReader {
+private:
+    char buffer[SERIAL_LINE_MAX];
+    size_t used;
+    size_t trimmed;        // Length without trailing blanks
+    bool complete;
+    bool overflowed;       // Current line too long: drop until end of line
+    uint32_t lines;
+    uint32_t overflows;
+
+public:
+    SerialLineReader() : used(0), trimmed(0), complete(false), overflowed(false), lines(0), overflows(0) {
+        buffer[0] = '\0';
+    }
+
+    // Feed one character. Returns true when a non-empty line is ready;
+    // further input is ignored until clear().
+    bool feed(char c) {
+        if (complete) return true;
+        if (c == '\n' || c == '\r') {
+            if (overflowed) {
+                overflowed = false;
+                overflows++;
+                reset();
+                return false;
+            }
+            if (trimmed == 0) {
+                reset();
+                return false;
+            }
+            buffer[trimmed] = '\0';
+            complete = true;
+            lines++;
+            return true;
+        }
+        if (overflowed) return false;
+        if (used == 0 && (c == ' ' || c == '\t')) return false;
+        if (used >= SERIAL_LINE_MAX - 1) {
+            overflowed = true;
+            return false;
+        }
+        buffer[used++] = c;
+        if (c != ' ' && c != '\t') trimmed = used;
+        return false;
+    }
+
+    // Read everything available from a Serial-like stream, stopping at the
+    // end of a line so the next line stays in the driver's buffer
+    template <typename Stream>
+    bool pump(Stream& stream) {
+        while (!complete && stream.available() > 0) {
+            feed((char)stream.read());
+        }
+        return complete;
+    }
+
+    bool ready() const { return complete; }
+    const char* line() const { return buffer; }
+    size_t length() const { return trimmed; }
+    void clear() { reset(); }
+
+    uint32_t getLines() const { return lines; }
+    uint32_t getOverflows() const { return overflows; }
+
+private:
+    void reset() {
+        used = trimmed = 0;
+        complete = false;
+        buffer[0] = '\0';
+    }
+};
+
+// ==================== DISPATCH TABLE ====================
+typedef void (*SerialCommandHandler)(const char* args);
+
+struct SerialCommand {
+    const char* name;      // Lower case; may contain spaces ("boot json")
+    SerialCommandHandler handler;
+    const char* help;
+};
+
+inline char serial_lower(char c) { return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c; }
+
+// Length of `name` if the line starts with it (case-insensitive) followed
+// by the end of the line or a blank, else 0
+inline size_t serial_match(const char* name, const char* line) {
+    size_t i = 0;
+    for (; name[i] != '\0'; i++) {
+        if (serial_lower(line[i]) != name[i]) return 0;
+    }
+    return (line[i] == '\0' || line[i] == ' ' || line[i] == '\t') ? i : 0;
+}
+
+// Longest matching command, or nullptr. args points at the rest of the
+// line (blanks skipped, "" when there is none).
+inline const SerialCommand* serial_find(const SerialCommand* table, size_t count, const char* line,
+                                        const char** args) {
+    const SerialCommand* best = nullptr;
+    size_t bestLength = 0;
+    for (size_t i = 0; i < count; i++) {
+        size_t length = serial_match(table[i].name, line);
+        if (length > bestLength) {
+            best = &table[i];
+            bestLength = length;
+        }
+    }
+    if (best != nullptr && args != nullptr) {
+        const char* rest = line + bestLength;
+        while (*rest == ' ' || *rest == '\t') rest++;
+        *args = rest;
+    }
+    return best;
+}
+
+// Run the matching handler. Returns false for an unknown command.
+inline bool serial_dispatch(const SerialCommand* table, size_t count, const char* line) {
+    const char* args = "";
+    const SerialCommand* command = serial_find(table, count, line, &args);
+    if (command == nullptr) return false;
+    command->handler(args);
+    return true;
+}
+
+// ==================== NUMBERS ====================
+// Decimal number with optional sign, fraction and exponent ("-12.5",
+// "1.0132e5"). Advances *text past the number. Up to 9 significant digits
+// are kept (float has ~7); the rest only move the decimal point.
+inline bool serial_parse_float(const char** text, float* out) {
+    static const float POW10[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+    const char* p = *text;
+    while (*p == ' ' || *p == '\t') p++;
+    bool negative = false;
+    if (*p == '+' || *p == '-') negative = *p++ == '-';
+
+    uint32_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    for (; *p >= '0' && *p <= '9'; p++) {
+        any = true;
+        if (digits < 9) {
+            mantissa = mantissa * 10 + (uint32_t)(*p - '0');
+            if (mantissa) digits++;
+        } else {
+            exponent++;
+        }
+    }
+    if (*p == '.') {
+        p++;
+        for (; *p >= '0' && *p <= '9'; p++) {
+            any = true;
+            if (digits < 9) {
+                mantissa = mantissa * 10 + (uint32_t)(*p - '0');
+                if (mantissa) digits++;
+                exponent--;
+            }
+        }
+    }
+    if (!any) return false;
+    if (*p == 'e' || *p == 'E') {
+        const char* e = p + 1;
+        bool expNegative = false;
+        if (*e == '+' || *e == '-') expNegative = *e++ == '-';
+        if (*e >= '0' && *e <= '9') {
+            int value = 0;
+            for (; *e >= '0' && *e <= '9'; e++) {
+                if (value < 100) value = value * 10 + (*e - '0');
+            }
+            exponent += expNegative ? -value : value;
+            p = e;
+        }
+    }
+
+    float value = (float)mantissa;
+    while (exponent > 10) {
+        value *= POW10[10];
+        exponent -= 10;
+    }
+    while (exponent < -10) {
+        value /= POW10[10];
+        exponent += 10;
+    }
+    value = exponent >= 0 ? value * POW10[exponent] : value / POW10[-exponent];
+    *out = negative ? -value : value;
+    *text = p;
+    return true;
+}
+
+// Exactly `count` numbers separated by `separator` (blanks allowed around
+// each), nothing after the last. Returns false otherwise.
+inline bool serial_parse_floats(const char* text, char separator, float* out, int count) {
+    const char* p = text;
+    for (int i = 0; i < count; i++) {
+        if (!serial_parse_float(&p, &out[i])) return false;
+        while (*p == ' ' || *p == '\t') p++;
+        if (i < count - 1) {
+            if (*p != separator) return false;
+            p++;
+        }
+    }
+    return *p == '\0';
+}
+
+#endif // SERIAL_COMMANDS_H
@@ -0,0 +1,259 @@
+/*
+ * Task Port - Portable tasks, bounded queues and clocks
+ *
+ * The smallest layer the dual-core pipeline needs, with two backends:
+ * - ESP32 (ESP_PLATFORM): FreeRTOS tasks pinned to a core, static queues
+ *   (no heap after construction), esp_timer clock
+ * - Host: std::thread (pinned with pthread affinity on Linux where the
+ *   core exists), mutex + condition variable ring, steady_clock (the
+ *   host shim's virtual clock when built with HOST_SHIM)
+ *
+ * The same pipeline code therefore runs on the device and in host stress
+ * tests (host_tools/pipeline_stress.cpp).
+ *
+ * Features:
+ * - PortQueue<T, N>: fixed-capacity copy-in/copy-out queue, send/receive
+ *   with timeouts (0 = poll, PORT_WAIT_FOREVER = block), depth and
+ *   high-water mark
+ * - PortTask: start(name, fn, arg, stack, priority, core); join() on the
+ *   host (device tasks run until reboot)
+ * - PortLock: short critical sections shared by both cores (spinlock on
+ *   the device, so never held across a blocking call; not for ISRs)
+ * - port_micros()/port_millis()/port_delay_ms()
+ *
+ * Usage:
+ *   PortQueue<TelemetryRecord, 8> queue;
+ *   PortTask net;
+ *   net.start("net", networkTask, nullptr, 12288, 1, 0);
+ *   queue.send(record, 0);                  // Producer core
+ *   queue.receive(record, 100);             // Consumer core
+ */
+
+#ifndef TASK_PORT_H
+#define TASK_PORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define PORT_WAIT_FOREVER 0xFFFFFFFFUL
+
+typedef void (*PortTaskFn)(void* arg);
+
+#if defined(ESP_PLATFORM)
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <esp_timer.h>
+
+inline uint32_t port_micros() { return (uint32_t)esp_timer_get_time(); }
+inline uint32_t port_millis() { return (uint32_t)(esp_timer_get_time() / 1000); }
+inline void port_delay_ms(uint32_t ms) { vTaskDelay(pdMS_TO_TICKS(ms)); }
+
+inline TickType_t port_ticks(uint32_t timeoutMs) {
+    return timeoutMs == PORT_WAIT_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+}
+
+template <typename T, size_t N>
+class PortQueue {
+private:
+    StaticQueue_t control;
+    uint8_t storage[N * sizeof(T)];
+    QueueHandle_t handle;
+    volatile uint32_t highWater;
+
+public:
+    PortQueue() : highWater(0) { handle = xQueueCreateStatic(N, sizeof(T), storage, &control); }
+
+    bool send(const T& item, uint32_t timeoutMs) {
+        if (xQueueSend(handle, &item, port_ticks(timeoutMs)) != pdTRUE) return false;
+        uint32_t depth = (uint32_t)uxQueueMessagesWaiting(handle);
+        if (depth > highWater) highWater = depth;
+        return true;
+    }
+
+    bool receive(T& item, uint32_t timeoutMs) {
+        return xQueueReceive(handle, &item, port_ticks(timeoutMs)) == pdTRUE;
+    }
+
+    size_t depth() const { return (size_t)uxQueueMessagesWaiting(handle); }
+    size_t capacity() const { return N; }
+    uint32_t getHighWater() const { return highWater; }
+};
+
+class PortTask {
+private:
+    TaskHandle_t handle;
+
+public:
+    PortTask() : handle(nullptr) {}
+
+    // stackBytes is in bytes (ESP-IDF convention); core < 0 = no affinity
+    bool start(const char* name, PortTaskFn fn, void* arg, uint32_t stackBytes, uint8_t priority, int core) {
+        BaseType_t ok = xTaskCreatePinnedToCore(fn, name, stackBytes, arg, priority, &handle,
+                                                core < 0 ? tskNO_AFFINITY : core);
+        return ok == pdPASS;
+    }
+
+    // Device tasks never return
+    void join() {}
+
+    uint32_t stackHighWater() const { return handle ? (uint32_t)uxTaskGetStackHighWaterMark(handle) : 0; }
+};
+
+inline int port_current_core() { return (int)xPortGetCoreID(); }
+
+class PortLock {
+private:
+    portMUX_TYPE mux;
+
+public:
+    PortLock() { portMUX_INITIALIZE(&mux); }
+    void lock() { portENTER_CRITICAL(&mux); }
+    void unlock() { portEXIT_CRITICAL(&mux); }
+};
+
+#else // Host backend
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(HOST_SHIM)
+#include <host_shim.h>
+
+// Native firmware build: the shim's virtual clock, so queues and task
+// delays speed up with the rest of the run
+inline uint64_t port_clock_us() { return host_clock_us(); }
+inline void port_delay_ms(uint32_t ms) { host_clock_sleep_ms(ms); }
+inline std::chrono::microseconds port_wait_duration(uint32_t timeoutMs) {
+    return std::chrono::microseconds(host_clock_real_us((uint64_t)timeoutMs * 1000));
+}
+#else
+inline uint64_t port_clock_us() {
+    static const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - origin).count();
+}
+inline void port_delay_ms(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+inline std::chrono::microseconds port_wait_duration(uint32_t timeoutMs) {
+    return std::chrono::milliseconds(timeoutMs);
+}
+#endif
+inline uint32_t port_micros() { return (uint32_t)port_clock_us(); }
+inline uint32_t port_millis() { return (uint32_t)(port_clock_us() / 1000); }
+
+template <typename T, size_t N>
+class PortQueue {
+private:
+    T items[N];
+    size_t head;
+    size_t count;
+    uint32_t highWater;
+    mutable std::mutex lock;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+
+    template <typename Predicate>
+    static bool wait(std::condition_variable& cv, std::unique_lock<std::mutex>& guard, uint32_t timeoutMs,
+                     Predicate ready) {
+        if (timeoutMs == PORT_WAIT_FOREVER) {
+            cv.wait(guard, ready);
+            return true;
+        }
+        return cv.wait_for(guard, port_wait_duration(timeoutMs), ready);
+    }
+
+public:
+    PortQueue() : head(0), count(0), highWater(0) {}
+
+    bool send(const T& item, uint32_t timeoutMs) {
+        std::unique_lock<std::mutex> guard(lock);
+        if (!wait(notFull, guard, timeoutMs, [this] { return count < N; })) return false;
+        items[(head + count) % N] = item;
+        count++;
+        if (count > highWater) highWater = (uint32_t)count;
+        guard.unlock();
+        notEmpty.notify_one();
+        return true;
+    }
+
+    bool receive(T& item, uint32_t timeoutMs) {
+        std::unique_lock<std::mutex> guard(lock);
+        if (!wait(notEmpty, guard, timeoutMs, [this] { return count > 0; })) return false;
+        item = items[head];
+        head = (head + 1) % N;
+        count--;
+        guard.unlock();
+        notFull.notify_one();
+        return true;
+    }
+
+    size_t depth() const {
+        std::lock_guard<std::mutex> guard(lock);
+        return count;
+    }
+    size_t capacity() const { return N; }
+    uint32_t getHighWater() const {
+        std::lock_guard<std::mutex> guard(lock);
+        return highWater;
+    }
+};
+
+class PortTask {
+private:
+    std::thread thread;
+
+public:
+    // stackBytes and priority are ignored; core pins the thread when the
+    // host has that many CPUs
+    bool start(const char* name, PortTaskFn fn, void* arg, uint32_t stackBytes, uint8_t priority, int core) {
+        (void)name;
+        (void)stackBytes;
+        (void)priority;
+        thread = std::thread(fn, arg);
+#if defined(__linux__)
+        if (core >= 0 && (unsigned)core < std::thread::hardware_concurrency()) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(core, &cpus);
+            pthread_setaffinity_np(thread.native_handle(), sizeof(cpus), &cpus);
+        }
+#else
+        (void)core;
+#endif
+        return true;
+    }
+
+    void join() {
+        if (thread.joinable()) thread.join();
+    }
+
+    uint32_t stackHighWater() const { return 0; }
+};
+
+inline int port_current_core() {
+#if defined(__linux__)
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+class PortLock {
+private:
+    std::mutex mutex;
+
+public:
+    void lock() { mutex.lock(); }
+    void unlock() { mutex.unlock(); }
+};
+
+#endif // ESP_PLATFORM
+
+#endif // TASK_PORT_H
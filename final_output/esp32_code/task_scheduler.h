@@ -0,0 +1,292 @@
+/*
+ * Task Scheduler - Cooperative timer wheel for loop() work
+ *
+ * Replaces the "if (now - last >= INTERVAL) { last = now; ... }" checks
+ * spread over the modules. `last = now` drifts: every run starts late by
+ * however long loop() took, and the lateness accumulates (a 1 s sampler
+ * that is 3 ms late each time loses a sample every ~5 minutes). Here a
+ * periodic task's next deadline is its previous deadline plus the period,
+ * so lateness never accumulates; if loop() stalls for several periods the
+ * missed runs are counted and skipped, not replayed in a burst.
+ *
+ * Timer wheel: TASK_WHEEL_SLOTS buckets of TASK_WHEEL_TICK_MS. A task sits
+ * in the bucket of its deadline (kept sorted by deadline, then by task id,
+ * so equal deadlines run in registration order); run() only looks at the
+ * buckets whose ticks have passed. Deadlines beyond one revolution stay in
+ * their bucket until their time comes.
+ *
+ * Features:
+ * - Drift-free periodic tasks, one-shot tasks, cancel from anywhere
+ *   (including the task itself)
+ * - Per-task deadline: runs later than this count as deadline misses
+ * - Per-task accounting: runs, skipped periods, lateness (jitter) mean/max,
+ *   CPU time mean/max; idle time for the whole loop
+ * - msUntilNext() so loop() can sleep until the next deadline
+ * - JSON export of the per-task figures
+ * - No Arduino dependencies: callers pass millis(), CPU time comes from a
+ *   microsecond clock given to the constructor
+ *
+ * Usage:
+ *   TaskScheduler scheduler(schedulerMicros);
+ *   scheduler.every("sensor", 1000, readSensorTask, &simulator, millis());
+ *   // loop():
+ *   scheduler.run(millis());
+ *   delay(scheduler.msUntilNext(millis()));
+ */
+
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#define TASK_MAX 16
+#define TASK_WHEEL_SLOTS 32              // Power of two
+#define TASK_WHEEL_TICK_MS 10            // One revolution = 320 ms
+#define TASK_NONE (-1)
+
+typedef void (*TaskFn)(void* context);
+typedef uint32_t (*TaskClockFn)();
+
+struct TaskStats {
+    uint32_t runs;
+    uint32_t skipped;          // Periods dropped after a stall
+    uint32_t deadlineMisses;   // Runs later than the task's deadline
+    uint32_t lateTotalMs;      // Start time minus deadline, summed
+    uint32_t lateMaxMs;
+    uint32_t cpuTotalUs;       // Time inside the task function
+    uint32_t cpuMaxUs;
+};
+
+struct ScheduledTask {
+    const char* name;
+    TaskFn fn;
+    void* context;
+    uint32_t periodMs;         // 0 = one-shot
+    uint32_t deadlineMs;       // Allowed lateness (0 = none)
+    uint32_t dueMs;
+    bool active;
+    int8_t next;               // Next task in the same wheel slot
+    TaskStats stats;
+};
+
+class TaskScheduler {
+private:
+    TaskClockFn cpuClock;
+    ScheduledTask tasks[TASK_MAX];
+    int taskCount;
+    int8_t slots[TASK_WHEEL_SLOTS];
+    uint32_t lastTick;         // Last tick fully processed
+    bool started;
+    uint32_t idleTotalMs;
+    uint32_t runCalls;
+
+public:
+    TaskScheduler(TaskClockFn microsFn) : cpuClock(microsFn), taskCount(0), lastTick(0), started(false),
+                                          idleTotalMs(0), runCalls(0) {
+        for (int i = 0; i < TASK_WHEEL_SLOTS; i++) slots[i] = TASK_NONE;
+    }
+
+    // Periodic task, first run after `firstDelayMs` (default: one period).
+    // Returns the task id, or TASK_NONE when the table is full.
+    int every(const char* name, uint32_t periodMs, TaskFn fn, void* context, uint32_t now,
+              uint32_t deadlineMs = 0, int32_t firstDelayMs = -1) {
+        if (periodMs == 0) return TASK_NONE;
+        return add(name, periodMs, fn, context, now + (firstDelayMs >= 0 ? (uint32_t)firstDelayMs : periodMs),
+                   deadlineMs);
+    }
+
+    // One-shot task
+    int after(const char* name, uint32_t delayMs, TaskFn fn, void* context, uint32_t now,
+              uint32_t deadlineMs = 0) {
+        return add(name, 0, fn, context, now + delayMs, deadlineMs);
+    }
+
+    // Stop a task (safe from inside its own function). The id may be
+    // reused by a later every()/after().
+    void cancel(int id) {
+        if (id < 0 || id >= taskCount || !tasks[id].active) return;
+        unlink(id);
+        tasks[id].active = false;
+    }
+
+    bool isActive(int id) const { return id >= 0 && id < taskCount && tasks[id].active; }
+
+    // Run every task whose deadline has passed (earliest first; each task
+    // at most once per call). Returns the number of tasks run.
+    int run(uint32_t now) {
+        uint32_t nowTick = now / TASK_WHEEL_TICK_MS;
+        if (!started) {
+            lastTick = nowTick - 1;
+            started = true;
+        }
+        runCalls++;
+        int ran = 0;
+        uint32_t ticks = nowTick - lastTick;
+        if (ticks > TASK_WHEEL_SLOTS) {
+            ticks = TASK_WHEEL_SLOTS;   // Stalled for a revolution or more: every slot once
+        }
+        // Tasks due later in a revisited slot (or re-added behind the scan)
+        // wait for the next call
+        uint32_t firstTick = nowTick - ticks + 1;
+        int8_t ranMark[TASK_MAX] = { 0 };
+        for (uint32_t tick = firstTick; tick != nowTick + 1; tick++) {
+            int8_t* link = &slots[tick & (TASK_WHEEL_SLOTS - 1)];
+            while (*link != TASK_NONE) {
+                int id = *link;
+                ScheduledTask& t = tasks[id];
+                if ((int32_t)(now - t.dueMs) < 0 || ranMark[id]) {
+                    link = &t.next;
+                    continue;
+                }
+                *link = t.next;         // Pop before running: the task may cancel itself
+                t.next = TASK_NONE;
+                ranMark[id] = 1;
+                execute(id, now);
+                ran++;
+                if (t.active) {
+                    insert(id);
+                }
+            }
+        }
+        // Keep the current tick open: tasks due later in it run next call
+        lastTick = nowTick - 1;
+        return ran;
+    }
+
+    // Milliseconds until the earliest deadline (0 = overdue, UINT32_MAX = no tasks)
+    uint32_t msUntilNext(uint32_t now) const {
+        uint32_t best = UINT32_MAX;
+        for (int i = 0; i < taskCount; i++) {
+            if (!tasks[i].active) continue;
+            int32_t left = (int32_t)(tasks[i].dueMs - now);
+            uint32_t wait = left > 0 ? (uint32_t)left : 0;
+            if (wait < best) best = wait;
+        }
+        return best;
+    }
+
+    // loop() slept this long (for the utilisation figure)
+    void addIdle(uint32_t ms) { idleTotalMs += ms; }
+    uint32_t getIdleMs() const { return idleTotalMs; }
+    uint32_t getRunCalls() const { return runCalls; }
+
+    int getTaskCount() const { return taskCount; }
+    const ScheduledTask& getTask(int id) const { return tasks[id]; }
+
+    // Mean lateness of a task in ms (jitter against its ideal timeline)
+    static float meanLateMs(const TaskStats& s) { return s.runs ? (float)s.lateTotalMs / s.runs : 0.0f; }
+    static float meanCpuUs(const TaskStats& s) { return s.runs ? (float)s.cpuTotalUs / s.runs : 0.0f; }
+
+    // {"idle_ms":n,"run_calls":n,"tasks":{"sensor":{"period":n,"runs":n,"skipped":n,"misses":n,
+    //  "late_avg":x,"late_max":n,"cpu_avg_us":x,"cpu_max_us":n},...}} (active tasks only)
+    int encodeJson(char* out, size_t size) const {
+        size_t used = 0;
+        int written = snprintf(out, size, "{\"idle_ms\":%lu,\"run_calls\":%lu,\"tasks\":{",
+                               (unsigned long)idleTotalMs, (unsigned long)runCalls);
+        if (!advance(written, size, used)) return -1;
+        bool first = true;
+        for (int i = 0; i < taskCount; i++) {
+            const ScheduledTask& t = tasks[i];
+            if (!t.active) continue;
+            written = snprintf(out + used, size - used,
+                               "%s\"%s\":{\"period\":%lu,\"runs\":%lu,\"skipped\":%lu,\"misses\":%lu,"
+                               "\"late_avg\":%.2f,\"late_max\":%lu,\"cpu_avg_us\":%.1f,\"cpu_max_us\":%lu}",
+                               first ? "" : ",", t.name, (unsigned long)t.periodMs, (unsigned long)t.stats.runs,
+                               (unsigned long)t.stats.skipped, (unsigned long)t.stats.deadlineMisses,
+                               meanLateMs(t.stats), (unsigned long)t.stats.lateMaxMs, meanCpuUs(t.stats),
+                               (unsigned long)t.stats.cpuMaxUs);
+            if (!advance(written, size, used)) return -1;
+            first = false;
+        }
+        written = snprintf(out + used, size - used, "}}");
+        if (!advance(written, size, used)) return -1;
+        return (int)used;
+    }
+
+private:
+    int add(const char* name, uint32_t periodMs, TaskFn fn, void* context, uint32_t dueMs, uint32_t deadlineMs) {
+        int id = TASK_NONE;
+        for (int i = 0; i < taskCount; i++) {
+            if (!tasks[i].active) {
+                id = i;
+                break;
+            }
+        }
+        if (id == TASK_NONE) {
+            if (taskCount >= TASK_MAX) return TASK_NONE;
+            id = taskCount++;
+        }
+        ScheduledTask& t = tasks[id];
+        t.name = name;
+        t.fn = fn;
+        t.context = context;
+        t.periodMs = periodMs;
+        t.deadlineMs = deadlineMs;
+        t.dueMs = dueMs;
+        t.active = true;
+        t.next = TASK_NONE;
+        t.stats = TaskStats();
+        insert(id);
+        return id;
+    }
+
+    void execute(int id, uint32_t now) {
+        ScheduledTask& t = tasks[id];
+        uint32_t late = now - t.dueMs;
+        t.stats.runs++;
+        t.stats.lateTotalMs += late;
+        if (late > t.stats.lateMaxMs) t.stats.lateMaxMs = late;
+        if (t.deadlineMs > 0 && late > t.deadlineMs) t.stats.deadlineMisses++;
+
+        if (t.periodMs > 0) {
+            // Next deadline on the ideal timeline; drop periods already missed
+            uint32_t missed = late / t.periodMs;
+            t.stats.skipped += missed;
+            t.dueMs += (missed + 1) * t.periodMs;
+        } else {
+            t.active = false;
+        }
+
+        uint32_t start = cpuClock();
+        t.fn(t.context);
+        uint32_t cpu = cpuClock() - start;
+        t.stats.cpuTotalUs += cpu;
+        if (cpu > t.stats.cpuMaxUs) t.stats.cpuMaxUs = cpu;
+    }
+
+    // Sorted insert into the deadline's slot (deadline, then id)
+    void insert(int id) {
+        ScheduledTask& t = tasks[id];
+        int8_t* link = &slots[(t.dueMs / TASK_WHEEL_TICK_MS) & (TASK_WHEEL_SLOTS - 1)];
+        while (*link != TASK_NONE) {
+            const ScheduledTask& other = tasks[*link];
+            int32_t order = (int32_t)(other.dueMs - t.dueMs);
+            if (order > 0 || (order == 0 && *link > id)) break;
+            link = &tasks[*link].next;
+        }
+        t.next = *link;
+        *link = (int8_t)id;
+    }
+
+    void unlink(int id) {
+        int8_t* link = &slots[(tasks[id].dueMs / TASK_WHEEL_TICK_MS) & (TASK_WHEEL_SLOTS - 1)];
+        while (*link != TASK_NONE) {
+            if (*link == id) {
+                *link = tasks[id].next;
+                tasks[id].next = TASK_NONE;
+                return;
+            }
+            link = &tasks[*link].next;
+        }
+    }
+
+    static bool advance(int written, size_t size, size_t& used) {
+        if (written < 0 || used + (size_t)written >= size) return false;
+        used += (size_t)written;
+        return true;
+    }
+};
+
+#endif // TASK_SCHEDULER_H
@@ -0,0 +1,271 @@
+/*
+ * Telemetry Codec - Compact Binary Framing for TelemetryRecord
+ *
+ * Replaces the text payloads (ThingSpeak URL ~95 B, Firebase JSON ~230 B)
+ * with ~20 B per record on the link to a local collector.
+ * Shared by the ESP32 (CollectorSink) and the host collector daemon.
+ *
+ * Frame Layout (little endian):
+ *   Offset  Size  Field
+ *   0       2     Magic 'W','T'
+ *   2       1     Version (1)
+ *   3       1     Flags (bit0 = votes present)
+ *   4       6     Device ID (MAC bytes)
+ *   10      2     Sequence number
+ *   12      8     Base timestamp (ms)
+ *   20      1     Record count
+ *   21      ...   Records
+ *   end-2   2     CRC-16/CCITT over everything before it
+ *
+ * Record Layout (varints are LEB128, signed values zigzag-encoded):
+ *   varint  Δ timestamp (ms, vs previous record / base)
+ *   svarint temperature  (0.01 °C)
+ *   svarint humidity     (0.01 %)
+ *   svarint pressure     (0.1 Pa)
+ *   svarint lux          (0.01 lux)
+ *   svarint gas          (0.01 PPM)
+ *   u8      class id
+ *   5 x u8  votes        (only if flags bit0)
+ *   varint  inference time (µs)
+ *   i8      RSSI (dBm)
+ *
+ * Stream transports (TCP) prefix every frame with its u16 length.
+ */
+
+#ifndef TELEMETRY_CODEC_H
+#define TELEMETRY_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include "telemetry_record.h"
+
+#define TELEMETRY_FRAME_MAGIC0 'W'
+#define TELEMETRY_FRAME_MAGIC1 'T'
+#define TELEMETRY_FRAME_VERSION 1
+#define TELEMETRY_FRAME_HEADER_SIZE 21
+#define TELEMETRY_FRAME_CRC_SIZE 2
+#define TELEMETRY_FRAME_MAX_RECORD_SIZE 72   // Worst case (all varints at max length)
+#define TELEMETRY_FRAME_FLAG_VOTES 0x01
+
+// Decoder error codes
+#define TELEMETRY_DECODE_TRUNCATED  (-1)
+#define TELEMETRY_DECODE_BAD_MAGIC  (-2)
+#define TELEMETRY_DECODE_BAD_CRC    (-3)
+#define TELEMETRY_DECODE_OVERFLOW   (-4)
+
+struct TelemetryFrameHeader {
+    uint8_t deviceId[6];
+    uint16_t sequence;
+    uint64_t baseTimestampMs;
+    uint8_t flags;
+    uint8_t recordCount;
+};
+
+// ==================== PRIMITIVES ====================
+inline uint16_t telemetry_crc16(const uint8_t* data, size_t length) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+inline size_t telemetry_put_varint(uint8_t* out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+inline size_t telemetry_get_varint(const uint8_t* in, size_t available, uint64_t& value) {
+    value = 0;
+    for (size_t n = 0; n < available && n < 10; n++) {
+        value |= (uint64_t)(in[n] & 0x7F) << (7 * n);
+        if ((in[n] & 0x80) == 0) return n + 1;
+    }
+    return 0;   // Truncated or over-long
+}
+
+inline uint64_t telemetry_zigzag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+inline int64_t telemetry_unzigzag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+inline int64_t telemetry_to_fixed(float value, float scale) {
+    return (int64_t)llroundf(value * scale);
+}
+
+// ==================== ENCODER ====================
+class TelemetryFrameEncoder {
+private:
+    uint8_t* buffer;
+    size_t capacity;
+    size_t position;
+    uint8_t count;
+    uint8_t flags;
+    uint64_t lastTimestampMs;
+
+public:
+    TelemetryFrameEncoder(uint8_t* out, size_t size)
+        : buffer(out), capacity(size), position(0), count(0), flags(0), lastTimestampMs(0) {}
+
+    // Start a new frame (base timestamp = first record's timestamp)
+    void begin(const uint8_t deviceId[6], uint16_t sequence, uint64_t baseTimestampMs,
+               uint8_t frameFlags = TELEMETRY_FRAME_FLAG_VOTES) {
+        flags = frameFlags;
+        count = 0;
+        lastTimestampMs = baseTimestampMs;
+
+        buffer[0] = TELEMETRY_FRAME_MAGIC0;
+        buffer[1] = TELEMETRY_FRAME_MAGIC1;
+        buffer[2] = TELEMETRY_FRAME_VERSION;
+        buffer[3] = flags;
+        memcpy(&buffer[4], deviceId, 6);
+        buffer[10] = (uint8_t)sequence;
+        buffer[11] = (uint8_t)(sequence >> 8);
+        for (int i = 0; i < 8; i++) {
+            buffer[12 + i] = (uint8_t)(baseTimestampMs >> (8 * i));
+        }
+        buffer[20] = 0;
+        position = TELEMETRY_FRAME_HEADER_SIZE;
+    }
+
+    // Append one record. Returns false (frame unchanged) when it does not fit.
+    bool add(const TelemetryRecord& r) {
+        if (count == 255 ||
+            position + TELEMETRY_FRAME_MAX_RECORD_SIZE + TELEMETRY_FRAME_CRC_SIZE > capacity) {
+            return false;
+        }
+        if (r.timestampMs < lastTimestampMs) {
+            return false;   // Timestamps must be monotonic inside a frame
+        }
+
+        uint8_t* out = buffer + position;
+        size_t n = 0;
+        n += telemetry_put_varint(out + n, r.timestampMs - lastTimestampMs);
+        n += telemetry_put_varint(out + n, telemetry_zigzag(telemetry_to_fixed(r.temperature, 100.0f)));
+        n += telemetry_put_varint(out + n, telemetry_zigzag(telemetry_to_fixed(r.humidity, 100.0f)));
+        n += telemetry_put_varint(out + n, telemetry_zigzag(telemetry_to_fixed(r.pressure, 10.0f)));
+        n += telemetry_put_varint(out + n, telemetry_zigzag(telemetry_to_fixed(r.lux, 100.0f)));
+        n += telemetry_put_varint(out + n, telemetry_zigzag(telemetry_to_fixed(r.gas, 100.0f)));
+        out[n++] = r.predictedClass;
+        if (flags & TELEMETRY_FRAME_FLAG_VOTES) {
+            memcpy(out + n, r.votes, TELEMETRY_NUM_CLASSES);
+            n += TELEMETRY_NUM_CLASSES;
+        }
+        n += telemetry_put_varint(out + n, r.inferenceTime);
+        out[n++] = (uint8_t)r.rssi;
+
+        position += n;
+        lastTimestampMs = r.timestampMs;
+        count++;
+        return true;
+    }
+
+    // Close the frame (count + CRC). Returns total frame length.
+    size_t finish() {
+        buffer[20] = count;
+        uint16_t crc = telemetry_crc16(buffer, position);
+        buffer[position++] = (uint8_t)crc;
+        buffer[position++] = (uint8_t)(crc >> 8);
+        return position;
+    }
+
+    uint8_t recordCount() const { return count; }
+    size_t size() const { return position; }
+};
+
+// ==================== DECODER ====================
+// Returns the number of records written to `records`, or a negative
+// TELEMETRY_DECODE_* error.
+inline int telemetry_decode_frame(const uint8_t* frame, size_t length,
+                                  TelemetryFrameHeader& header,
+                                  TelemetryRecord* records, int maxRecords) {
+    if (length < TELEMETRY_FRAME_HEADER_SIZE + TELEMETRY_FRAME_CRC_SIZE) {
+        return TELEMETRY_DECODE_TRUNCATED;
+    }
+    if (frame[0] != TELEMETRY_FRAME_MAGIC0 || frame[1] != TELEMETRY_FRAME_MAGIC1 ||
+        frame[2] != TELEMETRY_FRAME_VERSION) {
+        return TELEMETRY_DECODE_BAD_MAGIC;
+    }
+    uint16_t crc = (uint16_t)frame[length - 2] | ((uint16_t)frame[length - 1] << 8);
+    if (telemetry_crc16(frame, length - TELEMETRY_FRAME_CRC_SIZE) != crc) {
+        return TELEMETRY_DECODE_BAD_CRC;
+    }
+
+    header.flags = frame[3];
+    memcpy(header.deviceId, &frame[4], 6);
+    header.sequence = (uint16_t)frame[10] | ((uint16_t)frame[11] << 8);
+    header.baseTimestampMs = 0;
+    for (int i = 0; i < 8; i++) {
+        header.baseTimestampMs |= (uint64_t)frame[12 + i] << (8 * i);
+    }
+    header.recordCount = frame[20];
+    if (header.recordCount > maxRecords) {
+        return TELEMETRY_DECODE_OVERFLOW;
+    }
+
+    const uint8_t* in = frame + TELEMETRY_FRAME_HEADER_SIZE;
+    const uint8_t* end = frame + length - TELEMETRY_FRAME_CRC_SIZE;
+    uint64_t timestamp = header.baseTimestampMs;
+    uint64_t v;
+    size_t n;
+
+#define TELEMETRY_READ_VARINT()                                    \
+    do {                                                           \
+        n = telemetry_get_varint(in, (size_t)(end - in), v);       \
+        if (n == 0) return TELEMETRY_DECODE_TRUNCATED;             \
+        in += n;                                                   \
+    } while (0)
+
+    for (int i = 0; i < header.recordCount; i++) {
+        TelemetryRecord& r = records[i];
+
+        TELEMETRY_READ_VARINT();
+        timestamp += v;
+        r.timestampMs = timestamp;
+        r.epochMs = 0;      // Not on the wire
+        TELEMETRY_READ_VARINT();
+        r.temperature = telemetry_unzigzag(v) / 100.0f;
+        TELEMETRY_READ_VARINT();
+        r.humidity = telemetry_unzigzag(v) / 100.0f;
+        TELEMETRY_READ_VARINT();
+        r.pressure = telemetry_unzigzag(v) / 10.0f;
+        TELEMETRY_READ_VARINT();
+        r.lux = telemetry_unzigzag(v) / 100.0f;
+        TELEMETRY_READ_VARINT();
+        r.gas = telemetry_unzigzag(v) / 100.0f;
+
+        size_t fixedBytes = 1 + ((header.flags & TELEMETRY_FRAME_FLAG_VOTES) ? TELEMETRY_NUM_CLASSES : 0);
+        if ((size_t)(end - in) < fixedBytes) return TELEMETRY_DECODE_TRUNCATED;
+        r.predictedClass = *in++;
+        if (header.flags & TELEMETRY_FRAME_FLAG_VOTES) {
+            memcpy(r.votes, in, TELEMETRY_NUM_CLASSES);
+            in += TELEMETRY_NUM_CLASSES;
+        } else {
+            memset(r.votes, 0, TELEMETRY_NUM_CLASSES);
+        }
+
+        TELEMETRY_READ_VARINT();
+        r.inferenceTime = (uint32_t)v;
+        if (in >= end) return TELEMETRY_DECODE_TRUNCATED;
+        r.rssi = (int8_t)*in++;
+    }
+
+#undef TELEMETRY_READ_VARINT
+
+    return header.recordCount;
+}
+
+#endif // TELEMETRY_CODEC_H
@@ -0,0 +1,659 @@
+/*
+ * Telemetry Dispatcher - Fan-out of one record to every cloud sink
+ *
+ * Features:
+ * - Pluggable sink interface (ThingSpeak, Firebase, local file, ...)
+ * - Record is encoded lazily, once per wire format, then shared by all sinks
+ * - Uploads paced by rate_scheduler.h: per-sink token buckets + a global
+ *   budget, priorities, newest record wins while a sink waits for a token
+ * - Optional report-by-exception (report_by_exception.h) for change-driven
+ *   sinks: only class changes, deadband crossings and heartbeats go out
+ * - Records are stamped with epoch ms from an EpochClock (time_service.h)
+ *   before any sink sees them
+ * - Per-sink circuit breakers (circuit_breaker.h): an open breaker makes
+ *   its sink not-ready, so the record waits instead of hitting a dead
+ *   backend; transitions are logged and exported with the latency stats
+ * - Per-sink statistics (published / failed / skipped, time spent,
+ *   deferrals, coalesced records, budget utilisation)
+ * - Rolling latency windows (latency_window.h): inference, loop and upload
+ *   histograms per reporting window; each closed window's summary goes to
+ *   every sink (ThingSpeak status, Firebase latency node, MQTT topic)
+ * - Built-in benchmark of per-record CPU and heap cost
+ * - Per-upload outcomes logged through deferred_log.h
+ *
+ * Usage:
+ *   TelemetryDispatcher telemetry;
+ *   telemetry.addSink(&thingSpeakSink, RATE_PRIORITY_NORMAL, 15000);   // 1 per 15 s
+ *   telemetry.addSink(&localFileSink, RATE_PRIORITY_HIGH);              // unlimited
+ *   telemetry.dispatch(record);
+ *   telemetry.poll();   // from loop(): sends records once tokens free up
+ *   telemetry.loopIteration(ran > 0, busyUs);   // end of every loop() iteration
+ */
+
+#ifndef TELEMETRY_DISPATCHER_H
+#define TELEMETRY_DISPATCHER_H
+
+#include <Arduino.h>
+#include "telemetry_record.h"
+#include "rate_scheduler.h"
+#include "net_latency.h"
+#include "report_by_exception.h"
+#include "gorilla_block.h"
+#include "epoch_clock.h"
+#include "circuit_breaker.h"
+#include "deferred_log.h"
+#include "latency_window.h"
+
+#define TELEMETRY_MAX_SINKS 6
+
+// Global upload budget shared by all rate-limited sinks
+#define TELEMETRY_GLOBAL_INTERVAL_MS 5000   // One cloud upload per 5 s on average...
+#define TELEMETRY_GLOBAL_BURST 3            // ...with up to 3 back-to-back
+
+// Network latency histograms exported to sinks that accept diagnostics
+#define TELEMETRY_DIAGNOSTICS_INTERVAL_MS 300000   // 5 minutes
+#define TELEMETRY_DIAGNOSTICS_SIZE 2048
+
+// Reporting window of the inference/loop/upload latency summaries
+#ifndef TELEMETRY_LATENCY_WINDOW_MS
+#define TELEMETRY_LATENCY_WINDOW_MS LATENCY_WINDOW_MS
+#endif
+
+// ==================== SINK INTERFACE ====================
+class TelemetrySink {
+public:
+    virtual ~TelemetrySink() {}
+
+    // Short display name ("ThingSpeak", "Firebase", ...)
+    virtual const char* name() = 0;
+
+    // False when the backend cannot accept data right now (no WiFi, not initialized)
+    virtual bool isReady() = 0;
+
+    // Publish one record. Sinks pull the encoding they need from the payload.
+    virtual bool publish(TelemetryPayload& payload) = 0;
+
+    // Every record, before report-by-exception and rate limiting (rollups)
+    virtual void observe(const TelemetryRecord& record) {}
+
+    // Background work between records (flush batches, read acks, keep-alive)
+    virtual void poll() {}
+
+    // Per-phase upload timing, if the sink measures it
+    virtual const NetLatencyStats* latencyStats() { return nullptr; }
+
+    // Breaker guarding the sink's backend, if any (isReady() reports false
+    // while it is open)
+    virtual CircuitBreaker* circuitBreaker() { return nullptr; }
+
+    // Accept a diagnostics JSON document (network latency export)
+    virtual bool publishDiagnostics(const char* json) { return false; }
+
+    // Route the sink's per-operation upload times to the dispatcher's
+    // latency window (sinks that time their uploads)
+    virtual void setUploadListener(NetOperationListener fn, void* context) {}
+
+    // A reporting window closed: ship its summary with the next upload
+    virtual void publishLatencyWindow(const LatencyWindowReport& report) {}
+};
+
+// Breaker transitions on the serial log (one line each)
+static void telemetryBreakerLog(const CircuitBreaker& breaker, BreakerState from, BreakerState to) {
+    Serial.printf("\n🔌 %s circuit: %s → %s", breaker.name(), BREAKER_STATE_NAMES[from], BREAKER_STATE_NAMES[to]);
+    if (to == BREAKER_OPEN) {
+        Serial.printf(" (next probe in %lu s)", (unsigned long)breaker.getOpenPeriod() / 1000);
+    }
+    Serial.println();
+}
+
+// ==================== DISPATCHER ====================
+class TelemetryDispatcher {
+private:
+    struct SinkStats {
+        unsigned long published;
+        unsigned long failed;
+        unsigned long skipped;
+        unsigned long totalMicros;
+    };
+
+    TelemetrySink* sinks[TELEMETRY_MAX_SINKS];
+    SinkStats stats[TELEMETRY_MAX_SINKS];
+    int sinkCount;
+
+    RateScheduler scheduler;
+    bool budgetConfigured;
+
+    // Report-by-exception applies only to sinks registered as change-driven
+    ReportByException* exceptionFilter;
+    bool changeDriven[TELEMETRY_MAX_SINKS];
+
+    // Latest record. Every waiting sink sends this one (older records are
+    // coalesced away), so a single payload serves all of them.
+    TelemetryPayload payload;
+    const char* deviceId;
+    const EpochClock* epochClock;
+
+    unsigned long totalRecords;
+    unsigned long totalEncodes;
+    unsigned long lastDiagnosticsMs;
+
+    // Inference and upload are recorded on the dispatching core, loop on
+    // the loop() core (see loopIteration)
+    LatencyWindow latencyWindow;
+    LatencyWindowReport lastLatencyReport;
+    unsigned long latencyReports;
+
+    static void onUpload(uint32_t totalUs, bool ok, void* context) {
+        static_cast<TelemetryDispatcher*>(context)->latencyWindow.record(LATENCY_METRIC_UPLOAD, totalUs, millis());
+    }
+
+public:
+    TelemetryDispatcher() : latencyWindow(TELEMETRY_LATENCY_WINDOW_MS) {
+        sinkCount = 0;
+        budgetConfigured = false;
+        exceptionFilter = nullptr;
+        deviceId = "";
+        epochClock = nullptr;
+        totalRecords = 0;
+        totalEncodes = 0;
+        lastDiagnosticsMs = 0;
+        memset(&lastLatencyReport, 0, sizeof(lastLatencyReport));
+        latencyReports = 0;
+        for (int i = 0; i < TELEMETRY_MAX_SINKS; i++) {
+            sinks[i] = nullptr;
+            changeDriven[i] = false;
+            memset(&stats[i], 0, sizeof(SinkStats));
+        }
+    }
+
+    // intervalMs = minimum spacing between uploads (0 = unlimited),
+    // burst = uploads allowed back-to-back after an idle period,
+    // changeDriven = only receives records the exception filter reports
+    bool addSink(TelemetrySink* sink, uint8_t priority = RATE_PRIORITY_NORMAL,
+                 uint32_t intervalMs = 0, uint16_t burst = 1, bool changeDrivenSink = false) {
+        if (sink == nullptr || sinkCount >= TELEMETRY_MAX_SINKS) {
+            return false;
+        }
+        if (!budgetConfigured) {
+            setGlobalBudget(TELEMETRY_GLOBAL_INTERVAL_MS, TELEMETRY_GLOBAL_BURST);
+        }
+        if (scheduler.addSlot(priority, intervalMs, burst, millis()) < 0) {
+            return false;
+        }
+        if (sink->circuitBreaker() != nullptr) {
+            sink->circuitBreaker()->setListener(telemetryBreakerLog);
+        }
+        sink->setUploadListener(onUpload, this);
+        changeDriven[sinkCount] = changeDrivenSink;
+        sinks[sinkCount++] = sink;
+        return true;
+    }
+
+    // nullptr disables report-by-exception (every record goes to every sink)
+    void setExceptionFilter(ReportByException* filter) {
+        exceptionFilter = filter;
+    }
+
+    void setGlobalBudget(uint32_t intervalMs, uint16_t burst) {
+        scheduler.setGlobalBudget(intervalMs, burst, millis());
+        budgetConfigured = true;
+    }
+
+    // Device ID embedded in JSON payloads (pointer must stay valid)
+    void setDeviceID(const char* id) {
+        deviceId = id ? id : "";
+    }
+
+    // Wall clock for TelemetryRecord::epochMs (nullptr: records keep epoch 0)
+    void setClock(const EpochClock* clock) {
+        epochClock = clock;
+    }
+
+    // Hand one record to every sink, then upload wherever a token is free.
+    // Sinks still waiting get this record instead of the older one.
+    void dispatch(const TelemetryRecord& source) {
+        TelemetryRecord record = source;
+        record.epochMs = epochClock != nullptr ? epochClock->toEpochMs((uint32_t)source.timestampMs) : 0;
+        totalEncodes += payload.getEncodeCount();
+        payload.reset(record, deviceId);
+        totalRecords++;
+        latencyWindow.record(LATENCY_METRIC_INFERENCE, record.inferenceTime, millis());
+        for (int i = 0; i < sinkCount; i++) {
+            sinks[i]->observe(record);
+        }
+
+        uint32_t now = millis();
+        bool report = true;
+        if (exceptionFilter != nullptr) {
+            report = exceptionFilter->evaluate(record, now) != RBE_SUPPRESSED;
+        }
+
+        bool rebase = false;
+        for (int i = 0; i < sinkCount; i++) {
+            if (report || !changeDriven[i]) {
+                scheduler.offer(i, now);
+            } else if (scheduler.isPending(i)) {
+                // Waiting sink will send this newer record instead
+                scheduler.offer(i, now);
+                rebase = true;
+            }
+        }
+        if (rebase) {
+            exceptionFilter->rebase(record);
+        }
+        if (!report) {
+            LOG(LOG_MSG_RBE_SUPPRESSED);
+        }
+        service(true);
+    }
+
+    // Upload pending records whose sinks have tokens (highest priority first).
+    // Returns number of successful uploads.
+    int service(bool announce = false) {
+        bool ready[TELEMETRY_MAX_SINKS];
+        bool anyPending = false;
+        for (int i = 0; i < sinkCount; i++) {
+            ready[i] = scheduler.isPending(i);
+            anyPending = anyPending || ready[i];
+        }
+        if (!anyPending) return 0;
+
+        // Offline sinks keep their record until they come back
+        for (int i = 0; i < sinkCount; i++) {
+            if (ready[i] && !sinks[i]->isReady()) {
+                ready[i] = false;
+                if (announce) stats[i].skipped++;
+            }
+        }
+
+        int delivered = 0;
+        int attempted = 0;
+        int index;
+        while ((index = scheduler.next(millis(), ready)) >= 0) {
+            attempted++;
+            TelemetrySink* sink = sinks[index];
+
+            unsigned long start = micros();
+            bool ok = sink->publish(payload);
+            stats[index].totalMicros += micros() - start;
+            scheduler.complete(index, millis(), ok);
+            ready[index] = false;   // One attempt per sink per service call
+
+            if (ok) {
+                stats[index].published++;
+                delivered++;
+            } else {
+                stats[index].failed++;
+            }
+            LOG(LOG_MSG_SINK_RESULT, sink->name(), ok ? "ok" : "failed");
+        }
+
+        if (announce || attempted > 0) {
+            for (int i = 0; i < sinkCount; i++) {
+                if (scheduler.isPending(i)) {
+                    LOG(LOG_MSG_SINK_WAITING, sinks[i]->name(), sinks[i]->isReady() ? "pending" : "offline");
+                }
+            }
+        }
+        return delivered;
+    }
+
+    // Call from loop(): sends deferred records as tokens refill and keeps
+    // sinks with persistent connections serviced
+    void poll() {
+        service();
+        for (int i = 0; i < sinkCount; i++) {
+            sinks[i]->poll();
+        }
+        if (millis() - lastDiagnosticsMs >= TELEMETRY_DIAGNOSTICS_INTERVAL_MS) {
+            lastDiagnosticsMs = millis();
+            exportDiagnostics();
+        }
+        serviceLatencyWindow();
+    }
+
+    // ==================== LATENCY WINDOW ====================
+    // loop() core only, every iteration: records the busy time of
+    // iterations that ran a task; idle ones only keep the window on time
+    void loopIteration(bool ranTask, uint32_t busyUs) {
+        if (ranTask) {
+            latencyWindow.record(LATENCY_METRIC_LOOP, busyUs, millis());
+        } else {
+            latencyWindow.advance(LATENCY_METRIC_LOOP, millis());
+        }
+    }
+
+    // Latest closed window (n = 0 everywhere before the first one)
+    const LatencyWindowReport& getLastLatencyReport() { return lastLatencyReport; }
+    unsigned long getLatencyReports() { return latencyReports; }
+
+    void printLatencyWindow() {
+        char p50[12], p90[12], p99[12], max[12];
+        const LatencyWindowReport& r = lastLatencyReport;
+        Serial.printf("\n⏱️  Latency Window (%lu s, reports sent: %lu):\n",
+                      (unsigned long)latencyWindow.getWindowMs() / 1000, latencyReports);
+        Serial.println("─────────────────────────────────────────────────────────");
+        if (latencyReports == 0) {
+            Serial.printf("   (first window closes at %lu s uptime)\n",
+                          (unsigned long)(latencyWindow.getWindowMs() + LATENCY_WINDOW_GRACE_MS) / 1000);
+        } else {
+            Serial.printf("   Window at %lu s uptime\n", (unsigned long)r.startMs / 1000);
+            Serial.println("   Metric         n      p50      p90      p99      max");
+            for (int m = 0; m < LATENCY_METRIC_COUNT; m++) {
+                const LatencySummary& s = r.metrics[m];
+                Serial.printf("   %-9s %6lu %8s %8s %8s %8s\n", LATENCY_METRIC_NAMES[m], (unsigned long)s.count,
+                              latency_format_us(s.p50, p50, sizeof(p50)), latency_format_us(s.p90, p90, sizeof(p90)),
+                              latency_format_us(s.p99, p99, sizeof(p99)), latency_format_us(s.max, max, sizeof(max)));
+            }
+        }
+        Serial.println("─────────────────────────────────────────────────────────");
+    }
+
+    // ==================== NETWORK LATENCY ====================
+    // {"ThingSpeak":{"dns":{...},...,"breaker":{...}},"Firebase":{...}} for
+    // every timed sink or sink with a breaker
+    int encodeNetworkStats(char* out, size_t size) {
+        size_t used = 0;
+        if (size < 3) return -1;
+        out[used++] = '{';
+        bool first = true;
+        for (int i = 0; i < sinkCount; i++) {
+            const NetLatencyStats* latency = sinks[i]->latencyStats();
+            const CircuitBreaker* breaker = sinks[i]->circuitBreaker();
+            if (latency == nullptr && breaker == nullptr) continue;
+            int written = snprintf(out + used, size - used, "%s\"%s\":", first ? "" : ",", sinks[i]->name());
+            if (written < 0 || (size_t)written >= size - used) return -1;
+            used += written;
+            if (latency != nullptr) {
+                written = latency->encodeJson(out + used, size - used);
+                if (written < 0) return -1;
+                used += written;
+            } else {
+                written = snprintf(out + used, size - used, "{}");
+                if (written < 0 || (size_t)written >= size - used) return -1;
+                used += written;
+            }
+            if (breaker != nullptr) {
+                // Reopen the sink object: ...} -> ...,"breaker":{...}}
+                bool empty = out[used - 2] == '{';
+                used--;
+                written = snprintf(out + used, size - used, "%s\"breaker\":", empty ? "" : ",");
+                if (written < 0 || (size_t)written >= size - used) return -1;
+                used += written;
+                written = breaker->encodeJson(out + used, size - used);
+                if (written < 0 || used + written + 2 > size) return -1;
+                used += written;
+                out[used++] = '}';
+                out[used] = '\0';
+            }
+            first = false;
+        }
+        if (used + 2 > size) return -1;
+        out[used++] = '}';
+        out[used] = '\0';
+        return (int)used;
+    }
+
+    void printNetworkStats() {
+        char p50[12], p95[12], p99[12];
+        Serial.println("\n⏱️  Network Latency (per upload phase):");
+        Serial.println("─────────────────────────────────────────────────────────");
+        Serial.println("   Sink        Phase       n      p50      p95      p99   fail");
+        bool any = false;
+        for (int i = 0; i < sinkCount; i++) {
+            const NetLatencyStats* latency = sinks[i]->latencyStats();
+            if (latency == nullptr) continue;
+            any = true;
+            bool firstRow = true;
+            for (int p = 0; p < NET_PHASE_COUNT; p++) {
+                const LatencyHistogram& h = latency->phase((NetPhase)p);
+                if (h.count() == 0 && latency->getFailures((NetPhase)p) == 0) continue;
+                Serial.printf("   %-11s %-8s %5lu %8s %8s %8s %6lu\n",
+                              firstRow ? sinks[i]->name() : "", NET_PHASE_NAMES[p],
+                              (unsigned long)h.count(),
+                              latency_format_us(h.percentile(50), p50, sizeof(p50)),
+                              latency_format_us(h.percentile(95), p95, sizeof(p95)),
+                              latency_format_us(h.percentile(99), p99, sizeof(p99)),
+                              (unsigned long)latency->getFailures((NetPhase)p));
+                firstRow = false;
+            }
+        }
+        if (!any) {
+            Serial.println("   (no timed sinks registered)");
+        }
+        Serial.println("─────────────────────────────────────────────────────────");
+    }
+
+    int getSinkCount() { return sinkCount; }
+    unsigned long getTotalRecords() { return totalRecords; }
+
+    // ==================== STATISTICS ====================
+    void printStatistics() {
+        uint32_t now = millis();
+        unsigned long encodes = totalEncodes + payload.getEncodeCount();
+        Serial.println("\n📤 Telemetry Statistics:");
+        Serial.println("─────────────────────────────────────────────────────────");
+        Serial.printf("   Records:  %lu (%lu encodings, %.2f per record)\n",
+                      totalRecords, encodes,
+                      totalRecords > 0 ? (float)encodes / totalRecords : 0.0f);
+        for (int i = 0; i < sinkCount; i++) {
+            unsigned long attempts = stats[i].published + stats[i].failed;
+            Serial.printf("   %-11s ✅ %lu  ❌ %lu  ⏭️  %lu  avg %.1f ms\n",
+                          sinks[i]->name(),
+                          stats[i].published, stats[i].failed, stats[i].skipped,
+                          attempts > 0 ? stats[i].totalMicros / 1000.0f / attempts : 0.0f);
+        }
+        Serial.println("─────────────────────────────────────────────────────────");
+        Serial.println("   Scheduler   interval  prio  util   deferred  coalesced  avg wait");
+        for (int i = 0; i < sinkCount; i++) {
+            const RateSlotStats& rs = scheduler.getStats(i);
+            unsigned long waited = rs.offered - rs.coalesced;
+            if (scheduler.getInterval(i) > 0) {
+                Serial.printf("   %-11s %6lu s  %4u  %3.0f%%  %8lu  %9lu  %6.1f s\n",
+                              sinks[i]->name(), (unsigned long)scheduler.getInterval(i) / 1000,
+                              scheduler.getPriority(i), scheduler.utilisation(i, now) * 100.0f,
+                              (unsigned long)rs.deferred, (unsigned long)rs.coalesced,
+                              waited > 0 ? rs.queueDelayTotalMs / 1000.0f / waited : 0.0f);
+            } else {
+                Serial.printf("   %-11s    none  %4u     -  %8lu  %9lu  %6.1f s\n",
+                              sinks[i]->name(), scheduler.getPriority(i),
+                              (unsigned long)rs.deferred, (unsigned long)rs.coalesced,
+                              waited > 0 ? rs.queueDelayTotalMs / 1000.0f / waited : 0.0f);
+            }
+        }
+        if (scheduler.getGlobalInterval() > 0) {
+            Serial.printf("   Global budget: 1 upload / %lu s, %.0f%% used\n",
+                          (unsigned long)scheduler.getGlobalInterval() / 1000,
+                          scheduler.globalUtilisation(now) * 100.0f);
+        }
+        printBreakerStatistics(now);
+        if (exceptionFilter != nullptr) {
+            printExceptionStatistics();
+        }
+        Serial.println("─────────────────────────────────────────────────────────");
+    }
+
+    void printBreakerStatistics(uint32_t now) {
+        bool header = false;
+        for (int i = 0; i < sinkCount; i++) {
+            const CircuitBreaker* breaker = sinks[i]->circuitBreaker();
+            if (breaker == nullptr) continue;
+            if (!header) {
+                Serial.println("─────────────────────────────────────────────────────────");
+                Serial.println("   Breaker     state      opened  probes  rejected  outage   probe in");
+                header = true;
+            }
+            const BreakerStats& bs = breaker->getStats();
+            Serial.printf("   %-11s %-9s  %6lu  %6lu  %8lu  %5lu s  %5lu s\n",
+                          sinks[i]->name(), breaker->stateName(),
+                          (unsigned long)bs.transitions[BREAKER_OPEN], (unsigned long)bs.probes,
+                          (unsigned long)bs.rejected, (unsigned long)bs.openTimeMs / 1000,
+                          (unsigned long)breaker->msUntilProbe(now) / 1000);
+        }
+    }
+
+    void printExceptionStatistics() {
+        const RbeStats& rs = exceptionFilter->getStats();
+        Serial.println("─────────────────────────────────────────────────────────");
+        Serial.printf("   Report-by-exception: %lu of %lu records suppressed (%.0f%%)\n",
+                      (unsigned long)rs.byReason[RBE_SUPPRESSED], (unsigned long)rs.evaluated,
+                      exceptionFilter->suppressionRatio() * 100.0f);
+        Serial.printf("   Reported: first %lu | class change %lu | deadband %lu | heartbeat %lu\n",
+                      (unsigned long)rs.byReason[RBE_FIRST], (unsigned long)rs.byReason[RBE_CLASS_CHANGE],
+                      (unsigned long)rs.byReason[RBE_DEADBAND], (unsigned long)rs.byReason[RBE_HEARTBEAT]);
+        for (int f = 0; f < RBE_NUM_FEATURES; f++) {
+            Serial.printf("   %-12s deadband %7.2f  tripped %4lu  max hidden error %7.2f\n",
+                          RBE_FEATURE_NAMES[f], exceptionFilter->getDeadband(f),
+                          (unsigned long)rs.deadbandHits[f], rs.maxSuppressedError[f]);
+        }
+    }
+
+private:
+    // Close this core's metrics on time, then hand a closed window to
+    // every sink (each ships it with its next upload)
+    void serviceLatencyWindow() {
+        uint32_t now = millis();
+        latencyWindow.advance(LATENCY_METRIC_INFERENCE, now);
+        latencyWindow.advance(LATENCY_METRIC_UPLOAD, now);
+        LatencyWindowReport report;
+        if (!latencyWindow.takeReport(now, report)) {
+            return;
+        }
+        uint64_t startEpochMs = epochClock != nullptr ? epochClock->toEpochMs(report.startMs) : 0;
+        report.startS = (uint32_t)(startEpochMs / 1000);
+        lastLatencyReport = report;
+        latencyReports++;
+        for (int i = 0; i < sinkCount; i++) {
+            sinks[i]->publishLatencyWindow(report);
+        }
+    }
+
+    // Send the latency histograms to every ready sink that takes diagnostics
+    void exportDiagnostics() {
+        static char json[TELEMETRY_DIAGNOSTICS_SIZE];
+        bool anyTimed = false;
+        for (int i = 0; i < sinkCount; i++) {
+            anyTimed = anyTimed || sinks[i]->latencyStats() != nullptr || sinks[i]->circuitBreaker() != nullptr;
+        }
+        if (!anyTimed || encodeNetworkStats(json, sizeof(json)) < 0) {
+            return;
+        }
+        for (int i = 0; i < sinkCount; i++) {
+            if (sinks[i]->isReady()) {
+                sinks[i]->publishDiagnostics(json);
+            }
+        }
+    }
+
+public:
+    // ==================== BENCHMARK ====================
+    // Encode-only cost per record (no network): all wire formats through the
+    // shared payload vs. the legacy String-concatenation URL build.
+    void runBenchmark(unsigned int iterations) {
+        Serial.println("\n╔════════════════════════════════════════════════════════╗");
+        Serial.println("║           TELEMETRY ENCODE BENCHMARK                   ║");
+        Serial.println("╚════════════════════════════════════════════════════════╝");
+        Serial.printf("   Records: %u\n\n", iterations);
+
+        TelemetryRecord record;
+        memset(&record, 0, sizeof(record));
+        volatile unsigned long sink = 0;
+
+        // Separate payload: the shared one may still hold a record waiting for a token
+        static TelemetryPayload benchPayload;
+
+        // Shared payload path (all three formats, once each)
+        unsigned long heapStart = ESP.getFreeHeap();
+        unsigned long minHeap = heapStart;
+        unsigned long start = micros();
+        for (unsigned int i = 0; i < iterations; i++) {
+            fillBenchmarkRecord(record, i);
+            benchPayload.reset(record, deviceId);
+            sink += benchPayload.length(TELEMETRY_FORMAT_THINGSPEAK);
+            sink += benchPayload.length(TELEMETRY_FORMAT_FIREBASE_JSON);
+            sink += benchPayload.length(TELEMETRY_FORMAT_CSV);
+            unsigned long heap = ESP.getFreeHeap();
+            if (heap < minHeap) minHeap = heap;
+        }
+        unsigned long sharedMicros = micros() - start;
+        unsigned long sharedHeap = heapStart - minHeap;
+
+        // Legacy path (ThingSpeak URL built with String +=)
+        heapStart = ESP.getFreeHeap();
+        minHeap = heapStart;
+        start = micros();
+        for (unsigned int i = 0; i < iterations; i++) {
+            fillBenchmarkRecord(record, i);
+            String url = "http://api.thingspeak.com/update?api_key=XXXXXXXXXXXXXXXX";
+            url += "&field1=" + String(record.temperature, 2);
+            url += "&field2=" + String(record.humidity, 2);
+            url += "&field3=" + String(record.pressure, 2);
+            url += "&field4=" + String(record.lux, 2);
+            url += "&field5=" + String(record.gas, 2);
+            url += "&field6=" + String(record.predictedClass);
+            url += "&field7=" + String(record.inferenceTime);
+            url += "&field8=" + String(record.rssi);
+            sink += url.length();
+            unsigned long heap = ESP.getFreeHeap();
+            if (heap < minHeap) minHeap = heap;
+        }
+        unsigned long legacyMicros = micros() - start;
+        unsigned long legacyHeap = heapStart - minHeap;
+
+        Serial.println("   Path                      µs/record   Peak heap");
+        Serial.println("─────────────────────────────────────────────────────────");
+        Serial.printf("   Shared payload (3 fmts)   %9.2f   %5lu B\n",
+                      (float)sharedMicros / iterations, sharedHeap);
+        Serial.printf("   Legacy String URL (1 fmt) %9.2f   %5lu B\n",
+                      (float)legacyMicros / iterations, legacyHeap);
+        Serial.println("─────────────────────────────────────────────────────────");
+        Serial.printf("   Encoded sizes: ThingSpeak %d B | JSON %d B | CSV %d B\n",
+                      benchPayload.length(TELEMETRY_FORMAT_THINGSPEAK),
+                      benchPayload.length(TELEMETRY_FORMAT_FIREBASE_JSON),
+                      benchPayload.length(TELEMETRY_FORMAT_CSV));
+
+        // Gorilla blocks (one minute of 1 Hz samples per block, static buffer)
+        static uint8_t block[GORILLA_HEADER_SIZE + (60 * GORILLA_MAX_SAMPLE_BITS + 7) / 8];
+        GorillaBlockEncoder encoder(block, sizeof(block));
+        float values[GORILLA_CHANNELS];
+        unsigned long blockBytes = 0;
+        start = micros();
+        for (unsigned int i = 0; i < iterations; i++) {
+            fillBenchmarkRecord(record, i);
+            values[0] = record.temperature;
+            values[1] = record.humidity;
+            values[2] = record.pressure;
+            values[3] = record.lux;
+            values[4] = record.gas;
+            if (encoder.sampleCount() == 60) {
+                blockBytes += encoder.finish();
+                encoder.begin();
+            }
+            encoder.append(record.timestampMs, values, record.predictedClass);
+        }
+        blockBytes += encoder.finish();
+        unsigned long gorillaMicros = micros() - start;
+        Serial.printf("   Gorilla block (60/block): %.2f µs/record, %.1f B/record (raw 29 B)\n",
+                      (float)gorillaMicros / iterations, (float)blockBytes / iterations);
+        Serial.println();
+    }
+
+private:
+    void fillBenchmarkRecord(TelemetryRecord& record, unsigned int i) {
+        record.timestampMs = 15000ULL * i;
+        record.epochMs = 1700000000000ULL + record.timestampMs;
+        record.temperature = 19.0f + (i % 110) * 0.1f;
+        record.humidity = 29.3f + (i % 276) * 0.1f;
+        record.pressure = 96352.7f + (i % 3948);
+        record.lux = (float)(i % 632);
+        record.gas = 50.0f + (i % 1950);
+        record.predictedClass = i % TELEMETRY_NUM_CLASSES;
+        for (int c = 0; c < TELEMETRY_NUM_CLASSES; c++) {
+            record.votes[c] = (c == record.predictedClass) ? 200 : 12;
+        }
+        record.inferenceTime = 180 + (i % 40);
+        record.rssi = -40 - (int8_t)(i % 50);
+    }
+};
+
+#endif // TELEMETRY_DISPATCHER_H
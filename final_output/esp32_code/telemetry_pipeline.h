@@ -0,0 +1,163 @@
+/*
+ * Telemetry Pipeline - Acquisition core → network core hand-off
+ *
+ * Splits the loop in two stages linked by a bounded queue:
+ * - acquire (producer): sampling, averaging and the 250-tree predict on
+ *   one core; submit() never blocks, so a slow upload can no longer
+ *   delay a reading
+ * - network (consumer): drain() hands each record to the telemetry
+ *   dispatcher (HTTP, Firebase, MQTT, local log) on the core that also
+ *   runs the WiFi stack
+ *
+ * When the network core falls a full queue behind, the oldest record is
+ * dropped (and counted): the sinks coalesce to the latest value anyway,
+ * and a record that old has missed its upload slot.
+ *
+ * Features:
+ * - Per-stage items, busy time and throughput (items/s since start)
+ * - Queue latency histogram (submit → drain, µs), depth high-water mark,
+ *   drops
+ * - JSON export
+ * - Thread-safe by ownership: each counter is written by one core only
+ * - No Arduino dependencies (task_port.h provides queue and clock)
+ *
+ * Usage:
+ *   TelemetryPipeline pipeline;
+ *   pipeline.submit(record, acquireUs);                  // Acquisition core
+ *   pipeline.drain(handleRecord, &dispatcher, waitMs);   // Network core
+ */
+
+#ifndef TELEMETRY_PIPELINE_H
+#define TELEMETRY_PIPELINE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "task_port.h"
+#include "telemetry_record.h"
+#include "latency_histogram.h"
+
+#define PIPELINE_QUEUE_DEPTH 8      // 2 min of 15 s predictions
+
+enum PipelineStage {
+    PIPELINE_STAGE_ACQUIRE = 0,
+    PIPELINE_STAGE_NETWORK,
+    PIPELINE_STAGE_COUNT
+};
+
+static const char* const PIPELINE_STAGE_NAMES[PIPELINE_STAGE_COUNT] = { "acquire", "network" };
+
+struct PipelineItem {
+    TelemetryRecord record;
+    uint32_t submittedUs;
+};
+
+struct PipelineStageStats {
+    uint32_t items;
+    uint64_t busyUs;
+    uint32_t busyMaxUs;
+};
+
+typedef void (*PipelineHandler)(const TelemetryRecord& record, void* context);
+
+class TelemetryPipeline {
+private:
+    PortQueue<PipelineItem, PIPELINE_QUEUE_DEPTH> queue;
+    PipelineStageStats stages[PIPELINE_STAGE_COUNT];
+    LatencyHistogram queueLatency;   // Written by the consumer only
+    volatile uint32_t dropped;       // Written by the producer only
+    uint32_t startedMs;
+
+public:
+    TelemetryPipeline() : dropped(0), startedMs(0) {
+        memset(stages, 0, sizeof(stages));
+    }
+
+    void begin() { startedMs = port_millis(); }
+
+    // Producer: queue a record without blocking. acquireUs is the time the
+    // acquisition stage spent producing it. Returns false if an older
+    // record had to be dropped to make room.
+    bool submit(const TelemetryRecord& record, uint32_t acquireUs) {
+        account(stages[PIPELINE_STAGE_ACQUIRE], acquireUs);
+        PipelineItem item;
+        item.record = record;
+        item.submittedUs = port_micros();
+        if (queue.send(item, 0)) return true;
+        PipelineItem oldest;
+        if (queue.receive(oldest, 0)) dropped++;
+        queue.send(item, 0);
+        return false;
+    }
+
+    // Consumer: wait up to waitMs for the first record, then hand every
+    // queued record to handler. Returns the number handled.
+    int drain(PipelineHandler handler, void* context, uint32_t waitMs) {
+        PipelineItem item;
+        int handled = 0;
+        uint32_t wait = waitMs;
+        while (queue.receive(item, wait)) {
+            uint32_t start = port_micros();
+            queueLatency.record(start - item.submittedUs);
+            handler(item.record, context);
+            account(stages[PIPELINE_STAGE_NETWORK], port_micros() - start);
+            handled++;
+            wait = 0;
+        }
+        return handled;
+    }
+
+    const PipelineStageStats& getStage(int stage) const { return stages[stage]; }
+    const LatencyHistogram& getQueueLatency() const { return queueLatency; }
+    uint32_t getDropped() const { return dropped; }
+    size_t getDepth() const { return queue.depth(); }
+    uint32_t getHighWater() const { return queue.getHighWater(); }
+    size_t getCapacity() const { return queue.capacity(); }
+
+    // Items per second since begin()
+    float throughput(int stage) const {
+        uint32_t elapsed = port_millis() - startedMs;
+        return elapsed ? stages[stage].items * 1000.0f / elapsed : 0.0f;
+    }
+
+    static float meanBusyUs(const PipelineStageStats& s) { return s.items ? (float)s.busyUs / s.items : 0.0f; }
+
+    // {"stages":{"acquire":{"items":n,"per_s":x,"busy_avg_us":x,"busy_max_us":n},...},
+    //  "queue":{"depth":n,"capacity":n,"high_water":n,"dropped":n,
+    //  "latency_us":{"p50":n,"p99":n,"max":n}}}
+    int encodeJson(char* out, size_t size) const {
+        size_t used = 0;
+        int written = snprintf(out, size, "{\"stages\":{");
+        if (!advance(written, size, used)) return -1;
+        for (int i = 0; i < PIPELINE_STAGE_COUNT; i++) {
+            const PipelineStageStats& s = stages[i];
+            written = snprintf(out + used, size - used,
+                               "%s\"%s\":{\"items\":%lu,\"per_s\":%.3f,\"busy_avg_us\":%.1f,\"busy_max_us\":%lu}",
+                               i ? "," : "", PIPELINE_STAGE_NAMES[i], (unsigned long)s.items, throughput(i),
+                               meanBusyUs(s), (unsigned long)s.busyMaxUs);
+            if (!advance(written, size, used)) return -1;
+        }
+        written = snprintf(out + used, size - used,
+                           "},\"queue\":{\"depth\":%lu,\"capacity\":%lu,\"high_water\":%lu,\"dropped\":%lu,"
+                           "\"latency_us\":{\"p50\":%lu,\"p99\":%lu,\"max\":%lu}}}",
+                           (unsigned long)getDepth(), (unsigned long)getCapacity(), (unsigned long)getHighWater(),
+                           (unsigned long)dropped, (unsigned long)queueLatency.percentile(50),
+                           (unsigned long)queueLatency.percentile(99), (unsigned long)queueLatency.max());
+        if (!advance(written, size, used)) return -1;
+        return (int)used;
+    }
+
+private:
+    static void account(PipelineStageStats& s, uint32_t us) {
+        s.items++;
+        s.busyUs += us;
+        if (us > s.busyMaxUs) s.busyMaxUs = us;
+    }
+
+    static bool advance(int written, size_t size, size_t& used) {
+        if (written < 0 || used + (size_t)written >= size) return false;
+        used += (size_t)written;
+        return true;
+    }
+};
+
+#endif // TELEMETRY_PIPELINE_H
@@ -0,0 +1,241 @@
+/*
+ * Telemetry Record - Canonical Reading Format
+ *
+ * One averaged sensor reading + prediction, shared by every cloud sink.
+ *
+ * Features:
+ * - Single record type (timestamps, 5 sensor values, class, votes, inference µs, RSSI)
+ * - Two clocks: timestampMs (millis(), always set) for deltas and the local
+ *   log, epochMs (NTP wall clock, 0 until synced) for cloud keys
+ * - Lazy encoding: each wire format is serialized at most once per record
+ * - Fixed buffers only (no String, no heap)
+ * - No Arduino dependencies (host tools reuse the same encoders)
+ *
+ * Wire Formats:
+ * - ThingSpeak query:  field1=..&field2=..&...&field8=..
+ * - Firebase JSON:     {"temperature":..,"humidity":..,...,"device_id":".."}
+ *                      (json_stream_writer.h, schema JSON_READING_SCHEMA;
+ *                      "timestamp" is epochMs)
+ * - CSV line:          timestamp_ms,temp,humid,pressure,lux,gas,class,votes,inference_us,rssi
+ *
+ * ThingSpeak Field Mapping:
+ *   1: Temperature (°C)   2: Humidity (%)     3: Pressure (Pa)   4: Lux
+ *   5: Gas (PPM)          6: Class ID         7: Inference (µs)  8: WiFi RSSI (dBm)
+ */
+
+#ifndef TELEMETRY_RECORD_H
+#define TELEMETRY_RECORD_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "json_stream_writer.h"
+
+#define TELEMETRY_NUM_CLASSES 5
+#define TELEMETRY_MAX_PAYLOAD 320     // Largest encoded format (Firebase JSON ~230 bytes)
+
+static const char* const TELEMETRY_CLASS_NAMES[TELEMETRY_NUM_CLASSES] = {
+    "Cloudy", "Foggy", "Rainy", "Stormy", "Sunny"
+};
+
+// ==================== RECORD ====================
+struct TelemetryRecord {
+    uint64_t timestampMs;                   // Milliseconds since boot
+    uint64_t epochMs;                       // Unix epoch ms (0 = clock not synced yet)
+    float temperature;                      // °C
+    float humidity;                         // %
+    float pressure;                         // Pa
+    float lux;                              // lux
+    float gas;                              // PPM
+    uint8_t predictedClass;                 // 0-4 (see TELEMETRY_CLASS_NAMES)
+    uint8_t votes[TELEMETRY_NUM_CLASSES];   // Tree votes per class
+    uint32_t inferenceTime;                 // µs
+    int8_t rssi;                            // dBm (0 = unknown)
+};
+
+inline const char* telemetry_class_name(uint8_t classId) {
+    return classId < TELEMETRY_NUM_CLASSES ? TELEMETRY_CLASS_NAMES[classId] : "Unknown";
+}
+
+// ==================== ENCODERS ====================
+// Each encoder returns the number of characters written (excluding the
+// terminator), or -1 if the output buffer was too small.
+
+inline int telemetry_checked_length(int written, size_t size) {
+    return (written < 0 || (size_t)written >= size) ? -1 : written;
+}
+
+// ThingSpeak query fields (without server or api_key)
+inline int telemetry_encode_thingspeak(const TelemetryRecord& r, char* out, size_t size) {
+    int written = snprintf(out, size,
+        "field1=%.2f&field2=%.2f&field3=%.2f&field4=%.2f&field5=%.2f"
+        "&field6=%u&field7=%lu&field8=%d",
+        r.temperature, r.humidity, r.pressure, r.lux, r.gas,
+        (unsigned)r.predictedClass, (unsigned long)r.inferenceTime, (int)r.rssi);
+    return telemetry_checked_length(written, size);
+}
+
+// Firebase reading node (/devices/{id}/readings/{timestamp})
+enum JsonReadingField {
+    JSON_READING_TEMPERATURE = 0,
+    JSON_READING_HUMIDITY,
+    JSON_READING_PRESSURE,
+    JSON_READING_LUX,
+    JSON_READING_GAS_PPM,
+    JSON_READING_PREDICTION,
+    JSON_READING_CLASS_ID,
+    JSON_READING_VOTES,
+    JSON_READING_INFERENCE_TIME,
+    JSON_READING_RSSI,
+    JSON_READING_TIMESTAMP,
+    JSON_READING_DEVICE_ID,
+    JSON_READING_FIELD_COUNT
+};
+
+static const JsonField JSON_READING_SCHEMA[] = {
+    JSON_FIELD("temperature"),
+    JSON_FIELD("humidity"),
+    JSON_FIELD("pressure"),
+    JSON_FIELD("lux"),
+    JSON_FIELD("gas_ppm"),
+    JSON_FIELD("prediction"),
+    JSON_FIELD("class_id"),
+    JSON_FIELD("votes"),
+    JSON_FIELD("inference_time"),
+    JSON_FIELD("rssi"),
+    JSON_FIELD("timestamp"),
+    JSON_FIELD("device_id"),
+};
+static_assert(JSON_SCHEMA_SIZE(JSON_READING_SCHEMA) == JSON_READING_FIELD_COUNT, "reading schema");
+
+inline void json_write_reading(JsonStreamWriter& w, const TelemetryRecord& r, const char* deviceId) {
+    const JsonField* f = JSON_READING_SCHEMA;
+    w.beginObject();
+    w.field(f[JSON_READING_TEMPERATURE]);    w.value(r.temperature, 2);
+    w.field(f[JSON_READING_HUMIDITY]);       w.value(r.humidity, 2);
+    w.field(f[JSON_READING_PRESSURE]);       w.value(r.pressure, 2);
+    w.field(f[JSON_READING_LUX]);            w.value(r.lux, 2);
+    w.field(f[JSON_READING_GAS_PPM]);        w.value(r.gas, 2);
+    w.field(f[JSON_READING_PREDICTION]);     w.value(telemetry_class_name(r.predictedClass));
+    w.field(f[JSON_READING_CLASS_ID]);       w.value((uint32_t)r.predictedClass);
+    w.field(f[JSON_READING_VOTES]);
+    w.beginArray();
+    for (int i = 0; i < TELEMETRY_NUM_CLASSES; i++) w.value((uint32_t)r.votes[i]);
+    w.endArray();
+    w.field(f[JSON_READING_INFERENCE_TIME]); w.value(r.inferenceTime);
+    w.field(f[JSON_READING_RSSI]);           w.value((int32_t)r.rssi);
+    w.field(f[JSON_READING_TIMESTAMP]);      w.value(r.epochMs);
+    w.field(f[JSON_READING_DEVICE_ID]);      w.value(deviceId ? deviceId : "");
+    w.endObject();
+}
+
+inline int telemetry_encode_firebase_json(const TelemetryRecord& r, const char* deviceId,
+                                          char* out, size_t size) {
+    JsonStreamWriter w(out, size);
+    json_write_reading(w, r, deviceId);
+    return w.length();
+}
+
+// CSV line for the local file log (newline terminated)
+inline int telemetry_encode_csv(const TelemetryRecord& r, char* out, size_t size) {
+    int written = snprintf(out, size,
+        "%llu,%.2f,%.2f,%.2f,%.2f,%.2f,%u,%u;%u;%u;%u;%u,%lu,%d\n",
+        (unsigned long long)r.timestampMs,
+        r.temperature, r.humidity, r.pressure, r.lux, r.gas,
+        (unsigned)r.predictedClass,
+        (unsigned)r.votes[0], (unsigned)r.votes[1], (unsigned)r.votes[2],
+        (unsigned)r.votes[3], (unsigned)r.votes[4],
+        (unsigned long)r.inferenceTime, (int)r.rssi);
+    return telemetry_checked_length(written, size);
+}
+
+#define TELEMETRY_CSV_HEADER "timestamp_ms,temperature,humidity,pressure,lux,gas_ppm,class_id,votes,inference_us,rssi\n"
+
+// ==================== LAZY PAYLOAD ====================
+enum TelemetryFormat {
+    TELEMETRY_FORMAT_THINGSPEAK = 0,
+    TELEMETRY_FORMAT_FIREBASE_JSON,
+    TELEMETRY_FORMAT_CSV,
+    TELEMETRY_FORMAT_COUNT
+};
+
+// Holds one record plus its encoded forms. A format is only serialized the
+// first time a sink asks for it; every later sink reuses the same bytes.
+// Reuse one instance across records (~1 KB) instead of putting it on the stack.
+class TelemetryPayload {
+private:
+    TelemetryRecord rec;
+    const char* deviceId;
+    char buffers[TELEMETRY_FORMAT_COUNT][TELEMETRY_MAX_PAYLOAD];
+    int16_t lengths[TELEMETRY_FORMAT_COUNT];   // -1 = not encoded yet
+    uint8_t encodeCount;                       // Encodings performed for this record
+
+public:
+    TelemetryPayload() : deviceId("") {
+        memset(&rec, 0, sizeof(rec));
+        invalidate();
+    }
+
+    // Load a new record (drops all cached encodings)
+    void reset(const TelemetryRecord& record, const char* device = nullptr) {
+        rec = record;
+        if (device) deviceId = device;
+        invalidate();
+    }
+
+    const TelemetryRecord& record() const { return rec; }
+
+    // Encoded bytes for a format (serialized on first request)
+    const char* get(TelemetryFormat format) {
+        if (format >= TELEMETRY_FORMAT_COUNT) return "";
+        if (lengths[format] < 0) {
+            encode(format);
+        }
+        return buffers[format];
+    }
+
+    int length(TelemetryFormat format) {
+        if (format >= TELEMETRY_FORMAT_COUNT) return 0;
+        if (lengths[format] < 0) {
+            encode(format);
+        }
+        return lengths[format] < 0 ? 0 : lengths[format];
+    }
+
+    uint8_t getEncodeCount() const { return encodeCount; }
+
+private:
+    void invalidate() {
+        for (int i = 0; i < TELEMETRY_FORMAT_COUNT; i++) {
+            lengths[i] = -1;
+            buffers[i][0] = '\0';
+        }
+        encodeCount = 0;
+    }
+
+    void encode(TelemetryFormat format) {
+        char* out = buffers[format];
+        int written = -1;
+        switch (format) {
+            case TELEMETRY_FORMAT_THINGSPEAK:
+                written = telemetry_encode_thingspeak(rec, out, TELEMETRY_MAX_PAYLOAD);
+                break;
+            case TELEMETRY_FORMAT_FIREBASE_JSON:
+                written = telemetry_encode_firebase_json(rec, deviceId, out, TELEMETRY_MAX_PAYLOAD);
+                break;
+            case TELEMETRY_FORMAT_CSV:
+                written = telemetry_encode_csv(rec, out, TELEMETRY_MAX_PAYLOAD);
+                break;
+            default:
+                break;
+        }
+        if (written < 0) {
+            out[0] = '\0';
+            written = 0;
+        }
+        lengths[format] = (int16_t)written;
+        encodeCount++;
+    }
+};
+
+#endif // TELEMETRY_RECORD_H
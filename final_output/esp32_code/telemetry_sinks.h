@@ -0,0 +1,440 @@
+/*
+ * Telemetry Sinks - Backends for TelemetryDispatcher
+ *
+ * Sinks:
+ * - ThingSpeakSink: HTTP GET field1..field8 via CloudManager (+ status text
+ *                   with the last latency window)
+ * - FirebaseSink:   Reading node via FirebaseManager (batched PATCH; latency
+ *                   windows at latency/{start})
+ * - LocalFileSink:  CSV log on LittleFS (survives cloud outages)
+ * - CollectorSink:  Binary frames (telemetry_codec.h) over UDP/TCP to a LAN collector
+ * - MqttSink:       JSON reading over a persistent MQTT session (mqtt_uplink.h);
+ *                   latency windows on {prefix}/{device}/latency
+ *
+ * Each sink only pulls the encoding it needs from the shared payload,
+ * so a record is formatted at most once per wire format. Network sinks
+ * expose their circuit breaker (circuit_breaker.h) and report not-ready
+ * while it is open, so the dispatcher keeps their record instead of
+ * calling a dead backend.
+ */
+
+#ifndef TELEMETRY_SINKS_H
+#define TELEMETRY_SINKS_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <LittleFS.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include "telemetry_dispatcher.h"
+#include "telemetry_codec.h"
+#include "mqtt_uplink.h"
+#include "cloud_manager.h"
+#include "firebase_manager.h"
+
+// Local log settings
+#define TELEMETRY_LOG_PATH "/telemetry.csv"
+#define TELEMETRY_LOG_OLD_PATH "/telemetry.old.csv"
+#define TELEMETRY_LOG_MAX_BYTES 262144   // Rotate after 256 KB
+
+// Local collector settings (host_tools/telemetry_collector)
+#define COLLECTOR_HOST "192.168.1.100"
+#define COLLECTOR_PORT 5140
+#define COLLECTOR_USE_TCP false          // false = UDP datagram per frame
+#define COLLECTOR_BATCH_RECORDS 1        // Records per frame (1 = send immediately)
+#define COLLECTOR_FRAME_SIZE 512
+
+// MQTT uplink settings (host_tools/mqtt_broker_standin for local testing)
+#define MQTT_BROKER_HOST "192.168.1.100"
+#define MQTT_BROKER_PORT 1883
+#define MQTT_QOS 1
+#define MQTT_TOPIC_PREFIX "weather"      // Topic: weather/{deviceId}/reading
+
+// ==================== THINGSPEAK ====================
+// All eight fields carry the reading; a closed latency window rides along
+// once, as the entry's status text (latency_encode_status format)
+class ThingSpeakSink : public TelemetrySink {
+private:
+    CloudManager* cloud;
+    char status[LATENCY_STATUS_SIZE];   // Pending until an upload succeeds ("" = none)
+    char query[TELEMETRY_MAX_PAYLOAD + LATENCY_STATUS_SIZE + 8];
+
+public:
+    ThingSpeakSink(CloudManager* cloudManager) : cloud(cloudManager) {
+        status[0] = '\0';
+        query[0] = '\0';
+    }
+
+    const char* name() override { return "ThingSpeak"; }
+
+    bool isReady() override {
+        return cloud != nullptr && WiFi.status() == WL_CONNECTED && cloud->isAvailable();
+    }
+
+    bool publish(TelemetryPayload& payload) override {
+        const char* fields = payload.get(TELEMETRY_FORMAT_THINGSPEAK);
+        if (status[0] == '\0') {
+            return cloud->uploadFields(fields);
+        }
+        snprintf(query, sizeof(query), "%s&status=%s", fields, status);
+        bool ok = cloud->uploadFields(query);
+        if (ok) {
+            status[0] = '\0';
+        }
+        return ok;
+    }
+
+    const NetLatencyStats* latencyStats() override { return &cloud->getLatencyStats(); }
+
+    CircuitBreaker* circuitBreaker() override { return &cloud->getBreaker(); }
+
+    void setUploadListener(NetOperationListener fn, void* context) override {
+        cloud->setLatencyListener(fn, context);
+    }
+
+    // A newer window replaces one that never made it out
+    void publishLatencyWindow(const LatencyWindowReport& report) override {
+        if (latency_encode_status(report, status, sizeof(status)) < 0) {
+            status[0] = '\0';
+        }
+    }
+};
+
+// ==================== FIREBASE ====================
+class FirebaseSink : public TelemetrySink {
+private:
+    FirebaseManager* firebase;
+
+public:
+    FirebaseSink(FirebaseManager* firebaseManager) : firebase(firebaseManager) {}
+
+    const char* name() override { return "Firebase"; }
+
+    // Offline until the epoch clock is synced: the reading stays pending
+    // instead of failing and spending scheduler budget every interval
+    bool isReady() override {
+        return firebase != nullptr && firebase->isInitialized() && firebase->hasClock() &&
+               WiFi.status() == WL_CONNECTED && firebase->canAccept();
+    }
+
+    bool publish(TelemetryPayload& payload) override {
+        return firebase->backupRecord(payload.record(),
+                                      payload.get(TELEMETRY_FORMAT_FIREBASE_JSON));
+    }
+
+    // Minute/hour/day rollups count every record, reported or not
+    void observe(const TelemetryRecord& record) override { firebase->aggregate(record); }
+
+    // Flushes a partial batch (or dirty rollups) when its interval expires
+    void poll() override { firebase->poll(); }
+
+    const NetLatencyStats* latencyStats() override { return &firebase->getLatencyStats(); }
+
+    CircuitBreaker* circuitBreaker() override { return &firebase->getBreaker(); }
+
+    bool publishDiagnostics(const char* json) override {
+        return firebase->uploadDiagnostics(json);
+    }
+
+    void setUploadListener(NetOperationListener fn, void* context) override {
+        firebase->setLatencyListener(fn, context);
+    }
+
+    // Queued for the next batch PATCH
+    void publishLatencyWindow(const LatencyWindowReport& report) override { firebase->queueLatencyWindow(report); }
+};
+
+// ==================== LOCAL FILE ====================
+class LocalFileSink : public TelemetrySink {
+private:
+    bool mounted;
+    unsigned long bytesWritten;
+
+public:
+    LocalFileSink() : mounted(false), bytesWritten(0) {}
+
+    // Mount LittleFS (formats on first use) and create the CSV header
+    bool begin() {
+        mounted = LittleFS.begin(true);
+        if (!mounted) {
+            Serial.println("   ⚠️  LittleFS mount failed - local telemetry log disabled");
+            return false;
+        }
+        if (!LittleFS.exists(TELEMETRY_LOG_PATH)) {
+            writeHeader();
+        }
+        Serial.printf("   💾 Local telemetry log: %s\n", TELEMETRY_LOG_PATH);
+        return true;
+    }
+
+    const char* name() override { return "LocalFile"; }
+
+    bool isReady() override { return mounted; }
+
+    bool publish(TelemetryPayload& payload) override {
+        File file = LittleFS.open(TELEMETRY_LOG_PATH, FILE_APPEND);
+        if (!file) {
+            return false;
+        }
+
+        int length = payload.length(TELEMETRY_FORMAT_CSV);
+        size_t written = file.write((const uint8_t*)payload.get(TELEMETRY_FORMAT_CSV), length);
+        size_t fileSize = file.size();
+        file.close();
+
+        bytesWritten += written;
+        if (fileSize > TELEMETRY_LOG_MAX_BYTES) {
+            rotate();
+        }
+        return written == (size_t)length;
+    }
+
+    unsigned long getBytesWritten() { return bytesWritten; }
+
+private:
+    void writeHeader() {
+        File file = LittleFS.open(TELEMETRY_LOG_PATH, FILE_WRITE);
+        if (file) {
+            file.print(TELEMETRY_CSV_HEADER);
+            file.close();
+        }
+    }
+
+    // Keep one previous log; older data is dropped
+    void rotate() {
+        LittleFS.remove(TELEMETRY_LOG_OLD_PATH);
+        LittleFS.rename(TELEMETRY_LOG_PATH, TELEMETRY_LOG_OLD_PATH);
+        writeHeader();
+    }
+};
+
+// ==================== LOCAL COLLECTOR ====================
+class CollectorSink : public TelemetrySink {
+private:
+    WiFiUDP udp;
+    WiFiClient tcp;
+    const char* host;
+    uint16_t port;
+    bool useTcp;
+    uint8_t batchRecords;
+
+    uint8_t deviceMac[6];
+    uint8_t frame[COLLECTOR_FRAME_SIZE];
+    TelemetryFrameEncoder encoder;
+    bool frameOpen;
+    uint16_t sequence;
+
+    unsigned long framesSent;
+    unsigned long bytesSent;
+    CircuitBreaker breaker;
+
+public:
+    CollectorSink(const char* collectorHost = COLLECTOR_HOST, uint16_t collectorPort = COLLECTOR_PORT,
+                  bool tcpTransport = COLLECTOR_USE_TCP, uint8_t recordsPerFrame = COLLECTOR_BATCH_RECORDS)
+        : host(collectorHost), port(collectorPort), useTcp(tcpTransport),
+          batchRecords(recordsPerFrame > 0 ? recordsPerFrame : 1),
+          encoder(frame, sizeof(frame)), frameOpen(false), sequence(0),
+          framesSent(0), bytesSent(0), breaker("Collector") {
+        memset(deviceMac, 0, sizeof(deviceMac));
+    }
+
+    const char* name() override { return "Collector"; }
+
+    bool isReady() override { return WiFi.status() == WL_CONNECTED && breaker.wouldAllow(millis()); }
+
+    bool publish(TelemetryPayload& payload) override {
+        const TelemetryRecord& record = payload.record();
+
+        if (!frameOpen) {
+            WiFi.macAddress(deviceMac);
+            encoder.begin(deviceMac, sequence, record.timestampMs);
+            frameOpen = true;
+        }
+        if (!encoder.add(record)) {
+            // Frame full: ship it and start a new one with this record
+            if (!flush()) return false;
+            encoder.begin(deviceMac, sequence, record.timestampMs);
+            frameOpen = true;
+            encoder.add(record);
+        }
+        if (encoder.recordCount() >= batchRecords) {
+            return flush();
+        }
+        return true;
+    }
+
+    // Send the pending frame (if any). While the breaker is open the frame
+    // stays open and nothing is sent.
+    bool flush() {
+        if (!frameOpen || encoder.recordCount() == 0) {
+            return true;
+        }
+        if (!breaker.allowRequest(millis())) {
+            return false;
+        }
+        size_t length = encoder.finish();
+        frameOpen = false;
+        sequence++;
+
+        bool ok = useTcp ? sendTcp(length) : sendUdp(length);
+        if (ok) {
+            framesSent++;
+            bytesSent += length;
+            breaker.onSuccess(millis());
+        } else {
+            breaker.onFailure(millis());
+        }
+        return ok;
+    }
+
+    CircuitBreaker* circuitBreaker() override { return &breaker; }
+
+    unsigned long getFramesSent() { return framesSent; }
+    unsigned long getBytesSent() { return bytesSent; }
+
+private:
+    bool sendUdp(size_t length) {
+        if (!udp.beginPacket(host, port)) return false;
+        udp.write(frame, length);
+        return udp.endPacket() == 1;
+    }
+
+    // TCP keeps one connection open; frames are prefixed with their u16 length
+    bool sendTcp(size_t length) {
+        if (!tcp.connected() && !tcp.connect(host, port)) {
+            return false;
+        }
+        uint8_t prefix[2] = { (uint8_t)length, (uint8_t)(length >> 8) };
+        if (tcp.write(prefix, 2) != 2 || tcp.write(frame, length) != length) {
+            tcp.stop();
+            return false;
+        }
+        return true;
+    }
+};
+
+// ==================== MQTT ====================
+// WiFiClient adapter for the portable MQTT uplink
+class WiFiMqttTransport : public MqttTransport {
+private:
+    WiFiClient client;
+
+public:
+    bool open(const char* host, uint16_t port) override {
+        if (!client.connect(host, port)) {
+            return false;
+        }
+        client.setNoDelay(true);
+        return true;
+    }
+
+    bool isOpen() override { return client.connected(); }
+
+    size_t write(const uint8_t* data, size_t length) override {
+        return client.write(data, length);
+    }
+
+    int read(uint8_t* data, size_t length) override {
+        int pending = client.available();
+        if (pending <= 0) {
+            return client.connected() ? 0 : -1;
+        }
+        return client.read(data, length < (size_t)pending ? length : (size_t)pending);
+    }
+
+    void close() override { client.stop(); }
+};
+
+static uint32_t mqttMillis() { return millis(); }
+
+class MqttSink : public TelemetrySink {
+private:
+    WiFiMqttTransport transport;
+    MqttUplink mqtt;
+    char clientId[32];
+    char topic[64];
+    char diagnosticsTopic[64];
+    char latencyTopic[64];
+
+public:
+    MqttSink() : mqtt(&transport, mqttMillis) {
+        clientId[0] = '\0';
+        topic[0] = '\0';
+        diagnosticsTopic[0] = '\0';
+        latencyTopic[0] = '\0';
+    }
+
+    // Client ID and topic are derived from the device ID (persistent session key)
+    void begin(const char* deviceId) {
+        snprintf(clientId, sizeof(clientId), "weather-%s", deviceId);
+        snprintf(topic, sizeof(topic), "%s/%s/reading", MQTT_TOPIC_PREFIX, deviceId);
+        snprintf(diagnosticsTopic, sizeof(diagnosticsTopic), "%s/%s/netstats", MQTT_TOPIC_PREFIX, deviceId);
+        snprintf(latencyTopic, sizeof(latencyTopic), "%s/%s/latency", MQTT_TOPIC_PREFIX, deviceId);
+        mqtt.configure(MQTT_BROKER_HOST, MQTT_BROKER_PORT, clientId);
+        Serial.printf("   📨 MQTT uplink: %s:%d topic %s (QoS %d)\n",
+                      MQTT_BROKER_HOST, MQTT_BROKER_PORT, topic, MQTT_QOS);
+    }
+
+    const char* name() override { return "MQTT"; }
+
+    bool isReady() override {
+        return topic[0] != '\0' && WiFi.status() == WL_CONNECTED;
+    }
+
+    // QoS 1 records are held in the in-flight window while the broker is
+    // unreachable and resent after reconnect
+    bool publish(TelemetryPayload& payload) override {
+        if (!mqtt.isConnected()) {
+            mqtt.loop();
+        }
+        return mqtt.publish(topic,
+                            (const uint8_t*)payload.get(TELEMETRY_FORMAT_FIREBASE_JSON),
+                            payload.length(TELEMETRY_FORMAT_FIREBASE_JSON), MQTT_QOS);
+    }
+
+    void poll() override {
+        if (isReady()) {
+            mqtt.loop();
+        }
+    }
+
+    // Diagnostics are best effort (QoS 0, dropped while disconnected)
+    bool publishDiagnostics(const char* json) override {
+        return mqtt.isConnected() && mqtt.publish(diagnosticsTopic, json, 0);
+    }
+
+    // Same QoS as readings: a window is one data point of the fleet series
+    void publishLatencyWindow(const LatencyWindowReport& report) override {
+        if (latencyTopic[0] == '\0') return;
+        char json[LATENCY_JSON_SIZE];
+        JsonStreamWriter w(json, sizeof(json));
+        json_write_latency_window(w, report);
+        if (w.ok()) {
+            mqtt.publish(latencyTopic, (const uint8_t*)json, (size_t)w.length(), MQTT_QOS);
+        }
+    }
+
+    void printStatistics() {
+        const MqttStats& st = mqtt.getStats();
+        Serial.println("\n📨 MQTT Uplink Statistics:");
+        Serial.println("─────────────────────────────────────────────────────────");
+        Serial.printf("   Session:     %s (%lu connects, session present: %s)\n",
+                      mqtt.isConnected() ? "connected" : "down", (unsigned long)st.connects,
+                      mqtt.wasSessionPresent() ? "yes" : "no");
+        Serial.printf("   Published:   %lu  acked: %lu  retransmits: %lu  rejected: %lu\n",
+                      (unsigned long)st.published, (unsigned long)st.acked,
+                      (unsigned long)st.retransmits, (unsigned long)st.rejected);
+        Serial.printf("   In flight:   %d / %d\n", mqtt.getInflightCount(), mqtt.getWindowSize());
+        Serial.printf("   Wire:        %lu B sent in %lu writes, %lu B received\n",
+                      (unsigned long)st.bytesSent, (unsigned long)st.writes,
+                      (unsigned long)st.bytesReceived);
+        Serial.printf("   Ack latency: avg %.1f ms, max %lu ms\n",
+                      st.acked > 0 ? (float)st.ackLatencyTotalMs / st.acked : 0.0f,
+                      (unsigned long)st.ackLatencyMaxMs);
+        Serial.println("─────────────────────────────────────────────────────────");
+    }
+
+    MqttUplink& uplink() { return mqtt; }
+};
+
+#endif // TELEMETRY_SINKS_H
@@ -0,0 +1,133 @@
+/*
+ * Time Service - SNTP wall clock for telemetry keys and timestamps
+ *
+ * Starts SNTP once WiFi is up and keeps an EpochClock (epoch_clock.h) in
+ * step with the system time, so every record gets an epoch-millisecond
+ * timestamp. Firebase keys readings by it: 13-digit keys sort the same
+ * lexicographically and chronologically, never collide across reboots and
+ * match the dashboard's startAt/endAt range queries.
+ *
+ * Features:
+ * - configTime() with three NTP servers, UTC (keys are zone-free)
+ * - Non-blocking: update() polls the system clock; start() only configures
+ *   SNTP (boot pipeline), begin() also waits at most TIME_SYNC_WAIT_MS
+ * - Re-anchors every TIME_RESYNC_MS (drift tracking lives in EpochClock)
+ * - Records taken before the first sync keep epoch 0 (cloud sinks skip
+ *   them; the local log keeps them with their boot timestamp)
+ */
+
+#ifndef TIME_SERVICE_H
+#define TIME_SERVICE_H
+
+#include <Arduino.h>
+#include <time.h>
+#include <sys/time.h>
+#include "epoch_clock.h"
+
+// ==================== CONFIGURATION ====================
+#define TIME_NTP_SERVER_1 "pool.ntp.org"
+#define TIME_NTP_SERVER_2 "time.google.com"
+#define TIME_NTP_SERVER_3 "time.cloudflare.com"
+#define TIME_SYNC_WAIT_MS 5000        // begin() waits this long for the first answer
+#define TIME_POLL_MS 1000             // Check for the first sync
+#define TIME_RESYNC_MS 600000         // Re-anchor every 10 minutes once synced
+
+class TimeService {
+private:
+    EpochClock epochClock;
+    bool started;
+    unsigned long lastPoll;
+
+public:
+    TimeService() {
+        started = false;
+        lastPoll = 0;
+    }
+
+    // Start SNTP without waiting; update() picks up the first answer
+    // (call once WiFi is connected; safe to call again)
+    void start() {
+        if (!started) {
+            configTime(0, 0, TIME_NTP_SERVER_1, TIME_NTP_SERVER_2, TIME_NTP_SERVER_3);
+            started = true;
+            lastPoll = millis();
+        }
+    }
+
+    // start() and wait up to TIME_SYNC_WAIT_MS for the first answer
+    void begin() {
+        Serial.println("\n🕒 Time Service:");
+        Serial.println("─────────────────────────────────────────────────────────");
+        start();
+
+        unsigned long waitStart = millis();
+        while (!sample() && millis() - waitStart < TIME_SYNC_WAIT_MS) {
+            delay(100);
+        }
+        if (epochClock.isSynced()) {
+            printNow();
+        } else {
+            Serial.println("   Status: ⏳ Waiting for NTP (cloud uploads start once synced)");
+        }
+        Serial.println("─────────────────────────────────────────────────────────");
+    }
+
+    // Call from loop(): picks up the first sync and re-anchors periodically
+    void update() {
+        if (!started) {
+            return;
+        }
+        unsigned long now = millis();
+        unsigned long interval = epochClock.isSynced() ? TIME_RESYNC_MS : TIME_POLL_MS;
+        if (now - lastPoll < interval) {
+            return;
+        }
+        bool first = !epochClock.isSynced();
+        if (sample() && first) {
+            Serial.println("\n🕒 Time synced via NTP");
+            printNow();
+        }
+    }
+
+    bool isSynced() const { return epochClock.isSynced(); }
+
+    // Current epoch ms (0 before the first sync)
+    uint64_t epochMs() const { return epochClock.toEpochMs(millis()); }
+
+    const EpochClock& clock() const { return epochClock; }
+
+    void printStatus() {
+        const EpochClockStats& s = epochClock.getStats();
+        Serial.println("\n🕒 Time Service:");
+        Serial.println("─────────────────────────────────────────────────────────");
+        if (epochClock.isSynced()) {
+            printNow();
+        } else {
+            Serial.println("   Status: ⏳ Not synced");
+        }
+        Serial.printf("   Syncs: %lu | Steps: %lu | Last error: %ld ms | Drift: %.1f ppm\n",
+                      (unsigned long)s.syncs, (unsigned long)s.steps, (long)s.lastErrorMs, s.driftPpm);
+        Serial.println("─────────────────────────────────────────────────────────");
+    }
+
+private:
+    // Pair the system time with millis() and feed the clock
+    bool sample() {
+        lastPoll = millis();
+        struct timeval tv;
+        gettimeofday(&tv, nullptr);
+        uint64_t epoch = (uint64_t)tv.tv_sec * 1000 + (uint64_t)(tv.tv_usec / 1000);
+        return epochClock.sync(lastPoll, epoch);
+    }
+
+    void printNow() {
+        time_t seconds = (time_t)(epochMs() / 1000);
+        struct tm utc;
+        gmtime_r(&seconds, &utc);
+        char text[32];
+        strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &utc);
+        Serial.printf("   Status: ✅ %s UTC (epoch %llu ms)\n", text, (unsigned long long)epochMs());
+    }
+};
+
+#endif // TIME_SERVICE_H
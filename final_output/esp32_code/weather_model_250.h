@@ -55,7 +55,17 @@ namespace Eloquent {
                     * Predict class for features vector
                     */
                     int predict(float *x) {
-                        uint8_t votes[5] = { 0 };
+                        uint8_t votes[5];
+                        return predict(x, votes);
+                    }
+
+                    /**
+                    * Predict class for features vector, exposing the per-class tree votes
+                    */
+                    int predict(float *x, uint8_t *votes) {
+                        for (uint8_t i = 0; i < 5; i++) {
+                            votes[i] = 0;
+                        }
                         // tree #1
                         if (x[3] <= 0.2060023993253708) {
                             if (x[3] <= 0.0006623062654398382) {
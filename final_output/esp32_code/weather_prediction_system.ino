@@ -2,7 +2,19 @@
  * ESP32-S3 Weather Prediction System - MODULAR ARCHITECTURE v3.0
  * 
  * Architecture:
- * - Startup: WiFi + Cloud connections ONLY (NO sensor init)
+ * - Startup: dependency-ordered boot pipeline (boot_pipeline.h); sampling
+ *   starts immediately, WiFi/NTP/ThingSpeak/Firebase finish in the
+ *   background (NO sensor init)
+ * - Loop: periodic work runs as drift-free tasks on a timer wheel
+ *   (task_scheduler.h); loop() sleeps until the next deadline
+ * - Dual-core pipeline (telemetry_pipeline.h): sampling + inference on the
+ *   loop() core, WiFi/NTP/uploads on a network task pinned to the WiFi
+ *   core, linked by a bounded queue
+ * - Logging (deferred_log.h): readings, predictions and uploads are binary
+ *   records in a RAM ring, written to the serial port by a low-priority
+ *   task; decode with host_tools/log_decoder.cpp (text passes through)
+ * - Latency windows (latency_window.h): inference, loop and upload
+ *   histograms per 5-minute window, summaries shipped with telemetry
  * - Commands:
  *   • "sensortest" - Test real hardware sensors (15 readings, 15 seconds)
  *   • "startsim"   - Start continuous simulation mode
@@ -21,6 +33,7 @@
  * - Software I2C isolation during WiFi init
  * - 15-second data averaging for stability
  * - ThingSpeak cloud integration (15s rate limit compliant)
+ * - One telemetry record per prediction, fanned out to ThingSpeak, Firebase and a local CSV log
  * - ML weather prediction (RandomForest 250 trees)
  */
 
@@ -30,16 +43,36 @@
 #include "weather_model_250.h"
 #include "weather_scaling.h"
 
+// Deferred log: messages above this level are compiled out
+// (LOG_LEVEL_DEBUG adds per-second readings, queued Firebase readings and
+// waiting sinks)
+#define LOG_LEVEL LOG_LEVEL_INFO
+
+// Firebase backup (credentials and batching in firebase_manager.h). Set
+// before the include so it replaces the header's default.
+#ifndef FIREBASE_ENABLED
+#define FIREBASE_ENABLED false
+#endif
+
 // Include modular components
+#include "deferred_log.h"
 #include "wifi_manager.h"
+#include "time_service.h"
 #include "cloud_manager.h"
 #include "firebase_manager.h"
+#include "telemetry_dispatcher.h"
+#include "telemetry_sinks.h"
 #include "sensor_aht10.h"
 #include "sensor_bme280.h"
 #include "sensor_bh1750.h"
 #include "sensor_mq2.h"
 #include "sensor_test.h"
 #include "sensor_simulate.h"
+#include "boot_pipeline.h"
+#include "task_scheduler.h"
+#include "task_port.h"
+#include "telemetry_pipeline.h"
+#include "serial_commands.h"
 
 // ==================== CONFIGURATION ====================
 
@@ -51,15 +84,59 @@
 #define THINGSPEAK_API_KEY "J3GFLQKI0TVR6JC2"
 #define THINGSPEAK_CHANNEL_ID "3108323"
 
-// Firebase
-#define FIREBASE_ENABLED false
+// Local binary collector (see host_tools/telemetry_collector.cpp, COLLECTOR_* in telemetry_sinks.h)
+#define COLLECTOR_ENABLED false
+
+// MQTT uplink (MQTT_* broker settings in telemetry_sinks.h)
+#define MQTT_ENABLED false
+
+// Report-by-exception for cloud sinks (deadbands in report_by_exception.h);
+// the local CSV log always keeps every record
+#define REPORT_BY_EXCEPTION_ENABLED true
+
+// Boot
+#define AUTO_START_SIMULATION true     // Start sampling at boot instead of waiting for 'startsim'
+#define SERIAL_WAIT_MS 1000            // Wait at most this long for the USB console
+#define BOOT_TIME_STAGE_MS 30000       // Profile gives up on NTP after this (sync continues in loop())
+
+// Loop scheduler (task periods; sampling/prediction periods live in sensor_simulate.h)
+#define BOOT_STEP_INTERVAL_MS 50       // Boot stages polled until all have settled
+#define WIFI_UPDATE_INTERVAL_MS 100    // Apply WiFi driver events and due retries
+#define TIME_UPDATE_INTERVAL_MS 1000   // NTP first-sync / re-anchor check
+#define TELEMETRY_POLL_INTERVAL_MS 100 // Deferred uploads, MQTT acks, batch flushes
+#define LOOP_MAX_SLEEP_MS 20           // Upper bound on one sleep (serial input stays responsive)
+
+// Dual-core pipeline (false = everything on the loop() core, as before)
+#define DUAL_CORE_PIPELINE true
+#define NETWORK_CORE 0                 // WiFi/lwIP run here (PRO_CPU); loop() is on core 1
+#define NETWORK_TASK_STACK 16384       // Bytes; TLS handshakes (Firebase) need the room
+#define NETWORK_TASK_PRIORITY 1        // Same as loop()
+#define NETWORK_MAX_WAIT_MS 100        // Upper bound on one wait for records
+
+// Deferred log drain (LOG_LEVEL is set above the includes)
+#define LOG_OUTPUT_BINARY true         // Frames for log_decoder; false = text formatted by the drain task
+#define LOG_TASK_CORE 1                // Shares the loop() core below its priority: runs while loop() sleeps
+#define LOG_TASK_PRIORITY 0
+#define LOG_TASK_STACK 4096            // Bytes; text mode formats floats with snprintf
+#define LOG_DRAIN_PERIOD_MS 20
+#define LOG_DRAIN_BATCH 32             // Records per wake-up
 
 // ==================== GLOBAL OBJECTS ====================
 
 // Managers
 WiFiManager wifiManager;
+TimeService timeService;
 CloudManager cloudManager(THINGSPEAK_API_KEY, THINGSPEAK_CHANNEL_ID);
-FirebaseManager firebaseManager;  // Firebase enabled/disabled via FIREBASE_ENABLED define in firebase_manager.h
+FirebaseManager firebaseManager;  // Firebase enabled/disabled via FIREBASE_ENABLED above the includes
+
+// Telemetry fan-out (one record → every sink)
+TelemetryDispatcher telemetry;
+ThingSpeakSink thingSpeakSink(&cloudManager);
+FirebaseSink firebaseSink(&firebaseManager);
+LocalFileSink localFileSink;
+ReportByException exceptionFilter;
+CollectorSink collectorSink;
+MqttSink mqttSink;
 
 // Sensors (created but NOT initialized at startup)
 AHT10Sensor aht10;
@@ -74,16 +151,245 @@ Eloquent::ML::Port::RandomForest classifier;
 SensorTest* sensorTest;
 SensorSimulator simulator;
 
-// System state
-String inputString = "";
-bool stringComplete = false;
+// Loop schedulers: CPU time per task from the microsecond clock.
+// acquisitionScheduler runs in loop() (sampling, prediction),
+// networkScheduler on the network task (boot, WiFi, time, telemetry) -
+// or also in loop() when DUAL_CORE_PIPELINE is false
+uint32_t schedulerMicros() { return micros(); }
+TaskScheduler acquisitionScheduler(schedulerMicros);
+TaskScheduler networkScheduler(schedulerMicros);
+
+// Acquisition → network hand-off
+TelemetryPipeline pipeline;
+PortTask networkTask;
+bool networkTaskRunning = false;
+
+// Console command waiting for the network task (see postNetworkCommand)
+PortLock networkCommandLock;
+SerialCommandHandler networkCommand = nullptr;
+const char* networkCommandArgs = "";
+
+// Serial console (fixed line buffer, see serial_commands.h)
+SerialLineReader console;
+
+// Deferred log drain and time spent in LOG() per loop() iteration /
+// network task pass (only passes that ran something are counted)
+PortTask logTask;
+LatencyHistogram logLoopUs;
+LatencyHistogram logNetworkUs;
+
+// ==================== BOOT PIPELINE ====================
+// Init stages with their dependencies (boot_pipeline.h). Each stage is
+// called with start=true once, then polled until DONE or FAILED - from
+// setup() and then from loop(), so sampling starts right away and the
+// network stages finish in the background.
+
+uint32_t bootClock() { return millis(); }
+BootPipeline boot(bootClock);
+int bootRadio, bootTelemetry, bootSampling, bootLink, bootTime, bootFirebase, bootThingSpeak;
+bool bootProfilePrinted = false;
+
+// Radio up and association started (connect() returns immediately)
+BootStatus bootRadioStage(bool start) {
+    wifiManager.begin();
+    wifiManager.connect();
+    return BOOT_STAGE_DONE;
+}
+
+// Sinks and scheduler; needs the MAC (device ID) from the radio stage
+BootStatus bootTelemetryStage(bool start) {
+    localFileSink.begin();
+    telemetry.setDeviceID(firebaseManager.getDeviceIDCStr());
+    // Rate limits live here: local/LAN sinks are unlimited, cloud sinks
+    // get token buckets and share the global upload budget
+    telemetry.addSink(&localFileSink, RATE_PRIORITY_HIGH);
+    telemetry.addSink(&thingSpeakSink, RATE_PRIORITY_NORMAL, THINGSPEAK_MIN_INTERVAL_MS, 1, true);
+    telemetry.addSink(&firebaseSink, RATE_PRIORITY_LOW, firebaseManager.getBackupInterval(), 1, true);
+    if (COLLECTOR_ENABLED) {
+        telemetry.addSink(&collectorSink, RATE_PRIORITY_HIGH);
+    }
+    if (MQTT_ENABLED) {
+        mqttSink.begin(firebaseManager.getDeviceIDCStr());
+        telemetry.addSink(&mqttSink, RATE_PRIORITY_NORMAL, 0, 1, true);
+    }
+    if (REPORT_BY_EXCEPTION_ENABLED) {
+        telemetry.setExceptionFilter(&exceptionFilter);
+    }
+    return BOOT_STAGE_DONE;
+}
+
+// Sampling starts before the network: cloud sinks that are not ready yet
+// keep their latest record, the local log keeps every record
+BootStatus bootSamplingStage(bool start) {
+    simulator.begin();
+    simulator.setWiFiStatus(wifiManager.isConnected());
+    simulator.setTelemetryDispatcher(&telemetry);
+    simulator.setScheduler(&acquisitionScheduler);
+    if (DUAL_CORE_PIPELINE) {
+        pipeline.begin();
+        simulator.setPipeline(&pipeline);
+    }
+    if (AUTO_START_SIMULATION) {
+        simulator.start();
+    }
+    return BOOT_STAGE_DONE;
+}
+
+// Readiness signal for everything that needs the network
+BootStatus bootLinkStage(bool start) {
+    wifiManager.update();
+    return wifiManager.isConnected() ? BOOT_STAGE_DONE : BOOT_STAGE_RUNNING;
+}
+
+BootStatus bootTimeStage(bool start) {
+    if (start) {
+        timeService.start();
+    }
+    timeService.update();
+    return timeService.isSynced() ? BOOT_STAGE_DONE : BOOT_STAGE_RUNNING;
+}
+
+BootStatus bootThingSpeakStage(bool start) {
+    return cloudManager.testConnection() ? BOOT_STAGE_DONE : BOOT_STAGE_FAILED;
+}
+
+BootStatus bootFirebaseStage(bool start) {
+    if (start) {
+        firebaseManager.initialize();
+    }
+    if (!firebaseManager.finishInitialize()) {
+        return BOOT_STAGE_RUNNING;
+    }
+    return firebaseManager.isInitialized() ? BOOT_STAGE_DONE : BOOT_STAGE_FAILED;
+}
+
+// ==================== LOOP TASKS ====================
+// Periodic work registered with networkScheduler in setup(); the simulator
+// adds its own sampling and prediction tasks to acquisitionScheduler on
+// start()
+
+int bootTask = TASK_NONE;
+
+// Steps the boot pipeline; prints the profile once the first prediction
+// is out and every stage settled, then cancels itself
+void bootTaskFn(void* context) {
+    boot.step();
+    if (telemetry.getTotalRecords() > 0) {
+        boot.mark("first_prediction");
+    }
+    if (boot.isComplete() && boot.markTime("first_prediction") != 0) {
+        if (!bootProfilePrinted) {
+            printBootProfile();
+            bootProfilePrinted = true;
+        }
+        networkScheduler.cancel(bootTask);
+    }
+}
+
+// WiFi state machine: applies driver events and due retries (never blocks)
+void wifiTaskFn(void* context) {
+    wifiManager.update();
+    simulator.setWiFiStatus(wifiManager.isConnected());
+}
+
+void wifiCheckTaskFn(void* context) {
+    wifiManager.checkStatus();
+}
+
+void timeTaskFn(void* context) {
+    timeService.update();
+}
+
+// Send deferred telemetry as tokens refill; service MQTT acks/keep-alive
+void telemetryTaskFn(void* context) {
+    telemetry.poll();
+}
+
+// ==================== NETWORK TASK ====================
+// Dual-core mode: runs networkScheduler and fans out records from the
+// acquisition core. Waiting on the queue is the task's sleep, so a new
+// prediction is dispatched as soon as it is submitted.
+
+void dispatchRecord(const TelemetryRecord& record, void* context) {
+    static_cast<TelemetryDispatcher*>(context)->dispatch(record);
+}
+
+// Console commands that print state the network task writes (sinks,
+// dispatcher, MQTT session, WiFi, clock, boot stages, its scheduler) run
+// here instead of in loop(), so they never read it mid-update. One slot:
+// a second post before the first has run is refused. args must stay
+// valid until the command ran ("" or a static buffer).
+bool postNetworkCommand(SerialCommandHandler handler, const char* args) {
+    if (!networkTaskRunning) {
+        handler(args);
+        return true;
+    }
+    networkCommandLock.lock();
+    bool posted = networkCommand == nullptr;
+    if (posted) {
+        networkCommand = handler;
+        networkCommandArgs = args;
+    }
+    networkCommandLock.unlock();
+    if (!posted) {
+        Serial.println("⏳ Network task busy with the previous command - try again");
+    }
+    return posted;
+}
+
+void runNetworkCommand() {
+    networkCommandLock.lock();
+    SerialCommandHandler handler = networkCommand;
+    const char* args = networkCommandArgs;
+    networkCommandLock.unlock();
+    if (handler == nullptr) return;
+    handler(args);
+    networkCommandLock.lock();
+    networkCommand = nullptr;
+    networkCommandLock.unlock();
+}
+
+void networkTaskFn(void* arg) {
+    for (;;) {
+        int ran = networkScheduler.run(millis());
+        runNetworkCommand();
+        uint32_t wait = networkScheduler.msUntilNext(millis());
+        if (wait > NETWORK_MAX_WAIT_MS) wait = NETWORK_MAX_WAIT_MS;
+        uint32_t before = millis();
+        int dispatched = pipeline.drain(dispatchRecord, &telemetry, wait);
+        if (dispatched == 0) {
+            networkScheduler.addIdle(millis() - before);
+        }
+        uint32_t logged = deferred_log().takeSpentUs(port_current_core());
+        if (ran > 0 || dispatched > 0) {
+            logNetworkUs.record(logged);
+        }
+    }
+}
+
+// ==================== LOG TASK ====================
+// Writes queued log records to the serial port. A full UART blocks this
+// task, not the sampling or network work that produced the records.
+
+void logWrite(const uint8_t* data, size_t length, void* context) {
+    Serial.write(data, length);
+}
+
+void logTaskFn(void* arg) {
+    for (;;) {
+        deferred_log().drain(logWrite, nullptr, LOG_OUTPUT_BINARY, LOG_DRAIN_BATCH);
+        port_delay_ms(LOG_DRAIN_PERIOD_MS);
+    }
+}
 
 // ==================== SETUP ====================
 
 void setup() {
     Serial.begin(115200);
-    while (!Serial) { ; }
-    delay(1000);
+    // USB CDC console: wait briefly for a host, never indefinitely
+    while (!Serial && millis() < SERIAL_WAIT_MS) {
+        delay(10);
+    }
     
     // ========== SIMULATION MODE ONLY - REAL SENSORS DISABLED ==========
     // COMMENTED OUT: Real sensor I2C initialization to avoid WiFi interference
@@ -98,126 +404,279 @@ void setup() {
     
     Serial.println("⚠️  SIMULATION MODE: Real sensors are DISABLED");
     Serial.println("   I2C pins not initialized - prevents WiFi interference");
-    Serial.println("   Use 'startsim' command for data generation");
+    Serial.println(AUTO_START_SIMULATION ? "   Simulation starts at boot (any key stops it)"
+                                         : "   Use 'startsim' command for data generation");
     Serial.println();
     
+    if (!logTask.start("log", logTaskFn, nullptr, LOG_TASK_STACK, LOG_TASK_PRIORITY, LOG_TASK_CORE)) {
+        Serial.println("❌ Log task could not be created - log records will be dropped");
+    } else if (LOG_OUTPUT_BINARY) {
+        Serial.println("📝 Log: binary records on this port (decode with host_tools/log_decoder)");
+        Serial.println();
+    }
+    
     printBanner();
     
-    // Step 1: WiFi Connection
-    wifiManager.begin();
-    wifiManager.connect();
+    // Wall clock for Firebase keys and timestamps (set once NTP answers)
+    firebaseManager.setClock(&timeService.clock());
+    telemetry.setClock(&timeService.clock());
     
-    // Step 2: ThingSpeak Connection Test
-    cloudManager.testConnection();
+    // Stages start as soon as their dependencies are done:
+    //   radio ─┬─ telemetry ── sampling
+    //          └─ link ─┬─ time
+    //                   ├─ firebase
+    //                   └─ thingspeak
+    // (firebase before thingspeak: its token request is in flight while
+    // the blocking ThingSpeak probe runs)
+    bootRadio = boot.addStage("radio", bootRadioStage);
+    bootTelemetry = boot.addStage("telemetry", bootTelemetryStage, BOOT_DEP(bootRadio));
+    bootSampling = boot.addStage("sampling", bootSamplingStage, BOOT_DEP(bootTelemetry));
+    bootLink = boot.addStage("link", bootLinkStage, BOOT_DEP(bootRadio));
+    bootTime = boot.addStage("time", bootTimeStage, BOOT_DEP(bootLink), BOOT_TIME_STAGE_MS);
+    bootFirebase = boot.addStage("firebase", bootFirebaseStage, BOOT_DEP(bootLink));
+    bootThingSpeak = boot.addStage("thingspeak", bootThingSpeakStage, BOOT_DEP(bootLink));
     
-    // CRITICAL: Allow HTTP client to fully release before any future uploads
-    // ESP32 HTTPClient requires time to properly close connections
-    Serial.println("   ⏳ Waiting 2 seconds for HTTP connection to release...");
-    delay(2000);
-    Serial.println("   ✅ HTTP client ready for future requests");
-    Serial.println();
+    // Network tasks (the sampling stage adds the simulator's tasks to
+    // acquisitionScheduler)
+    uint32_t now = millis();
+    bootTask = networkScheduler.every("boot", BOOT_STEP_INTERVAL_MS, bootTaskFn, nullptr, now);
+    networkScheduler.every("wifi", WIFI_UPDATE_INTERVAL_MS, wifiTaskFn, nullptr, now);
+    networkScheduler.every("wificheck", WIFI_CHECK_INTERVAL, wifiCheckTaskFn, nullptr, now);
+    networkScheduler.every("time", TIME_UPDATE_INTERVAL_MS, timeTaskFn, nullptr, now);
+    networkScheduler.every("telemetry", TELEMETRY_POLL_INTERVAL_MS, telemetryTaskFn, nullptr, now);
     
-    // Step 3: Firebase Init
-    firebaseManager.initialize();
+    // First step on this core: radio → telemetry → sampling settle here,
+    // so the simulator's tasks are registered before the network task
+    // starts touching the shared objects
+    boot.step();
+    if (DUAL_CORE_PIPELINE) {
+        if (networkTask.start("network", networkTaskFn, nullptr, NETWORK_TASK_STACK, NETWORK_TASK_PRIORITY,
+                              NETWORK_CORE)) {
+            networkTaskRunning = true;
+            Serial.printf("   Pipeline: acquisition on core %d, network on core %d\n", port_current_core(),
+                          NETWORK_CORE);
+        } else {
+            Serial.println("❌ Network task could not be created - uploads stopped");
+        }
+    }
     
     // COMMENTED OUT: Real sensor test module
     // Uncomment when hardware fixes are complete
     // sensorTest = new SensorTest(I2C_SDA, I2C_SCL, 
     //                              &aht10, &bme280, &bh1750, &mq2,
-    //                              &cloudManager, &firebaseManager, &classifier);
-    
-    simulator.begin();
-    simulator.setWiFiStatus(wifiManager.isConnected());
-    simulator.setFirebaseManager(&firebaseManager);
+    //                              &telemetry, &classifier);
     
     // Ready!
     Serial.println("\n╔════════════════════════════════════════════════════════╗");
     Serial.println("║              ✅ SYSTEM READY - SIMULATION MODE         ║");
     Serial.println("╚════════════════════════════════════════════════════════╝");
     Serial.println();
+    Serial.printf("   Boot: %lu ms to loop(), network stages continue in the background\n", millis());
+    Serial.println();
     Serial.println("💡 Available Commands:");
     Serial.println("   • startsim   - Start continuous simulation (RECOMMENDED)");
     Serial.println("   • help       - Show command help");
     Serial.println();
     Serial.println("⚠️  Note: 'sensortest' command disabled (hardware not configured)");
     Serial.println();
-    
-    inputString.reserve(200);
 }
 
 // ==================== MAIN LOOP ====================
 
 void loop() {
-    // CRITICAL: Monitor WiFi connection status continuously
-    // This detects disconnections and can trigger auto-reconnect
-    wifiManager.update();
-    
-    // Update WiFi status for simulator
-    simulator.setWiFiStatus(wifiManager.isConnected());
+    uint32_t loopStart = micros();
     
-    // Update simulator (if running)
-    simulator.update();
+    // Every task whose deadline has passed: sampling and prediction (plus
+    // boot, WiFi, time and telemetry when running on one core)
+    int ran = acquisitionScheduler.run(millis());
+    if (!DUAL_CORE_PIPELINE) {
+        ran += networkScheduler.run(millis());
+    }
+    uint32_t logged = deferred_log().takeSpentUs(port_current_core());
+    if (ran > 0) {
+        logLoopUs.record(logged);
+    }
     
     // Check for serial input
-    if (stringComplete) {
+    if (console.ready()) {
         // Stop simulation if any key pressed while running
         if (simulator.running()) {
             simulator.stop();
+            postNetworkCommand(cmdTelemetry, "");
         } else {
-            processCommand();
+            processCommand(console.line());
+        }
+        console.clear();
+    }
+    telemetry.loopIteration(ran > 0, micros() - loopStart);
+    
+    // Sleep until the next deadline (delay() yields to the other FreeRTOS
+    // tasks); serialEvent() runs when loop() returns
+    if (!Serial.available()) {
+        uint32_t wait = acquisitionScheduler.msUntilNext(millis());
+        if (!DUAL_CORE_PIPELINE) {
+            uint32_t network = networkScheduler.msUntilNext(millis());
+            if (network < wait) wait = network;
+        }
+        if (wait > LOOP_MAX_SLEEP_MS) wait = LOOP_MAX_SLEEP_MS;
+        if (wait > 0) {
+            delay(wait);
+            acquisitionScheduler.addIdle(wait);
         }
-        inputString = "";
-        stringComplete = false;
     }
 }
 
 void serialEvent() {
-    while (Serial.available()) {
-        char inChar = (char)Serial.read();
-        if (inChar == '\n' || inChar == '\r') {
-            if (inputString.length() > 0) {
-                stringComplete = true;
-            }
-        } else {
-            inputString += inChar;
-        }
-    }
+    console.pump(Serial);
 }
 
 // ==================== COMMAND PROCESSING ====================
 
-void processCommand() {
-    inputString.trim();
-    inputString.toLowerCase();
+void cmdSensorTest(const char* args) {
+    // DISABLED: Real sensor testing (hardware not configured)
+    Serial.println();
+    Serial.println("❌ 'sensortest' command is currently DISABLED");
+    Serial.println();
+    Serial.println("Reason: Real sensors cause WiFi interference without proper hardware fixes");
+    Serial.println();
+    Serial.println("Required hardware to enable:");
+    Serial.println("   ✓ External 5V power supply for sensors");
+    Serial.println("   ✓ 2× 2.2kΩ pull-up resistors on SDA/SCL");
+    Serial.println("   ✓ 4× 10µF decoupling capacitors (one per sensor)");
+    Serial.println("   ✓ 1× 100µF main power capacitor");
+    Serial.println("   ✓ Short I2C cables (<15cm, twisted)");
+    Serial.println();
+    Serial.println("💡 For now, use 'startsim' for weather prediction testing");
+    Serial.println();
     
-    if (inputString == "sensortest") {
-        // DISABLED: Real sensor testing (hardware not configured)
-        Serial.println();
-        Serial.println("❌ 'sensortest' command is currently DISABLED");
-        Serial.println();
-        Serial.println("Reason: Real sensors cause WiFi interference without proper hardware fixes");
-        Serial.println();
-        Serial.println("Required hardware to enable:");
-        Serial.println("   ✓ External 5V power supply for sensors");
-        Serial.println("   ✓ 2× 2.2kΩ pull-up resistors on SDA/SCL");
-        Serial.println("   ✓ 4× 10µF decoupling capacitors (one per sensor)");
-        Serial.println("   ✓ 1× 100µF main power capacitor");
-        Serial.println("   ✓ Short I2C cables (<15cm, twisted)");
-        Serial.println();
-        Serial.println("💡 For now, use 'startsim' for weather prediction testing");
-        Serial.println();
-        
-        // Uncomment this line when hardware is ready:
-        // sensorTest->run();
-    } else if (inputString == "startsim") {
-        simulator.start();
-    } else if (inputString == "help") {
-        printHelp();
-    } else {
+    // Uncomment this line when hardware is ready:
+    // sensorTest->run();
+}
+
+void cmdStartSim(const char* args) { simulator.start(); }
+void cmdTelemetry(const char* args) { telemetry.printStatistics(); }
+void cmdTelemetryBench(const char* args) { telemetry.runBenchmark(1000); }
+void cmdNetStats(const char* args) { telemetry.printNetworkStats(); }
+void cmdLatency(const char* args) { telemetry.printLatencyWindow(); }
+void cmdMqtt(const char* args) { mqttSink.printStatistics(); }
+void cmdTime(const char* args) { timeService.printStatus(); }
+void cmdWiFi(const char* args) { wifiManager.printStatistics(); }
+void cmdBoot(const char* args) { printBootProfile(); }
+void cmdPipeline(const char* args) { printPipelineStatistics(); }
+void cmdLog(const char* args) { printLogStatistics(); }
+void cmdHelp(const char* args) { printHelp(); }
+
+void cmdNetStatsJson(const char* args) {
+    static char json[TELEMETRY_DIAGNOSTICS_SIZE];
+    if (telemetry.encodeNetworkStats(json, sizeof(json)) >= 0) {
+        Serial.println(json);
+    }
+}
+
+void cmdBootJson(const char* args) {
+    static char json[640];
+    if (boot.encodeJson(json, sizeof(json)) >= 0) {
+        Serial.println(json);
+    }
+}
+
+void printNetworkTasks(const char* args) {
+    printTaskStatistics(DUAL_CORE_PIPELINE ? "Network task" : "Network (on loop())", networkScheduler);
+}
+
+void cmdTasks(const char* args) {
+    printTaskStatistics("Acquisition", acquisitionScheduler);
+    postNetworkCommand(printNetworkTasks, "");
+}
+
+// Acquisition half encoded here, network half by printNetworkTasksJson on
+// the network task (the buffer is not reused until that post has run)
+static char tasksJson[1536];
+
+void printNetworkTasksJson(const char* args) {
+    int used = (int)strlen(tasksJson);
+    used += snprintf(tasksJson + used, sizeof(tasksJson) - used, ",\"network\":");
+    if (networkScheduler.encodeJson(tasksJson + used, sizeof(tasksJson) - used - 1) >= 0) {
+        Serial.printf("%s}\n", tasksJson);
+    }
+}
+
+void cmdTasksJson(const char* args) {
+    if (networkTaskRunning) {
+        networkCommandLock.lock();
+        bool busy = networkCommand != nullptr;
+        networkCommandLock.unlock();
+        if (busy) {
+            Serial.println("⏳ Network task busy with the previous command - try again");
+            return;
+        }
+    }
+    int used = snprintf(tasksJson, sizeof(tasksJson), "{\"acquisition\":");
+    if (acquisitionScheduler.encodeJson(tasksJson + used, sizeof(tasksJson) - used) >= 0) {
+        postNetworkCommand(printNetworkTasksJson, "");
+    }
+}
+
+void cmdPipelineJson(const char* args) {
+    static char json[512];
+    if (pipeline.encodeJson(json, sizeof(json)) >= 0) {
+        Serial.println(json);
+    }
+}
+
+void cmdConsole(const char* args) {
+    Serial.printf("\n⌨️  Console: %lu lines, %lu overlong (max %d chars)\n\n", (unsigned long)console.getLines(),
+                  (unsigned long)console.getOverflows(), SERIAL_LINE_MAX - 1);
+}
+
+// Matched case-insensitively on whole words; serial_find picks the longest
+// matching name ("netstats json" beats "netstats"), so table order only
+// sets the order of the help listing
+static const SerialCommand COMMANDS[] = {
+    { "startsim", cmdStartSim, "Start continuous simulation (RECOMMENDED)" },
+    { "sensortest", cmdSensorTest, "Test real hardware sensors (DISABLED)" },
+    { "telemetry", cmdTelemetry, "Show per-sink upload statistics" },
+    { "telemetrybench", cmdTelemetryBench, "Benchmark record encoding (CPU + heap per record)" },
+    { "netstats", cmdNetStats, "Upload latency per phase (DNS/connect/send/server/read)" },
+    { "netstats json", cmdNetStatsJson, "Same histograms as JSON (also exported every 5 min)" },
+    { "latency", cmdLatency, "Last 5-min window: inference/loop/upload p50-p99 (sent with telemetry)" },
+    { "mqtt", cmdMqtt, "Show MQTT uplink session statistics" },
+    { "time", cmdTime, "Show NTP sync state and clock drift" },
+    { "wifi", cmdWiFi, "Show WiFi link state, retries and outages" },
+    { "boot", cmdBoot, "Boot profile: per-stage timings, time to first prediction" },
+    { "boot json", cmdBootJson, "Same profile as JSON" },
+    { "tasks", cmdTasks, "Loop tasks: runs, skipped periods, lateness, CPU time" },
+    { "tasks json", cmdTasksJson, "Same figures as JSON" },
+    { "pipeline", cmdPipeline, "Dual-core pipeline: per-stage throughput, queue latency" },
+    { "pipeline json", cmdPipelineJson, "Same figures as JSON" },
+    { "console", cmdConsole, "Serial input statistics (lines, overlong lines)" },
+    { "log", cmdLog, "Deferred log: records, drops, ring use, LOG() time per cycle" },
+    { "help", cmdHelp, "Show this help message" },
+};
+
+// Handlers posted to the network task rather than run in loop()
+static const SerialCommandHandler NETWORK_COMMANDS[] = {
+    cmdTelemetry, cmdTelemetryBench, cmdNetStats, cmdNetStatsJson, cmdLatency,
+    cmdMqtt, cmdTime, cmdWiFi, cmdBoot, cmdBootJson,
+};
+
+void processCommand(const char* line) {
+    const char* args = "";
+    const SerialCommand* command = serial_find(COMMANDS, SERIAL_COMMAND_COUNT(COMMANDS), line, &args);
+    if (command == nullptr) {
         Serial.println("❌ Unknown command");
         Serial.println("💡 Type 'help' for available commands");
         Serial.println();
+        return;
+    }
+    for (size_t i = 0; i < SERIAL_COMMAND_COUNT(NETWORK_COMMANDS); i++) {
+        if (command->handler == NETWORK_COMMANDS[i]) {
+            // args points into the console line, cleared after this call
+            postNetworkCommand(command->handler, "");
+            return;
+        }
     }
+    command->handler(args);
 }
 
 // ==================== UI ====================
@@ -231,6 +690,121 @@ void printBanner() {
     Serial.println();
 }
 
+void printBootProfile() {
+    Serial.println("\n🚀 Boot Profile (ms since power-on):");
+    Serial.println("─────────────────────────────────────────────────────────");
+    Serial.println("   Stage        status     start      end   duration    busy");
+    for (int i = 0; i < boot.getStageCount(); i++) {
+        const BootStage& s = boot.getStage(i);
+        bool started = s.status != BOOT_STAGE_PENDING;
+        bool ended = s.status != BOOT_STAGE_PENDING && s.status != BOOT_STAGE_RUNNING;
+        uint32_t end = ended ? s.endMs : millis();
+        char endText[12] = "-";
+        if (ended) {
+            snprintf(endText, sizeof(endText), "%lu", (unsigned long)s.endMs);
+        }
+        Serial.printf("   %-11s  %-8s %7lu  %7s  %7lu ms  %4lu ms%s\n", s.name, BOOT_STAGE_STATUS_NAMES[s.status],
+                      started ? (unsigned long)s.startMs : 0UL, endText,
+                      started ? (unsigned long)(end - s.startMs) : 0UL, (unsigned long)s.busyMs,
+                      s.timedOut ? "  (timeout)" : "");
+    }
+    Serial.println("─────────────────────────────────────────────────────────");
+    Serial.printf("   Stages back to back: %lu ms | pipeline: ", (unsigned long)boot.sequentialMs());
+    if (boot.isComplete()) {
+        Serial.printf("%lu ms", (unsigned long)boot.getCompletedMs());
+    } else {
+        Serial.print("in progress");
+    }
+    Serial.printf(" | loop() held: %lu ms\n", (unsigned long)boot.busyMs());
+    for (int i = 0; i < boot.getMarkCount(); i++) {
+        Serial.printf("   %s: %lu ms after power-on\n", boot.getMark(i).name, (unsigned long)boot.getMark(i).atMs);
+    }
+    Serial.println("─────────────────────────────────────────────────────────");
+    Serial.println();
+}
+
+void printTaskStatistics(const char* title, const TaskScheduler& scheduler) {
+    uint32_t uptime = millis();
+    Serial.printf("\n⏱️  %s Tasks (lateness = start time minus ideal deadline):\n", title);
+    Serial.println("─────────────────────────────────────────────────────────");
+    Serial.println("   Task         period    runs  skip  miss   late avg/max    cpu avg/max");
+    for (int i = 0; i < scheduler.getTaskCount(); i++) {
+        const ScheduledTask& t = scheduler.getTask(i);
+        if (!t.active) continue;
+        Serial.printf("   %-10s %6lu ms %7lu %5lu %5lu  %5.1f/%4lu ms  %6.0f/%6lu us\n", t.name,
+                      (unsigned long)t.periodMs, (unsigned long)t.stats.runs, (unsigned long)t.stats.skipped,
+                      (unsigned long)t.stats.deadlineMisses, TaskScheduler::meanLateMs(t.stats),
+                      (unsigned long)t.stats.lateMaxMs, TaskScheduler::meanCpuUs(t.stats),
+                      (unsigned long)t.stats.cpuMaxUs);
+    }
+    Serial.println("─────────────────────────────────────────────────────────");
+    Serial.printf("   Idle (sleeping): %lu ms of %lu ms (%.1f%%)\n", (unsigned long)scheduler.getIdleMs(),
+                  (unsigned long)uptime, uptime ? scheduler.getIdleMs() * 100.0f / uptime : 0.0f);
+    Serial.println("─────────────────────────────────────────────────────────");
+    Serial.println();
+}
+
+void printPipelineStatistics() {
+    if (!DUAL_CORE_PIPELINE) {
+        Serial.println("\nℹ️  Dual-core pipeline disabled (DUAL_CORE_PIPELINE false)\n");
+        return;
+    }
+    char p50[16], p99[16], worst[16];
+    const LatencyHistogram& latency = pipeline.getQueueLatency();
+    Serial.println("\n🔀 Dual-Core Pipeline:");
+    Serial.println("─────────────────────────────────────────────────────────");
+    Serial.println("   Stage       items    per min   busy avg    busy max");
+    for (int i = 0; i < PIPELINE_STAGE_COUNT; i++) {
+        const PipelineStageStats& s = pipeline.getStage(i);
+        char avg[16], peak[16];
+        Serial.printf("   %-9s %7lu %10.2f %10s %11s\n", PIPELINE_STAGE_NAMES[i], (unsigned long)s.items,
+                      pipeline.throughput(i) * 60.0f,
+                      latency_format_us((uint32_t)TelemetryPipeline::meanBusyUs(s), avg, sizeof(avg)),
+                      latency_format_us(s.busyMaxUs, peak, sizeof(peak)));
+    }
+    Serial.println("─────────────────────────────────────────────────────────");
+    Serial.printf("   Queue: %lu/%lu queued, high-water %lu, dropped %lu\n", (unsigned long)pipeline.getDepth(),
+                  (unsigned long)pipeline.getCapacity(), (unsigned long)pipeline.getHighWater(),
+                  (unsigned long)pipeline.getDropped());
+    Serial.printf("   Queue latency: p50 %s | p99 %s | max %s\n",
+                  latency_format_us(latency.percentile(50), p50, sizeof(p50)),
+                  latency_format_us(latency.percentile(99), p99, sizeof(p99)),
+                  latency_format_us(latency.max(), worst, sizeof(worst)));
+    Serial.printf("   Network task stack free: %lu bytes\n", (unsigned long)networkTask.stackHighWater());
+    Serial.println("─────────────────────────────────────────────────────────");
+    Serial.println();
+}
+
+void printLogStatistics() {
+    LogStats s = deferred_log().getStats();
+    Serial.println("\n📝 Deferred Log:");
+    Serial.println("─────────────────────────────────────────────────────────");
+    Serial.printf("   Level: %s | output: %s\n", LOG_LEVEL_NAMES[LOG_LEVEL],
+                  LOG_OUTPUT_BINARY ? "binary frames" : "text (drain task)");
+    Serial.printf("   Records: %lu (%.1f B avg), drained %lu, dropped %lu, oversized %lu\n",
+                  (unsigned long)s.records, s.records ? (float)s.bytes / s.records : 0.0f,
+                  (unsigned long)s.drained, (unsigned long)s.dropped, (unsigned long)s.truncated);
+    Serial.printf("   Ring: %lu/%lu B queued, high-water %lu B\n", (unsigned long)deferred_log().getDepth(),
+                  (unsigned long)DeferredLog::capacity(), (unsigned long)s.highWater);
+    Serial.printf("   Output: %lu B, drain busy %lu ms total, max %lu us per wake-up\n",
+                  (unsigned long)s.outputBytes, (unsigned long)(s.drainBusyUs / 1000),
+                  (unsigned long)s.drainMaxUs);
+    Serial.println("─────────────────────────────────────────────────────────");
+    Serial.println("   LOG() time per cycle   cycles      p50      p99      max");
+    const LatencyHistogram* cycles[] = { &logLoopUs, &logNetworkUs };
+    const char* names[] = { "loop()", "network task" };
+    for (int i = 0; i < 2; i++) {
+        char p50[16], p99[16], worst[16];
+        Serial.printf("   %-20s %8lu %8s %8s %8s\n", names[i], (unsigned long)cycles[i]->count(),
+                      latency_format_us(cycles[i]->percentile(50), p50, sizeof(p50)),
+                      latency_format_us(cycles[i]->percentile(99), p99, sizeof(p99)),
+                      latency_format_us(cycles[i]->max(), worst, sizeof(worst)));
+    }
+    Serial.printf("   Log task stack free: %lu bytes\n", (unsigned long)logTask.stackHighWater());
+    Serial.println("─────────────────────────────────────────────────────────");
+    Serial.println();
+}
+
 void printHelp() {
     Serial.println("\n╔════════════════════════════════════════════════════════╗");
     Serial.println("║                  AVAILABLE COMMANDS                    ║");
@@ -238,18 +812,14 @@ void printHelp() {
     Serial.println();
     Serial.println("📋 Command List:");
     Serial.println("─────────────────────────────────────────────────────────");
-    Serial.println("   startsim   - Start continuous simulation (RECOMMENDED)");
-    Serial.println("                • Random sensor data generation");
-    Serial.println("                • 1 reading/second");
-    Serial.println("                • Prediction every 15 seconds");
-    Serial.println("                • Auto cloud upload with retry logic");
-    Serial.println("                • Press ANY KEY to stop");
-    Serial.println();
-    Serial.println("   sensortest - Test real hardware sensors (DISABLED)");
-    Serial.println("                ⚠️  Requires external 5V power & proper wiring");
-    Serial.println("                ⚠️  See WIRING_DIAGRAM_FIXED.txt for details");
+    for (size_t i = 0; i < SERIAL_COMMAND_COUNT(COMMANDS); i++) {
+        Serial.printf("   %-14s - %s\n", COMMANDS[i].name, COMMANDS[i].help);
+    }
     Serial.println();
-    Serial.println("   help       - Show this help message");
+    Serial.println("   startsim: random sensor data, 1 reading/second, prediction every");
+    Serial.println("   15 seconds, cloud upload per sink - press ANY KEY to stop");
+    Serial.println("   sensortest: requires external 5V power & proper wiring");
+    Serial.println("   (see WIRING_DIAGRAM_FIXED.txt)");
     Serial.println("─────────────────────────────────────────────────────────");
     Serial.println();
     Serial.println("ℹ️  NOTE: Model may occasionally confuse similar conditions");
@@ -18,7 +18,12 @@
  * - help: Show all commands
  * - test: Run 6 quick test predictions
  * - benchmark: Run comprehensive 20-second performance test with accuracy report
+ * - ibench: Cycle-counted latency distribution over the whole feature space
+ *   (p50/p90/p99/p99.9, per class, warm vs cold cache; inference_bench.h)
+ * - ibench json: Same as one JSON line, to diff across model versions
  * - stats: Show system statistics
+ * - binary: Binary framed batch mode for hardware-in-the-loop validation
+ *   (hil_protocol.h, host side: host_tools/hil_driver.cpp)
  * 
  * LED Status Indicators:
  * - BLUE pulsing: System ready/idle
@@ -27,6 +32,7 @@
  * - RED: Test failed
  * - YELLOW: Making prediction
  * - MAGENTA: Benchmark in progress
+ * - WHITE: Binary (HIL) mode
  * 
  * Model: RandomForest with 250 trees (optimized for ESP32-S3 2.5MB limit)
  * Features: Temperature (°C), Humidity (%), Pressure (Pa), Lux
@@ -38,6 +44,9 @@
 // Include the model and scaling functions
 #include "weather_model_250.h"
 #include "weather_scaling.h"
+#include "serial_commands.h"
+#include "hil_protocol.h"
+#include "inference_bench.h"
 
 // NeoPixel LED Configuration
 #include <Adafruit_NeoPixel.h>
@@ -72,9 +81,15 @@ Eloquent::ML::Port::RandomForest classifier;
 const float FEATURE_MIN[] = {19.000000f, 29.300000f, 96352.680000f, 0.000000f};
 const float FEATURE_MAX[] = {30.000000f, 56.900000f, 100301.060000f, 632.080000f};
 
-// Buffer for serial input
-String inputString = "";
-bool stringComplete = false;
+// Serial input (fixed line buffer, see serial_commands.h)
+SerialLineReader console;
+
+// Binary HIL mode: the port carries frames instead of text lines
+#define HIL_RX_BUFFER_SIZE 4096     // Holds a full batch frame plus the next one
+int hilPredict(const float* features, bool scaled, void* context);
+uint32_t hilCycles();
+void hilWrite(const uint8_t* data, size_t length, void* context);
+HilSession hil(hilPredict, hilCycles, hilWrite, nullptr);
 
 // Sensor values
 float temperature = 0.0;
@@ -92,7 +107,15 @@ unsigned long maxInferenceTime = 0;
 // Benchmark statistics
 bool benchmarkRunning = false;
 
+// Inference benchmark (~46 KB of samples: static, not on the loop task stack)
+#define IBENCH_SEED 1
+#define IBENCH_MODEL_NAME "rf250"
+int ibenchPredict(const float* scaled, void* context);
+void ibenchEvict(void* context);
+InferenceBench inferenceBench(ibenchPredict, hilCycles, nullptr);
+
 void setup() {
+    Serial.setRxBufferSize(HIL_RX_BUFFER_SIZE);
     Serial.begin(115200);
     while (!Serial) {
         ; // Wait for serial port to connect
@@ -166,8 +189,6 @@ void setup() {
     
     printUsageInstructions();
     
-    inputString.reserve(200);
-    
     // Set LED to idle state
     setLED(COLOR_BLUE);
 }
@@ -178,7 +199,7 @@ void loop() {
     static int pulseDirection = 1;
     static int pulseBrightness = 10;
     
-    if (!benchmarkRunning && millis() - lastPulse > 50) {
+    if (!benchmarkRunning && !hil.isActive() && millis() - lastPulse > 50) {
         lastPulse = millis();
         pulseBrightness += pulseDirection * 5;
         if (pulseBrightness >= 50) pulseDirection = -1;
@@ -189,59 +210,246 @@ void loop() {
     }
     
     // Check for serial input
-    if (stringComplete) {
-        processInput();
-        inputString = "";
-        stringComplete = false;
+    if (console.ready()) {
+        processInput(console.line());
+        console.clear();
         
-        if (!benchmarkRunning) {
+        if (!benchmarkRunning && !hil.isActive()) {
             setLED(COLOR_BLUE);
         }
     }
 }
 
 void serialEvent() {
-    while (Serial.available()) {
-        char inChar = (char)Serial.read();
-        
-        if (inChar == '\n' || inChar == '\r') {
-            if (inputString.length() > 0) {
-                stringComplete = true;
-            }
+    if (hil.isActive()) {
+        pumpBinary();
+        return;
+    }
+    console.pump(Serial);
+}
+
+// ==================== BINARY (HIL) MODE ====================
+
+int hilPredict(const float* features, bool scaled, void* context) {
+    float x[NUM_FEATURES];
+    if (scaled) {
+        memcpy(x, features, sizeof(x));
+    } else {
+        x[0] = scale_temperature(features[0]);
+        x[1] = scale_humidity(features[1]);
+        x[2] = scale_pressure(features[2]);
+        x[3] = scale_lux(features[3]);
+    }
+    return classifier.predict(x);
+}
+
+uint32_t hilCycles() { return ESP.getCycleCount(); }
+
+void hilWrite(const uint8_t* data, size_t length, void* context) {
+    Serial.write(data, length);
+}
+
+void pumpBinary() {
+    static uint8_t chunk[256];
+    int available;
+    while (hil.isActive() && (available = Serial.available()) > 0) {
+        size_t n = Serial.readBytes(chunk, available < (int)sizeof(chunk) ? available : sizeof(chunk));
+        if (!hil.feed(chunk, n)) {
+            const HilSessionStats& stats = hil.getStats();
+            Serial.println();
+            Serial.printf("✓ Binary mode ended: %lu batches, %lu predictions, %lu errors, %.1f cycles/prediction\n",
+                          (unsigned long)stats.batches, (unsigned long)stats.samples, (unsigned long)stats.errors,
+                          stats.samples ? (double)stats.cycles / stats.samples : 0.0);
+            Serial.println();
+            setLED(COLOR_BLUE);
+        }
+    }
+}
+
+void cmdBinary(const char* args) {
+    setLED(COLOR_WHITE);
+    Serial.println(HIL_READY_LINE);
+    Serial.flush();
+    hil.begin();
+}
+
+// ==================== INFERENCE BENCHMARK ====================
+
+int ibenchPredict(const float* scaled, void* context) {
+    return classifier.predict(const_cast<float*>(scaled));
+}
+
+// Cache eviction for the cold series. Rodata and code both run from
+// flash through the cache: reading a table larger than the data cache at
+// line stride evicts the data side, executing a chain of functions larger
+// than the instruction cache evicts the code side (the model is code: the
+// exported trees are nested ifs with thresholds as immediates).
+#define IBENCH_EVICT_DATA_BYTES (128 * 1024)
+#define IBENCH_EVICT_CODE_BLOCKS 24     // x 1024 nops (2-3 bytes each)
+#define IBENCH_CACHE_LINE 32
+
+static const uint8_t IBENCH_EVICT_TABLE[IBENCH_EVICT_DATA_BYTES] = { 1 };
+volatile uint32_t ibenchSink = 0;
+
+template <int N>
+__attribute__((noinline)) void ibenchEvictCode() {
+    asm volatile(".rept 1024\n\tnop\n\t.endr");
+    ibenchEvictCode<N - 1>();
+}
+
+template <>
+__attribute__((noinline)) void ibenchEvictCode<0>() {}
+
+void ibenchEvict(void* context) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i < IBENCH_EVICT_DATA_BYTES; i += IBENCH_CACHE_LINE) {
+        sum += IBENCH_EVICT_TABLE[i];
+    }
+    ibenchSink = sum;
+    ibenchEvictCode<IBENCH_EVICT_CODE_BLOCKS>();
+}
+
+// Reference kernel: the same body placed in IRAM and in flash. Its
+// cold/warm gap in flash is the cache-miss penalty the model pays per
+// line; in IRAM it stays flat.
+static inline __attribute__((always_inline)) uint32_t ibenchReferenceKernel(const float* x) {
+    uint32_t votes = 0;
+    for (int t = 0; t < 32; t++) {
+        float threshold = (t + 0.5f) / 32.0f;
+        votes += (x[t & 3] > threshold) ? 1 : 0;
+    }
+    return votes;
+}
+
+void IRAM_ATTR ibenchIramProbe(const float* x) { ibenchSink = ibenchReferenceKernel(x); }
+
+__attribute__((noinline)) void ibenchFlashProbe(const float* x) { ibenchSink = ibenchReferenceKernel(x); }
+
+void printLatencyRow(const char* label, const InferenceLatency& s, uint32_t mhz) {
+    Serial.printf("  %-10s %6lu %8.1f %8.1f %8.1f %8.1f %8.1f\n", label, (unsigned long)s.count,
+                  (double)s.p50 / mhz, (double)s.p90 / mhz, (double)s.p99 / mhz, (double)s.p999 / mhz,
+                  (double)s.max / mhz);
+}
+
+void runInferenceBenchmark(bool json) {
+    setLED(COLOR_MAGENTA);
+    benchmarkRunning = true;
+
+    static bool probesAdded = false;
+    if (!probesAdded) {
+        inferenceBench.setEvict(ibenchEvict);
+        inferenceBench.addProbe("iram_ref", ibenchIramProbe);
+        inferenceBench.addProbe("flash_ref", ibenchFlashProbe);
+        probesAdded = true;
+    }
+
+    if (!json) {
+        Serial.println("\n╔════════════════════════════════════════════════════════╗");
+        Serial.println("║          INFERENCE LATENCY DISTRIBUTION                ║");
+        Serial.println("╚════════════════════════════════════════════════════════╝");
+        Serial.println();
+        Serial.printf("⏱️  %d hypercube inputs + rare-class top-ups, %d warmup, %d cold...\n",
+                      INFERENCE_BENCH_SAMPLES, INFERENCE_BENCH_WARMUP, INFERENCE_BENCH_COLD_SAMPLES);
+        Serial.flush();
+    }
+
+    inferenceBench.run(IBENCH_SEED);
+    uint32_t mhz = ESP.getCpuFreqMHz();
+
+    if (json) {
+        static char line[1536];
+        if (inferenceBench.encodeJson(line, sizeof(line), IBENCH_MODEL_NAME, mhz) > 0) {
+            Serial.println(line);
         } else {
-            inputString += inChar;
+            Serial.println("{\"error\":\"ibench json overflow\"}");
         }
+        benchmarkRunning = false;
+        setLED(COLOR_BLUE);
+        return;
+    }
+
+    Serial.println();
+    Serial.printf("📊 LATENCY (µs @ %lu MHz, cycle counter, overhead %lu cycles subtracted)\n",
+                  (unsigned long)mhz, (unsigned long)inferenceBench.getOverhead());
+    Serial.println("─────────────────────────────────────────────────────────");
+    Serial.println("             n      p50      p90      p99    p99.9      max");
+    printLatencyRow("warm", inferenceBench.warm(), mhz);
+    printLatencyRow("cold", inferenceBench.cold(), mhz);
+    Serial.println();
+
+    Serial.println("🎯 PER CLASS (warm; share of the feature space)");
+    Serial.println("─────────────────────────────────────────────────────────");
+    for (int c = 0; c < NUM_CLASSES; c++) {
+        char label[16];
+        snprintf(label, sizeof(label), "%s %2lu%%", WEATHER_CLASSES[c],
+                 (unsigned long)(inferenceBench.hypercubeCount(c) * 100 / INFERENCE_BENCH_SAMPLES));
+        printLatencyRow(label, inferenceBench.forClass(c), mhz);
+    }
+    Serial.printf("  Rare-class top-ups: %lu\n", (unsigned long)inferenceBench.getTopups());
+    Serial.println();
+
+    Serial.println("💾 IRAM vs FLASH CACHE (reference kernel)");
+    Serial.println("─────────────────────────────────────────────────────────");
+    for (int p = 0; p < inferenceBench.getProbeCount(); p++) {
+        const InferenceProbe& probe = inferenceBench.probe(p);
+        Serial.printf("  %-10s warm p50 %5lu  cold p50 %5lu  cold p99 %5lu cycles\n", probe.name,
+                      (unsigned long)probe.warm.p50, (unsigned long)probe.cold.p50,
+                      (unsigned long)probe.cold.p99);
+    }
+    const InferenceLatency& warm = inferenceBench.warm();
+    const InferenceLatency& cold = inferenceBench.cold();
+    if (warm.p50 > 0) {
+        Serial.printf("  Model cold/warm p50:    %.2fx (+%.1f µs flash cache refill)\n",
+                      (double)cold.p50 / warm.p50,
+                      cold.p50 > warm.p50 ? (double)(cold.p50 - warm.p50) / mhz : 0.0);
     }
+    Serial.println();
+
+    Serial.printf("  Prediction digest:      %08lx (changes when the model does)\n",
+                  (unsigned long)inferenceBench.getDigest());
+    Serial.println("  Machine-readable:       ibench json");
+    Serial.println();
+
+    benchmarkRunning = false;
+    setLED(COLOR_GREEN);
 }
 
-void processInput() {
-    inputString.trim();
-    
+void cmdHelp(const char* args) { printUsageInstructions(); }
+void cmdStats(const char* args) { printStatistics(); }
+void cmdTest(const char* args) { runTestPredictions(); }
+void cmdBenchmark(const char* args) { runComprehensiveBenchmark(); }
+void cmdInferenceBench(const char* args) { runInferenceBenchmark(false); }
+void cmdInferenceBenchJson(const char* args) { runInferenceBenchmark(true); }
+
+void cmdClear(const char* args) {
+    totalPredictions = 0;
+    totalInferenceTime = 0;
+    minInferenceTime = 999999;
+    maxInferenceTime = 0;
+    Serial.println("✓ Statistics cleared.");
+    Serial.println();
+}
+
+static const SerialCommand COMMANDS[] = {
+    { "help", cmdHelp, "Show all commands" },
+    { "?", cmdHelp, "Same as help" },
+    { "stats", cmdStats, "Show system statistics" },
+    { "test", cmdTest, "Run 6 quick test predictions" },
+    { "benchmark", cmdBenchmark, "Run comprehensive 20-second performance test" },
+    { "ibench", cmdInferenceBench, "Inference latency distribution (cycles, per class, cold cache)" },
+    { "ibench json", cmdInferenceBenchJson, "Same as one JSON line" },
+    { "clear", cmdClear, "Reset statistics" },
+    { "binary", cmdBinary, "Binary framed batch mode (HIL validation)" },
+};
+
+void processInput(const char* line) {
     // Check for commands
-    if (inputString.equalsIgnoreCase("help") || inputString.equals("?")) {
-        printUsageInstructions();
-        return;
-    } else if (inputString.equalsIgnoreCase("stats")) {
-        printStatistics();
-        return;
-    } else if (inputString.equalsIgnoreCase("test")) {
-        runTestPredictions();
-        return;
-    } else if (inputString.equalsIgnoreCase("benchmark")) {
-        runComprehensiveBenchmark();
-        return;
-    } else if (inputString.equalsIgnoreCase("clear")) {
-        totalPredictions = 0;
-        totalInferenceTime = 0;
-        minInferenceTime = 999999;
-        maxInferenceTime = 0;
-        Serial.println("✓ Statistics cleared.");
-        Serial.println();
+    if (serial_dispatch(COMMANDS, SERIAL_COMMAND_COUNT(COMMANDS), line)) {
         return;
     }
     
     // Parse sensor values
-    if (parseSensorValues(inputString)) {
+    if (parseSensorValues(line)) {
         makePrediction();
     } else {
         setLED(COLOR_RED);
@@ -254,25 +462,17 @@ void processInput() {
     }
 }
 
-bool parseSensorValues(String input) {
-    int commaIndex1 = input.indexOf(',');
-    if (commaIndex1 == -1) return false;
-    
-    int commaIndex2 = input.indexOf(',', commaIndex1 + 1);
-    if (commaIndex2 == -1) return false;
-    
-    int commaIndex3 = input.indexOf(',', commaIndex2 + 1);
-    if (commaIndex3 == -1) return false;
-    
-    String tempStr = input.substring(0, commaIndex1);
-    String humStr = input.substring(commaIndex1 + 1, commaIndex2);
-    String pressStr = input.substring(commaIndex2 + 1, commaIndex3);
-    String luxStr = input.substring(commaIndex3 + 1);
+// temperature,humidity,pressure,lux - parsed in place, no copies
+bool parseSensorValues(const char* input) {
+    float values[NUM_FEATURES];
+    if (!serial_parse_floats(input, ',', values, NUM_FEATURES)) {
+        return false;
+    }
     
-    temperature = tempStr.toFloat();
-    humidity = humStr.toFloat();
-    pressure = pressStr.toFloat();
-    lux = luxStr.toFloat();
+    temperature = values[0];
+    humidity = values[1];
+    pressure = values[2];
+    lux = values[3];
     
     return true;
 }
@@ -622,8 +822,10 @@ void printUsageInstructions() {
     Serial.println("    help      - Show this help message");
     Serial.println("    test      - Run 6 quick test predictions");
     Serial.println("    benchmark - Run 20-second comprehensive performance test");
+    Serial.println("    ibench    - Inference latency p50..p99.9 over the feature space (ibench json: one line)");
     Serial.println("    stats     - Show prediction statistics");
     Serial.println("    clear     - Clear statistics");
+    Serial.println("    binary    - Binary batch mode for host_tools/hil_driver (EXIT frame returns)");
     Serial.println("═════════════════════════════════════════════════════════");
     Serial.println();
 }
@@ -0,0 +1,85 @@
+/*
+ * WiFi Connect Cache - Last good access point
+ *
+ * A full connect scans every channel for the SSID before it associates:
+ * seconds on every boot and after every outage. With the BSSID and channel
+ * of the access point that last worked, the station can associate directly
+ * (no scan). WiFiManager stores this record after a connect (only when it
+ * changed - flash wear) and tries a directed fast connect from it before
+ * the full path.
+ *
+ * The IP lease is deliberately not cached: applied as a static address it
+ * would outlive the router's lease (association still succeeds, so nothing
+ * falls back) and collide with the client the address is handed to next.
+ * Fast connects run DHCP like full ones.
+ *
+ * Blob Layout (little endian, WIFI_CACHE_BLOB_SIZE bytes):
+ *   Offset  Size  Field
+ *   0       2     Magic 'W','C'
+ *   2       1     Version (2; version 1 also held a static IP lease)
+ *   3       1     Channel
+ *   4       6     BSSID
+ *   10      2     CRC-16/CCITT over everything before it
+ *
+ * Stored as one NVS entry on the device (Preferences, namespace "wifi") and
+ * as a plain file by host tools. A record with a bad magic, version or CRC
+ * is rejected as a whole: the next connect takes the full path and rewrites it.
+ */
+
+#ifndef WIFI_CONNECT_CACHE_H
+#define WIFI_CONNECT_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "telemetry_codec.h"   // telemetry_crc16
+
+#define WIFI_CACHE_MAGIC0 'W'
+#define WIFI_CACHE_MAGIC1 'C'
+#define WIFI_CACHE_VERSION 2
+#define WIFI_CACHE_BLOB_SIZE 12
+#define WIFI_CACHE_PREFS_NAMESPACE "wifi"
+#define WIFI_CACHE_PREFS_KEY "cache"
+
+struct WiFiConnectCache {
+    uint8_t bssid[6];
+    uint8_t channel;       // 0 = no record
+};
+
+inline bool wifi_cache_valid(const WiFiConnectCache& cache) {
+    return cache.channel != 0;
+}
+
+// Same access point (decides whether a rewrite is needed)
+inline bool wifi_cache_equal(const WiFiConnectCache& a, const WiFiConnectCache& b) {
+    return memcmp(a.bssid, b.bssid, sizeof(a.bssid)) == 0 && a.channel == b.channel;
+}
+
+inline void wifi_cache_encode(const WiFiConnectCache& cache, uint8_t out[WIFI_CACHE_BLOB_SIZE]) {
+    out[0] = WIFI_CACHE_MAGIC0;
+    out[1] = WIFI_CACHE_MAGIC1;
+    out[2] = WIFI_CACHE_VERSION;
+    out[3] = cache.channel;
+    memcpy(out + 4, cache.bssid, 6);
+    uint16_t crc = telemetry_crc16(out, WIFI_CACHE_BLOB_SIZE - 2);
+    out[10] = (uint8_t)crc;
+    out[11] = (uint8_t)(crc >> 8);
+}
+
+// Returns false (and clears `cache`) unless the blob is an intact record
+inline bool wifi_cache_decode(const uint8_t* in, size_t length, WiFiConnectCache& cache) {
+    memset(&cache, 0, sizeof(cache));
+    if (length != WIFI_CACHE_BLOB_SIZE || in[0] != WIFI_CACHE_MAGIC0 || in[1] != WIFI_CACHE_MAGIC1 ||
+        in[2] != WIFI_CACHE_VERSION) {
+        return false;
+    }
+    uint16_t crc = (uint16_t)(in[10] | (in[11] << 8));
+    if (crc != telemetry_crc16(in, WIFI_CACHE_BLOB_SIZE - 2) || in[3] == 0) {
+        return false;
+    }
+    cache.channel = in[3];
+    memcpy(cache.bssid, in + 4, 6);
+    return true;
+}
+
+#endif // WIFI_CONNECT_CACHE_H
@@ -0,0 +1,271 @@
+/*
+ * WiFi Link - Non-blocking station connect state machine
+ *
+ * Drives (re)connection from WiFi driver events and a periodic tick instead
+ * of waiting in a loop. The caller performs the returned action (start an
+ * association, abort one) and feeds back GOT_IP / DISCONNECTED events, so
+ * nothing here ever waits: loop() keeps sampling and predicting while the
+ * access point is down.
+ *
+ * States:
+ *   IDLE ──start()──► CONNECTING ──got IP──► CONNECTED
+ *                        │  ▲                    │
+ *          timeout/fail  ▼  │ retry due          │ link lost
+ *                       BACKOFF ◄─────────────────┘ (first retry after
+ *                                                    WIFI_LINK_BACKOFF_MIN_MS)
+ *
+ * Fast connect: when the caller has a cached access point (see
+ * wifi_connect_cache.h), every retry cycle starts with a directed attempt
+ * (BEGIN_FAST, shorter timeout). If it fails, the full scan + DHCP attempt
+ * follows immediately, without backoff. A directed miss costs less than a
+ * scan, so this also finds a returning access point sooner.
+ *
+ * Features:
+ * - Per-attempt timeout (WIFI_LINK_ATTEMPT_MS), retries forever
+ * - Directed fast attempt first in every retry cycle when an access point is cached
+ * - Association time recorded separately for fast and full attempts
+ * - Exponential backoff with jitter between attempts, capped at
+ *   WIFI_LINK_BACKOFF_MAX_MS, reset once connected
+ * - Outage accounting (count, total and longest time without a link)
+ * - No Arduino dependencies: callers pass millis() (host tools reuse it)
+ *
+ * Usage:
+ *   WiFiLink link;
+ *   act(link.start(millis()));                 // act() calls WiFi.begin()/disconnect()
+ *   // driver event task:  GOT_IP → link.onConnected(), DISCONNECTED → link.onDisconnected()
+ *   act(link.tick(millis()));                  // from loop()
+ */
+
+#ifndef WIFI_LINK_H
+#define WIFI_LINK_H
+
+#include <stdint.h>
+
+#define WIFI_LINK_ATTEMPT_MS 15000       // Give up on one association after this
+#define WIFI_LINK_FAST_ATTEMPT_MS 4000   // Directed attempt (no scan, DHCP) normally takes ~1 s
+#define WIFI_LINK_BACKOFF_MIN_MS 1000    // First retry
+#define WIFI_LINK_BACKOFF_MAX_MS 30000   // Retry at least every 30 s (+ jitter)
+#define WIFI_LINK_JITTER_PERCENT 25      // Random extra delay (spreads reconnect storms)
+
+enum WiFiLinkState {
+    WIFI_LINK_IDLE = 0,
+    WIFI_LINK_CONNECTING,
+    WIFI_LINK_CONNECTED,
+    WIFI_LINK_BACKOFF,
+    WIFI_LINK_STATE_COUNT
+};
+
+static const char* const WIFI_LINK_STATE_NAMES[WIFI_LINK_STATE_COUNT] = {
+    "idle", "connecting", "connected", "backoff"
+};
+
+// What the caller has to do with the radio
+enum WiFiLinkAction {
+    WIFI_LINK_NONE = 0,
+    WIFI_LINK_BEGIN,         // Start an association (WiFi.begin)
+    WIFI_LINK_BEGIN_FAST,    // Start a directed association from the cached access point
+    WIFI_LINK_ABORT          // Abandon the current attempt (WiFi.disconnect)
+};
+
+struct WiFiLinkStats {
+    uint32_t attempts;
+    uint32_t connects;
+    uint32_t failures;          // Attempts that timed out or were refused
+    uint32_t drops;             // Established links lost
+    uint32_t outages;           // Periods without a link after the first connect
+    uint32_t outageTotalMs;
+    uint32_t outageMaxMs;
+    uint32_t lastAttemptMs;     // Duration of the latest successful attempt
+    bool lastAttemptFast;       // ... and whether it was a fast one
+    uint8_t lastReason;         // Driver reason code of the latest disconnect
+    uint32_t fastAttempts;
+    uint32_t fastConnects;
+    uint32_t fastFailures;      // Fast attempts that fell back to a full connect
+    uint32_t fastAssocTotalMs;  // Sum of successful fast attempt durations
+    uint32_t fullAssocTotalMs;  // Sum of successful full attempt durations
+};
+
+class WiFiLink {
+private:
+    WiFiLinkState currentState;
+    uint32_t stateSinceMs;
+    uint32_t attemptStartMs;
+    uint32_t retryAtMs;
+    uint32_t backoffMs;
+    uint32_t outageStartMs;
+    bool inOutage;
+    bool fastAvailable;         // Caller has a cached access point
+    bool fallbackPending;       // Fast attempt failed: next attempt is the full one
+    bool attemptFast;           // Current attempt is a fast one
+    uint32_t seed;
+    WiFiLinkStats stats;
+
+public:
+    WiFiLink() {
+        seed = 0x9E3779B9u;
+        fastAvailable = false;
+        reset();
+    }
+
+    void reset() {
+        currentState = WIFI_LINK_IDLE;
+        stateSinceMs = 0;
+        attemptStartMs = 0;
+        retryAtMs = 0;
+        backoffMs = WIFI_LINK_BACKOFF_MIN_MS;
+        outageStartMs = 0;
+        inOutage = false;
+        fallbackPending = false;
+        attemptFast = false;
+        stats = WiFiLinkStats();
+    }
+
+    // Jitter source (e.g. the MAC address, so devices do not retry in step)
+    void setSeed(uint32_t value) { seed = value ? value : 1; }
+
+    // Whether a cached access point exists (the caller knows how to BEGIN_FAST)
+    void setFastConnect(bool available) { fastAvailable = available; }
+    bool hasFastConnect() const { return fastAvailable; }
+
+    // Begin connecting (no-op unless idle)
+    WiFiLinkAction start(uint32_t now) {
+        if (currentState != WIFI_LINK_IDLE) {
+            return WIFI_LINK_NONE;
+        }
+        backoffMs = WIFI_LINK_BACKOFF_MIN_MS;
+        fallbackPending = false;
+        return beginAttempt(now);
+    }
+
+    // Stop managing the link (caller disconnects)
+    void stop(uint32_t now) {
+        fallbackPending = false;
+        endOutage(now);
+        enter(WIFI_LINK_IDLE, now);
+    }
+
+    // Driver: station got an IP address
+    WiFiLinkAction onConnected(uint32_t now) {
+        if (currentState == WIFI_LINK_CONNECTED || currentState == WIFI_LINK_IDLE) {
+            return WIFI_LINK_NONE;
+        }
+        stats.connects++;
+        stats.lastAttemptMs = now - attemptStartMs;
+        stats.lastAttemptFast = attemptFast;
+        if (attemptFast) {
+            stats.fastConnects++;
+            stats.fastAssocTotalMs += stats.lastAttemptMs;
+        } else {
+            stats.fullAssocTotalMs += stats.lastAttemptMs;
+        }
+        backoffMs = WIFI_LINK_BACKOFF_MIN_MS;
+        endOutage(now);
+        enter(WIFI_LINK_CONNECTED, now);
+        return WIFI_LINK_NONE;
+    }
+
+    // Driver: station disconnected (reason = driver reason code)
+    WiFiLinkAction onDisconnected(uint32_t now, uint8_t reason = 0) {
+        stats.lastReason = reason;
+        if (currentState == WIFI_LINK_CONNECTED) {
+            stats.drops++;
+            stats.outages++;
+            outageStartMs = now;
+            inOutage = true;
+            backoffMs = WIFI_LINK_BACKOFF_MIN_MS;
+            scheduleRetry(now);
+        } else if (currentState == WIFI_LINK_CONNECTING) {
+            stats.failures++;
+            scheduleRetry(now);
+        }
+        return WIFI_LINK_NONE;
+    }
+
+    // Call often (every loop()): attempt timeouts and due retries
+    WiFiLinkAction tick(uint32_t now) {
+        uint32_t timeoutMs = attemptFast ? WIFI_LINK_FAST_ATTEMPT_MS : WIFI_LINK_ATTEMPT_MS;
+        if (currentState == WIFI_LINK_CONNECTING && now - attemptStartMs >= timeoutMs) {
+            stats.failures++;
+            scheduleRetry(now);
+            return WIFI_LINK_ABORT;
+        }
+        if (currentState == WIFI_LINK_BACKOFF && (int32_t)(now - retryAtMs) >= 0) {
+            return beginAttempt(now);
+        }
+        return WIFI_LINK_NONE;
+    }
+
+    WiFiLinkState state() const { return currentState; }
+    const char* stateName() const { return WIFI_LINK_STATE_NAMES[currentState]; }
+    bool isConnected() const { return currentState == WIFI_LINK_CONNECTED; }
+    uint32_t stateAgeMs(uint32_t now) const { return now - stateSinceMs; }
+    uint32_t getBackoff() const { return backoffMs; }
+    const WiFiLinkStats& getStats() const { return stats; }
+
+    // Milliseconds until the next attempt (0 unless in BACKOFF)
+    uint32_t msUntilRetry(uint32_t now) const {
+        if (currentState != WIFI_LINK_BACKOFF) return 0;
+        int32_t left = (int32_t)(retryAtMs - now);
+        return left > 0 ? (uint32_t)left : 0;
+    }
+
+    // Current outage so far (0 while connected or before the first connect)
+    uint32_t outageMs(uint32_t now) const { return inOutage ? now - outageStartMs : 0; }
+
+    // Mean successful association time (0 if none yet)
+    uint32_t meanFastAssocMs() const {
+        return stats.fastConnects ? stats.fastAssocTotalMs / stats.fastConnects : 0;
+    }
+    uint32_t meanFullAssocMs() const {
+        uint32_t full = stats.connects - stats.fastConnects;
+        return full ? stats.fullAssocTotalMs / full : 0;
+    }
+
+private:
+    WiFiLinkAction beginAttempt(uint32_t now) {
+        stats.attempts++;
+        attemptStartMs = now;
+        attemptFast = fastAvailable && !fallbackPending;
+        fallbackPending = false;
+        enter(WIFI_LINK_CONNECTING, now);
+        if (attemptFast) {
+            stats.fastAttempts++;
+            return WIFI_LINK_BEGIN_FAST;
+        }
+        return WIFI_LINK_BEGIN;
+    }
+
+    void scheduleRetry(uint32_t now) {
+        if (currentState == WIFI_LINK_CONNECTING && attemptFast) {
+            // Cached access point did not answer: full connect right away
+            stats.fastFailures++;
+            fallbackPending = true;
+            retryAtMs = now;
+            enter(WIFI_LINK_BACKOFF, now);
+            return;
+        }
+        // xorshift32 jitter: 0..JITTER_PERCENT of the backoff on top
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        uint32_t jitter = backoffMs / 100 * WIFI_LINK_JITTER_PERCENT;
+        retryAtMs = now + backoffMs + (jitter ? seed % (jitter + 1) : 0);
+        backoffMs = backoffMs >= WIFI_LINK_BACKOFF_MAX_MS / 2 ? WIFI_LINK_BACKOFF_MAX_MS : backoffMs * 2;
+        enter(WIFI_LINK_BACKOFF, now);
+    }
+
+    void endOutage(uint32_t now) {
+        if (!inOutage) return;
+        uint32_t length = now - outageStartMs;
+        stats.outageTotalMs += length;
+        if (length > stats.outageMaxMs) stats.outageMaxMs = length;
+        inOutage = false;
+    }
+
+    void enter(WiFiLinkState next, uint32_t now) {
+        currentState = next;
+        stateSinceMs = now;
+    }
+};
+
+#endif // WIFI_LINK_H
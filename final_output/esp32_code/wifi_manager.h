@@ -3,33 +3,44 @@
  * Handles WiFi connection, reconnection, status monitoring, and LED indicators
  * 
  * Features:
- * - Auto-connect with retry logic
- * - Connection status monitoring
+ * - Non-blocking connect: an event-driven state machine (wifi_link.h) fed
+ *   by WiFi system events; update() never waits, so sampling, prediction
+ *   and local logging keep running during outages
+ * - Retries forever with exponential backoff + jitter (1 s .. 30 s)
+ * - Fast reconnect: last good BSSID and channel cached in NVS
+ *   (wifi_connect_cache.h); boot and reconnects try a directed connect
+ *   without a scan first, then fall back to the full path (DHCP runs on
+ *   both: a cached lease could since have been handed to another client)
+ * - Connection status monitoring (events, plus checkStatus() scheduled
+ *   every WIFI_CHECK_INTERVAL)
  * - LED status indicators
- * - Connection logging
+ * - Connection logging and outage statistics
  * - Network diagnostics
  * 
  * LED Indicators:
- * - WHITE pulsing: Attempting connection
+ * - WHITE: Attempting connection
  * - GREEN solid: Connected
- * - RED blinking: Connection failed
- * - YELLOW: Reconnecting
+ * - RED: Connection lost / attempt failed
+ * - YELLOW: Waiting to retry (backoff)
  */
 
 #ifndef WIFI_MANAGER_H
 #define WIFI_MANAGER_H
 
 #include <WiFi.h>
+#include <Preferences.h>
+#include "wifi_link.h"
+#include "wifi_connect_cache.h"
+#include "task_port.h"
 
 // WiFi Configuration
 #define WIFI_SSID     "COMFRI"
 #define WIFI_PASSWORD "1234567890"
 
-// Connection settings
-#define WIFI_TIMEOUT_MS 20000           // 20 seconds timeout per attempt
-#define WIFI_RETRY_DELAY_MS 5000        // 5 seconds between retries
-#define MAX_WIFI_RETRIES 5              // Maximum connection attempts
-#define WIFI_CHECK_INTERVAL 10000       // Check connection every 10 seconds
+// Connection settings (attempt timeout and backoff live in wifi_link.h)
+#define WIFI_BOOT_WAIT_MS 20000         // setup() waits at most this long for the first link
+#define WIFI_CHECK_INTERVAL 10000       // Cross-check WiFi.status() every 10 seconds
+#define WIFI_FAST_CONNECT 1             // 0 = always scan (ignore the cached access point)
 
 // WiFi Status enum
 enum WiFiStatus {
@@ -41,19 +52,41 @@ enum WiFiStatus {
     WIFI_RECONNECTING
 };
 
+// Driver events arrive on the WiFi event task; the handler only records
+// them and update() applies them from loop(). Both fields change together
+// under wifiPendingLock (a bit set between update()'s read and clear, or a
+// reason torn from its bit, would otherwise be lost).
+#define WIFI_PENDING_GOT_IP 0x01
+#define WIFI_PENDING_DISCONNECTED 0x02
+static PortLock wifiPendingLock;
+static uint8_t wifiPendingEvents = 0;
+static uint8_t wifiPendingReason = 0;
+
+static void wifiEventHandler(arduino_event_id_t event, arduino_event_info_t info) {
+    if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+        wifiPendingLock.lock();
+        wifiPendingEvents |= WIFI_PENDING_GOT_IP;
+        wifiPendingLock.unlock();
+    } else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED &&
+               info.wifi_sta_disconnected.reason != WIFI_REASON_ASSOC_LEAVE) {
+        wifiPendingLock.lock();
+        wifiPendingReason = info.wifi_sta_disconnected.reason;
+        wifiPendingEvents |= WIFI_PENDING_DISCONNECTED;
+        wifiPendingLock.unlock();
+    }
+}
+
 class WiFiManager {
 private:
-    WiFiStatus currentStatus;
-    int retryCount;
-    unsigned long lastConnectionAttempt;
-    unsigned long lastStatusCheck;
-    unsigned long connectionStartTime;
+    WiFiLink link;
+    WiFiLinkState reportedState;
     bool autoReconnect;
     
+    // Fast reconnect cache (NVS)
+    WiFiConnectCache cache;
+    uint32_t cacheWrites;
+    
     // Connection statistics
-    unsigned int totalConnectionAttempts;
-    unsigned int successfulConnections;
-    unsigned int failedConnections;
     unsigned long totalConnectedTime;
     unsigned long lastConnectedTime;
     
@@ -62,19 +95,12 @@ private:
     
 public:
     WiFiManager() {
-        currentStatus = WIFI_IDLE;
-        retryCount = 0;
-        lastConnectionAttempt = 0;
-        lastStatusCheck = 0;
-        connectionStartTime = 0;
+        reportedState = WIFI_LINK_IDLE;
         autoReconnect = true;
-        
-        totalConnectionAttempts = 0;
-        successfulConnections = 0;
-        failedConnections = 0;
-
         totalConnectedTime = 0;
         lastConnectedTime = 0;
+        memset(&cache, 0, sizeof(cache));
+        cacheWrites = 0;
     }
     
     // Initialize WiFi manager
@@ -85,7 +111,8 @@ public:
         Serial.println("─────────────────────────────────────────────────────────");
         Serial.printf("   SSID: %s\n", WIFI_SSID);
         Serial.printf("   Auto-reconnect: %s\n", autoReconnect ? "Enabled" : "Disabled");
-        Serial.printf("   Max retries: %d\n", MAX_WIFI_RETRIES);
+        Serial.printf("   Attempt timeout: %d s, backoff %d..%d s\n", WIFI_LINK_ATTEMPT_MS / 1000,
+                      WIFI_LINK_BACKOFF_MIN_MS / 1000, WIFI_LINK_BACKOFF_MAX_MS / 1000);
         Serial.println("─────────────────────────────────────────────────────────");
         
         // Clean WiFi state first
@@ -95,17 +122,29 @@ public:
         // Set WiFi mode
         WiFi.mode(WIFI_STA);
         WiFi.setAutoReconnect(false); // We handle reconnection manually
-        delay(100);
+        WiFi.onEvent(wifiEventHandler);
+        
+        // Different devices back off differently (jitter seed from the MAC)
+        uint8_t mac[6];
+        WiFi.macAddress(mac);
+        link.setSeed(((uint32_t)mac[2] << 24) | ((uint32_t)mac[3] << 16) | ((uint32_t)mac[4] << 8) | mac[5]);
         
+        loadCache();
+        if (wifi_cache_valid(cache)) {
+            Serial.printf("   Fast connect: %02X:%02X:%02X:%02X:%02X:%02X ch %u\n",
+                          cache.bssid[0], cache.bssid[1], cache.bssid[2], cache.bssid[3],
+                          cache.bssid[4], cache.bssid[5], cache.channel);
+        } else {
+            Serial.println("   Fast connect: no cached access point (full scan)");
+        }
         Serial.println("   Status: Ready");
         Serial.println();
     }
     
-    // Start connection attempt
+    // Start connecting in the background. Returns true if already connected.
     bool connect() {
-        if (currentStatus == WIFI_CONNECTING) {
-            Serial.println("⚠️  Connection already in progress...");
-            return false;
+        if (link.state() != WIFI_LINK_IDLE) {
+            return isConnected();
         }
         
         Serial.println("╔════════════════════════════════════════════════════════╗");
@@ -113,69 +152,71 @@ public:
         Serial.println("╚════════════════════════════════════════════════════════╝");
         Serial.println();
         
-        currentStatus = WIFI_CONNECTING;
-        retryCount = 0;
-        totalConnectionAttempts++;
-        connectionStartTime = millis();
-        
-        return attemptConnection();
+        perform(link.start(millis()));
+        return isConnected();
     }
     
-    // Attempt single connection
-    bool attemptConnection() {
-        retryCount++;
-        lastConnectionAttempt = millis();
-        
-        Serial.printf("📡 Attempt %d/%d: Connecting to '%s'...\n", 
-                     retryCount, MAX_WIFI_RETRIES, WIFI_SSID);
-        
-        // LED: White pulsing (connecting)
-        if (ledCallback) ledCallback(0xFFFFFF); // WHITE
-        
-        // Disconnect any existing connection first
-        WiFi.disconnect();
-        delay(100);
-        
-        // Start fresh connection
-        WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-        
-        // Wait for connection with timeout
-        unsigned long startAttempt = millis();
+    // Boot only: run the state machine until connected or timeoutMs passed
+    // (services that need the network at startup wait here once)
+    bool waitForConnection(unsigned long timeoutMs = WIFI_BOOT_WAIT_MS) {
+        unsigned long start = millis();
         int dots = 0;
+        while (!isConnected() && millis() - start < timeoutMs) {
+            update();
+            delay(100);
+            if (++dots % 5 == 0) Serial.print(".");
+        }
+        Serial.println();
+        update();
+        if (!isConnected()) {
+            Serial.println("   ⏳ No WiFi yet - continuing offline, retrying in the background");
+            Serial.println();
+        }
+        return isConnected();
+    }
+    
+    // Monitor connection status (call in loop, never blocks)
+    void update() {
+        unsigned long now = millis();
         
-        while (WiFi.status() != WL_CONNECTED && 
-               (millis() - startAttempt) < WIFI_TIMEOUT_MS) {
-            delay(500);
-            Serial.print(".");
-            dots++;
-            if (dots % 40 == 0) Serial.println();
-            
-            // Yield to watchdog and other tasks - CRITICAL for ESP32-S3
-            yield();
-            
-            // LED feedback during connection
-            if (ledCallback && dots % 2 == 0) {
-                ledCallback(0xFFFFFF); // WHITE
-            } else if (ledCallback) {
-                ledCallback(0x000000); // OFF
+        // Events recorded by the driver task since the last call, taken
+        // (and cleared) in one step
+        wifiPendingLock.lock();
+        uint8_t events = wifiPendingEvents;
+        uint8_t reason = wifiPendingReason;
+        wifiPendingEvents = 0;
+        wifiPendingLock.unlock();
+        if (events) {
+            if (events & WIFI_PENDING_DISCONNECTED) {
+                perform(link.onDisconnected(now, reason));
+            }
+            if ((events & WIFI_PENDING_GOT_IP) && WiFi.status() == WL_CONNECTED) {
+                perform(link.onConnected(now));
             }
         }
-        Serial.println();
         
-        // Check connection result
-        if (WiFi.status() == WL_CONNECTED) {
-            onConnectionSuccess();
-            return true;
-        } else {
-            onConnectionFailed();
-            return false;
+        if (autoReconnect || link.state() == WIFI_LINK_CONNECTING) {
+            perform(link.tick(now));
         }
+        reportTransition();
+    }
+    
+    // Cross-check WiFi.status() in case an event was missed (a scheduler
+    // task every WIFI_CHECK_INTERVAL)
+    void checkStatus() {
+        unsigned long now = millis();
+        bool up = WiFi.status() == WL_CONNECTED;
+        if (link.isConnected() && !up) {
+            perform(link.onDisconnected(now, 0));
+        } else if (link.state() == WIFI_LINK_CONNECTING && up) {
+            perform(link.onConnected(now));
+        }
+        reportTransition();
     }
     
     // Connection succeeded
     void onConnectionSuccess() {
-        currentStatus = WIFI_CONNECTED;
-        successfulConnections++;
+        const WiFiLinkStats& stats = link.getStats();
         lastConnectedTime = millis();
         
         // LED: Green solid (connected)
@@ -196,116 +237,75 @@ public:
         Serial.printf("   Signal (RSSI): %d dBm ", WiFi.RSSI());
         Serial.println(getSignalQuality());
         Serial.printf("   Channel:       %d\n", WiFi.channel());
-        Serial.printf("   Connection #:  %u\n", successfulConnections);
-        Serial.printf("   Time taken:    %.2f seconds\n", 
-                     (millis() - connectionStartTime) / 1000.0f);
+        Serial.printf("   Connection #:  %lu (attempt %lu)\n",
+                      (unsigned long)stats.connects, (unsigned long)stats.attempts);
+        Serial.printf("   Time taken:    %.2f seconds (%s)\n", stats.lastAttemptMs / 1000.0f,
+                      stats.lastAttemptFast ? "fast connect" : "full scan + DHCP");
         Serial.println("─────────────────────────────────────────────────────────");
         Serial.println();
+        
+        storeCache();
     }
     
-    // Connection failed
+    // Attempt failed or link lost: the state machine is in backoff
     void onConnectionFailed() {
+        const WiFiLinkStats& stats = link.getStats();
         wl_status_t status = WiFi.status();
         
-        Serial.println("✗ Connection failed!");
-        Serial.println("─────────────────────────────────────────────────────────");
-        Serial.printf("   WiFi Status Code: %d\n", status);
-        Serial.printf("   Status Name: %s\n", getWiFiStatusString(status));
-        Serial.printf("   Reason: %s\n", getDisconnectReason());
-        Serial.println("─────────────────────────────────────────────────────────");
-        
-        // Additional diagnostics
-        Serial.println("\n🔍 Diagnostics:");
-        Serial.printf("   WiFi Mode: %s\n", WiFi.getMode() == WIFI_STA ? "Station" : "Other");
-        Serial.printf("   SSID Length: %d characters\n", strlen(WIFI_SSID));
-        Serial.printf("   Password Length: %d characters\n", strlen(WIFI_PASSWORD));
-        Serial.printf("   MAC Address: %s\n", WiFi.macAddress().c_str());
-        Serial.println();
+        // LED: Red (failed), then yellow while waiting to retry
+        if (ledCallback) ledCallback(0xFF0000); // RED
         
-        if (retryCount < MAX_WIFI_RETRIES) {
-            currentStatus = WIFI_RECONNECTING;
-            Serial.printf("   ⏳ Retrying in %d seconds... (Attempt %d/%d)\n", 
-                         WIFI_RETRY_DELAY_MS/1000, retryCount + 1, MAX_WIFI_RETRIES);
-            Serial.println();
-            
-            // LED: Yellow (reconnecting)
-            if (ledCallback) ledCallback(0xFFFF00); // YELLOW
-            
-            delay(WIFI_RETRY_DELAY_MS);
-            attemptConnection();
-        } else {
-            currentStatus = WIFI_FAILED;
-            failedConnections++;
-            
-            // LED: Red blinking (failed)
-            if (ledCallback) ledCallback(0xFF0000); // RED
-            
-            Serial.println("╔════════════════════════════════════════════════════════╗");
-            Serial.println("║           ❌ WIFI CONNECTION FAILED                   ║");
-            Serial.println("╚════════════════════════════════════════════════════════╝");
-            Serial.println();
-            Serial.printf("   All %d connection attempts failed.\n", MAX_WIFI_RETRIES);
+        Serial.printf("✗ WiFi: no link (status %d: %s, reason %u)\n",
+                      status, getWiFiStatusString(status), stats.lastReason);
+        Serial.printf("   ⏳ Retrying in %.1f s (attempt %lu), pipeline keeps running offline\n",
+                      link.msUntilRetry(millis()) / 1000.0f, (unsigned long)stats.attempts + 1);
+        if (stats.failures == 5 && stats.connects == 0) {
+            // Printed once: likely a configuration problem rather than an outage
             Serial.println("\n   Troubleshooting:");
             Serial.println("   1. Check WiFi credentials:");
             Serial.printf("      - SSID: '%s'\n", WIFI_SSID);
-            Serial.printf("      - Password: %d characters (hidden)\n", strlen(WIFI_PASSWORD));
+            Serial.printf("      - Password: %u characters (hidden)\n", (unsigned)strlen(WIFI_PASSWORD));
             Serial.println("   2. Router is powered on and in range");
             Serial.println("   3. Network is 2.4GHz (ESP32 doesn't support 5GHz)");
             Serial.println("   4. Check router MAC filtering");
             Serial.println("   5. Try power-cycling the router");
-            Serial.println();
-            Serial.println("   Type 'reconnect' to try again.");
-            Serial.println();
-        }
-    }
-    
-    // Monitor connection status (call in loop)
-    void update() {
-        // Only check periodically
-        if (millis() - lastStatusCheck < WIFI_CHECK_INTERVAL) {
-            return;
-        }
-        lastStatusCheck = millis();
-        
-        // Check if we were connected but now disconnected
-        if (currentStatus == WIFI_CONNECTED && WiFi.status() != WL_CONNECTED) {
-            Serial.println("\n⚠️  WiFi connection lost!");
-            onDisconnected();
         }
+        Serial.println();
         
-        // Auto-reconnect if enabled
-        if (autoReconnect && currentStatus == WIFI_DISCONNECTED) {
-            Serial.println("🔄 Auto-reconnecting...");
-            connect();
-        }
+        if (ledCallback) ledCallback(0xFFFF00); // YELLOW
     }
     
     // Handle disconnection
     void onDisconnected() {
-        if (currentStatus == WIFI_CONNECTED) {
+        if (lastConnectedTime != 0) {
             // Update connected time
             totalConnectedTime += (millis() - lastConnectedTime);
+            lastConnectedTime = 0;
         }
         
-        currentStatus = WIFI_DISCONNECTED;
-        
+        Serial.println("\n⚠️  WiFi connection lost!");
         Serial.println("─────────────────────────────────────────────────────────");
         Serial.printf("   Reason: %s\n", getDisconnectReason());
         Serial.println("─────────────────────────────────────────────────────────");
-        Serial.println();
-        
-        // LED: Red blinking (disconnected)
-        if (ledCallback) ledCallback(0xFF0000); // RED
     }
     
     // Get connection status
     WiFiStatus getStatus() {
-        return currentStatus;
+        switch (link.state()) {
+            case WIFI_LINK_CONNECTING: return link.getStats().attempts > 1 ? WIFI_RECONNECTING : WIFI_CONNECTING;
+            case WIFI_LINK_CONNECTED: return WIFI_CONNECTED;
+            case WIFI_LINK_BACKOFF: return link.getStats().connects > 0 ? WIFI_DISCONNECTED : WIFI_FAILED;
+            default: return WIFI_IDLE;
+        }
     }
     
     // Check if connected
     bool isConnected() {
-        return (currentStatus == WIFI_CONNECTED && WiFi.status() == WL_CONNECTED);
+        return (link.isConnected() && WiFi.status() == WL_CONNECTED);
+    }
+    
+    const WiFiLink& getLink() {
+        return link;
     }
     
     // Get IP address
@@ -350,14 +350,16 @@ public:
         }
     }
     
-    // Disconnect WiFi
+    // Disconnect WiFi (stays down until connect())
     void disconnect() {
-        if (currentStatus == WIFI_CONNECTED) {
+        if (lastConnectedTime != 0) {
             totalConnectedTime += (millis() - lastConnectedTime);
+            lastConnectedTime = 0;
         }
         
+        link.stop(millis());
+        reportedState = WIFI_LINK_IDLE;
         WiFi.disconnect(true);
-        currentStatus = WIFI_DISCONNECTED;
         Serial.println("📡 WiFi disconnected");
     }
     
@@ -369,17 +371,44 @@ public:
     
     // Get status as string
     const char* getStatusString() {
-        switch (currentStatus) {
+        switch (getStatus()) {
             case WIFI_IDLE: return "Idle";
             case WIFI_CONNECTING: return "Connecting...";
             case WIFI_CONNECTED: return "Connected ✅";
             case WIFI_DISCONNECTED: return "Disconnected";
-            case WIFI_FAILED: return "Failed ❌";
+            case WIFI_FAILED: return "Not connected yet (retrying)";
             case WIFI_RECONNECTING: return "Reconnecting...";
             default: return "Unknown";
         }
     }
     
+    void printStatistics() {
+        const WiFiLinkStats& stats = link.getStats();
+        unsigned long now = millis();
+        unsigned long connectedTime = totalConnectedTime + (lastConnectedTime != 0 ? now - lastConnectedTime : 0);
+        Serial.println("\n📡 WiFi Statistics:");
+        Serial.println("─────────────────────────────────────────────────────────");
+        Serial.printf("   State:     %s (%lu s)", link.stateName(), (unsigned long)link.stateAgeMs(now) / 1000);
+        if (link.state() == WIFI_LINK_BACKOFF) {
+            Serial.printf(", retry in %.1f s", link.msUntilRetry(now) / 1000.0f);
+        }
+        Serial.println();
+        Serial.printf("   Attempts:  %lu (%lu connected, %lu failed)\n", (unsigned long)stats.attempts,
+                      (unsigned long)stats.connects, (unsigned long)stats.failures);
+        Serial.printf("   Outages:   %lu (longest %lu s, total %lu s)\n", (unsigned long)stats.outages,
+                      (unsigned long)stats.outageMaxMs / 1000,
+                      (unsigned long)(stats.outageTotalMs + link.outageMs(now)) / 1000);
+        Serial.printf("   Connected: %lu s of %lu s uptime\n", connectedTime / 1000, now / 1000);
+        Serial.printf("   Fast:      %lu/%lu connected (%lu fell back), cache %s, %lu NVS writes\n",
+                      (unsigned long)stats.fastConnects, (unsigned long)stats.fastAttempts,
+                      (unsigned long)stats.fastFailures, link.hasFastConnect() ? "valid" : "empty",
+                      (unsigned long)cacheWrites);
+        Serial.printf("   Assoc:     fast %lu ms, full %lu ms (mean), last %lu ms\n",
+                      (unsigned long)link.meanFastAssocMs(), (unsigned long)link.meanFullAssocMs(),
+                      (unsigned long)stats.lastAttemptMs);
+        Serial.println("─────────────────────────────────────────────────────────");
+    }
+    
     // Scan for available networks
     void scanNetworks() {
         Serial.println("\n📡 Scanning for WiFi networks...");
@@ -403,6 +432,89 @@ public:
         Serial.println("─────────────────────────────────────────────────────────");
         Serial.println();
     }
+
+private:
+    // Carry out what the state machine asked for (returns immediately)
+    void perform(WiFiLinkAction action) {
+        if (action == WIFI_LINK_BEGIN) {
+            Serial.printf("📡 Attempt %lu: Connecting to '%s'...\n",
+                          (unsigned long)link.getStats().attempts, WIFI_SSID);
+            // LED: White (connecting)
+            if (ledCallback) ledCallback(0xFFFFFF); // WHITE
+            WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+        } else if (action == WIFI_LINK_BEGIN_FAST) {
+            Serial.printf("📡 Attempt %lu: Fast connect to '%s' (cached AP, channel %u)...\n",
+                          (unsigned long)link.getStats().attempts, WIFI_SSID, cache.channel);
+            if (ledCallback) ledCallback(0xFFFFFF); // WHITE
+            WiFi.begin(WIFI_SSID, WIFI_PASSWORD, cache.channel, cache.bssid);
+        } else if (action == WIFI_LINK_ABORT) {
+            // Our own disconnect reports ASSOC_LEAVE, which the handler ignores
+            wifiPendingLock.lock();
+            wifiPendingEvents &= (uint8_t)~WIFI_PENDING_DISCONNECTED;
+            wifiPendingLock.unlock();
+            WiFi.disconnect();
+        }
+    }
+    
+    void loadCache() {
+        uint8_t blob[WIFI_CACHE_BLOB_SIZE];
+        size_t length = 0;
+        Preferences prefs;
+        if (prefs.begin(WIFI_CACHE_PREFS_NAMESPACE, true)) {
+            if (prefs.getBytesLength(WIFI_CACHE_PREFS_KEY) == sizeof(blob)) {
+                length = prefs.getBytes(WIFI_CACHE_PREFS_KEY, blob, sizeof(blob));
+            }
+            prefs.end();
+        }
+        wifi_cache_decode(blob, length, cache);
+        link.setFastConnect(WIFI_FAST_CONNECT && wifi_cache_valid(cache));
+    }
+    
+    // Remember the access point we just joined (written only when changed)
+    void storeCache() {
+        WiFiConnectCache current;
+        memset(&current, 0, sizeof(current));
+        const uint8_t* bssid = WiFi.BSSID();
+        if (bssid == nullptr || WiFi.channel() <= 0) {
+            return;
+        }
+        memcpy(current.bssid, bssid, sizeof(current.bssid));
+        current.channel = (uint8_t)WiFi.channel();
+        if (wifi_cache_equal(current, cache)) {
+            return;
+        }
+        
+        uint8_t blob[WIFI_CACHE_BLOB_SIZE];
+        wifi_cache_encode(current, blob);
+        Preferences prefs;
+        if (prefs.begin(WIFI_CACHE_PREFS_NAMESPACE, false)) {
+            if (prefs.putBytes(WIFI_CACHE_PREFS_KEY, blob, sizeof(blob)) == sizeof(blob)) {
+                cache = current;
+                cacheWrites++;
+                link.setFastConnect(WIFI_FAST_CONNECT != 0);
+                Serial.printf("💾 WiFi fast-connect cache updated (channel %u)\n", cache.channel);
+            }
+            prefs.end();
+        }
+    }
+    
+    // Log state changes once, from loop() context
+    void reportTransition() {
+        WiFiLinkState state = link.state();
+        if (state == reportedState) {
+            return;
+        }
+        WiFiLinkState previous = reportedState;
+        reportedState = state;
+        if (state == WIFI_LINK_CONNECTED) {
+            onConnectionSuccess();
+        } else if (state == WIFI_LINK_BACKOFF) {
+            if (previous == WIFI_LINK_CONNECTED) {
+                onDisconnected();
+            }
+            onConnectionFailed();
+        }
+    }
 };
 
 #endif // WIFI_MANAGER_H
@@ -0,0 +1,41 @@
+/*
+ * Adafruit_AHTX0.h (host shim) - AHT10/AHT20 on the fake I2C bus
+ */
+
+#ifndef HOST_SHIM_ADAFRUIT_AHTX0_H
+#define HOST_SHIM_ADAFRUIT_AHTX0_H
+
+#include "Adafruit_Sensor.h"
+#include "Wire.h"
+
+#define AHTX0_I2CADDR_DEFAULT 0x38
+
+class Adafruit_AHTX0 {
+private:
+    uint8_t address = AHTX0_I2CADDR_DEFAULT;
+
+public:
+    bool begin(TwoWire* wire = &Wire, int32_t sensorId = 0, uint8_t i2cAddress = AHTX0_I2CADDR_DEFAULT) {
+        (void)wire;
+        (void)sensorId;
+        address = i2cAddress;
+        return host_i2c_present(address);
+    }
+
+    bool getEvent(sensors_event_t* humidity, sensors_event_t* temperature) {
+        float t = 0.0f, h = 0.0f;
+        bool ok = host_i2c_measure(address, HOST_I2C_TEMPERATURE, &t) &&
+                  host_i2c_measure(address, HOST_I2C_HUMIDITY, &h);
+        if (humidity) {
+            memset(humidity, 0, sizeof(*humidity));
+            humidity->relative_humidity = h;
+        }
+        if (temperature) {
+            memset(temperature, 0, sizeof(*temperature));
+            temperature->temperature = t;
+        }
+        return ok;
+    }
+};
+
+#endif // HOST_SHIM_ADAFRUIT_AHTX0_H
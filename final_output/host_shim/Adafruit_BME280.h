@@ -0,0 +1,36 @@
+/*
+ * Adafruit_BME280.h (host shim) - BME280 on the fake I2C bus
+ */
+
+#ifndef HOST_SHIM_ADAFRUIT_BME280_H
+#define HOST_SHIM_ADAFRUIT_BME280_H
+
+#include "Adafruit_Sensor.h"
+#include "Wire.h"
+
+#define BME280_ADDRESS 0x77
+#define BME280_ADDRESS_ALTERNATE 0x76
+
+class Adafruit_BME280 {
+private:
+    uint8_t address = BME280_ADDRESS;
+
+    float measure(uint8_t channel) {
+        float value = NAN;
+        host_i2c_measure(address, channel, &value);
+        return value;
+    }
+
+public:
+    bool begin(uint8_t i2cAddress = BME280_ADDRESS, TwoWire* wire = &Wire) {
+        (void)wire;
+        address = i2cAddress;
+        return host_i2c_present(address);
+    }
+
+    float readTemperature() { return measure(HOST_I2C_TEMPERATURE); }
+    float readPressure() { return measure(HOST_I2C_PRESSURE); }
+    float readHumidity() { return measure(HOST_I2C_HUMIDITY); }
+};
+
+#endif // HOST_SHIM_ADAFRUIT_BME280_H
@@ -0,0 +1,21 @@
+/*
+ * Adafruit_Sensor.h (host shim) - Unified sensor event
+ */
+
+#ifndef HOST_SHIM_ADAFRUIT_SENSOR_H
+#define HOST_SHIM_ADAFRUIT_SENSOR_H
+
+#include "Arduino.h"
+
+typedef struct {
+    int32_t version;
+    int32_t sensor_id;
+    int32_t type;
+    int32_t timestamp;
+    float temperature;
+    float relative_humidity;
+    float pressure;
+    float light;
+} sensors_event_t;
+
+#endif // HOST_SHIM_ADAFRUIT_SENSOR_H
@@ -0,0 +1,291 @@
+/*
+ * Arduino.h (host shim) - Core API of the ESP32 Arduino core on Linux
+ *
+ * Features:
+ * - millis()/micros()/delay() on the virtual clock (host_shim.h), 64-bit
+ *   so they never wrap on the host
+ * - String (std::string underneath: it allocates like the device's)
+ * - Print/Stream and Serial on stdout/stdin, printf() format-checked
+ * - IPAddress, ESP (chip info, free heap from the shim's heap accounting,
+ *   cycle counter at 240 MHz of virtual time)
+ * - GPIO/analog stand-ins, random()/map(), configTime()
+ */
+
+#ifndef HOST_SHIM_ARDUINO_H
+#define HOST_SHIM_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <string>
+#include <algorithm>
+#include "host_shim.h"
+
+#ifndef HOST_SHIM
+#define HOST_SHIM 1
+#endif
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+using std::max;
+using std::min;
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// ==================== TIME ====================
+inline unsigned long millis() { return (unsigned long)(host_clock_us() / 1000); }
+inline unsigned long micros() { return (unsigned long)host_clock_us(); }
+inline void delay(uint32_t ms) { host_clock_sleep_ms(ms); }
+void delayMicroseconds(uint32_t us);
+void yield();
+
+// SNTP (see host_shim.h: gettimeofday() follows once the link is up)
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1, const char* server2 = nullptr,
+                const char* server3 = nullptr);
+
+// ==================== GPIO ====================
+inline void pinMode(uint8_t pin, uint8_t mode) {
+    (void)pin;
+    (void)mode;
+}
+inline void digitalWrite(uint8_t pin, uint8_t value) {
+    (void)pin;
+    (void)value;
+}
+inline int digitalRead(uint8_t pin) {
+    (void)pin;
+    return LOW;
+}
+inline uint16_t analogRead(uint8_t pin) { return (uint16_t)host_analog_read(pin); }
+
+// ==================== MATH ====================
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+uint32_t esp_random();
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+// ==================== STRING ====================
+class String {
+private:
+    std::string text;
+
+    static std::string fromUnsigned(unsigned long long value, unsigned char base);
+    static std::string fromSigned(long long value, unsigned char base);
+    static std::string fromFloat(double value, unsigned int decimals);
+
+public:
+    String(const char* cstr = "") : text(cstr ? cstr : "") {}
+    String(const std::string& s) : text(s) {}
+    explicit String(char c) : text(1, c) {}
+    explicit String(unsigned char value, unsigned char base = 10) : text(fromUnsigned(value, base)) {}
+    explicit String(int value, unsigned char base = 10) : text(fromSigned(value, base)) {}
+    explicit String(unsigned int value, unsigned char base = 10) : text(fromUnsigned(value, base)) {}
+    explicit String(long value, unsigned char base = 10) : text(fromSigned(value, base)) {}
+    explicit String(unsigned long value, unsigned char base = 10) : text(fromUnsigned(value, base)) {}
+    explicit String(long long value, unsigned char base = 10) : text(fromSigned(value, base)) {}
+    explicit String(unsigned long long value, unsigned char base = 10) : text(fromUnsigned(value, base)) {}
+    explicit String(float value, unsigned int decimals = 2) : text(fromFloat(value, decimals)) {}
+    explicit String(double value, unsigned int decimals = 2) : text(fromFloat(value, decimals)) {}
+
+    const char* c_str() const { return text.c_str(); }
+    unsigned int length() const { return (unsigned int)text.size(); }
+    bool isEmpty() const { return text.empty(); }
+    bool reserve(unsigned int size) {
+        text.reserve(size);
+        return true;
+    }
+
+    String& operator+=(const String& rhs) {
+        text += rhs.text;
+        return *this;
+    }
+    String& operator+=(const char* rhs) {
+        text += rhs ? rhs : "";
+        return *this;
+    }
+    String& operator+=(char c) {
+        text += c;
+        return *this;
+    }
+    bool concat(const String& rhs) {
+        text += rhs.text;
+        return true;
+    }
+
+    friend String operator+(const String& lhs, const String& rhs) { return String(lhs.text + rhs.text); }
+    friend String operator+(const String& lhs, const char* rhs) { return String(lhs.text + (rhs ? rhs : "")); }
+    friend String operator+(const char* lhs, const String& rhs) { return String((lhs ? lhs : "") + rhs.text); }
+
+    bool operator==(const String& rhs) const { return text == rhs.text; }
+    bool operator==(const char* rhs) const { return text == (rhs ? rhs : ""); }
+    bool operator!=(const String& rhs) const { return text != rhs.text; }
+    bool operator!=(const char* rhs) const { return !(*this == rhs); }
+    bool operator<(const String& rhs) const { return text < rhs.text; }
+    bool equals(const String& rhs) const { return text == rhs.text; }
+    bool equalsIgnoreCase(const String& rhs) const;
+
+    char charAt(unsigned int index) const { return index < text.size() ? text[index] : '\0'; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const char* s, unsigned int from = 0) const;
+    bool startsWith(const char* prefix) const { return text.compare(0, strlen(prefix), prefix) == 0; }
+    bool endsWith(const char* suffix) const;
+    String substring(unsigned int from) const { return substring(from, length()); }
+    String substring(unsigned int from, unsigned int to) const;
+
+    void trim();
+    void toLowerCase();
+    void toUpperCase();
+    long toInt() const { return atol(text.c_str()); }
+    float toFloat() const { return (float)atof(text.c_str()); }
+    double toDouble() const { return atof(text.c_str()); }
+};
+
+// ==================== PRINT / STREAM ====================
+class Print {
+private:
+    size_t printNumber(unsigned long long value, int base);
+
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* s) { return s ? write((const uint8_t*)s, strlen(s)) : 0; }
+    size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+    virtual void flush() {}
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write(s.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char value, int base = DEC) { return print((unsigned long long)value, base); }
+    size_t print(int value, int base = DEC) { return print((long long)value, base); }
+    size_t print(unsigned int value, int base = DEC) { return print((unsigned long long)value, base); }
+    size_t print(long value, int base = DEC) { return print((long long)value, base); }
+    size_t print(unsigned long value, int base = DEC) { return print((unsigned long long)value, base); }
+    size_t print(long long value, int base = DEC);
+    size_t print(unsigned long long value, int base = DEC) { return printNumber(value, base); }
+    size_t print(double value, int digits = 2);
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T& value) {
+        size_t n = print(value);
+        return n + println();
+    }
+    template <typename T>
+    size_t println(const T& value, int format) {
+        size_t n = print(value, format);
+        return n + println();
+    }
+};
+
+class Stream : public Print {
+protected:
+    unsigned long timeoutMs = 1000;
+
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout) { timeoutMs = timeout; }
+    size_t readBytes(uint8_t* buffer, size_t length);
+    size_t readBytes(char* buffer, size_t length) { return readBytes((uint8_t*)buffer, length); }
+};
+
+// Serial: stdout (whole writes are atomic between threads, flushed at once)
+// and a receive buffer fed by stdin / host_serial_inject()
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    explicit operator bool() const { return true; }
+    size_t setRxBufferSize(size_t size) { return size; }
+    size_t setTxBufferSize(size_t size) { return size; }
+
+    int available() override;
+    int read() override;
+    int peek() override;
+
+    using Print::write;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override;
+    void flush() override;
+};
+
+extern HardwareSerial Serial;
+
+// ==================== NETWORK ADDRESS ====================
+class IPAddress {
+private:
+    uint8_t bytes[4];
+
+public:
+    IPAddress() { memset(bytes, 0, sizeof(bytes)); }
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+        bytes[0] = a;
+        bytes[1] = b;
+        bytes[2] = c;
+        bytes[3] = d;
+    }
+    // Same layout as the ESP32 core: first octet in the low byte
+    IPAddress(uint32_t address) { memcpy(bytes, &address, sizeof(bytes)); }
+
+    operator uint32_t() const {
+        uint32_t address;
+        memcpy(&address, bytes, sizeof(address));
+        return address;
+    }
+    bool operator==(const IPAddress& rhs) const { return memcmp(bytes, rhs.bytes, sizeof(bytes)) == 0; }
+    bool operator!=(const IPAddress& rhs) const { return !(*this == rhs); }
+    uint8_t operator[](int index) const { return bytes[index]; }
+    uint8_t& operator[](int index) { return bytes[index]; }
+
+    bool fromString(const char* text);
+    String toString() const;
+};
+
+// ==================== CHIP ====================
+class EspClass {
+public:
+    uint32_t getFreeHeap();
+    uint32_t getHeapSize() { return HOST_HEAP_BYTES; }
+    uint32_t getMinFreeHeap();
+    uint32_t getFlashChipSize() { return 8u * 1024 * 1024; }
+    uint32_t getPsramSize() { return 0; }
+    uint32_t getCpuFreqMHz() { return 240; }
+    const char* getChipModel() { return "ESP32-S3 (host shim)"; }
+    uint8_t getChipCores() { return 2; }
+    uint32_t getCycleCount() { return (uint32_t)(host_clock_us() * 240); }
+    void restart();
+};
+
+extern EspClass ESP;
+
+#endif // HOST_SHIM_ARDUINO_H
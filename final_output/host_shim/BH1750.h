@@ -0,0 +1,42 @@
+/*
+ * BH1750.h (host shim) - BH1750 light meter on the fake I2C bus
+ */
+
+#ifndef HOST_SHIM_BH1750_H
+#define HOST_SHIM_BH1750_H
+
+#include "Wire.h"
+
+class BH1750 {
+public:
+    enum Mode {
+        UNCONFIGURED = 0,
+        CONTINUOUS_HIGH_RES_MODE = 0x10,
+        CONTINUOUS_HIGH_RES_MODE_2 = 0x11,
+        CONTINUOUS_LOW_RES_MODE = 0x13,
+        ONE_TIME_HIGH_RES_MODE = 0x20,
+        ONE_TIME_HIGH_RES_MODE_2 = 0x21,
+        ONE_TIME_LOW_RES_MODE = 0x23
+    };
+
+private:
+    uint8_t address;
+
+public:
+    explicit BH1750(uint8_t i2cAddress = 0x23) : address(i2cAddress) {}
+
+    bool begin(Mode mode = CONTINUOUS_HIGH_RES_MODE, uint8_t i2cAddress = 0x23, TwoWire* wire = nullptr) {
+        (void)mode;
+        (void)wire;
+        address = i2cAddress;
+        return host_i2c_present(address);
+    }
+
+    // -1 = device not answering (as the library reports read errors)
+    float readLightLevel() {
+        float lux = 0.0f;
+        return host_i2c_measure(address, HOST_I2C_LIGHT, &lux) ? lux : -1.0f;
+    }
+};
+
+#endif // HOST_SHIM_BH1750_H
@@ -0,0 +1,64 @@
+/*
+ * FS.h (host shim) - File handle of the ESP32 file system API
+ *
+ * A File wraps a stdio stream; copies share it and the last one closes it.
+ */
+
+#ifndef HOST_SHIM_FS_H
+#define HOST_SHIM_FS_H
+
+#include <memory>
+#include "Arduino.h"
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+class File : public Stream {
+private:
+    std::shared_ptr<FILE> stream;
+
+public:
+    File() {}
+    explicit File(FILE* file) : stream(file, fclose) {}
+
+    explicit operator bool() const { return stream != nullptr; }
+
+    using Print::write;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        return stream ? fwrite(buffer, 1, size, stream.get()) : 0;
+    }
+
+    int available() override;
+    int read() override { return stream ? fgetc(stream.get()) : -1; }
+    int peek() override;
+    size_t read(uint8_t* buffer, size_t size) { return stream ? fread(buffer, 1, size, stream.get()) : 0; }
+
+    size_t size() const;
+    void flush() override {
+        if (stream) fflush(stream.get());
+    }
+    void close() { stream.reset(); }
+};
+
+namespace fs {
+// Directory-backed file system ("/path" maps to "<root>/path")
+class FS {
+private:
+    const char* area;
+
+    bool hostPath(const char* path, char* out, size_t size) const;
+
+public:
+    explicit FS(const char* stateArea) : area(stateArea) {}
+
+    File open(const char* path, const char* mode = FILE_READ, bool create = false);
+    bool exists(const char* path);
+    bool remove(const char* path);
+    bool rename(const char* from, const char* to);
+    bool mkdir(const char* path);
+};
+} // namespace fs
+
+#endif // HOST_SHIM_FS_H
@@ -0,0 +1,62 @@
+/*
+ * Firebase_ESP_Client.h (host shim) - Sign-in part of the Mobizt client
+ *
+ * FirebaseManager only uses the library for the ID token; its writes go
+ * over REST (WiFiClientSecure). Here the token is ready
+ * HOST_FIREBASE_TOKEN_MS after begin() once the fake link is up, has the
+ * size of a real one (request headers stay realistic) and never expires.
+ * The token status callback runs once, from the ready() call that sees it.
+ */
+
+#ifndef HOST_SHIM_FIREBASE_ESP_CLIENT_H
+#define HOST_SHIM_FIREBASE_ESP_CLIENT_H
+
+#include "Arduino.h"
+
+typedef enum {
+    token_status_uninitialized,
+    token_status_on_initialize,
+    token_status_on_signing,
+    token_status_on_request,
+    token_status_on_refresh,
+    token_status_ready,
+    token_status_error
+} firebase_auth_token_status;
+
+struct TokenInfo {
+    firebase_auth_token_status status = token_status_uninitialized;
+    struct {
+        int code = 0;
+        String message;
+    } error;
+};
+
+struct FirebaseAuth {
+    struct {
+        String email;
+        String password;
+    } user;
+};
+
+struct FirebaseConfig {
+    String api_key;
+    String database_url;
+    void (*token_status_callback)(TokenInfo info) = nullptr;
+};
+
+class Firebase_ESP_Client {
+private:
+    FirebaseConfig* config = nullptr;
+    unsigned long beganAt = 0;
+    bool tokenReady = false;
+
+public:
+    void begin(FirebaseConfig* cfg, FirebaseAuth* auth);
+    void reconnectWiFi(bool reconnect) { (void)reconnect; }
+    bool ready();
+    const char* getToken();
+};
+
+extern Firebase_ESP_Client Firebase;
+
+#endif // HOST_SHIM_FIREBASE_ESP_CLIENT_H
@@ -0,0 +1,60 @@
+/*
+ * HTTPClient.h (host shim) - Minimal HTTP/1.1 client on WiFiClient
+ *
+ * GET/POST to "http://host[:port]/path" with Connection: close; the host
+ * goes through the shim's routes like every other connection. Status code
+ * or the same negative HTTPC_ERROR_* codes as the ESP32 library.
+ */
+
+#ifndef HOST_SHIM_HTTP_CLIENT_H
+#define HOST_SHIM_HTTP_CLIENT_H
+
+#include "Arduino.h"
+#include "WiFiClient.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_NO_STREAM (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM (-8)
+#define HTTPC_ERROR_ENCODING (-9)
+#define HTTPC_ERROR_STREAM_WRITE (-10)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+#define HTTP_CODE_OK 200
+#define HTTP_CODE_NOT_FOUND 404
+
+class HTTPClient {
+private:
+    WiFiClient client;
+    String host;
+    String path;
+    uint16_t port;
+    bool valid;
+    uint16_t timeoutMs;
+    String body;
+
+    int request(const char* method, const uint8_t* payload, size_t size);
+
+public:
+    HTTPClient() : port(80), valid(false), timeoutMs(5000) {}
+
+    bool begin(const String& url);
+    void end();
+    void setReuse(bool reuse) { (void)reuse; }   // Always Connection: close
+    void setTimeout(uint16_t timeout) { timeoutMs = timeout; }
+    void setConnectTimeout(int32_t timeout) { (void)timeout; }
+
+    int GET();
+    int POST(const String& payload);
+    int POST(const uint8_t* payload, size_t size);
+    String getString() { return body; }
+    int getSize() { return (int)body.length(); }
+
+    static String errorToString(int error);
+};
+
+#endif // HOST_SHIM_HTTP_CLIENT_H
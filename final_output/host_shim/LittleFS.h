@@ -0,0 +1,23 @@
+/*
+ * LittleFS.h (host shim) - Flash file system as "<state>/littlefs"
+ */
+
+#ifndef HOST_SHIM_LITTLEFS_H
+#define HOST_SHIM_LITTLEFS_H
+
+#include "FS.h"
+
+class LittleFSFS : public fs::FS {
+public:
+    LittleFSFS() : fs::FS("littlefs") {}
+
+    bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+               const char* partitionLabel = "spiffs");
+    void end() {}
+    bool format();
+    size_t totalBytes() { return 1536u * 1024; }
+};
+
+extern LittleFSFS LittleFS;
+
+#endif // HOST_SHIM_LITTLEFS_H
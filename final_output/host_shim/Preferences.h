@@ -0,0 +1,39 @@
+/*
+ * Preferences.h (host shim) - NVS key/value store as files
+ *
+ * One file per key under "<state>/nvs/<namespace>.<key>", so values
+ * (WiFi fast-connect cache, Firebase info hash) survive from one run to
+ * the next like NVS survives a reboot. Read-only handles refuse writes.
+ */
+
+#ifndef HOST_SHIM_PREFERENCES_H
+#define HOST_SHIM_PREFERENCES_H
+
+#include "Arduino.h"
+
+class Preferences {
+private:
+    char space[16];
+    bool open;
+    bool readOnly;
+
+    bool keyPath(const char* key, char* out, size_t size) const;
+
+public:
+    Preferences() : open(false), readOnly(false) { space[0] = '\0'; }
+    ~Preferences() { end(); }
+
+    bool begin(const char* name, bool readOnlyMode = false, const char* partition = nullptr);
+    void end() { open = false; }
+
+    size_t putBytes(const char* key, const void* value, size_t length);
+    size_t getBytes(const char* key, void* buffer, size_t maxLength);
+    size_t getBytesLength(const char* key);
+    size_t putUInt(const char* key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0);
+    bool isKey(const char* key) { return getBytesLength(key) > 0; }
+    bool remove(const char* key);
+    bool clear();
+};
+
+#endif // HOST_SHIM_PREFERENCES_H
@@ -0,0 +1,49 @@
+/*
+ * WiFiClient.h (host shim) - TCP client on a POSIX socket
+ *
+ * Connects only while the fake link is up (host_shim.h); names and ports
+ * go through the shim's routes, so "api.thingspeak.com:80" can land on a
+ * local stand-in. A socket opened before the link dropped stops working
+ * (write 0, connected() false), like the device's after a disconnect.
+ */
+
+#ifndef HOST_SHIM_WIFI_CLIENT_H
+#define HOST_SHIM_WIFI_CLIENT_H
+
+#include "Arduino.h"
+
+class WiFiClient : public Stream {
+private:
+    int fd;
+    uint32_t linkGeneration;   // Fake link session the socket belongs to
+
+    bool linkAlive() const;
+    bool connectTo(uint32_t address, uint16_t port, int32_t timeoutMs);
+
+public:
+    WiFiClient() : fd(-1), linkGeneration(0) {}
+    ~WiFiClient() override { stop(); }
+    WiFiClient(const WiFiClient&) = delete;
+    WiFiClient& operator=(const WiFiClient&) = delete;
+
+    int connect(IPAddress ip, uint16_t port);
+    int connect(const char* host, uint16_t port);
+    int connect(IPAddress ip, uint16_t port, int32_t timeoutMs);
+    int connect(const char* host, uint16_t port, int32_t timeoutMs);
+
+    using Print::write;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override;
+
+    int available() override;
+    int read() override;
+    int read(uint8_t* buffer, size_t size);
+    int peek() override;
+
+    uint8_t connected();
+    explicit operator bool() { return connected(); }
+    void stop();
+    int setNoDelay(bool noDelay);
+};
+
+#endif // HOST_SHIM_WIFI_CLIENT_H
@@ -0,0 +1,22 @@
+/*
+ * WiFiClientSecure.h (host shim) - TLS client without the TLS
+ *
+ * Plain TCP: the local stand-ins (host_tools/rtdb_standin.cpp) speak HTTP,
+ * so the Firebase REST writes reach them through a route such as
+ * "*.firebasedatabase.app:443" → "127.0.0.1:8081". Handshake time is not
+ * modelled.
+ */
+
+#ifndef HOST_SHIM_WIFI_CLIENT_SECURE_H
+#define HOST_SHIM_WIFI_CLIENT_SECURE_H
+
+#include "WiFiClient.h"
+
+class WiFiClientSecure : public WiFiClient {
+public:
+    void setInsecure() {}
+    void setCACert(const char* rootCA) { (void)rootCA; }
+    void setHandshakeTimeout(unsigned long seconds) { (void)seconds; }
+};
+
+#endif // HOST_SHIM_WIFI_CLIENT_SECURE_H
@@ -0,0 +1,39 @@
+/*
+ * WiFiUdp.h (host shim) - UDP datagrams on a POSIX socket
+ *
+ * beginPacket()/write()/endPacket() collect one datagram and send it to
+ * the (routed) destination; nothing is sent while the fake link is down.
+ */
+
+#ifndef HOST_SHIM_WIFI_UDP_H
+#define HOST_SHIM_WIFI_UDP_H
+
+#include <vector>
+#include "Arduino.h"
+
+class WiFiUDP : public Print {
+private:
+    int fd;
+    uint32_t remoteAddress;
+    uint16_t remotePort;
+    bool packetOpen;
+    std::vector<uint8_t> packet;
+
+public:
+    WiFiUDP() : fd(-1), remoteAddress(0), remotePort(0), packetOpen(false) {}
+    ~WiFiUDP() override { stop(); }
+    WiFiUDP(const WiFiUDP&) = delete;
+    WiFiUDP& operator=(const WiFiUDP&) = delete;
+
+    int beginPacket(IPAddress ip, uint16_t port);
+    int beginPacket(const char* host, uint16_t port);
+    int endPacket();   // 1 = sent
+
+    using Print::write;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override;
+
+    void stop();
+};
+
+#endif // HOST_SHIM_WIFI_UDP_H
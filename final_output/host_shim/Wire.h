@@ -0,0 +1,62 @@
+/*
+ * Wire.h (host shim) - I2C bus with fake devices
+ *
+ * An address answers (endTransmission() == 0) when a device is attached
+ * with host_i2c_attach() / host_attach_weather_sensors(); everything else
+ * NACKs (2), so bus scans show exactly the attached devices. Drivers read
+ * measurements through host_i2c_measure() rather than raw registers.
+ */
+
+#ifndef HOST_SHIM_WIRE_H
+#define HOST_SHIM_WIRE_H
+
+#include "Arduino.h"
+
+class TwoWire {
+private:
+    uint8_t address;
+    bool transmitting;
+
+public:
+    TwoWire() : address(0), transmitting(false) {}
+
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) {
+        (void)sda;
+        (void)scl;
+        (void)frequency;
+        return true;
+    }
+    bool setPins(int sda, int scl) {
+        (void)sda;
+        (void)scl;
+        return true;
+    }
+    bool setClock(uint32_t frequency) {
+        (void)frequency;
+        return true;
+    }
+    void setTimeOut(uint16_t timeoutMs) { (void)timeoutMs; }
+    bool end() { return true; }
+
+    void beginTransmission(uint8_t target) {
+        address = target;
+        transmitting = true;
+    }
+    size_t write(uint8_t data) {
+        (void)data;
+        return transmitting ? 1 : 0;
+    }
+    // 0 = ACK, 2 = address NACK
+    uint8_t endTransmission(bool sendStop = true) {
+        (void)sendStop;
+        transmitting = false;
+        return host_i2c_present(address) ? 0 : 2;
+    }
+    uint8_t requestFrom(uint8_t target, uint8_t quantity) { return host_i2c_present(target) ? quantity : 0; }
+    int available() { return 0; }
+    int read() { return -1; }
+};
+
+extern TwoWire Wire;
+
+#endif // HOST_SHIM_WIRE_H
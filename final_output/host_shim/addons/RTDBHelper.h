@@ -0,0 +1,11 @@
+/*
+ * addons/RTDBHelper.h (host shim) - Nothing to help with: the firmware
+ * writes the RTDB over REST itself
+ */
+
+#ifndef HOST_SHIM_RTDB_HELPER_H
+#define HOST_SHIM_RTDB_HELPER_H
+
+#include "../Firebase_ESP_Client.h"
+
+#endif // HOST_SHIM_RTDB_HELPER_H
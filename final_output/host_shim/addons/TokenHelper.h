@@ -0,0 +1,22 @@
+/*
+ * addons/TokenHelper.h (host shim) - Token status strings
+ */
+
+#ifndef HOST_SHIM_TOKEN_HELPER_H
+#define HOST_SHIM_TOKEN_HELPER_H
+
+#include "../Firebase_ESP_Client.h"
+
+inline const char* getTokenStatus(const TokenInfo& info) {
+    switch (info.status) {
+        case token_status_on_initialize: return "on initializing";
+        case token_status_on_signing: return "on signing";
+        case token_status_on_request: return "on request";
+        case token_status_on_refresh: return "on refreshing";
+        case token_status_ready: return "ready";
+        case token_status_error: return "error";
+        default: return "uninitialized";
+    }
+}
+
+#endif // HOST_SHIM_TOKEN_HELPER_H
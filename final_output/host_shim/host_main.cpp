@@ -0,0 +1,168 @@
+/*
+ * Host Main - Runs the sketch as a Linux process against the host shim
+ *
+ * Calls setup() once, then loop() (and serialEvent() whenever Serial has
+ * input, as the ESP32 core does after each loop()) until the run time is
+ * up, then exits with status 0. Every option configures the shim before
+ * setup(); see host_shim.h.
+ *
+ * Build (from final_output/):
+ *   cmake -S . -B build && cmake --build build --target weather_firmware
+ *
+ * Usage:
+ *   ./build/weather_firmware --seconds 120 --speed 20 --standins | ./build/log_decoder
+ *   ./build/weather_firmware --outage 600:45 --at 5:x --at 6:netstats --seconds 900 --speed 30
+ *   ./build/weather_firmware --route api.thingspeak.com:80=127.0.0.1:18080 --no-stdin
+ */
+
+#include "host_shim.h"
+#include "Arduino.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+void setup();
+void loop();
+
+// Sketches without one (the ESP32 core has the same weak default)
+__attribute__((weak)) void serialEvent() {}
+
+namespace {
+
+struct ScriptedLine {
+    double atSeconds;
+    std::string line;
+};
+
+void printUsage(const char* program) {
+    printf("Usage: %s [options]\n"
+           "  --seconds S        Virtual run time (default 60; 0 = until killed)\n"
+           "  --speed X          Virtual clock speed (default 1 = real time)\n"
+           "  --state DIR        NVS/LittleFS directory (default " HOST_STATE_DIR ")\n"
+           "  --route FROM=TO    host[:port]=ipv4[:port], \"*.suffix\" wildcards\n"
+           "  --standins         Route ThingSpeak to 127.0.0.1:8080 and Firebase to\n"
+           "                     127.0.0.1:8081 (host_tools/mqtt_broker_standin, rtdb_standin)\n"
+           "  --internet         Resolve unrouted names (real uploads!)\n"
+           "  --sensors          Attach the fake AHT10/BME280/BH1750/MQ2\n"
+           "  --wifi-down        Start with the access point out of range\n"
+           "  --outage AT:DUR    Access point gone at AT s for DUR s (repeatable)\n"
+           "  --assoc-ms MS      Association time (default %d)\n"
+           "  --token-ms MS      Firebase sign-in time (default %d)\n"
+           "  --at SEC:LINE      Type LINE on the console at SEC s (repeatable)\n"
+           "  --seed N           Random seed\n"
+           "  --no-stdin         Do not forward stdin to Serial\n",
+           program, HOST_WIFI_ASSOC_MS, HOST_FIREBASE_TOKEN_MS);
+}
+
+bool parseAtSpan(const char* text, double& at, double& second) {
+    char* end = nullptr;
+    at = strtod(text, &end);
+    if (end == text || *end != ':') return false;
+    const char* rest = end + 1;
+    second = strtod(rest, &end);
+    return end != rest && *end == '\0' && at >= 0 && second >= 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    double seconds = 60;
+    bool readStdin = true;
+    std::vector<ScriptedLine> script;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool takesValue = true;
+        bool ok = true;
+
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        } else if (strcmp(arg, "--standins") == 0) {
+            takesValue = false;
+            host_net_route("api.thingspeak.com:80", "127.0.0.1:8080");
+            host_net_route("*.firebasedatabase.app:443", "127.0.0.1:8081");
+        } else if (strcmp(arg, "--internet") == 0) {
+            takesValue = false;
+            host_net_allow_internet(true);
+        } else if (strcmp(arg, "--sensors") == 0) {
+            takesValue = false;
+            host_attach_weather_sensors();
+        } else if (strcmp(arg, "--wifi-down") == 0) {
+            takesValue = false;
+            host_wifi_set_ap(false);
+        } else if (strcmp(arg, "--no-stdin") == 0) {
+            takesValue = false;
+            readStdin = false;
+        } else if (value == nullptr) {
+            ok = false;
+        } else if (strcmp(arg, "--seconds") == 0) {
+            seconds = atof(value);
+            ok = seconds >= 0;
+        } else if (strcmp(arg, "--speed") == 0) {
+            double speed = atof(value);
+            ok = speed > 0;
+            if (ok) host_clock_set_speed(speed);
+        } else if (strcmp(arg, "--state") == 0) {
+            host_state_set_dir(value);
+        } else if (strcmp(arg, "--route") == 0) {
+            std::string spec(value);
+            size_t equals = spec.find('=');
+            ok = equals != std::string::npos &&
+                 host_net_route(spec.substr(0, equals).c_str(), spec.substr(equals + 1).c_str());
+        } else if (strcmp(arg, "--outage") == 0) {
+            double at, duration;
+            ok = parseAtSpan(value, at, duration);
+            if (ok) host_wifi_schedule_outage((uint32_t)(at * 1000), (uint32_t)(duration * 1000));
+        } else if (strcmp(arg, "--assoc-ms") == 0) {
+            uint32_t ms = (uint32_t)atol(value);
+            host_wifi_set_assoc_ms(ms, ms < HOST_WIFI_FAST_MS ? ms : HOST_WIFI_FAST_MS);
+        } else if (strcmp(arg, "--token-ms") == 0) {
+            host_firebase_set_token_ms((uint32_t)atol(value));
+        } else if (strcmp(arg, "--at") == 0) {
+            const char* colon = strchr(value, ':');
+            ok = colon != nullptr;
+            if (ok) script.push_back({ atof(value), std::string(colon + 1) + "\n" });
+        } else if (strcmp(arg, "--seed") == 0) {
+            randomSeed((unsigned long)atol(value));
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            fprintf(stderr, "Bad option: %s%s%s\n\n", arg, value && takesValue ? " " : "",
+                    value && takesValue ? value : "");
+            printUsage(argv[0]);
+            return 2;
+        }
+        if (takesValue) i++;
+    }
+
+    std::stable_sort(script.begin(), script.end(),
+                     [](const ScriptedLine& a, const ScriptedLine& b) { return a.atSeconds < b.atSeconds; });
+    if (readStdin) host_serial_start_stdin();
+
+    setup();
+
+    const uint64_t endUs = (uint64_t)(seconds * 1e6);
+    size_t next = 0;
+    while (seconds == 0 || host_clock_us() < endUs) {
+        while (next < script.size() && host_clock_us() >= (uint64_t)(script[next].atSeconds * 1e6)) {
+            host_serial_inject(script[next].line.c_str());
+            next++;
+        }
+        loop();
+        if (Serial.available()) serialEvent();
+    }
+
+    // Tasks and the WiFi event thread never return (as on the device):
+    // give the log task a moment to drain, then leave without joining
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    Serial.flush();
+    fflush(stdout);
+    std::_Exit(0);
+}
@@ -0,0 +1,843 @@
+/*
+ * Host Shim - Fake WiFi, routed sockets, HTTPClient and Firebase sign-in
+ *
+ * The fake link is a small state machine on the virtual clock, advanced
+ * by an event thread that also delivers the driver events. Sockets are
+ * real (loopback stand-ins in host_tools/), but only usable while the link
+ * that was up when they connected is still up.
+ */
+
+#include "host_shim.h"
+#include "Arduino.h"
+#include "WiFi.h"
+#include "WiFiClient.h"
+#include "WiFiUdp.h"
+#include "HTTPClient.h"
+#include "Firebase_ESP_Client.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+WiFiClass WiFi;
+Firebase_ESP_Client Firebase;
+
+// ==================== ROUTES ====================
+
+namespace {
+
+struct HostRoute {
+    std::string host;      // Without "*." for wildcards
+    bool wildcard;
+    int port;              // -1 = any
+    uint32_t target;       // IPAddress layout
+    int targetPort;        // -1 = same port
+};
+
+std::mutex routeLock;
+std::vector<HostRoute> routes;
+std::atomic<bool> internetAllowed(false);
+
+bool parse_ipv4(const char* text, uint32_t& address) {
+    IPAddress ip;
+    if (!ip.fromString(text)) return false;
+    address = (uint32_t)ip;
+    return true;
+}
+
+// "name[:port]" → name, port (-1 when absent)
+bool split_host_port(const char* text, std::string& host, int& port) {
+    const char* colon = strrchr(text, ':');
+    port = -1;
+    if (colon != nullptr) {
+        char* end = nullptr;
+        long value = strtol(colon + 1, &end, 10);
+        if (end == colon + 1 || *end != '\0' || value <= 0 || value > 65535) return false;
+        port = (int)value;
+        host.assign(text, (size_t)(colon - text));
+    } else {
+        host = text;
+    }
+    return !host.empty();
+}
+
+bool route_matches(const HostRoute& route, const char* host) {
+    if (!route.wildcard) return strcasecmp(route.host.c_str(), host) == 0;
+    size_t hostLength = strlen(host);
+    size_t suffixLength = route.host.size();
+    return hostLength > suffixLength && host[hostLength - suffixLength - 1] == '.' &&
+           strcasecmp(host + hostLength - suffixLength, route.host.c_str()) == 0;
+}
+
+// Routed destination for host:port (port -1 = name only, for DNS)
+bool route_lookup(const char* host, int port, uint32_t& address, int& targetPort) {
+    std::lock_guard<std::mutex> guard(routeLock);
+    for (const HostRoute& route : routes) {
+        if (route_matches(route, host) && (port < 0 || route.port < 0 || route.port == port)) {
+            address = route.target;
+            targetPort = route.targetPort < 0 || port < 0 ? port : route.targetPort;
+            return true;
+        }
+    }
+    return false;
+}
+
+// A connection to an address that a routed name resolved to keeps the
+// route's port mapping
+uint16_t route_port(uint32_t address, uint16_t port) {
+    std::lock_guard<std::mutex> guard(routeLock);
+    for (const HostRoute& route : routes) {
+        if (route.target == address && route.port == port && route.targetPort > 0) {
+            return (uint16_t)route.targetPort;
+        }
+    }
+    return port;
+}
+
+bool resolve_host(const char* host, uint32_t& address) {
+    int unusedPort;
+    if (route_lookup(host, -1, address, unusedPort)) return true;
+    if (parse_ipv4(host, address)) return true;
+    if (!internetAllowed) return false;
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    struct addrinfo* result = nullptr;
+    if (getaddrinfo(host, nullptr, &hints, &result) != 0 || result == nullptr) return false;
+    struct sockaddr_in* in = (struct sockaddr_in*)result->ai_addr;
+    memcpy(&address, &in->sin_addr.s_addr, sizeof(address));   // Network order = IPAddress layout
+    freeaddrinfo(result);
+    return true;
+}
+
+struct sockaddr_in socket_address(uint32_t address, uint16_t port) {
+    struct sockaddr_in in;
+    memset(&in, 0, sizeof(in));
+    in.sin_family = AF_INET;
+    in.sin_port = htons(port);
+    memcpy(&in.sin_addr.s_addr, &address, sizeof(address));
+    return in;
+}
+
+} // namespace
+
+bool host_net_route(const char* from, const char* to) {
+    HostRoute route;
+    std::string target;
+    if (!split_host_port(from, route.host, route.port) || !split_host_port(to, target, route.targetPort) ||
+        !parse_ipv4(target.c_str(), route.target)) {
+        return false;
+    }
+    route.wildcard = route.host.compare(0, 2, "*.") == 0;
+    if (route.wildcard) route.host.erase(0, 2);
+    std::lock_guard<std::mutex> guard(routeLock);
+    routes.push_back(route);
+    return true;
+}
+
+void host_net_allow_internet(bool allow) { internetAllowed = allow; }
+
+// ==================== FAKE LINK ====================
+
+namespace {
+
+struct HostOutage {
+    uint64_t atMs;
+    uint64_t durationMs;
+};
+
+struct HostWiFi {
+    std::mutex lock;
+    wifi_mode_t mode = WIFI_OFF;
+    wl_status_t status = WL_IDLE_STATUS;
+    bool connecting = false;
+    uint64_t connectDueMs = 0;
+    bool apUp = true;
+    std::vector<HostOutage> outages;
+    uint32_t assocMs = HOST_WIFI_ASSOC_MS;
+    uint32_t fastMs = HOST_WIFI_FAST_MS;
+    std::string ssid = "host-shim-ap";
+    bool staticIp = false;
+    IPAddress ip, gateway, subnet, dns;
+    std::vector<WiFiEventFuncCb> handlers;
+    std::vector<arduino_event_id_t> handlerEvents;
+    bool threadStarted = false;
+};
+
+HostWiFi& host_wifi() {
+    static HostWiFi wifi;
+    return wifi;
+}
+
+// Bumped whenever the link goes down: sockets of an earlier link are dead
+std::atomic<uint32_t> linkGeneration(1);
+
+const uint8_t HOST_MAC[6] = { 0x34, 0x85, 0x18, 0x4A, 0x2C, 0x10 };
+uint8_t HOST_BSSID[6] = { 0x24, 0x0A, 0xC4, 0x5E, 0x71, 0x02 };
+const int32_t HOST_CHANNEL = 6;
+
+struct PendingEvent {
+    arduino_event_id_t id;
+    arduino_event_info_t info;
+};
+
+bool ap_in_range(HostWiFi& wifi, uint64_t nowMs) {
+    if (!wifi.apUp) return false;
+    for (const HostOutage& outage : wifi.outages) {
+        if (nowMs >= outage.atMs && nowMs < outage.atMs + outage.durationMs) return false;
+    }
+    return true;
+}
+
+PendingEvent disconnect_event(HostWiFi& wifi, uint8_t reason) {
+    PendingEvent event;
+    event.id = ARDUINO_EVENT_WIFI_STA_DISCONNECTED;
+    memset(&event.info, 0, sizeof(event.info));
+    size_t length = wifi.ssid.size() < 32 ? wifi.ssid.size() : 32;
+    memcpy(event.info.wifi_sta_disconnected.ssid, wifi.ssid.c_str(), length);
+    event.info.wifi_sta_disconnected.ssid_len = (uint8_t)length;
+    memcpy(event.info.wifi_sta_disconnected.bssid, HOST_BSSID, sizeof(HOST_BSSID));
+    event.info.wifi_sta_disconnected.reason = reason;
+    return event;
+}
+
+// Status after a disconnect, as the ESP32 core maps the reason
+wl_status_t status_for_reason(uint8_t reason) {
+    switch (reason) {
+        case WIFI_REASON_NO_AP_FOUND: return WL_NO_SSID_AVAIL;
+        case WIFI_REASON_AUTH_FAIL:
+        case WIFI_REASON_ASSOC_FAIL: return WL_CONNECT_FAILED;
+        case WIFI_REASON_BEACON_TIMEOUT: return WL_CONNECTION_LOST;
+        default: return WL_DISCONNECTED;
+    }
+}
+
+// Link down (caller holds the lock); the event goes out after unlocking
+void link_down(HostWiFi& wifi, uint8_t reason, std::vector<PendingEvent>& events) {
+    if (wifi.status == WL_CONNECTED) {
+        linkGeneration++;
+    }
+    wifi.connecting = false;
+    wifi.status = status_for_reason(reason);
+    events.push_back(disconnect_event(wifi, reason));
+}
+
+void deliver(const std::vector<PendingEvent>& events) {
+    if (events.empty()) return;
+    HostWiFi& wifi = host_wifi();
+    std::vector<WiFiEventFuncCb> handlers;
+    std::vector<arduino_event_id_t> filters;
+    {
+        std::lock_guard<std::mutex> guard(wifi.lock);
+        handlers = wifi.handlers;
+        filters = wifi.handlerEvents;
+    }
+    for (const PendingEvent& event : events) {
+        for (size_t i = 0; i < handlers.size(); i++) {
+            if (filters[i] == ARDUINO_EVENT_MAX || filters[i] == event.id) {
+                handlers[i](event.id, event.info);
+            }
+        }
+    }
+}
+
+// One step of the link state machine on the virtual clock
+void link_tick() {
+    HostWiFi& wifi = host_wifi();
+    std::vector<PendingEvent> events;
+    {
+        std::lock_guard<std::mutex> guard(wifi.lock);
+        uint64_t now = host_clock_us() / 1000;
+        bool inRange = ap_in_range(wifi, now);
+        if (wifi.status == WL_CONNECTED && !inRange) {
+            link_down(wifi, WIFI_REASON_BEACON_TIMEOUT, events);
+        } else if (wifi.connecting && now >= wifi.connectDueMs) {
+            if (inRange) {
+                wifi.connecting = false;
+                wifi.status = WL_CONNECTED;
+                PendingEvent connected;
+                connected.id = ARDUINO_EVENT_WIFI_STA_CONNECTED;
+                memset(&connected.info, 0, sizeof(connected.info));
+                connected.info.wifi_sta_connected.channel = (uint8_t)HOST_CHANNEL;
+                events.push_back(connected);
+                PendingEvent gotIp;
+                gotIp.id = ARDUINO_EVENT_WIFI_STA_GOT_IP;
+                memset(&gotIp.info, 0, sizeof(gotIp.info));
+                events.push_back(gotIp);
+            } else {
+                link_down(wifi, WIFI_REASON_NO_AP_FOUND, events);
+            }
+        }
+    }
+    deliver(events);
+}
+
+// Event task: steps the link every 2 ms of real time
+void start_event_thread(HostWiFi& wifi) {
+    if (wifi.threadStarted) return;
+    wifi.threadStarted = true;
+    std::thread([] {
+        for (;;) {
+            link_tick();
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }).detach();
+}
+
+bool link_up() { return host_wifi_connected(); }
+
+} // namespace
+
+void host_wifi_set_ap(bool up) {
+    HostWiFi& wifi = host_wifi();
+    std::lock_guard<std::mutex> guard(wifi.lock);
+    wifi.apUp = up;
+}
+
+void host_wifi_schedule_outage(uint32_t atMs, uint32_t durationMs) {
+    HostWiFi& wifi = host_wifi();
+    std::lock_guard<std::mutex> guard(wifi.lock);
+    wifi.outages.push_back({ atMs, durationMs });
+}
+
+void host_wifi_set_assoc_ms(uint32_t fullMs, uint32_t fastMs) {
+    HostWiFi& wifi = host_wifi();
+    std::lock_guard<std::mutex> guard(wifi.lock);
+    wifi.assocMs = fullMs;
+    wifi.fastMs = fastMs;
+}
+
+bool host_wifi_connected() {
+    HostWiFi& wifi = host_wifi();
+    std::lock_guard<std::mutex> guard(wifi.lock);
+    return wifi.status == WL_CONNECTED;
+}
+
+// ==================== WiFiClass ====================
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* passphrase, int32_t channel, const uint8_t* bssid,
+                             bool connect) {
+    (void)passphrase;
+    HostWiFi& wifi = host_wifi();
+    std::vector<PendingEvent> events;
+    wl_status_t status;
+    {
+        std::lock_guard<std::mutex> guard(wifi.lock);
+        if (wifi.mode == WIFI_OFF) wifi.mode = WIFI_STA;
+        if (wifi.status == WL_CONNECTED) {
+            link_down(wifi, WIFI_REASON_ASSOC_LEAVE, events);
+        }
+        wifi.ssid = ssid ? ssid : "";
+        if (connect) {
+            bool directed = channel > 0 && bssid != nullptr;
+            wifi.connecting = true;
+            wifi.connectDueMs = host_clock_us() / 1000 + (directed ? wifi.fastMs : wifi.assocMs);
+            wifi.status = WL_DISCONNECTED;
+        }
+        start_event_thread(wifi);
+        status = wifi.status;
+    }
+    deliver(events);
+    return status;
+}
+
+bool WiFiClass::config(IPAddress localIP, IPAddress gateway, IPAddress subnet, IPAddress dns1, IPAddress dns2) {
+    (void)dns2;
+    HostWiFi& wifi = host_wifi();
+    std::lock_guard<std::mutex> guard(wifi.lock);
+    wifi.staticIp = (uint32_t)localIP != 0;
+    wifi.ip = localIP;
+    wifi.gateway = gateway;
+    wifi.subnet = subnet;
+    wifi.dns = dns1;
+    return true;
+}
+
+bool WiFiClass::disconnect(bool wifiOff, bool eraseAp) {
+    (void)eraseAp;
+    HostWiFi& wifi = host_wifi();
+    std::vector<PendingEvent> events;
+    {
+        std::lock_guard<std::mutex> guard(wifi.lock);
+        if (wifi.status == WL_CONNECTED || wifi.connecting) {
+            link_down(wifi, WIFI_REASON_ASSOC_LEAVE, events);
+        }
+        if (wifiOff) wifi.mode = WIFI_OFF;
+    }
+    deliver(events);
+    return true;
+}
+
+bool WiFiClass::reconnect() {
+    std::string ssid;
+    {
+        HostWiFi& wifi = host_wifi();
+        std::lock_guard<std::mutex> guard(wifi.lock);
+        ssid = wifi.ssid;
+    }
+    return begin(ssid.c_str()) != WL_CONNECT_FAILED;
+}
+
+wl_status_t WiFiClass::status() {
+    HostWiFi& wifi = host_wifi();
+    std::lock_guard<std::mutex> guard(wifi.lock);
+    return wifi.status;
+}
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+    HostWiFi& wifi = host_wifi();
+    std::lock_guard<std::mutex> guard(wifi.lock);
+    wifi.mode = mode;
+    if (mode != WIFI_OFF && wifi.status == WL_IDLE_STATUS) wifi.status = WL_DISCONNECTED;
+    return true;
+}
+
+wifi_mode_t WiFiClass::getMode() {
+    HostWiFi& wifi = host_wifi();
+    std::lock_guard<std::mutex> guard(wifi.lock);
+    return wifi.mode;
+}
+
+// The fake driver never reconnects on its own (the firmware's WiFiLink does)
+bool WiFiClass::setAutoReconnect(bool autoReconnect) {
+    (void)autoReconnect;
+    return true;
+}
+
+bool WiFiClass::getAutoReconnect() { return false; }
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventFuncCb callback, arduino_event_id_t event) {
+    HostWiFi& wifi = host_wifi();
+    std::lock_guard<std::mutex> guard(wifi.lock);
+    wifi.handlers.push_back(callback);
+    wifi.handlerEvents.push_back(event);
+    start_event_thread(wifi);
+    return wifi.handlers.size();
+}
+
+String WiFiClass::SSID() {
+    HostWiFi& wifi = host_wifi();
+    std::lock_guard<std::mutex> guard(wifi.lock);
+    return wifi.status == WL_CONNECTED ? String(wifi.ssid) : String();
+}
+
+int8_t WiFiClass::RSSI() {
+    if (!link_up()) return 0;
+    return (int8_t)(HOST_WIFI_RSSI + (int)(esp_random() % 7) - 3);
+}
+
+int32_t WiFiClass::channel() { return link_up() ? HOST_CHANNEL : 0; }
+
+uint8_t* WiFiClass::BSSID() { return link_up() ? HOST_BSSID : nullptr; }
+
+String WiFiClass::BSSIDstr() {
+    char text[18];
+    snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X", HOST_BSSID[0], HOST_BSSID[1], HOST_BSSID[2],
+             HOST_BSSID[3], HOST_BSSID[4], HOST_BSSID[5]);
+    return String(text);
+}
+
+IPAddress WiFiClass::localIP() {
+    HostWiFi& wifi = host_wifi();
+    std::lock_guard<std::mutex> guard(wifi.lock);
+    if (wifi.status != WL_CONNECTED) return IPAddress();
+    return wifi.staticIp ? wifi.ip : IPAddress(192, 168, 4, 20);
+}
+
+IPAddress WiFiClass::gatewayIP() {
+    HostWiFi& wifi = host_wifi();
+    std::lock_guard<std::mutex> guard(wifi.lock);
+    if (wifi.status != WL_CONNECTED) return IPAddress();
+    return wifi.staticIp ? wifi.gateway : IPAddress(192, 168, 4, 1);
+}
+
+IPAddress WiFiClass::subnetMask() {
+    HostWiFi& wifi = host_wifi();
+    std::lock_guard<std::mutex> guard(wifi.lock);
+    if (wifi.status != WL_CONNECTED) return IPAddress();
+    return wifi.staticIp ? wifi.subnet : IPAddress(255, 255, 255, 0);
+}
+
+IPAddress WiFiClass::dnsIP(uint8_t index) {
+    (void)index;
+    HostWiFi& wifi = host_wifi();
+    std::lock_guard<std::mutex> guard(wifi.lock);
+    if (wifi.status != WL_CONNECTED) return IPAddress();
+    return wifi.staticIp && (uint32_t)wifi.dns != 0 ? wifi.dns : IPAddress(192, 168, 4, 1);
+}
+
+uint8_t* WiFiClass::macAddress(uint8_t* mac) {
+    memcpy(mac, HOST_MAC, sizeof(HOST_MAC));
+    return mac;
+}
+
+String WiFiClass::macAddress() {
+    char text[18];
+    snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X", HOST_MAC[0], HOST_MAC[1], HOST_MAC[2],
+             HOST_MAC[3], HOST_MAC[4], HOST_MAC[5]);
+    return String(text);
+}
+
+int16_t WiFiClass::scanNetworks(bool async, bool showHidden) {
+    (void)async;
+    (void)showHidden;
+    HostWiFi& wifi = host_wifi();
+    std::lock_guard<std::mutex> guard(wifi.lock);
+    return ap_in_range(wifi, host_clock_us() / 1000) ? 1 : 0;
+}
+
+String WiFiClass::SSID(uint8_t index) {
+    HostWiFi& wifi = host_wifi();
+    std::lock_guard<std::mutex> guard(wifi.lock);
+    return index == 0 ? String(wifi.ssid) : String();
+}
+
+int32_t WiFiClass::RSSI(uint8_t index) { return index == 0 ? HOST_WIFI_RSSI : 0; }
+
+wifi_auth_mode_t WiFiClass::encryptionType(uint8_t index) {
+    (void)index;
+    return WIFI_AUTH_WPA2_PSK;
+}
+
+int WiFiClass::hostByName(const char* host, IPAddress& result) {
+    uint32_t address;
+    if (!link_up() || !resolve_host(host, address)) {
+        result = IPAddress();
+        return 0;
+    }
+    result = IPAddress(address);
+    return 1;
+}
+
+// ==================== WiFiClient ====================
+
+bool WiFiClient::linkAlive() const { return fd >= 0 && linkGeneration == ::linkGeneration.load() && link_up(); }
+
+bool WiFiClient::connectTo(uint32_t address, uint16_t port, int32_t timeoutMs) {
+    stop();
+    if (!link_up()) return false;
+    int s = socket(AF_INET, SOCK_STREAM, 0);
+    if (s < 0) return false;
+    fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+
+    struct sockaddr_in target = socket_address(address, route_port(address, port));
+    int rc = ::connect(s, (struct sockaddr*)&target, sizeof(target));
+    if (rc < 0 && errno == EINPROGRESS) {
+        struct pollfd waiter = { s, POLLOUT, 0 };
+        rc = poll(&waiter, 1, timeoutMs) == 1 ? 0 : -1;
+        int error = 0;
+        socklen_t length = sizeof(error);
+        if (rc == 0 && (getsockopt(s, SOL_SOCKET, SO_ERROR, &error, &length) < 0 || error != 0)) {
+            rc = -1;
+        }
+    }
+    if (rc < 0) {
+        close(s);
+        return false;
+    }
+    fd = s;
+    this->linkGeneration = ::linkGeneration.load();
+    return true;
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) { return connect(ip, port, HOST_CONNECT_TIMEOUT_MS); }
+
+int WiFiClient::connect(const char* host, uint16_t port) { return connect(host, port, HOST_CONNECT_TIMEOUT_MS); }
+
+int WiFiClient::connect(IPAddress ip, uint16_t port, int32_t timeoutMs) {
+    return connectTo((uint32_t)ip, port, timeoutMs) ? 1 : 0;
+}
+
+int WiFiClient::connect(const char* host, uint16_t port, int32_t timeoutMs) {
+    if (!link_up()) return 0;
+    uint32_t address;
+    int targetPort;
+    if (route_lookup(host, port, address, targetPort)) {
+        // Routed: the target port as given (route_port() maps by address only)
+        stop();
+        int s = socket(AF_INET, SOCK_STREAM, 0);
+        if (s < 0) return 0;
+        struct sockaddr_in target = socket_address(address, (uint16_t)targetPort);
+        struct timeval timeout = { timeoutMs / 1000, (timeoutMs % 1000) * 1000 };
+        setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        if (::connect(s, (struct sockaddr*)&target, sizeof(target)) < 0) {
+            close(s);
+            return 0;
+        }
+        fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+        fd = s;
+        this->linkGeneration = ::linkGeneration.load();
+        return 1;
+    }
+    if (!resolve_host(host, address)) return 0;
+    return connectTo(address, port, timeoutMs) ? 1 : 0;
+}
+
+size_t WiFiClient::write(const uint8_t* buffer, size_t size) {
+    size_t sent = 0;
+    while (sent < size && linkAlive()) {
+        ssize_t n = send(fd, buffer + sent, size - sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += (size_t)n;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            struct pollfd waiter = { fd, POLLOUT, 0 };
+            if (poll(&waiter, 1, HOST_CONNECT_TIMEOUT_MS) <= 0) break;
+        } else {
+            break;
+        }
+    }
+    return sent;
+}
+
+int WiFiClient::available() {
+    if (!linkAlive()) return 0;
+    int pending = 0;
+    if (ioctl(fd, FIONREAD, &pending) < 0) return 0;
+    return pending;
+}
+
+int WiFiClient::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t size) {
+    if (!linkAlive()) return -1;
+    ssize_t n = recv(fd, buffer, size, MSG_DONTWAIT);
+    return n > 0 ? (int)n : -1;
+}
+
+int WiFiClient::peek() {
+    if (!linkAlive()) return -1;
+    uint8_t c;
+    return recv(fd, &c, 1, MSG_DONTWAIT | MSG_PEEK) == 1 ? c : -1;
+}
+
+// Open until the peer closed and everything it sent was read
+uint8_t WiFiClient::connected() {
+    if (!linkAlive()) return 0;
+    uint8_t c;
+    ssize_t n = recv(fd, &c, 1, MSG_DONTWAIT | MSG_PEEK);
+    if (n > 0) return 1;
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return 1;
+    return 0;
+}
+
+void WiFiClient::stop() {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+int WiFiClient::setNoDelay(bool noDelay) {
+    if (fd < 0) return -1;
+    int flag = noDelay ? 1 : 0;
+    return setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+}
+
+// ==================== WiFiUDP ====================
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port) {
+    remoteAddress = (uint32_t)ip;
+    remotePort = route_port(remoteAddress, port);
+    packet.clear();
+    packetOpen = true;
+    return 1;
+}
+
+int WiFiUDP::beginPacket(const char* host, uint16_t port) {
+    uint32_t address;
+    int targetPort;
+    if (route_lookup(host, port, address, targetPort)) {
+        remoteAddress = address;
+        remotePort = (uint16_t)targetPort;
+    } else if (resolve_host(host, address)) {
+        remoteAddress = address;
+        remotePort = route_port(address, port);
+    } else {
+        return 0;
+    }
+    packet.clear();
+    packetOpen = true;
+    return 1;
+}
+
+size_t WiFiUDP::write(const uint8_t* buffer, size_t size) {
+    if (!packetOpen) return 0;
+    packet.insert(packet.end(), buffer, buffer + size);
+    return size;
+}
+
+int WiFiUDP::endPacket() {
+    if (!packetOpen) return 0;
+    packetOpen = false;
+    if (!link_up()) return 0;
+    if (fd < 0) {
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0) return 0;
+    }
+    struct sockaddr_in target = socket_address(remoteAddress, remotePort);
+    ssize_t n = sendto(fd, packet.data(), packet.size(), 0, (struct sockaddr*)&target, sizeof(target));
+    return n == (ssize_t)packet.size() ? 1 : 0;
+}
+
+void WiFiUDP::stop() {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+// ==================== HTTPClient ====================
+
+bool HTTPClient::begin(const String& url) {
+    const char* text = url.c_str();
+    port = 80;
+    if (strncmp(text, "http://", 7) == 0) {
+        text += 7;
+    } else if (strncmp(text, "https://", 8) == 0) {
+        text += 8;
+        port = 443;
+    }
+    const char* slash = strchr(text, '/');
+    std::string authority = slash ? std::string(text, (size_t)(slash - text)) : std::string(text);
+    path = slash ? String(slash) : String("/");
+    size_t colon = authority.find(':');
+    if (colon != std::string::npos) {
+        port = (uint16_t)atoi(authority.c_str() + colon + 1);
+        authority.erase(colon);
+    }
+    host = String(authority);
+    valid = !authority.empty() && port != 0;
+    return valid;
+}
+
+void HTTPClient::end() {
+    client.stop();
+    valid = false;
+}
+
+int HTTPClient::GET() { return request("GET", nullptr, 0); }
+
+int HTTPClient::POST(const String& payload) {
+    return request("POST", (const uint8_t*)payload.c_str(), payload.length());
+}
+
+int HTTPClient::POST(const uint8_t* payload, size_t size) { return request("POST", payload, size); }
+
+int HTTPClient::request(const char* method, const uint8_t* payload, size_t size) {
+    body = String();
+    if (!valid) return HTTPC_ERROR_NOT_CONNECTED;
+    if (!client.connect(host.c_str(), port)) return HTTPC_ERROR_CONNECTION_REFUSED;
+
+    char header[512];
+    int length = snprintf(header, sizeof(header),
+                          "%s %s HTTP/1.1\r\nHost: %s\r\nUser-Agent: ESP32HTTPClient\r\n"
+                          "Connection: close\r\nContent-Length: %u\r\n\r\n",
+                          method, path.c_str(), host.c_str(), (unsigned int)size);
+    if (length <= 0 || length >= (int)sizeof(header) ||
+        client.write((const uint8_t*)header, (size_t)length) != (size_t)length) {
+        client.stop();
+        return HTTPC_ERROR_SEND_HEADER_FAILED;
+    }
+    if (size > 0 && client.write(payload, size) != size) {
+        client.stop();
+        return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+    }
+
+    // Whole response (Connection: close), bounded by the timeout
+    std::string response;
+    unsigned long start = millis();
+    while (millis() - start < timeoutMs) {
+        uint8_t chunk[512];
+        int n = client.available() > 0 ? client.read(chunk, sizeof(chunk)) : 0;
+        if (n > 0) {
+            response.append((const char*)chunk, (size_t)n);
+        } else if (!client.connected()) {
+            break;
+        } else {
+            delay(1);
+        }
+    }
+    client.stop();
+
+    if (response.empty()) return HTTPC_ERROR_READ_TIMEOUT;
+    if (response.compare(0, 5, "HTTP/") != 0 || response.size() < 12) return HTTPC_ERROR_NO_HTTP_SERVER;
+    int code = atoi(response.c_str() + 9);
+    size_t headerEnd = response.find("\r\n\r\n");
+    if (headerEnd != std::string::npos) body = String(response.substr(headerEnd + 4));
+    return code > 0 ? code : HTTPC_ERROR_NO_HTTP_SERVER;
+}
+
+String HTTPClient::errorToString(int error) {
+    switch (error) {
+        case HTTPC_ERROR_CONNECTION_REFUSED: return "connection refused";
+        case HTTPC_ERROR_SEND_HEADER_FAILED: return "send header failed";
+        case HTTPC_ERROR_SEND_PAYLOAD_FAILED: return "send payload failed";
+        case HTTPC_ERROR_NOT_CONNECTED: return "not connected";
+        case HTTPC_ERROR_CONNECTION_LOST: return "connection lost";
+        case HTTPC_ERROR_NO_STREAM: return "no stream";
+        case HTTPC_ERROR_NO_HTTP_SERVER: return "no HTTP server";
+        case HTTPC_ERROR_TOO_LESS_RAM: return "too less ram";
+        case HTTPC_ERROR_ENCODING: return "Transfer-Encoding not supported";
+        case HTTPC_ERROR_STREAM_WRITE: return "Stream write error";
+        case HTTPC_ERROR_READ_TIMEOUT: return "read Timeout";
+        default: return String();
+    }
+}
+
+// ==================== FIREBASE SIGN-IN ====================
+
+namespace {
+std::atomic<uint32_t> firebaseTokenMs(HOST_FIREBASE_TOKEN_MS);
+} // namespace
+
+void host_firebase_set_token_ms(uint32_t ms) { firebaseTokenMs = ms; }
+
+void Firebase_ESP_Client::begin(FirebaseConfig* cfg, FirebaseAuth* auth) {
+    (void)auth;
+    config = cfg;
+    beganAt = millis();
+    tokenReady = false;
+}
+
+bool Firebase_ESP_Client::ready() {
+    if (config == nullptr) return false;
+    if (!tokenReady && link_up() && millis() - beganAt >= firebaseTokenMs) {
+        tokenReady = true;
+        if (config->token_status_callback != nullptr) {
+            TokenInfo info;
+            info.status = token_status_ready;
+            config->token_status_callback(info);
+        }
+    }
+    return tokenReady;
+}
+
+const char* Firebase_ESP_Client::getToken() {
+    static std::string token;
+    if (token.empty()) {
+        token = "eyJhbGciOiJSUzI1NiIsImtpZCI6Imhvc3Qtc2hpbSJ9.";
+        while (token.size() < HOST_FIREBASE_TOKEN_SIZE) {
+            token += "aG9zdC1zaGltLWlkLXRva2Vu";
+        }
+        token.resize(HOST_FIREBASE_TOKEN_SIZE);
+    }
+    return tokenReady ? token.c_str() : "";
+}
@@ -0,0 +1,614 @@
+/*
+ * Host Shim - Clock, heap, serial, Arduino core and sensor stand-ins
+ *
+ * Network, WiFi and Firebase live in host_network.cpp, Preferences and
+ * LittleFS in host_storage.cpp (see host_shim.h for the whole picture).
+ */
+
+#include "host_shim.h"
+#include "Arduino.h"
+#include "Wire.h"
+
+#include <errno.h>
+#include <malloc.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+HardwareSerial Serial;
+EspClass ESP;
+TwoWire Wire;
+
+// ==================== CLOCK ====================
+// virtual = virtualBase + (real - realBase) * speed, rebased whenever the
+// speed changes so the clock never jumps backwards
+
+namespace {
+
+struct HostClock {
+    std::mutex lock;
+    std::chrono::steady_clock::time_point realBase;
+    uint64_t virtualBaseUs;
+    double speed;
+    uint64_t epochAtStartUs;   // Host wall clock when the virtual clock started
+
+    HostClock() : realBase(std::chrono::steady_clock::now()), virtualBaseUs(0), speed(1.0) {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        epochAtStartUs = (uint64_t)now.tv_sec * 1000000ULL + (uint64_t)(now.tv_nsec / 1000);
+    }
+
+    uint64_t nowLocked() const {
+        double realUs = (double)std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - realBase).count();
+        return virtualBaseUs + (uint64_t)(realUs * speed);
+    }
+};
+
+HostClock& host_clock() {
+    static HostClock clock;
+    return clock;
+}
+
+} // namespace
+
+uint64_t host_clock_us() {
+    HostClock& clock = host_clock();
+    std::lock_guard<std::mutex> guard(clock.lock);
+    return clock.nowLocked();
+}
+
+uint64_t host_clock_real_us(uint64_t virtualUs) {
+    HostClock& clock = host_clock();
+    std::lock_guard<std::mutex> guard(clock.lock);
+    return (uint64_t)(virtualUs / clock.speed);
+}
+
+void host_clock_sleep_ms(uint32_t ms) {
+    if (ms == 0) {
+        std::this_thread::yield();
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(host_clock_real_us((uint64_t)ms * 1000)));
+}
+
+void host_clock_set_speed(double speed) {
+    if (speed <= 0.0) return;
+    HostClock& clock = host_clock();
+    std::lock_guard<std::mutex> guard(clock.lock);
+    clock.virtualBaseUs = clock.nowLocked();
+    clock.realBase = std::chrono::steady_clock::now();
+    clock.speed = speed;
+}
+
+double host_clock_speed() {
+    HostClock& clock = host_clock();
+    std::lock_guard<std::mutex> guard(clock.lock);
+    return clock.speed;
+}
+
+void host_clock_advance_ms(uint32_t ms) {
+    HostClock& clock = host_clock();
+    std::lock_guard<std::mutex> guard(clock.lock);
+    clock.virtualBaseUs += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(uint32_t us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(host_clock_real_us(us)));
+}
+
+void yield() { std::this_thread::yield(); }
+
+// ==================== SNTP ====================
+// The device's system time counts from 0 at boot until SNTP sets it. Here
+// it is set HOST_SNTP_MS after configTime() once the fake link is up, to
+// the host's wall clock at start plus the virtual time since.
+
+namespace {
+std::atomic<bool> sntpRequested(false);
+std::atomic<uint64_t> sntpRequestedUs(0);
+std::atomic<bool> sntpSynced(false);
+} // namespace
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1, const char* server2,
+                const char* server3) {
+    (void)gmtOffsetSec;
+    (void)daylightOffsetSec;
+    (void)server1;
+    (void)server2;
+    (void)server3;
+    if (!sntpRequested.exchange(true)) {
+        sntpRequestedUs = host_clock_us();
+    }
+}
+
+extern "C" int gettimeofday(struct timeval* __restrict tv, void* __restrict tz) {
+    (void)tz;
+    uint64_t uptimeUs = host_clock_us();
+    if (!sntpSynced && sntpRequested && host_wifi_connected() &&
+        uptimeUs - sntpRequestedUs >= (uint64_t)HOST_SNTP_MS * 1000) {
+        sntpSynced = true;
+    }
+    uint64_t us = sntpSynced ? host_clock().epochAtStartUs + uptimeUs : uptimeUs;
+    tv->tv_sec = (time_t)(us / 1000000);
+    tv->tv_usec = (suseconds_t)(us % 1000000);
+    return 0;
+}
+
+// ==================== HEAP ====================
+// Every operator new/delete in the process is counted (usable size, as the
+// device's allocator reports free heap in whole blocks)
+
+namespace {
+std::atomic<uint64_t> heapAllocations(0);
+std::atomic<uint64_t> heapLive(0);
+std::atomic<uint64_t> heapPeak(0);
+
+void* heap_allocate(size_t size) {
+    void* block = malloc(size ? size : 1);
+    if (block == nullptr) return nullptr;
+    uint64_t usable = malloc_usable_size(block);
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    uint64_t live = heapLive.fetch_add(usable, std::memory_order_relaxed) + usable;
+    uint64_t peak = heapPeak.load(std::memory_order_relaxed);
+    while (live > peak && !heapPeak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    return block;
+}
+
+// GCC sees free() inlined into operator delete; the block did come from malloc
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void heap_release(void* block) {
+    if (block == nullptr) return;
+    heapLive.fetch_sub(malloc_usable_size(block), std::memory_order_relaxed);
+    free(block);
+}
+#pragma GCC diagnostic pop
+} // namespace
+
+void* operator new(size_t size) {
+    void* block = heap_allocate(size);
+    if (block == nullptr) throw std::bad_alloc();
+    return block;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return heap_allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return heap_allocate(size); }
+void operator delete(void* block) noexcept { heap_release(block); }
+void operator delete[](void* block) noexcept { heap_release(block); }
+void operator delete(void* block, size_t) noexcept { heap_release(block); }
+void operator delete[](void* block, size_t) noexcept { heap_release(block); }
+
+uint64_t host_heap_allocations() { return heapAllocations.load(std::memory_order_relaxed); }
+uint64_t host_heap_live_bytes() { return heapLive.load(std::memory_order_relaxed); }
+
+uint32_t EspClass::getFreeHeap() {
+    uint64_t live = host_heap_live_bytes();
+    return live >= HOST_HEAP_BYTES ? 0 : (uint32_t)(HOST_HEAP_BYTES - live);
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+    uint64_t peak = heapPeak.load(std::memory_order_relaxed);
+    return peak >= HOST_HEAP_BYTES ? 0 : (uint32_t)(HOST_HEAP_BYTES - peak);
+}
+
+void EspClass::restart() {
+    Serial.println("ESP.restart() - host process exits");
+    Serial.flush();
+    _exit(0);
+}
+
+// ==================== RANDOM ====================
+// xorshift64*; seeded from the clock unless randomSeed() is called
+
+namespace {
+std::mutex randomLock;
+uint64_t randomState = 0;
+} // namespace
+
+uint32_t esp_random() {
+    std::lock_guard<std::mutex> guard(randomLock);
+    if (randomState == 0) {
+        randomState = (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count() | 1;
+    }
+    randomState ^= randomState >> 12;
+    randomState ^= randomState << 25;
+    randomState ^= randomState >> 27;
+    return (uint32_t)((randomState * 2685821657736338717ULL) >> 32);
+}
+
+void randomSeed(unsigned long seed) {
+    std::lock_guard<std::mutex> guard(randomLock);
+    randomState = seed ? (uint64_t)seed * 0x9E3779B97F4A7C15ULL : 1;
+}
+
+long random(long howBig) {
+    if (howBig <= 0) return 0;
+    return (long)(esp_random() % (uint32_t)howBig);
+}
+
+long random(long howSmall, long howBig) {
+    if (howSmall >= howBig) return howSmall;
+    return random(howBig - howSmall) + howSmall;
+}
+
+// ==================== STRING ====================
+
+std::string String::fromUnsigned(unsigned long long value, unsigned char base) {
+    if (base < 2 || base > 36) base = 10;
+    char digits[72];
+    int length = 0;
+    do {
+        int digit = (int)(value % base);
+        digits[length++] = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+        value /= base;
+    } while (value > 0);
+    std::string text;
+    while (length > 0) text += digits[--length];
+    return text;
+}
+
+std::string String::fromSigned(long long value, unsigned char base) {
+    if (value < 0 && base == 10) {
+        return "-" + fromUnsigned(0ULL - (unsigned long long)value, base);
+    }
+    return fromUnsigned((unsigned long long)value, base);
+}
+
+std::string String::fromFloat(double value, unsigned int decimals) {
+    char text[64];
+    snprintf(text, sizeof(text), "%.*f", (int)decimals, value);
+    return text;
+}
+
+bool String::equalsIgnoreCase(const String& rhs) const { return strcasecmp(c_str(), rhs.c_str()) == 0; }
+
+int String::indexOf(char c, unsigned int from) const {
+    size_t at = text.find(c, from);
+    return at == std::string::npos ? -1 : (int)at;
+}
+
+int String::indexOf(const char* s, unsigned int from) const {
+    size_t at = text.find(s, from);
+    return at == std::string::npos ? -1 : (int)at;
+}
+
+bool String::endsWith(const char* suffix) const {
+    size_t n = strlen(suffix);
+    return n <= text.size() && text.compare(text.size() - n, n, suffix) == 0;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= text.size()) return String();
+    if (to > text.size()) to = (unsigned int)text.size();
+    return String(text.substr(from, to - from));
+}
+
+void String::trim() {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        text.clear();
+        return;
+    }
+    size_t end = text.find_last_not_of(" \t\r\n");
+    text = text.substr(begin, end - begin + 1);
+}
+
+void String::toLowerCase() {
+    for (char& c : text) c = (char)tolower((unsigned char)c);
+}
+
+void String::toUpperCase() {
+    for (char& c : text) c = (char)toupper((unsigned char)c);
+}
+
+// ==================== PRINT / STREAM ====================
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+        if (write(*buffer++) == 0) break;
+        n++;
+    }
+    return n;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char local[256];
+    va_list args;
+    va_start(args, format);
+    va_list copy;
+    va_copy(copy, args);
+    int length = vsnprintf(local, sizeof(local), format, copy);
+    va_end(copy);
+    if (length < 0) {
+        va_end(args);
+        return 0;
+    }
+    if ((size_t)length < sizeof(local)) {
+        va_end(args);
+        return write((const uint8_t*)local, (size_t)length);
+    }
+    std::vector<char> text((size_t)length + 1);
+    vsnprintf(text.data(), text.size(), format, args);
+    va_end(args);
+    return write((const uint8_t*)text.data(), (size_t)length);
+}
+
+size_t Print::printNumber(unsigned long long value, int base) {
+    if (base < 2) base = 10;
+    char digits[72];
+    int length = 0;
+    do {
+        int digit = (int)(value % (unsigned)base);
+        digits[length++] = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+        value /= (unsigned)base;
+    } while (value > 0);
+    char text[72];
+    for (int i = 0; i < length; i++) text[i] = digits[length - 1 - i];
+    return write((const uint8_t*)text, (size_t)length);
+}
+
+size_t Print::print(long long value, int base) {
+    if (value < 0 && base == 10) {
+        return write((uint8_t)'-') + printNumber(0ULL - (unsigned long long)value, base);
+    }
+    return printNumber((unsigned long long)value, base);
+}
+
+size_t Print::print(double value, int digits) {
+    char text[64];
+    int length = snprintf(text, sizeof(text), "%.*f", digits, value);
+    return length > 0 ? write((const uint8_t*)text, (size_t)length) : 0;
+}
+
+size_t Stream::readBytes(uint8_t* buffer, size_t length) {
+    size_t count = 0;
+    unsigned long start = millis();
+    while (count < length) {
+        int c = read();
+        if (c < 0) {
+            if (millis() - start >= timeoutMs) break;
+            delay(1);
+            continue;
+        }
+        buffer[count++] = (uint8_t)c;
+    }
+    return count;
+}
+
+// ==================== SERIAL ====================
+
+namespace {
+std::mutex serialOutLock;
+std::mutex serialInLock;
+std::deque<uint8_t> serialIn;
+std::atomic<bool> serialMuted(false);
+} // namespace
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    if (serialMuted) return size;
+    std::lock_guard<std::mutex> guard(serialOutLock);
+    size_t written = fwrite(buffer, 1, size, stdout);
+    fflush(stdout);
+    return written;
+}
+
+void HardwareSerial::flush() {
+    std::lock_guard<std::mutex> guard(serialOutLock);
+    fflush(stdout);
+}
+
+int HardwareSerial::available() {
+    std::lock_guard<std::mutex> guard(serialInLock);
+    return (int)serialIn.size();
+}
+
+int HardwareSerial::read() {
+    std::lock_guard<std::mutex> guard(serialInLock);
+    if (serialIn.empty()) return -1;
+    uint8_t c = serialIn.front();
+    serialIn.pop_front();
+    return c;
+}
+
+int HardwareSerial::peek() {
+    std::lock_guard<std::mutex> guard(serialInLock);
+    return serialIn.empty() ? -1 : serialIn.front();
+}
+
+void host_serial_mute(bool mute) { serialMuted = mute; }
+
+void host_serial_inject(const char* text) {
+    std::lock_guard<std::mutex> guard(serialInLock);
+    while (*text) serialIn.push_back((uint8_t)*text++);
+}
+
+void host_serial_start_stdin() {
+    std::thread([] {
+        uint8_t buffer[256];
+        for (;;) {
+            ssize_t n = ::read(STDIN_FILENO, buffer, sizeof(buffer));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return;
+            std::lock_guard<std::mutex> guard(serialInLock);
+            serialIn.insert(serialIn.end(), buffer, buffer + n);
+        }
+    }).detach();
+}
+
+// ==================== IP ADDRESS ====================
+
+bool IPAddress::fromString(const char* text) {
+    unsigned int parts[4];
+    char tail;
+    if (sscanf(text, "%u.%u.%u.%u%c", &parts[0], &parts[1], &parts[2], &parts[3], &tail) != 4) {
+        return false;
+    }
+    for (int i = 0; i < 4; i++) {
+        if (parts[i] > 255) return false;
+        bytes[i] = (uint8_t)parts[i];
+    }
+    return true;
+}
+
+String IPAddress::toString() const {
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+    return String(text);
+}
+
+// ==================== I2C AND ANALOG ====================
+
+namespace {
+struct HostI2CDevice {
+    const char* name;
+    HostI2CReadFn read;
+    void* context;
+};
+
+struct HostAnalogPin {
+    int pin;
+    HostAnalogFn read;
+    void* context;
+};
+
+std::mutex sensorLock;
+HostI2CDevice i2cDevices[128];
+std::vector<HostAnalogPin> analogPins;
+} // namespace
+
+bool host_i2c_attach(uint8_t address, const char* name, HostI2CReadFn read, void* context) {
+    if (address >= 128 || read == nullptr) return false;
+    std::lock_guard<std::mutex> guard(sensorLock);
+    i2cDevices[address] = { name, read, context };
+    return true;
+}
+
+void host_i2c_detach(uint8_t address) {
+    if (address >= 128) return;
+    std::lock_guard<std::mutex> guard(sensorLock);
+    i2cDevices[address] = { nullptr, nullptr, nullptr };
+}
+
+bool host_i2c_present(uint8_t address) {
+    if (address >= 128) return false;
+    std::lock_guard<std::mutex> guard(sensorLock);
+    return i2cDevices[address].read != nullptr;
+}
+
+bool host_i2c_measure(uint8_t address, uint8_t channel, float* value) {
+    if (address >= 128) return false;
+    HostI2CDevice device;
+    {
+        std::lock_guard<std::mutex> guard(sensorLock);
+        device = i2cDevices[address];
+    }
+    return device.read != nullptr && device.read(channel, value, device.context);
+}
+
+void host_analog_attach(int pin, HostAnalogFn read, void* context) {
+    std::lock_guard<std::mutex> guard(sensorLock);
+    for (HostAnalogPin& entry : analogPins) {
+        if (entry.pin == pin) {
+            entry.read = read;
+            entry.context = context;
+            return;
+        }
+    }
+    analogPins.push_back({ pin, read, context });
+}
+
+int host_analog_read(int pin) {
+    HostAnalogPin found = { pin, nullptr, nullptr };
+    {
+        std::lock_guard<std::mutex> guard(sensorLock);
+        for (const HostAnalogPin& entry : analogPins) {
+            if (entry.pin == pin) found = entry;
+        }
+    }
+    if (found.read == nullptr) return 0;
+    int value = found.read(pin, found.context);
+    return value < 0 ? 0 : (value > 4095 ? 4095 : value);
+}
+
+// Weather on the virtual clock: a 24 h temperature/light cycle, humidity
+// opposite to temperature, pressure on a 3-day swing, a little noise
+namespace {
+float weather_noise(float amplitude) { return amplitude * ((float)(esp_random() % 2001) / 1000.0f - 1.0f); }
+
+float weather_day_phase() {
+    double hours = (double)host_clock_us() / 3.6e9;
+    return (float)sin(2.0 * PI * (hours - 9.0) / 24.0);   // Peaks mid-afternoon
+}
+
+bool weather_sensor_read(uint8_t channel, float* value, void* context) {
+    (void)context;
+    float day = weather_day_phase();
+    double days = (double)host_clock_us() / 8.64e10;
+    switch (channel) {
+        case HOST_I2C_TEMPERATURE: *value = 24.5f + 4.0f * day + weather_noise(0.2f); return true;
+        case HOST_I2C_HUMIDITY: *value = 44.0f - 9.0f * day + weather_noise(0.5f); return true;
+        case HOST_I2C_PRESSURE:
+            *value = 98600.0f + 1400.0f * (float)sin(2.0 * PI * days / 3.0) + weather_noise(15.0f);
+            return true;
+        case HOST_I2C_LIGHT: {
+            float lux = 650.0f * day;
+            *value = (lux > 0.0f ? lux : 0.0f) + 5.0f + weather_noise(3.0f);
+            return true;
+        }
+        default: return false;
+    }
+}
+
+int weather_gas_read(int pin, void* context) {
+    (void)pin;
+    (void)context;
+    return 260 + (int)weather_noise(20.0f);
+}
+} // namespace
+
+void host_attach_weather_sensors() {
+    host_i2c_attach(0x38, "AHT10", weather_sensor_read, nullptr);
+    host_i2c_attach(0x76, "BME280", weather_sensor_read, nullptr);
+    host_i2c_attach(0x23, "BH1750", weather_sensor_read, nullptr);
+    host_analog_attach(6, weather_gas_read, nullptr);
+}
+
+// ==================== STATE DIRECTORY ====================
+
+namespace {
+std::mutex stateLock;
+std::string stateDir = HOST_STATE_DIR;
+} // namespace
+
+void host_state_set_dir(const char* dir) {
+    std::lock_guard<std::mutex> guard(stateLock);
+    stateDir = dir;
+}
+
+const char* host_state_dir() {
+    std::lock_guard<std::mutex> guard(stateLock);
+    return stateDir.c_str();
+}
+
+bool host_state_path(const char* area, const char* name, char* out, size_t size) {
+    std::lock_guard<std::mutex> guard(stateLock);
+    mkdir(stateDir.c_str(), 0755);
+    int length = snprintf(out, size, "%s/%s", stateDir.c_str(), area);
+    if (length < 0 || (size_t)length >= size) return false;
+    mkdir(out, 0755);
+    length = snprintf(out, size, "%s/%s/%s", stateDir.c_str(), area, name);
+    return length >= 0 && (size_t)length < size;
+}
@@ -0,0 +1,127 @@
+/*
+ * Host Shim - Arduino/ESP32 stand-ins for running the firmware on Linux
+ *
+ * The headers in this directory take the place of the Arduino core and of
+ * the libraries the sketch uses (Arduino.h, WiFi.h, HTTPClient.h, Wire.h,
+ * Preferences.h, LittleFS.h, Firebase_ESP_Client.h, the sensor drivers).
+ * esp32_code/ compiles unchanged against them with HOST_SHIM defined and
+ * runs as an ordinary process: host_main.cpp drives setup()/loop(), the
+ * CMake project one directory up builds it (weather_firmware).
+ *
+ * This header is the control side: what a run or a host tool configures
+ * before setup() and changes while the firmware runs. No Arduino
+ * dependencies.
+ *
+ * Features:
+ * - Virtual clock: millis()/micros()/delay(), task_port.h and the wall
+ *   clock run at host_clock_set_speed() times real time (micros() deltas
+ *   are scaled too: measure latency at speed 1); host_clock_advance_ms()
+ *   jumps ahead
+ * - Serial on stdout (deferred-log frames included: pipe the output
+ *   through host_tools/log_decoder); input from stdin and
+ *   host_serial_inject()
+ * - Fake WiFi: association after HOST_WIFI_ASSOC_MS (HOST_WIFI_FAST_MS
+ *   for a directed connect), scripted access point outages, driver events
+ *   delivered from an event thread like the ESP32 event task
+ * - Network: WiFiClient, WiFiUDP and HTTPClient on POSIX sockets, only
+ *   while the fake link is up. DNS answers routed names only
+ *   (host_net_route) unless host_net_allow_internet() is set, so a run
+ *   never uploads to the real ThingSpeak or Firebase by accident
+ * - SNTP: gettimeofday() reports uptime until configTime() was called and
+ *   the link is up, then host time advanced by the virtual clock
+ * - Firebase sign-in: a token of realistic size, ready after
+ *   HOST_FIREBASE_TOKEN_MS (writes go over REST like on the device)
+ * - Fake I2C devices (AHT10, BME280, BH1750) and analog pins, read by the
+ *   sensor driver stand-ins
+ * - NVS (Preferences) and LittleFS as files under a state directory, so
+ *   caches and logs survive "reboots" (consecutive runs)
+ * - Heap accounting (global operator new/delete): ESP.getFreeHeap() and
+ *   allocation counters for benchmarks
+ *
+ * Usage:
+ *   host_clock_set_speed(20.0);
+ *   host_net_route("api.thingspeak.com:80", "127.0.0.1:8080");
+ *   host_net_route("*.firebasedatabase.app:443", "127.0.0.1:8081");
+ *   host_wifi_schedule_outage(600000, 45000);   // At 10 min, for 45 s
+ *   host_attach_weather_sensors();
+ *   setup();
+ *   for (;;) loop();
+ */
+
+#ifndef HOST_SHIM_H
+#define HOST_SHIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define HOST_WIFI_ASSOC_MS 1500         // Scan + association + DHCP
+#define HOST_WIFI_FAST_MS 300           // Directed connect (channel + BSSID given)
+#define HOST_WIFI_RSSI -58
+#define HOST_SNTP_MS 400                // First NTP answer after configTime() with the link up
+#define HOST_FIREBASE_TOKEN_MS 1200     // Sign-in round trips
+#define HOST_FIREBASE_TOKEN_SIZE 920    // ID tokens are ~1 KB on the device
+#define HOST_CONNECT_TIMEOUT_MS 3000    // TCP connect (real time)
+#define HOST_HEAP_BYTES 327680          // ESP32-S3 internal RAM the heap starts with
+#define HOST_STATE_DIR "host_state"     // NVS and LittleFS files (relative to the working directory)
+
+// ==================== CLOCK ====================
+uint64_t host_clock_us();                       // Virtual microseconds since start
+void host_clock_sleep_ms(uint32_t ms);          // Sleep for ms of virtual time
+uint64_t host_clock_real_us(uint64_t virtualUs);  // Virtual span → real span
+void host_clock_set_speed(double speed);        // > 0; 1 = real time
+double host_clock_speed();
+void host_clock_advance_ms(uint32_t ms);        // Jump ahead (sleepers wake on their real deadline)
+
+// ==================== SERIAL ====================
+void host_serial_inject(const char* text);      // Appended to the receive buffer
+void host_serial_start_stdin();                 // Reader thread: stdin → receive buffer
+void host_serial_mute(bool mute);               // Drop Serial output (benchmarks print with printf)
+
+// ==================== NETWORK ====================
+// from "host[:port]" ("*.suffix" matches any subdomain, no port = any
+// port), to "ipv4[:port]" (no port = same port). Routed names resolve to
+// the target address; connections to (target address, original port) go
+// to the target port.
+bool host_net_route(const char* from, const char* to);
+void host_net_allow_internet(bool allow);       // Resolve unrouted names with the system resolver
+
+// ==================== WIFI ====================
+void host_wifi_set_ap(bool up);                 // Access point in range (drops the link when false)
+void host_wifi_schedule_outage(uint32_t atMs, uint32_t durationMs);
+void host_wifi_set_assoc_ms(uint32_t fullMs, uint32_t fastMs);
+bool host_wifi_connected();
+
+// ==================== FIREBASE ====================
+void host_firebase_set_token_ms(uint32_t ms);
+
+// ==================== SENSORS ====================
+#define HOST_I2C_TEMPERATURE 0   // °C
+#define HOST_I2C_HUMIDITY 1      // %
+#define HOST_I2C_PRESSURE 2      // Pa
+#define HOST_I2C_LIGHT 3         // lux
+
+typedef bool (*HostI2CReadFn)(uint8_t channel, float* value, void* context);
+typedef int (*HostAnalogFn)(int pin, void* context);
+
+bool host_i2c_attach(uint8_t address, const char* name, HostI2CReadFn read, void* context);
+void host_i2c_detach(uint8_t address);
+bool host_i2c_present(uint8_t address);
+bool host_i2c_measure(uint8_t address, uint8_t channel, float* value);
+void host_analog_attach(int pin, HostAnalogFn read, void* context);
+int host_analog_read(int pin);                  // 0..4095; unattached pins read 0
+
+// AHT10 @ 0x38, BME280 @ 0x76, BH1750 @ 0x23 and the MQ2 on GPIO 6,
+// following a slow day/night cycle on the virtual clock
+void host_attach_weather_sensors();
+
+// ==================== STATE ====================
+void host_state_set_dir(const char* dir);
+const char* host_state_dir();
+// "<state>/<area>/<name>", directories created; false if it does not fit
+bool host_state_path(const char* area, const char* name, char* out, size_t size);
+
+// ==================== HEAP ====================
+uint64_t host_heap_allocations();               // operator new calls since start
+uint64_t host_heap_live_bytes();
+
+#endif // HOST_SHIM_H
@@ -0,0 +1,202 @@
+/*
+ * Host Shim - Preferences (NVS) and LittleFS on the host file system
+ *
+ * Both live under the state directory (host_state_set_dir()), so a second
+ * run starts from what the first one stored, the way a reboot would.
+ */
+
+#include "host_shim.h"
+#include "Preferences.h"
+#include "FS.h"
+#include "LittleFS.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+LittleFSFS LittleFS;
+
+// ==================== PREFERENCES ====================
+
+bool Preferences::begin(const char* name, bool readOnlyMode, const char* partition) {
+    (void)partition;
+    size_t length = strlen(name);
+    if (length == 0 || length >= sizeof(space)) return false;   // NVS: 15 characters max
+    memcpy(space, name, length + 1);
+    readOnly = readOnlyMode;
+    open = true;
+    return true;
+}
+
+bool Preferences::keyPath(const char* key, char* out, size_t size) const {
+    if (!open || strlen(key) > 15) return false;
+    char name[40];
+    snprintf(name, sizeof(name), "%s.%s", space, key);
+    return host_state_path("nvs", name, out, size);
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length) {
+    char path[512];
+    if (readOnly || !keyPath(key, path, sizeof(path))) return 0;
+
+    // Write-then-rename, so a killed run never leaves half a value
+    char temporary[520];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", path);
+    FILE* file = fopen(temporary, "wb");
+    if (file == nullptr) return 0;
+    size_t written = fwrite(value, 1, length, file);
+    bool ok = fclose(file) == 0 && written == length && ::rename(temporary, path) == 0;
+    return ok ? length : 0;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    char path[512];
+    struct stat info;
+    if (!keyPath(key, path, sizeof(path)) || stat(path, &info) != 0) return 0;
+    return (size_t)info.st_size;
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t maxLength) {
+    size_t length = getBytesLength(key);
+    if (length == 0 || length > maxLength) return 0;
+    char path[512];
+    keyPath(key, path, sizeof(path));
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) return 0;
+    size_t read = fread(buffer, 1, length, file);
+    fclose(file);
+    return read == length ? length : 0;
+}
+
+uint32_t Preferences::getUInt(const char* key, uint32_t defaultValue) {
+    uint32_t value;
+    if (getBytesLength(key) != sizeof(value)) return defaultValue;
+    return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+}
+
+bool Preferences::remove(const char* key) {
+    char path[512];
+    if (readOnly || !keyPath(key, path, sizeof(path))) return false;
+    return unlink(path) == 0;
+}
+
+bool Preferences::clear() {
+    char directory[512];
+    if (readOnly || !open || !host_state_path("nvs", "", directory, sizeof(directory))) return false;
+    DIR* dir = opendir(directory);
+    if (dir == nullptr) return false;
+    size_t prefix = strlen(space);
+    while (struct dirent* entry = readdir(dir)) {
+        if (strncmp(entry->d_name, space, prefix) == 0 && entry->d_name[prefix] == '.') {
+            char path[768];
+            snprintf(path, sizeof(path), "%s%s", directory, entry->d_name);
+            unlink(path);
+        }
+    }
+    closedir(dir);
+    return true;
+}
+
+// ==================== FILE ====================
+
+int File::available() {
+    if (!stream) return 0;
+    long position = ftell(stream.get());
+    long total = (long)size();
+    return position >= 0 && total > position ? (int)(total - position) : 0;
+}
+
+int File::peek() {
+    if (!stream) return -1;
+    int c = fgetc(stream.get());
+    if (c != EOF) ungetc(c, stream.get());
+    return c;
+}
+
+size_t File::size() const {
+    if (!stream) return 0;
+    fflush(stream.get());
+    struct stat info;
+    return fstat(fileno(stream.get()), &info) == 0 ? (size_t)info.st_size : 0;
+}
+
+// ==================== FS ====================
+
+namespace fs {
+
+bool FS::hostPath(const char* path, char* out, size_t size) const {
+    if (path == nullptr || path[0] != '/' || strstr(path, "..") != nullptr) return false;
+    return host_state_path(area, path + 1, out, size);
+}
+
+File FS::open(const char* path, const char* mode, bool create) {
+    char target[512];
+    if (!hostPath(path, target, sizeof(target))) return File();
+    if (create && mode[0] != 'r') {
+        // Parent directories as LittleFS creates them with create=true
+        for (char* slash = strchr(target + strlen(target) - strlen(path) + 1, '/'); slash != nullptr;
+             slash = strchr(slash + 1, '/')) {
+            *slash = '\0';
+            ::mkdir(target, 0755);
+            *slash = '/';
+        }
+    }
+    char stdioMode[4];
+    snprintf(stdioMode, sizeof(stdioMode), "%sb", mode);
+    FILE* file = fopen(target, stdioMode);
+    return file ? File(file) : File();
+}
+
+bool FS::exists(const char* path) {
+    char target[512];
+    struct stat info;
+    return hostPath(path, target, sizeof(target)) && stat(target, &info) == 0;
+}
+
+bool FS::remove(const char* path) {
+    char target[512];
+    return hostPath(path, target, sizeof(target)) && unlink(target) == 0;
+}
+
+bool FS::rename(const char* from, const char* to) {
+    char source[512];
+    char target[512];
+    return hostPath(from, source, sizeof(source)) && hostPath(to, target, sizeof(target)) &&
+           ::rename(source, target) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+    char target[512];
+    return hostPath(path, target, sizeof(target)) && (::mkdir(target, 0755) == 0 || errno == EEXIST);
+}
+
+} // namespace fs
+
+// ==================== LITTLEFS ====================
+
+bool LittleFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel) {
+    (void)formatOnFail;
+    (void)basePath;
+    (void)maxOpenFiles;
+    (void)partitionLabel;
+    char root[512];
+    struct stat info;
+    return host_state_path("littlefs", "", root, sizeof(root)) && stat(root, &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+// Flat removal is enough: the firmware only keeps files in the root
+bool LittleFSFS::format() {
+    char root[512];
+    if (!host_state_path("littlefs", "", root, sizeof(root))) return false;
+    DIR* dir = opendir(root);
+    if (dir == nullptr) return false;
+    while (struct dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] == '.') continue;
+        char path[768];
+        snprintf(path, sizeof(path), "%s%s", root, entry->d_name);
+        unlink(path);
+    }
+    closedir(dir);
+    return true;
+}
@@ -0,0 +1,32 @@
+#!/bin/sh
+# Run the native firmware against the ThingSpeak and Firebase stand-ins
+# on loopback, then print its upload statistics (ctest: firmware_standins)
+#
+# Usage:
+#   sh run_with_standins.sh WEATHER_FIRMWARE MQTT_BROKER_STANDIN RTDB_STANDIN STATE_DIR [SECONDS]
+#
+# Ports 18080/18081/18830 keep clear of stand-ins already running on the
+# default ports.
+
+set -u
+
+FIRMWARE=$1
+BROKER=$2
+RTDB=$3
+STATE=$4
+SECONDS_RUN=${5:-100}
+
+rm -rf "$STATE"
+
+"$BROKER" --mqtt-port 18830 --http-port 18080 >/dev/null 2>&1 &
+BROKER_PID=$!
+"$RTDB" --port 18081 >/dev/null 2>&1 &
+RTDB_PID=$!
+trap 'kill $BROKER_PID $RTDB_PID 2>/dev/null' EXIT INT TERM
+sleep 0.5
+
+# "x" stops the simulator so the commands after it run
+"$FIRMWARE" --no-stdin --seconds "$SECONDS_RUN" --speed 10 --state "$STATE" \
+    --route api.thingspeak.com:80=127.0.0.1:18080 \
+    --route '*.firebasedatabase.app:443=127.0.0.1:18081' \
+    --at "$((SECONDS_RUN - 2)):x" --at "$((SECONDS_RUN - 1)):telemetry" --at "$((SECONDS_RUN - 1)).5:latency"
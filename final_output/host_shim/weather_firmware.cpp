@@ -0,0 +1,23 @@
+/*
+ * Weather Firmware (native) - esp32_code/weather_prediction_system.ino as
+ * a C++ translation unit
+ *
+ * The Arduino builder adds prototypes for a sketch's functions before
+ * compiling it; this file does the same for the ones the sketch uses
+ * before their definition, then includes the sketch unchanged.
+ */
+
+#include <Arduino.h>
+
+class TaskScheduler;
+
+void printBanner();
+void printBootProfile();
+void printTaskStatistics(const char* title, const TaskScheduler& scheduler);
+void printPipelineStatistics();
+void printLogStatistics();
+void printHelp();
+void processCommand(const char* line);
+void cmdTelemetry(const char* args);
+
+#include "weather_prediction_system.ino"
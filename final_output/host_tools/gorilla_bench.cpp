@@ -0,0 +1,280 @@
+/*
+ * Gorilla Block Benchmark - Compression ratio and speed of gorilla_block.h
+ *
+ * Encodes a sensor trace into Gorilla blocks (the same header the ESP32
+ * uses), decodes every block back and checks the round trip is bit-exact.
+ * Compared against:
+ * - raw:     8-byte timestamp + 5 × float + class byte (29 B / sample)
+ * - binary:  telemetry_codec.h frames (fixed-point, lossy to 0.01)
+ * - csv:     the LocalFileSink log line
+ *
+ * Traces:
+ * - default: synthetic day at 1 Hz (raw sensor cadence, batched uploads)
+ *   and at 15 s (one record per prediction)
+ * - --replay FILE: the LocalFileSink CSV (/telemetry.csv) pulled from a device
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -I../esp32_code gorilla_bench.cpp -o gorilla_bench
+ *
+ * Usage:
+ *   ./gorilla_bench [--hours 24] [--replay telemetry.csv]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "telemetry_record.h"
+#include "telemetry_codec.h"
+#include "gorilla_block.h"
+
+static const double PI = 3.14159265358979323846;
+static const size_t BLOCK_SIZES[] = { 16, 60, 240, 1024 };
+
+// Labelling rules used to build the training set (see sensor_simulate.h)
+static uint8_t label(const TelemetryRecord& r) {
+    if (r.lux > 130.0f) return 4;                                // Sunny
+    if (r.pressure < 97200.0f) return 3;                         // Stormy
+    if (r.humidity > 48.0f && r.lux < 120.0f) return 1;          // Foggy
+    if (r.pressure < 98000.0f && r.humidity > 42.0f) return 2;   // Rainy
+    return 0;                                                    // Cloudy
+}
+
+// ==================== TRACES ====================
+// Same weather model as rbe_trace_sim, at any cadence. Sensor readings are
+// quantised to the resolution the drivers report (BMP180 1 Pa, BH1750
+// ~1 lux, DHT 0.1) so repeated values occur as they do on the device.
+static void synthetic_trace(std::vector<TelemetryRecord>& trace, double hours, uint32_t stepMs) {
+    std::mt19937 rng(42);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+    size_t count = (size_t)(hours * 3600.0 * 1000.0 / stepMs);
+    float perStep = stepMs / 15000.0f;   // Drift rates are per 15 s record
+    trace.resize(count);
+
+    float front = 0.0f;
+    float frontTarget = 0.0f;
+    float cloud = 0.3f;
+    float gas = 300.0f;
+
+    for (size_t i = 0; i < count; i++) {
+        TelemetryRecord& r = trace[i];
+        memset(&r, 0, sizeof(r));
+        r.timestampMs = (uint64_t)i * stepMs + (uniform(rng) < 0.05f ? 1 : 0);   // Loop jitter
+        double hourOfDay = fmod(r.timestampMs / 3600000.0 + 6.0, 24.0);
+        double day = sin((hourOfDay - 6.0) / 12.0 * PI);
+
+        if (uniform(rng) < perStep / 960.0f) frontTarget = -1600.0f * uniform(rng) + 300.0f;
+        front += (frontTarget - front) * 0.004f * perStep;
+        cloud += noise(rng) * 0.02f * sqrtf(perStep) + (frontTarget < -500.0f ? 0.002f : -0.001f) * perStep;
+        cloud = cloud < 0.0f ? 0.0f : (cloud > 1.0f ? 1.0f : cloud);
+        gas += noise(rng) * 2.0f * sqrtf(perStep) + (350.0f - gas) * 0.002f * perStep;
+
+        float temperature = 23.5f + 3.5f * (float)sin((hourOfDay - 9.0) / 24.0 * 2.0 * PI) + noise(rng) * 0.05f;
+        float humidity = 44.0f - 6.0f * (float)sin((hourOfDay - 9.0) / 24.0 * 2.0 * PI) +
+                         cloud * 6.0f + noise(rng) * 0.2f;
+        float daylight = day > 0.0 ? (float)day : 0.0f;
+        float lux = daylight * 520.0f * (1.0f - 0.85f * cloud) + noise(rng) * 3.0f;
+
+        r.temperature = roundf(temperature * 10.0f) / 10.0f;
+        r.humidity = roundf(humidity * 10.0f) / 10.0f;
+        r.pressure = roundf(98700.0f + front + noise(rng) * 5.0f);
+        r.lux = lux < 0.0f ? 0.0f : roundf(lux);
+        r.gas = roundf((gas + noise(rng) * 10.0f) * 10.0f) / 10.0f;
+        r.predictedClass = label(r);
+    }
+}
+
+// timestamp_ms,temperature,humidity,pressure,lux,gas_ppm,class_id,votes,inference_us,rssi
+static bool replay_trace(const char* path, std::vector<TelemetryRecord>& trace) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return false;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        TelemetryRecord r;
+        memset(&r, 0, sizeof(r));
+        unsigned long long ts;
+        unsigned cls;
+        if (sscanf(line, "%llu,%f,%f,%f,%f,%f,%u", &ts, &r.temperature, &r.humidity,
+                   &r.pressure, &r.lux, &r.gas, &cls) != 7) {
+            continue;   // Header or malformed line
+        }
+        r.timestampMs = ts;
+        r.predictedClass = (uint8_t)cls;
+        trace.push_back(r);
+    }
+    fclose(file);
+    return !trace.empty();
+}
+
+// ==================== BENCHMARK ====================
+static void channels(const TelemetryRecord& r, float* out) {
+    out[0] = r.temperature;
+    out[1] = r.humidity;
+    out[2] = r.pressure;
+    out[3] = r.lux;
+    out[4] = r.gas;
+}
+
+static double elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Encode the whole trace in blocks of `perBlock` samples; returns total bytes
+static size_t encode_trace(const std::vector<TelemetryRecord>& trace, size_t perBlock,
+                           uint8_t* buffer, size_t capacity, std::vector<std::vector<uint8_t>>* blocks) {
+    size_t total = 0;
+    GorillaBlockEncoder encoder(buffer, capacity);
+    float values[GORILLA_CHANNELS];
+    for (size_t i = 0; i < trace.size(); i++) {
+        channels(trace[i], values);
+        if (encoder.sampleCount() == perBlock ||
+            !encoder.append(trace[i].timestampMs, values, trace[i].predictedClass)) {
+            size_t length = encoder.finish();
+            total += length;
+            if (blocks) blocks->emplace_back(buffer, buffer + length);
+            encoder.begin();
+            encoder.append(trace[i].timestampMs, values, trace[i].predictedClass);
+        }
+    }
+    if (encoder.sampleCount() > 0) {
+        size_t length = encoder.finish();
+        total += length;
+        if (blocks) blocks->emplace_back(buffer, buffer + length);
+    }
+    return total;
+}
+
+static bool verify(const std::vector<TelemetryRecord>& trace, const std::vector<std::vector<uint8_t>>& blocks) {
+    size_t index = 0;
+    for (const std::vector<uint8_t>& block : blocks) {
+        GorillaBlockDecoder decoder(block.data(), block.size());
+        uint64_t ts;
+        float values[GORILLA_CHANNELS];
+        float expected[GORILLA_CHANNELS];
+        uint8_t cls;
+        while (decoder.next(ts, values, cls)) {
+            if (index >= trace.size()) return false;
+            channels(trace[index], expected);
+            if (ts != trace[index].timestampMs || cls != trace[index].predictedClass ||
+                memcmp(values, expected, sizeof(values)) != 0) {
+                fprintf(stderr, "❌ Mismatch at sample %zu\n", index);
+                return false;
+            }
+            index++;
+        }
+        if (!decoder.isValid()) return false;
+    }
+    return index == trace.size();
+}
+
+static void run_trace(const char* title, const std::vector<TelemetryRecord>& trace) {
+    size_t n = trace.size();
+    const size_t rawBytes = n * (8 + 4 * GORILLA_CHANNELS + 1);
+
+    char text[TELEMETRY_MAX_PAYLOAD];
+    size_t csvBytes = 0;
+    for (const TelemetryRecord& r : trace) {
+        csvBytes += (size_t)telemetry_encode_csv(r, text, sizeof(text));
+    }
+
+    printf("\n%s: %zu samples\n", title, n);
+    printf("   Encoding          samples/block   bytes/sample   vs raw   vs csv   encode ns/sample   decode ns/sample   round trip\n");
+    printf("   ─────────────────────────────────────────────────────────────────────────────────────────────────────────────\n");
+    printf("   raw struct                    -         %6.2f    1.00x    %5.2fx                  -                  -            -\n",
+           (double)rawBytes / n, (double)csvBytes / rawBytes);
+    printf("   csv                           -         %6.2f    %5.2fx   1.00x                  -                  -            -\n",
+           (double)csvBytes / n, (double)rawBytes / csvBytes);
+
+    // telemetry_codec frames (lossy fixed point), 64 records per frame, no votes
+    static uint8_t frame[TELEMETRY_FRAME_HEADER_SIZE + 64 * TELEMETRY_FRAME_MAX_RECORD_SIZE + TELEMETRY_FRAME_CRC_SIZE];
+    const uint8_t mac[6] = { 0x24, 0x0A, 0xC4, 0x12, 0x34, 0x56 };
+    TelemetryFrameEncoder frameEncoder(frame, sizeof(frame));
+    size_t binaryBytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; i += 64) {
+        frameEncoder.begin(mac, (uint16_t)i, trace[i].timestampMs, 0);
+        for (size_t j = i; j < n && j < i + 64; j++) frameEncoder.add(trace[j]);
+        binaryBytes += frameEncoder.finish();
+    }
+    double binaryNs = elapsed_ns(start) / n;
+    printf("   telemetry_codec              64         %6.2f    %5.2fx   %5.2fx   %16.1f                  -       lossy\n",
+           (double)binaryBytes / n, (double)rawBytes / binaryBytes, (double)csvBytes / binaryBytes, binaryNs);
+
+    for (size_t perBlock : BLOCK_SIZES) {
+        std::vector<uint8_t> buffer(GORILLA_HEADER_SIZE + (perBlock * GORILLA_MAX_SAMPLE_BITS + 7) / 8 + 64);
+        std::vector<std::vector<uint8_t>> blocks;
+        size_t bytes = encode_trace(trace, perBlock, buffer.data(), buffer.size(), &blocks);
+
+        // Timing: repeat until ~100 ms of work
+        int rounds = 0;
+        start = std::chrono::steady_clock::now();
+        double ns = 0;
+        do {
+            encode_trace(trace, perBlock, buffer.data(), buffer.size(), nullptr);
+            rounds++;
+            ns = elapsed_ns(start);
+        } while (ns < 1e8);
+        double encodeNs = ns / ((double)rounds * n);
+
+        rounds = 0;
+        volatile float sink = 0;
+        start = std::chrono::steady_clock::now();
+        do {
+            for (const std::vector<uint8_t>& block : blocks) {
+                GorillaBlockDecoder decoder(block.data(), block.size());
+                uint64_t ts;
+                float values[GORILLA_CHANNELS];
+                uint8_t cls;
+                while (decoder.next(ts, values, cls)) sink = sink + values[0];
+            }
+            rounds++;
+            ns = elapsed_ns(start);
+        } while (ns < 1e8);
+        double decodeNs = ns / ((double)rounds * n);
+
+        printf("   gorilla                   %5zu         %6.2f    %5.2fx   %5.2fx   %16.1f   %16.1f       %s\n",
+               perBlock, (double)bytes / n, (double)rawBytes / bytes, (double)csvBytes / bytes,
+               encodeNs, decodeNs, verify(trace, blocks) ? "✅ exact" : "❌ FAIL");
+    }
+}
+
+int main(int argc, char** argv) {
+    double hours = 24.0;
+    const char* replay = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--hours") == 0 && i + 1 < argc) hours = atof(argv[++i]);
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) replay = argv[++i];
+        else {
+            fprintf(stderr, "Usage: gorilla_bench [--hours H] [--replay FILE.csv]\n");
+            return 2;
+        }
+    }
+
+    std::vector<TelemetryRecord> trace;
+    if (replay) {
+        if (!replay_trace(replay, trace)) return 1;
+        run_trace(replay, trace);
+        return 0;
+    }
+
+    char title[64];
+    synthetic_trace(trace, hours, 1000);
+    snprintf(title, sizeof(title), "Synthetic %.1f h @ 1 s", hours);
+    run_trace(title, trace);
+
+    trace.clear();
+    synthetic_trace(trace, hours, 15000);
+    snprintf(title, sizeof(title), "Synthetic %.1f h @ 15 s", hours);
+    run_trace(title, trace);
+    return 0;
+}
@@ -0,0 +1,491 @@
+/*
+ * HIL Driver - Stream a dataset through the device's binary batch mode
+ *
+ * Host side of hil_protocol.h. Switches the test sketch
+ * (weather_prediction_test_250trees.ino) into binary mode with the
+ * "binary" command, streams feature vectors in length-prefixed, CRC'd
+ * batches with several batches in flight, and checks every returned class
+ * against the same model and scaling run on the host. With a labelled
+ * dataset it also reports accuracy against the labels.
+ *
+ * Without --port it runs against an emulator: a pseudo-terminal whose
+ * other end is served by a thread running the same HilSession and model
+ * the sketch runs (cycles there are host nanoseconds, not ESP32 cycles).
+ * --corrupt N flips a bit in every Nth frame sent, to exercise the CRC
+ * error and resend path.
+ *
+ * Dataset: CSV with a header row, columns temperature,humidity,pressure,
+ * lux and optionally a label (class id 0-4 or name, e.g. "Sunny"). Without
+ * --dataset, --samples random vectors over the training ranges are used.
+ *
+ * Reports samples/s, link bytes/s, device cycles per prediction
+ * (p50/p99/max, and µs at --cpu-mhz), mismatches vs the host model and
+ * resends. Exits non-zero on any mismatch or if the stream did not
+ * complete.
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread -I../esp32_code hil_driver.cpp -o hil_driver
+ *
+ * Usage:
+ *   ./hil_driver [--samples 104000] [--batch 64] [--window 4] [--corrupt 0]
+ *   ./hil_driver --port /dev/ttyACM0 [--baud 921600] [--cpu-mhz 240] [--dataset test.csv]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "weather_model_250.h"
+
+// weather_scaling.h prints diagnostics through Serial; route them to stdout
+struct HostSerial {
+    template <typename T> void print(const T& value, int = 0) { fputs(to_text(value).c_str(), stdout); }
+    template <typename T> void println(const T& value, int = 0) { print(value), fputc('\n', stdout); }
+    void println() { fputc('\n', stdout); }
+    static std::string to_text(const char* s) { return s; }
+    template <typename T> static std::string to_text(const T& v) { return std::to_string(v); }
+};
+static HostSerial Serial;
+
+#include "weather_scaling.h"
+#include "hil_protocol.h"
+#include "latency_histogram.h"
+#include "serial_commands.h"
+
+struct Sample {
+    float features[HIL_FEATURES];
+    int label;              // -1 = none
+    int expected;           // Host model
+};
+
+static const char* const CLASS_NAMES[] = { "Cloudy", "Foggy", "Rainy", "Stormy", "Sunny" };
+
+static int host_predict(Eloquent::ML::Port::RandomForest& model, const float* raw) {
+    float x[HIL_FEATURES] = { scale_temperature(raw[0]), scale_humidity(raw[1]), scale_pressure(raw[2]),
+                              scale_lux(raw[3]) };
+    return model.predict(x);
+}
+
+// ==================== DATASET ====================
+static int parse_label(const char* text) {
+    while (*text == ' ' || *text == '"') text++;
+    if (*text >= '0' && *text <= '9') return atoi(text);
+    for (int i = 0; i < 5; i++) {
+        if (strncasecmp(text, CLASS_NAMES[i], strlen(CLASS_NAMES[i])) == 0) return i;
+    }
+    return -1;
+}
+
+static bool load_dataset(const char* path, std::vector<Sample>& samples) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return false;
+    }
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        Sample s;
+        const char* p = line;
+        bool ok = true;
+        for (int k = 0; k < HIL_FEATURES && ok; k++) {
+            ok = serial_parse_float(&p, &s.features[k]);
+            while (ok && (*p == ' ' || *p == ',')) p++;
+        }
+        if (!ok) continue;   // Header or malformed line
+        s.label = (*p && *p != '\n' && *p != '\r') ? parse_label(p) : -1;
+        samples.push_back(s);
+    }
+    fclose(file);
+    return !samples.empty();
+}
+
+static void synthetic_dataset(size_t count, std::vector<Sample>& samples) {
+    std::mt19937 rng(23);
+    std::uniform_real_distribution<float> temp(TEMP_MIN, TEMP_MAX), hum(HUMID_MIN, HUMID_MAX),
+        press(PRESSURE_MIN, PRESSURE_MAX), lux(LUX_MIN, LUX_MAX);
+    samples.resize(count);
+    for (Sample& s : samples) {
+        s.features[0] = temp(rng);
+        s.features[1] = hum(rng);
+        s.features[2] = press(rng);
+        s.features[3] = lux(rng);
+        s.label = -1;
+    }
+}
+
+// ==================== PORT ====================
+static bool write_all(int fd, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = write(fd, data, length);
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                struct pollfd pfd = { fd, POLLOUT, 0 };
+                poll(&pfd, 1, 100);
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+static void make_raw(int fd, speed_t speed) {
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) return;
+    cfmakeraw(&tio);
+    if (speed) {
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+    }
+    tcsetattr(fd, TCSANOW, &tio);
+}
+
+static speed_t baud_constant(long baud) {
+    switch (baud) {
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+        default: return B115200;
+    }
+}
+
+// ==================== EMULATOR ====================
+// The device side, as the sketch runs it: text console until "binary",
+// then HilSession until EXIT
+static Eloquent::ML::Port::RandomForest emulatorModel;
+static int emulatorFd = -1;
+
+static int emulator_predict(const float* features, bool scaled, void*) {
+    if (scaled) {
+        float x[HIL_FEATURES];
+        memcpy(x, features, sizeof(x));
+        return emulatorModel.predict(x);
+    }
+    return host_predict(emulatorModel, features);
+}
+
+static uint32_t emulator_cycles() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void emulator_write(const uint8_t* data, size_t length, void*) { write_all(emulatorFd, data, length); }
+
+static void emulator_main(const char* slavePath) {
+    emulatorFd = open(slavePath, O_RDWR | O_NOCTTY);
+    if (emulatorFd < 0) {
+        perror(slavePath);
+        return;
+    }
+    make_raw(emulatorFd, 0);
+    SerialLineReader console;
+    HilSession session(emulator_predict, emulator_cycles, emulator_write, nullptr);
+    uint8_t chunk[1024];
+    for (;;) {
+        ssize_t n = read(emulatorFd, chunk, sizeof(chunk));
+        if (n <= 0) break;
+        size_t i = 0;
+        while (i < (size_t)n) {
+            if (session.isActive()) {
+                session.feed(chunk + i, (size_t)n - i);
+                break;
+            }
+            if (console.feed((char)chunk[i++])) {
+                if (strcmp(console.line(), "binary") == 0) {
+                    const char ready[] = HIL_READY_LINE "\r\n";
+                    write_all(emulatorFd, (const uint8_t*)ready, sizeof(ready) - 1);
+                    session.begin();
+                }
+                console.clear();
+            }
+        }
+    }
+    close(emulatorFd);
+}
+
+// ==================== DRIVER ====================
+struct Outstanding {
+    size_t first;           // First sample index
+    uint16_t count;
+    uint16_t sequence;
+    std::chrono::steady_clock::time_point sentAt;
+    bool active;
+};
+
+class Driver {
+private:
+    int fd;
+    std::vector<Sample>& samples;
+    uint16_t batchSize;
+    uint8_t window;
+    uint32_t corruptEvery;
+    HilFrameParser parser;
+    std::vector<Outstanding> slots;
+    std::vector<int> results;
+    uint16_t nextSequence;
+    uint32_t framesSent;
+
+public:
+    LatencyHistogram cycles;
+    uint64_t bytesOut, bytesIn;
+    uint32_t resends, errors;
+
+    Driver(int port, std::vector<Sample>& data, uint16_t batch, uint8_t inFlight, uint32_t corrupt)
+        : fd(port), samples(data), batchSize(batch), window(inFlight), corruptEvery(corrupt),
+          slots(inFlight), results(data.size(), -1), nextSequence(1), framesSent(0), bytesOut(0), bytesIn(0),
+          resends(0), errors(0) {
+        for (Outstanding& o : slots) o.active = false;
+    }
+
+    const std::vector<int>& getResults() const { return results; }
+
+    bool enterBinary() {
+        const char command[] = "\nbinary\n";
+        write_all(fd, (const uint8_t*)command, sizeof(command) - 1);
+        char line[128];
+        size_t used = 0;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (std::chrono::steady_clock::now() < deadline) {
+            struct pollfd pfd = { fd, POLLIN, 0 };
+            if (poll(&pfd, 1, 100) <= 0) continue;
+            char c;
+            if (read(fd, &c, 1) != 1) continue;
+            if (c == '\n' || c == '\r') {
+                line[used] = '\0';
+                if (strcmp(line, HIL_READY_LINE) == 0) return true;
+                used = 0;
+            } else if (used < sizeof(line) - 1) {
+                line[used++] = c;
+            }
+        }
+        return false;
+    }
+
+    bool stream() {
+        size_t next = 0;
+        size_t done = 0;
+        while (done < samples.size()) {
+            for (Outstanding& o : slots) {
+                if (!o.active && next < samples.size()) {
+                    o.first = next;
+                    o.count = (uint16_t)std::min<size_t>(batchSize, samples.size() - next);
+                    next += o.count;
+                    send(o);
+                }
+            }
+            int handled = receive(200);
+            if (handled < 0) return false;
+            done += (size_t)handled;
+            // Answer lost (or the frame was dropped): send it again
+            auto now = std::chrono::steady_clock::now();
+            for (Outstanding& o : slots) {
+                if (o.active && now - o.sentAt > std::chrono::seconds(2)) {
+                    resends++;
+                    send(o);
+                }
+            }
+        }
+        return true;
+    }
+
+    bool exitBinary() {
+        uint8_t frame[HIL_HEADER_SIZE + HIL_CRC_SIZE];
+        size_t size = hil_write_frame(frame, HIL_FRAME_EXIT, 0, 0, nullptr, 0);
+        write_all(fd, frame, size);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (std::chrono::steady_clock::now() < deadline) {
+            uint8_t byte;
+            struct pollfd pfd = { fd, POLLIN, 0 };
+            if (poll(&pfd, 1, 100) <= 0 || read(fd, &byte, 1) != 1) continue;
+            if (parser.feed(byte) == HIL_PARSE_FRAME && parser.frame().type == HIL_FRAME_BYE) return true;
+        }
+        return false;
+    }
+
+private:
+    void send(Outstanding& o) {
+        static uint8_t frame[HIL_MAX_FRAME];
+        uint8_t* payload = frame + HIL_HEADER_SIZE;
+        hil_put_u16(payload, o.count);
+        for (uint16_t i = 0; i < o.count; i++) {
+            memcpy(payload + 2 + i * HIL_FEATURES * 4, samples[o.first + i].features, HIL_FEATURES * 4);
+        }
+        o.sequence = nextSequence++;
+        size_t size = hil_write_frame(frame, HIL_FRAME_BATCH, 0, o.sequence, payload,
+                                      (uint16_t)(2 + o.count * HIL_FEATURES * 4));
+        framesSent++;
+        if (corruptEvery > 0 && framesSent % corruptEvery == 0) {
+            frame[HIL_HEADER_SIZE + 5] ^= 0x10;   // Inside the first feature
+        }
+        write_all(fd, frame, size);
+        bytesOut += size;
+        o.sentAt = std::chrono::steady_clock::now();
+        o.active = true;
+    }
+
+    Outstanding* find(uint16_t sequence) {
+        for (Outstanding& o : slots) {
+            if (o.active && o.sequence == sequence) return &o;
+        }
+        return nullptr;
+    }
+
+    // Samples completed, or -1 on a port error
+    int receive(int timeoutMs) {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        int ready = poll(&pfd, 1, timeoutMs);
+        if (ready < 0) return errno == EINTR ? 0 : -1;
+        if (ready == 0) return 0;
+        uint8_t chunk[4096];
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n <= 0) return -1;
+        bytesIn += (uint64_t)n;
+        int handled = 0;
+        for (ssize_t i = 0; i < n; i++) {
+            HilParseResult result = parser.feed(chunk[i]);
+            if (result != HIL_PARSE_FRAME) continue;
+            const HilFrame& frame = parser.frame();
+            Outstanding* o = find(frame.sequence);
+            if (o == nullptr) continue;   // Late answer to a resent batch
+            if (frame.type == HIL_FRAME_ERROR) {
+                errors++;
+                resends++;
+                send(*o);
+            } else if (frame.type == HIL_FRAME_RESULT && hil_get_u16(frame.payload) == o->count) {
+                const uint8_t* classes = frame.payload + 2;
+                const uint8_t* spent = classes + o->count;
+                for (uint16_t k = 0; k < o->count; k++) {
+                    results[o->first + k] = classes[k];
+                    cycles.record(hil_get_u32(spent + k * 4));
+                }
+                handled += o->count;
+                o->active = false;
+            }
+        }
+        return handled;
+    }
+};
+
+int main(int argc, char** argv) {
+    const char* port = nullptr;
+    const char* dataset = nullptr;
+    long baud = 921600;
+    size_t sampleCount = 104000;
+    uint16_t batch = HIL_MAX_BATCH;
+    uint8_t window = 4;
+    uint32_t corrupt = 0;
+    double cpuMhz = 0.0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) port = argv[++i];
+        else if (strcmp(argv[i], "--baud") == 0 && i + 1 < argc) baud = atol(argv[++i]);
+        else if (strcmp(argv[i], "--dataset") == 0 && i + 1 < argc) dataset = argv[++i];
+        else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) sampleCount = (size_t)atol(argv[++i]);
+        else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) batch = (uint16_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc) window = (uint8_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--corrupt") == 0 && i + 1 < argc) corrupt = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--cpu-mhz") == 0 && i + 1 < argc) cpuMhz = atof(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: hil_driver [--port DEV] [--baud N] [--dataset CSV] [--samples N] [--batch N] "
+                            "[--window N] [--corrupt N] [--cpu-mhz MHZ]\n");
+            return 2;
+        }
+    }
+    if (batch < 1 || batch > HIL_MAX_BATCH) batch = HIL_MAX_BATCH;
+    if (window < 1) window = 1;
+    if (cpuMhz <= 0.0) cpuMhz = port ? 240.0 : 1000.0;   // Emulator "cycles" are ns
+
+    std::vector<Sample> samples;
+    if (dataset) {
+        if (!load_dataset(dataset, samples)) return 1;
+    } else {
+        synthetic_dataset(sampleCount, samples);
+    }
+    Eloquent::ML::Port::RandomForest model;
+    size_t labelled = 0;
+    for (Sample& s : samples) {
+        s.expected = host_predict(model, s.features);
+        if (s.label >= 0) labelled++;
+    }
+
+    int fd;
+    std::thread emulator;
+    if (port) {
+        fd = open(port, O_RDWR | O_NOCTTY);
+        if (fd < 0) {
+            perror(port);
+            return 1;
+        }
+        make_raw(fd, baud_constant(baud));
+    } else {
+        fd = posix_openpt(O_RDWR | O_NOCTTY);
+        if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) {
+            perror("posix_openpt");
+            return 1;
+        }
+        make_raw(fd, 0);
+        emulator = std::thread(emulator_main, ptsname(fd));
+    }
+
+    printf("HIL driver: %zu samples (%s), batch %u, window %u, %s\n", samples.size(),
+           dataset ? dataset : "synthetic", batch, window, port ? port : "pty emulator");
+
+    Driver driver(fd, samples, batch, window, corrupt);
+    if (!driver.enterBinary()) {
+        fprintf(stderr, "No \"%s\" from the device\n", HIL_READY_LINE);
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    bool complete = driver.stream();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    bool bye = driver.exitBinary();
+
+    const std::vector<int>& results = driver.getResults();
+    size_t mismatches = 0, correct = 0, answered = 0;
+    for (size_t i = 0; i < samples.size(); i++) {
+        if (results[i] < 0) continue;
+        answered++;
+        if (results[i] != samples[i].expected) {
+            if (mismatches < 10) {
+                printf("   mismatch #%zu: %.2f,%.2f,%.2f,%.2f device %d host %d\n", i, samples[i].features[0],
+                       samples[i].features[1], samples[i].features[2], samples[i].features[3], results[i],
+                       samples[i].expected);
+            }
+            mismatches++;
+        }
+        if (samples[i].label >= 0 && results[i] == samples[i].label) correct++;
+    }
+
+    const LatencyHistogram& c = driver.cycles;
+    printf("\n   Throughput: %.0f samples/s (%.2f s), link %.1f KB/s out, %.1f KB/s in\n", answered / seconds,
+           seconds, driver.bytesOut / seconds / 1024.0, driver.bytesIn / seconds / 1024.0);
+    printf("   Device cycles/prediction: p50 %lu | p99 %lu | max %lu  (%.1f / %.1f us at %.0f MHz)\n",
+           (unsigned long)c.percentile(50), (unsigned long)c.percentile(99), (unsigned long)c.max(),
+           c.percentile(50) / cpuMhz, c.percentile(99) / cpuMhz, cpuMhz);
+    printf("   Answered %zu/%zu, mismatches vs host model %zu, CRC/frame errors %lu, resends %lu\n", answered,
+           samples.size(), mismatches, (unsigned long)driver.errors, (unsigned long)driver.resends);
+    if (labelled > 0) {
+        printf("   Accuracy vs labels: %.2f %% (%zu labelled)\n", correct * 100.0 / labelled, labelled);
+    }
+
+    bool ok = complete && bye && answered == samples.size() && mismatches == 0;
+    printf("\n%s\n", ok ? "PASS: every sample answered and matches the host model" : "FAIL");
+
+    close(fd);
+    if (emulator.joinable()) emulator.join();
+    return ok ? 0 : 1;
+}
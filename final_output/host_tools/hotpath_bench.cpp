@@ -0,0 +1,636 @@
+/*
+ * Hot Path Bench - Micro-benchmarks of the firmware's per-sample and
+ * per-prediction code, with a regression gate (host build)
+ *
+ * Runs the ESP32 code itself (through host_shim/) on the host:
+ * - predict: the 250-tree RandomForest on scaled features
+ * - scale_temperature / scale_humidity / scale_pressure / scale_lux
+ * - window_average: the five 15-sample means of one prediction window
+ * - thingspeak_fields / firebase_json / csv_line: the upload encoders
+ *   (telemetry_record.h); payload_all: one record, all three formats
+ * - make_prediction: SensorSimulator::makePrediction() end to end
+ *   (averages, scaling, inference, LOG records, record build, dispatch to
+ *   an encoding-only ThingSpeak + local-file sink pair)
+ *
+ * Inputs cycle through 256 readings drawn from the five weather patterns'
+ * ranges, so the forest sees every class. Every case is calibrated to a
+ * minimum time per repetition, warmed up, then repeated; the report gives
+ * the median, minimum and interquartile spread of ns/op and the heap
+ * allocations per op (operator new, counted by the shim). Timing is real
+ * time (steady_clock), independent of the shim's virtual clock.
+ *
+ * --json writes the results; --compare reads an earlier --json file and
+ * exits 1 if any case's median ns/op grew by more than --threshold percent
+ * or its allocations/op grew at all. --allocs-only still prints the ns/op
+ * change but gates on allocations/op alone (deterministic, so it holds
+ * on a loaded CI host; ctest uses it).
+ *
+ * --inference runs the device's "ibench" measurement (inference_bench.h)
+ * instead, with nanoseconds in place of CPU cycles and a pass over a
+ * buffer larger than the last-level cache in place of the flash cache
+ * eviction; it checks the run is reproducible (same seed, same digest)
+ * and internally consistent, and --json writes its one-line report.
+ *
+ * Build (links host_shim, see final_output/CMakeLists.txt):
+ *   cmake -S .. -B ../build && cmake --build ../build --target hotpath_bench
+ *
+ * Usage:
+ *   ./hotpath_bench [--reps 15] [--min-ms 20] [--filter predict] [--json results.json]
+ *   ./hotpath_bench --json baseline.json                        (on the reference tree)
+ *   ./hotpath_bench --compare baseline.json [--threshold 10]    (after a change)
+ *   ./hotpath_bench --compare baseline.json --allocs-only       (CI)
+ *   ./hotpath_bench --inference [--json ibench.json]
+ */
+
+#include <Arduino.h>
+#include <host_shim.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "weather_model_250.h"
+#include "weather_scaling.h"
+#include "telemetry_record.h"
+#include "telemetry_dispatcher.h"
+#include "task_scheduler.h"
+#include "sensor_simulate.h"
+#include "inference_bench.h"
+
+#define BENCH_INPUTS 256           // Readings the cases cycle through (power of two)
+#define BENCH_WINDOW 15            // Samples per averaging window (SensorSimulator::BUFFER_SIZE)
+#define BENCH_CHUNK 64             // Ops per timed chunk (untimed housekeeping between chunks)
+#define BENCH_WARMUP_REPS 2
+#define BENCH_DEFAULT_REPS 15
+#define BENCH_DEFAULT_MIN_MS 20
+#define BENCH_DEFAULT_THRESHOLD 10.0
+#define BENCH_EVICT_BYTES (4 * 1024 * 1024)   // Beyond a typical host L2, at cache line stride
+#define BENCH_CACHE_LINE 64
+
+static volatile uint32_t benchSink = 0;
+
+// ==================== INPUTS ====================
+struct BenchInputs {
+    float raw[BENCH_INPUTS + BENCH_WINDOW][5];   // temperature, humidity, pressure, lux, gas
+    float scaled[BENCH_INPUTS][4];
+    float series[5][BENCH_INPUTS + BENCH_WINDOW];   // Per-channel copies for the window means
+    TelemetryRecord records[BENCH_INPUTS];
+};
+
+static BenchInputs inputs;
+
+// Same ranges as SensorSimulator::readSensors(), pattern by pattern
+static void make_inputs() {
+    static const float RANGES[5][5][2] = {
+        { { 22.0f, 26.0f }, { 38.0f, 48.0f }, { 98000.0f, 99500.0f }, { 60.0f, 130.0f }, { 200.0f, 600.0f } },
+        { { 20.0f, 24.0f }, { 48.1f, 56.9f }, { 97300.0f, 99000.0f }, { 0.0f, 119.0f }, { 400.0f, 800.0f } },
+        { { 19.0f, 23.0f }, { 42.1f, 52.0f }, { 97200.0f, 97999.0f }, { 30.0f, 130.0f }, { 300.0f, 700.0f } },
+        { { 19.5f, 23.0f }, { 45.0f, 56.5f }, { 96352.7f, 97199.0f }, { 0.0f, 100.0f }, { 350.0f, 900.0f } },
+        { { 25.0f, 30.0f }, { 29.3f, 42.0f }, { 98500.0f, 100301.1f }, { 131.0f, 632.1f }, { 100.0f, 400.0f } },
+    };
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int i = 0; i < BENCH_INPUTS + BENCH_WINDOW; i++) {
+        int pattern = (i / 16) % 5;
+        for (int c = 0; c < 5; c++) {
+            float low = RANGES[pattern][c][0];
+            float high = RANGES[pattern][c][1];
+            inputs.raw[i][c] = low + unit(rng) * (high - low);
+            inputs.series[c][i] = inputs.raw[i][c];
+        }
+    }
+    Eloquent::ML::Port::RandomForest classifier;
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        scale_features(inputs.raw[i][0], inputs.raw[i][1], inputs.raw[i][2], inputs.raw[i][3], inputs.scaled[i]);
+        TelemetryRecord& r = inputs.records[i];
+        memset(&r, 0, sizeof(r));
+        r.timestampMs = 15000ULL * (i + 1);
+        r.epochMs = 1760000000000ULL + r.timestampMs;
+        r.temperature = inputs.raw[i][0];
+        r.humidity = inputs.raw[i][1];
+        r.pressure = inputs.raw[i][2];
+        r.lux = inputs.raw[i][3];
+        r.gas = inputs.raw[i][4];
+        r.predictedClass = (uint8_t)classifier.predict(inputs.scaled[i], r.votes);
+        r.inferenceTime = 1400 + (uint32_t)(i % 90);
+        r.rssi = (int8_t)(-50 - i % 30);
+    }
+}
+
+// ==================== CASES ====================
+// run(n, offset) performs n ops starting at input `offset`; between() is
+// untimed housekeeping after each chunk
+
+typedef void (*BenchRunFn)(uint32_t count, uint32_t offset);
+typedef void (*BenchBetweenFn)();
+
+struct BenchCase {
+    const char* name;
+    BenchRunFn run;
+    BenchBetweenFn between;
+};
+
+static Eloquent::ML::Port::RandomForest benchClassifier;
+
+static void run_predict(uint32_t count, uint32_t offset) {
+    uint8_t votes[TELEMETRY_NUM_CLASSES];
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        acc += (uint32_t)benchClassifier.predict(inputs.scaled[(offset + i) & (BENCH_INPUTS - 1)], votes);
+    }
+    benchSink = benchSink + acc;
+}
+
+template <float (*Scale)(float), int Channel>
+static void run_scale(uint32_t count, uint32_t offset) {
+    float acc = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        acc += Scale(inputs.raw[(offset + i) & (BENCH_INPUTS - 1)][Channel]);
+    }
+    benchSink = benchSink + (uint32_t)acc;
+}
+
+static void run_window_average(uint32_t count, uint32_t offset) {
+    float acc = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t start = (offset + i) & (BENCH_INPUTS - 1);
+        for (int c = 0; c < 5; c++) {
+            acc += SensorSimulator::windowAverage(&inputs.series[c][start], BENCH_WINDOW);
+        }
+    }
+    benchSink = benchSink + (uint32_t)acc;
+}
+
+static void run_thingspeak_fields(uint32_t count, uint32_t offset) {
+    char out[TELEMETRY_MAX_PAYLOAD];
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        acc += (uint32_t)telemetry_encode_thingspeak(inputs.records[(offset + i) & (BENCH_INPUTS - 1)], out,
+                                                     sizeof(out));
+    }
+    benchSink = benchSink + acc;
+}
+
+static void run_firebase_json(uint32_t count, uint32_t offset) {
+    char out[TELEMETRY_MAX_PAYLOAD];
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        acc += (uint32_t)telemetry_encode_firebase_json(inputs.records[(offset + i) & (BENCH_INPUTS - 1)],
+                                                        "240AC4123456", out, sizeof(out));
+    }
+    benchSink = benchSink + acc;
+}
+
+static void run_csv_line(uint32_t count, uint32_t offset) {
+    char out[TELEMETRY_MAX_PAYLOAD];
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        acc += (uint32_t)telemetry_encode_csv(inputs.records[(offset + i) & (BENCH_INPUTS - 1)], out, sizeof(out));
+    }
+    benchSink = benchSink + acc;
+}
+
+static void run_payload_all(uint32_t count, uint32_t offset) {
+    static TelemetryPayload payload;
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        payload.reset(inputs.records[(offset + i) & (BENCH_INPUTS - 1)], "240AC4123456");
+        acc += (uint32_t)payload.length(TELEMETRY_FORMAT_THINGSPEAK);
+        acc += (uint32_t)payload.length(TELEMETRY_FORMAT_FIREBASE_JSON);
+        acc += (uint32_t)payload.length(TELEMETRY_FORMAT_CSV);
+    }
+    benchSink = benchSink + acc;
+}
+
+// ==================== END TO END ====================
+// Sinks that only pull their encoding (no file or network I/O)
+class EncodeOnlySink : public TelemetrySink {
+private:
+    const char* sinkName;
+    TelemetryFormat format;
+
+public:
+    EncodeOnlySink(const char* displayName, TelemetryFormat encoding) : sinkName(displayName), format(encoding) {}
+    const char* name() override { return sinkName; }
+    bool isReady() override { return true; }
+    bool publish(TelemetryPayload& payload) override {
+        benchSink = benchSink + (uint32_t)payload.length(format);
+        return true;
+    }
+};
+
+static uint32_t bench_micros() { return micros(); }
+
+static TaskScheduler benchScheduler(bench_micros);
+static TelemetryDispatcher benchDispatcher;
+static EncodeOnlySink benchFileSink("LocalFile", TELEMETRY_FORMAT_CSV);
+static EncodeOnlySink benchThingSpeakSink("ThingSpeak", TELEMETRY_FORMAT_THINGSPEAK);
+static SensorSimulator simulator;
+
+static void discard_log(const uint8_t* data, size_t length, void* context) {
+    (void)data;
+    (void)context;
+    benchSink = benchSink + (uint32_t)length;
+}
+
+// Fill one window with the simulator's own readings, as the firmware does
+static void setup_simulator() {
+    benchDispatcher.addSink(&benchFileSink, RATE_PRIORITY_HIGH);
+    benchDispatcher.addSink(&benchThingSpeakSink, RATE_PRIORITY_NORMAL, 15000, 1, true);
+    simulator.setScheduler(&benchScheduler);
+    simulator.setTelemetryDispatcher(&benchDispatcher);
+
+    host_serial_mute(true);
+    simulator.begin();
+    simulator.start();
+    for (int i = 0; i < BENCH_WINDOW; i++) {
+        benchScheduler.run(millis());
+        host_clock_advance_ms(1000);
+    }
+    simulator.stop();
+    host_serial_mute(false);
+}
+
+static void run_make_prediction(uint32_t count, uint32_t offset) {
+    (void)offset;
+    for (uint32_t i = 0; i < count; i++) {
+        simulator.makePrediction();
+    }
+}
+
+// The log task's job: keep the ring from filling (full rings drop, which
+// is cheaper than the write path being measured)
+static void drain_log() {
+    while (deferred_log().drain(discard_log, nullptr, true, 64) > 0) {
+    }
+}
+
+static const BenchCase CASES[] = {
+    { "predict", run_predict, nullptr },
+    { "scale_temperature", run_scale<scale_temperature, 0>, nullptr },
+    { "scale_humidity", run_scale<scale_humidity, 1>, nullptr },
+    { "scale_pressure", run_scale<scale_pressure, 2>, nullptr },
+    { "scale_lux", run_scale<scale_lux, 3>, nullptr },
+    { "window_average", run_window_average, nullptr },
+    { "thingspeak_fields", run_thingspeak_fields, nullptr },
+    { "firebase_json", run_firebase_json, nullptr },
+    { "csv_line", run_csv_line, nullptr },
+    { "payload_all", run_payload_all, nullptr },
+    { "make_prediction", run_make_prediction, drain_log },
+};
+static const int CASE_COUNT = sizeof(CASES) / sizeof(CASES[0]);
+
+// ==================== HARNESS ====================
+struct BenchResult {
+    std::string name;
+    uint64_t opsPerRep;
+    int reps;
+    double medianNs;
+    double minNs;
+    double iqrPercent;       // (p75 - p25) / median
+    double allocsPerOp;
+};
+
+struct RepSample {
+    double nsPerOp;
+    uint64_t allocations;
+};
+
+static RepSample time_ops(const BenchCase& bench, uint64_t ops, uint32_t& offset) {
+    uint64_t elapsedNs = 0;
+    uint64_t allocations = 0;
+    for (uint64_t done = 0; done < ops;) {
+        uint32_t n = (uint32_t)std::min<uint64_t>(BENCH_CHUNK, ops - done);
+        uint64_t allocStart = host_heap_allocations();
+        auto start = std::chrono::steady_clock::now();
+        bench.run(n, offset);
+        auto end = std::chrono::steady_clock::now();
+        allocations += host_heap_allocations() - allocStart;
+        elapsedNs += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        offset += n;
+        done += n;
+        if (bench.between != nullptr) bench.between();
+    }
+    return { (double)elapsedNs / (double)ops, allocations };
+}
+
+static double percentile(std::vector<double> values, double p) {
+    std::sort(values.begin(), values.end());
+    double position = p * (double)(values.size() - 1);
+    size_t low = (size_t)position;
+    size_t high = std::min(low + 1, values.size() - 1);
+    return values[low] + (values[high] - values[low]) * (position - (double)low);
+}
+
+static BenchResult run_case(const BenchCase& bench, int reps, double minMs) {
+    uint32_t offset = 0;
+
+    // Calibrate (doubles as the first warmup): ops per repetition >= minMs
+    uint64_t ops = BENCH_CHUNK;
+    for (;;) {
+        RepSample sample = time_ops(bench, ops, offset);
+        if (sample.nsPerOp * (double)ops >= minMs * 1e6 || ops >= (1ULL << 32)) break;
+        ops *= 2;
+    }
+    for (int i = 0; i < BENCH_WARMUP_REPS; i++) {
+        time_ops(bench, ops, offset);
+    }
+
+    std::vector<double> nsPerOp;
+    uint64_t allocations = 0;
+    for (int i = 0; i < reps; i++) {
+        RepSample sample = time_ops(bench, ops, offset);
+        nsPerOp.push_back(sample.nsPerOp);
+        allocations += sample.allocations;
+    }
+
+    BenchResult result;
+    result.name = bench.name;
+    result.opsPerRep = ops;
+    result.reps = reps;
+    result.medianNs = percentile(nsPerOp, 0.5);
+    result.minNs = *std::min_element(nsPerOp.begin(), nsPerOp.end());
+    result.iqrPercent = result.medianNs > 0
+                            ? (percentile(nsPerOp, 0.75) - percentile(nsPerOp, 0.25)) * 100.0 / result.medianNs
+                            : 0.0;
+    result.allocsPerOp = (double)allocations / ((double)ops * reps);
+    return result;
+}
+
+// ==================== JSON ====================
+static bool write_json(const char* path, const std::vector<BenchResult>& results) {
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return false;
+    }
+    fprintf(file, "{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        fprintf(file,
+                "    {\"name\":\"%s\",\"ns_per_op\":%.3f,\"ns_per_op_min\":%.3f,\"iqr_percent\":%.2f,"
+                "\"allocs_per_op\":%.4f,\"ops_per_rep\":%llu,\"reps\":%d}%s\n",
+                r.name.c_str(), r.medianNs, r.minNs, r.iqrPercent, r.allocsPerOp, (unsigned long long)r.opsPerRep,
+                r.reps, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    return fclose(file) == 0;
+}
+
+// Reads the files write_json() produces (one benchmark object per line)
+static bool read_json(const char* path, std::vector<BenchResult>& results) {
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) {
+        fprintf(stderr, "Cannot read %s\n", path);
+        return false;
+    }
+    char line[512];
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        const char* name = strstr(line, "\"name\":\"");
+        const char* ns = strstr(line, "\"ns_per_op\":");
+        const char* allocs = strstr(line, "\"allocs_per_op\":");
+        if (name == nullptr || ns == nullptr || allocs == nullptr) continue;
+        name += 8;
+        const char* nameEnd = strchr(name, '"');
+        if (nameEnd == nullptr) continue;
+        BenchResult r;
+        r.name.assign(name, (size_t)(nameEnd - name));
+        r.medianNs = atof(ns + 12);
+        r.allocsPerOp = atof(allocs + 16);
+        r.minNs = r.iqrPercent = 0;
+        r.opsPerRep = 0;
+        r.reps = 0;
+        results.push_back(r);
+    }
+    fclose(file);
+    if (results.empty()) {
+        fprintf(stderr, "No benchmarks in %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+// ==================== REPORT ====================
+static void print_results(const std::vector<BenchResult>& results) {
+    printf("   %-18s %12s %12s %8s %12s %10s\n", "Case", "ns/op", "min ns/op", "IQR", "allocs/op", "ops/rep");
+    printf("─────────────────────────────────────────────────────────────────────────────────\n");
+    for (const BenchResult& r : results) {
+        printf("   %-18s %12.2f %12.2f %7.1f%% %12.3f %10llu\n", r.name.c_str(), r.medianNs, r.minNs, r.iqrPercent,
+               r.allocsPerOp, (unsigned long long)r.opsPerRep);
+    }
+    printf("─────────────────────────────────────────────────────────────────────────────────\n");
+}
+
+// Returns the number of regressed cases (gateTime false: allocs/op only)
+static int compare(const std::vector<BenchResult>& results, const std::vector<BenchResult>& baseline,
+                   double threshold, bool gateTime) {
+    int regressions = 0;
+    if (gateTime) {
+        printf("\n   Against baseline (threshold +%.1f%% ns/op, any allocs/op increase):\n", threshold);
+    } else {
+        printf("\n   Against baseline (any allocs/op increase; ns/op for reference only):\n");
+    }
+    printf("   %-18s %12s %12s %9s %10s %10s\n", "Case", "base ns/op", "ns/op", "change", "allocs/op", "verdict");
+    printf("─────────────────────────────────────────────────────────────────────────────────\n");
+    for (const BenchResult& r : results) {
+        const BenchResult* base = nullptr;
+        for (const BenchResult& b : baseline) {
+            if (b.name == r.name) base = &b;
+        }
+        if (base == nullptr) {
+            printf("   %-18s %12s %12.2f %9s %10.3f %10s\n", r.name.c_str(), "-", r.medianNs, "-", r.allocsPerOp,
+                   "new");
+            continue;
+        }
+        double change = base->medianNs > 0 ? (r.medianNs - base->medianNs) * 100.0 / base->medianNs : 0.0;
+        bool slower = gateTime && change > threshold;
+        bool allocates = r.allocsPerOp > base->allocsPerOp + 0.001;
+        const char* verdict = slower && allocates ? "SLOW+HEAP" : slower ? "SLOWER" : allocates ? "HEAP" : "ok";
+        if (slower || allocates) regressions++;
+        printf("   %-18s %12.2f %12.2f %+8.1f%% %10.3f %10s\n", r.name.c_str(), base->medianNs, r.medianNs, change,
+               r.allocsPerOp, verdict);
+    }
+    printf("─────────────────────────────────────────────────────────────────────────────────\n");
+    return regressions;
+}
+
+// ==================== INFERENCE DISTRIBUTION ====================
+static int ibench_predict(const float* scaled, void* context) {
+    return benchClassifier.predict(const_cast<float*>(scaled));
+}
+
+static uint32_t ibench_nanos() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static std::vector<uint8_t> evictBuffer;
+
+static void ibench_evict(void* context) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i < evictBuffer.size(); i += BENCH_CACHE_LINE) {
+        evictBuffer[i]++;
+        sum += evictBuffer[i];
+    }
+    benchSink = benchSink + sum;
+}
+
+// Same reference kernel as the test sketch's iram_ref / flash_ref probes
+// (the host has no IRAM: both are ordinary functions)
+static uint32_t ibench_reference(const float* x) {
+    uint32_t votes = 0;
+    for (int t = 0; t < 32; t++) {
+        float threshold = (t + 0.5f) / 32.0f;
+        votes += (x[t & 3] > threshold) ? 1 : 0;
+    }
+    return votes;
+}
+
+static void ibench_probe(const float* x) { benchSink = benchSink + ibench_reference(x); }
+
+static bool ordered(const InferenceLatency& s) {
+    return s.min <= s.p50 && s.p50 <= s.p90 && s.p90 <= s.p99 && s.p99 <= s.p999 && s.p999 <= s.max;
+}
+
+static int run_inference(const char* jsonPath) {
+    static InferenceBench bench(ibench_predict, ibench_nanos, nullptr);
+    static InferenceBench again(ibench_predict, ibench_nanos, nullptr);
+    evictBuffer.assign(BENCH_EVICT_BYTES, 1);
+    bench.setEvict(ibench_evict);
+    bench.addProbe("ref", ibench_probe);
+
+    printf("Inference distribution: %d hypercube inputs, %d warmup, %d cold (ns)\n\n", INFERENCE_BENCH_SAMPLES,
+           INFERENCE_BENCH_WARMUP, INFERENCE_BENCH_COLD_SAMPLES);
+    bench.run(1);
+    again.run(1);
+
+    printf("   %-8s %6s %8s %8s %8s %8s %8s\n", "", "n", "p50", "p90", "p99", "p99.9", "max");
+    const InferenceLatency* rows[2] = { &bench.warm(), &bench.cold() };
+    const char* names[2] = { "warm", "cold" };
+    for (int r = 0; r < 2; r++) {
+        printf("   %-8s %6lu %8lu %8lu %8lu %8lu %8lu\n", names[r], (unsigned long)rows[r]->count,
+               (unsigned long)rows[r]->p50, (unsigned long)rows[r]->p90, (unsigned long)rows[r]->p99,
+               (unsigned long)rows[r]->p999, (unsigned long)rows[r]->max);
+    }
+    int failures = 0;
+    uint32_t classified = 0;
+    for (int c = 0; c < TELEMETRY_NUM_CLASSES; c++) {
+        const InferenceLatency& s = bench.forClass(c);
+        printf("   %-8s %6lu %8lu %8lu %8lu %8s %8lu  (%.1f%% of the space)\n", telemetry_class_name((uint8_t)c),
+               (unsigned long)s.count, (unsigned long)s.p50, (unsigned long)s.p90, (unsigned long)s.p99, "",
+               (unsigned long)s.max, 100.0 * bench.hypercubeCount(c) / INFERENCE_BENCH_SAMPLES);
+        classified += bench.hypercubeCount(c);
+        if (!ordered(s)) failures++;
+    }
+    printf("\n   Top-ups %lu, counter overhead %lu ns, digest %08lx\n", (unsigned long)bench.getTopups(),
+           (unsigned long)bench.getOverhead(), (unsigned long)bench.getDigest());
+
+    if (bench.warm().count != INFERENCE_BENCH_SAMPLES || classified != INFERENCE_BENCH_SAMPLES) failures++;
+    if (bench.cold().count != INFERENCE_BENCH_COLD_SAMPLES || !ordered(bench.warm()) || !ordered(bench.cold())) {
+        failures++;
+    }
+    if (again.getDigest() != bench.getDigest()) {
+        printf("   ❌ Digest differs between two runs with the same seed\n");
+        failures++;
+    }
+
+    static char line[2048];
+    // A nanosecond counter is a 1000 MHz cycle counter
+    int length = bench.encodeJson(line, sizeof(line), "rf250", 1000);
+    if (length <= 0) {
+        printf("   ❌ JSON report does not fit %zu bytes\n", sizeof(line));
+        failures++;
+    } else if (jsonPath != nullptr) {
+        FILE* file = fopen(jsonPath, "w");
+        if (file == nullptr) {
+            fprintf(stderr, "Cannot write %s\n", jsonPath);
+            return 2;
+        }
+        fprintf(file, "%s\n", line);
+        fclose(file);
+        printf("   Report: %s (%d bytes)\n", jsonPath, length);
+    }
+
+    if (failures > 0) {
+        printf("\n❌ %d inference distribution check(s) failed\n", failures);
+        return 1;
+    }
+    printf("\n✅ Inference distribution consistent and reproducible\n");
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    int reps = BENCH_DEFAULT_REPS;
+    double minMs = BENCH_DEFAULT_MIN_MS;
+    double threshold = BENCH_DEFAULT_THRESHOLD;
+    const char* filter = nullptr;
+    const char* jsonPath = nullptr;
+    const char* baselinePath = nullptr;
+    bool inference = false;
+    bool allocsOnly = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+            reps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--min-ms") == 0 && i + 1 < argc) {
+            minMs = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+            baselinePath = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--allocs-only") == 0) {
+            allocsOnly = true;
+        } else if (strcmp(argv[i], "--inference") == 0) {
+            inference = true;
+        } else {
+            fprintf(stderr, "Usage: hotpath_bench [--reps N] [--min-ms MS] [--filter TEXT] [--json FILE] "
+                            "[--compare BASELINE.json] [--threshold PERCENT] [--allocs-only] [--inference]\n");
+            return 2;
+        }
+    }
+    if (reps < 3) reps = 3;
+    if (minMs < 0.1) minMs = 0.1;
+    if (inference) return run_inference(jsonPath);
+
+    std::vector<BenchResult> baseline;
+    if (baselinePath != nullptr && !read_json(baselinePath, baseline)) return 2;
+
+    make_inputs();
+    setup_simulator();
+
+    printf("Hot path bench: %d reps (+%d warmup) of >= %.1f ms per case, %d inputs\n\n", reps, BENCH_WARMUP_REPS,
+           minMs, BENCH_INPUTS);
+
+    std::vector<BenchResult> results;
+    for (int i = 0; i < CASE_COUNT; i++) {
+        if (filter != nullptr && strstr(CASES[i].name, filter) == nullptr) continue;
+        results.push_back(run_case(CASES[i], reps, minMs));
+    }
+    if (results.empty()) {
+        fprintf(stderr, "No case matches '%s'\n", filter);
+        return 2;
+    }
+    print_results(results);
+
+    if (jsonPath != nullptr) {
+        if (!write_json(jsonPath, results)) return 2;
+        printf("   Results: %s\n", jsonPath);
+    }
+
+    if (baselinePath != nullptr) {
+        int regressions = compare(results, baseline, threshold, !allocsOnly);
+        if (regressions > 0) {
+            printf("\n❌ %d hot path(s) regressed against %s\n", regressions, baselinePath);
+            return 1;
+        }
+        printf("\n✅ No regression against %s\n", baselinePath);
+    }
+    return 0;
+}
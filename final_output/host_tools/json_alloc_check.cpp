@@ -0,0 +1,275 @@
+/*
+ * JSON Allocation Check - Heap allocations per Firebase backup (host build)
+ *
+ * Counts every malloc/calloc/realloc made while building the Firebase
+ * reading, status, info and latency window nodes with json_stream_writer.h
+ * (the same code the ESP32 runs), and compares against:
+ * - the previous snprintf reading encoder (byte-for-byte output check,
+ *   apart from printf's "-0.00")
+ * - a FirebaseJson-style builder (String keys/values, String paths), which
+ *   is what every backup used to do on the device
+ *
+ * Exits non-zero if the writer allocates or its output differs from the
+ * snprintf encoder, or if a latency window summary with every value at
+ * its maximum does not fit LATENCY_JSON_SIZE / LATENCY_STATUS_SIZE.
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -I../esp32_code json_alloc_check.cpp -o json_alloc_check
+ *
+ * Usage:
+ *   ./json_alloc_check [--records 100000]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <string>
+
+#include "telemetry_record.h"
+#include "json_stream_writer.h"
+#include "latency_window.h"
+
+// ==================== ALLOCATION COUNTER ====================
+// glibc: wrap the allocator entry points (operator new ends up here too)
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* p, size_t size);
+
+static unsigned long allocations = 0;
+
+extern "C" void* malloc(size_t size) {
+    allocations++;
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    allocations++;
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* p, size_t size) {
+    allocations++;
+    return __libc_realloc(p, size);
+}
+
+// ==================== REFERENCE ENCODERS ====================
+// Reading encoder before json_stream_writer.h
+static int legacy_encode_reading(const TelemetryRecord& r, const char* deviceId, char* out, size_t size) {
+    int written = snprintf(out, size,
+        "{\"temperature\":%.2f,\"humidity\":%.2f,\"pressure\":%.2f,\"lux\":%.2f,"
+        "\"gas_ppm\":%.2f,\"prediction\":\"%s\",\"class_id\":%u,"
+        "\"votes\":[%u,%u,%u,%u,%u],\"inference_time\":%lu,\"rssi\":%d,"
+        "\"timestamp\":%llu,\"device_id\":\"%s\"}",
+        r.temperature, r.humidity, r.pressure, r.lux, r.gas,
+        telemetry_class_name(r.predictedClass), (unsigned)r.predictedClass,
+        (unsigned)r.votes[0], (unsigned)r.votes[1], (unsigned)r.votes[2],
+        (unsigned)r.votes[3], (unsigned)r.votes[4],
+        (unsigned long)r.inferenceTime, (int)r.rssi,
+        (unsigned long long)r.epochMs, deviceId);
+    return telemetry_checked_length(written, size);
+}
+
+// FirebaseJson-style: every set() appends String pieces, paths are Strings
+class StringJson {
+private:
+    std::string members;
+
+    void add(const char* key, const std::string& encoded) {
+        if (!members.empty()) members += ",";
+        members += std::string("\"") + key + "\":" + encoded;
+    }
+
+public:
+    void set(const char* key, const char* v) { add(key, std::string("\"") + v + "\""); }
+    void set(const char* key, bool v) { add(key, v ? "true" : "false"); }
+    void set(const char* key, unsigned long v) { add(key, std::to_string(v)); }
+    void set(const char* key, double v) { add(key, std::to_string(v)); }
+    std::string toString() const { return "{" + members + "}"; }
+};
+
+static size_t legacy_backup(const TelemetryRecord& r, const std::string& deviceId) {
+    std::string readingPath = "/devices/" + deviceId + "/readings/" + std::to_string(r.epochMs);
+    StringJson reading;
+    reading.set("temperature", (double)r.temperature);
+    reading.set("humidity", (double)r.humidity);
+    reading.set("pressure", (double)r.pressure);
+    reading.set("lux", (double)r.lux);
+    reading.set("gas_ppm", (double)r.gas);
+    reading.set("prediction", telemetry_class_name(r.predictedClass));
+    reading.set("class_id", (unsigned long)r.predictedClass);
+    reading.set("inference_time", (unsigned long)r.inferenceTime);
+    reading.set("timestamp", (unsigned long)r.epochMs);
+    reading.set("device_id", deviceId.c_str());
+
+    std::string statusPath = "/devices/" + deviceId + "/status";
+    StringJson status;
+    status.set("online", true);
+    status.set("last_seen", (unsigned long)r.epochMs);
+    return readingPath.size() + reading.toString().size() + statusPath.size() + status.toString().size();
+}
+
+// Same work with the stream writer: reading + status into reused buffers
+static size_t writer_backup(const TelemetryRecord& r, const char* deviceId, char* body, size_t size) {
+    char path[64];
+    snprintf(path, sizeof(path), "/devices/%s.json", deviceId);
+    JsonStreamWriter w(body, size);
+    w.beginObject();
+    char key[32];
+    snprintf(key, sizeof(key), "readings/%llu", (unsigned long long)r.epochMs);
+    w.key(key);
+    json_write_reading(w, r, deviceId);
+    w.field(JSON_FIELD("status"));
+    json_write_status(w, true, r.epochMs);
+    w.endObject();
+    return strlen(path) + (size_t)(w.length() > 0 ? w.length() : 0);
+}
+
+// ==================== MAIN ====================
+static void random_record(std::mt19937& rng, TelemetryRecord& r, unsigned i) {
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+    memset(&r, 0, sizeof(r));
+    r.timestampMs = (uint64_t)i * 15000 + (rng() % 1000);
+    r.epochMs = 1700000000000ULL + r.timestampMs;
+    r.temperature = -20.0f + u(rng) * 70.0f;
+    r.humidity = u(rng) * 100.0f;
+    r.pressure = 90000.0f + u(rng) * 15000.0f;
+    r.lux = (i % 7 == 0) ? 0.0f : u(rng) * 60000.0f;
+    r.gas = (i % 11 == 0) ? (float)(rng() % 2000) + 0.125f * (rng() % 8) : u(rng) * 5000.0f;   // Exact ties too
+    r.predictedClass = (uint8_t)(rng() % TELEMETRY_NUM_CLASSES);
+    for (int c = 0; c < TELEMETRY_NUM_CLASSES; c++) r.votes[c] = (uint8_t)(rng() % 251);
+    r.inferenceTime = 150 + rng() % 200;
+    r.rssi = (int8_t)(-(int)(rng() % 100));
+}
+
+static double elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    unsigned records = 100000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--records") == 0 && i + 1 < argc) records = (unsigned)atoi(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: json_alloc_check [--records N]\n");
+            return 2;
+        }
+    }
+
+    const char* deviceId = "240AC4123456";
+    const std::string deviceIdString(deviceId);
+    std::mt19937 rng(7);
+    TelemetryRecord r;
+    static char a[TELEMETRY_MAX_PAYLOAD], b[TELEMETRY_MAX_PAYLOAD];
+    static char body[1024];
+
+    // Output equivalence with the snprintf encoder
+    unsigned mismatches = 0;
+    for (unsigned i = 0; i < records; i++) {
+        random_record(rng, r, i);
+        int la = telemetry_encode_firebase_json(r, deviceId, a, sizeof(a));
+        int lb = legacy_encode_reading(r, deviceId, b, sizeof(b));
+        // printf keeps the sign of values that round to zero ("-0.00"); the
+        // writer prints "0.00" - same number, so compare without it
+        for (char* neg = strstr(b, ":-0.00,"); neg; neg = strstr(neg, ":-0.00,")) {
+            memmove(neg + 1, neg + 2, strlen(neg + 2) + 1);
+            lb--;
+        }
+        if (la != lb || strcmp(a, b) != 0) {
+            if (mismatches++ < 3) fprintf(stderr, "❌ writer: %s\n   printf: %s\n", a, b);
+        }
+    }
+
+    // Allocations and time per node / per backup
+    struct Row { const char* name; unsigned long allocs; double ns; };
+    Row rows[6];
+    volatile size_t sink = 0;
+    unsigned long before;
+    std::chrono::steady_clock::time_point start;
+
+    before = allocations; start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < records; i++) {
+        random_record(rng, r, i);
+        sink = sink + (size_t)telemetry_encode_firebase_json(r, deviceId, a, sizeof(a));
+    }
+    rows[0] = { "Reading node (writer)", allocations - before, elapsed_ns(start) / records };
+
+    before = allocations; start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < records; i++) {
+        random_record(rng, r, i);
+        sink = sink + (size_t)legacy_encode_reading(r, deviceId, b, sizeof(b));
+    }
+    rows[1] = { "Reading node (snprintf)", allocations - before, elapsed_ns(start) / records };
+
+    DeviceInfo info = { deviceId, "v3.0", "RandomForest-250trees", "ESP32-S3", 2, 240, 8.0f,
+                        "24:0A:C4:12:34:56", 0 };
+    before = allocations; start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < records; i++) {
+        info.lastBootMs = 1700000000000ULL + i;
+        JsonStreamWriter w(body, sizeof(body));
+        json_write_info(w, info);
+        JsonStreamWriter s(a, sizeof(a));
+        json_write_status(s, true, 1700000000000ULL + i);
+        sink = sink + (size_t)w.length() + (size_t)s.length();
+    }
+    rows[2] = { "Info + status (writer)", allocations - before, elapsed_ns(start) / records };
+
+    before = allocations; start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < records; i++) {
+        random_record(rng, r, i);
+        sink = sink + writer_backup(r, deviceId, body, sizeof(body));
+    }
+    rows[3] = { "Backup (writer)", allocations - before, elapsed_ns(start) / records };
+
+    before = allocations; start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < records; i++) {
+        random_record(rng, r, i);
+        sink = sink + legacy_backup(r, deviceIdString);
+    }
+    rows[4] = { "Backup (String JSON)", allocations - before, elapsed_ns(start) / records };
+
+    // Latency window summary: Firebase node + ThingSpeak status text
+    LatencyWindowReport report;
+    memset(&report, 0, sizeof(report));
+    report.lengthMs = LATENCY_WINDOW_MS;
+    before = allocations; start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < records; i++) {
+        report.startS = 1700000000UL + i * (LATENCY_WINDOW_MS / 1000);
+        for (int m = 0; m < LATENCY_METRIC_COUNT; m++) {
+            uint32_t base = 100 + rng() % 5000;
+            report.metrics[m] = { 20 + i % 300, base, base * 2, base * 3, base * 4 };
+        }
+        JsonStreamWriter w(a, LATENCY_JSON_SIZE);
+        json_write_latency_window(w, report);
+        sink = sink + (size_t)w.length() + (size_t)latency_encode_status(report, b, LATENCY_STATUS_SIZE);
+    }
+    rows[5] = { "Latency window (writer)", allocations - before, elapsed_ns(start) / records };
+
+    report.startS = UINT32_MAX;
+    report.lengthMs = UINT32_MAX;
+    for (int m = 0; m < LATENCY_METRIC_COUNT; m++) {
+        report.metrics[m] = { UINT32_MAX, UINT32_MAX, UINT32_MAX, UINT32_MAX, UINT32_MAX };
+    }
+    JsonStreamWriter worst(a, LATENCY_JSON_SIZE);
+    json_write_latency_window(worst, report);
+    int worstStatus = latency_encode_status(report, b, LATENCY_STATUS_SIZE);
+    bool latencyFits = worst.ok() && worstStatus > 0;
+    if (!latencyFits) {
+        fprintf(stderr, "❌ Worst-case latency window does not fit (JSON %d of %d, status %d of %d)\n",
+                worst.length(), LATENCY_JSON_SIZE, worstStatus, LATENCY_STATUS_SIZE);
+    }
+
+    printf("Records: %u | output mismatches vs snprintf: %u\n\n", records, mismatches);
+    printf("   Path                        allocs/op    ns/op\n");
+    printf("   ──────────────────────────────────────────────\n");
+    for (const Row& row : rows) {
+        printf("   %-26s %10.2f %8.1f\n", row.name, (double)row.allocs / records, row.ns);
+    }
+
+    bool ok = mismatches == 0 && rows[0].allocs == 0 && rows[2].allocs == 0 && rows[3].allocs == 0 &&
+              rows[5].allocs == 0 && latencyFits;
+    printf("\n%s\n", ok ? "✅ Zero heap allocations per backup, output identical"
+                        : "❌ Writer allocated or output differs");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,518 @@
+/*
+ * Log Decoder - Turn deferred_log.h frames back into text
+ *
+ * The main sketch writes its readings, predictions and upload outcomes as
+ * binary records (message id + raw arguments) between ordinary text on the
+ * same serial port. This reads that stream from a port, a capture file or
+ * stdin, passes the text through, and prints each frame as a line using
+ * the format table in log_messages.h:
+ *   [     31.204117] I predict: #2 Sunny (class 4) in 812 us
+ * Frames with a bad CRC or arguments that do not match their format are
+ * counted and reported at the end (the firmware and decoder must be built
+ * from the same log_messages.h).
+ *
+ * --selftest checks the logging path on the host instead:
+ * - every message formats exactly as printf() would with the same
+ *   arguments, and decodes from a stream mixed with text
+ * - a full ring drops and counts records, and the drain reports them
+ * - two writer threads and a drain thread: nothing lost or reordered
+ *   without being counted
+ * - LOG() above LOG_LEVEL does not evaluate its arguments
+ * - cost per LOG() vs formatting the same line, and bytes on the wire per
+ *   15 s prediction cycle as text vs frames (UART time at 115200 baud)
+ * Exits non-zero on any failure.
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread -I../esp32_code log_decoder.cpp -o log_decoder
+ *
+ * Usage:
+ *   ./log_decoder --port /dev/ttyACM0 [--baud 115200]
+ *   ./log_decoder capture.bin          (or: ... | ./log_decoder)
+ *   ./log_decoder --selftest
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define LOG_LEVEL LOG_LEVEL_INFO
+#include "deferred_log.h"
+
+// ==================== STREAM DECODER ====================
+class LogStreamDecoder {
+private:
+    enum State { TEXT, MAGIC, LENGTH, BODY };
+    State state;
+    uint8_t frame[1 + LOG_MAX_RECORD + 2];
+    size_t needed;
+    size_t used;
+    bool lineStart;
+
+public:
+    uint32_t frames;
+    uint32_t crcErrors;
+    uint32_t badRecords;
+    uint32_t textBytes;
+
+    LogStreamDecoder()
+        : state(TEXT), needed(0), used(0), lineStart(true), frames(0), crcErrors(0), badRecords(0), textBytes(0) {}
+
+    // Decoded lines and passed-through text go to out
+    void feed(uint8_t byte, std::string& out) {
+        switch (state) {
+            case TEXT:
+                if (byte == LOG_FRAME_MAGIC0) {
+                    state = MAGIC;
+                } else {
+                    out += (char)byte;
+                    textBytes++;
+                    lineStart = byte == '\n';
+                }
+                break;
+            case MAGIC:
+                if (byte == LOG_FRAME_MAGIC1) {
+                    state = LENGTH;
+                } else {
+                    state = TEXT;
+                    feed(byte, out);
+                }
+                break;
+            case LENGTH:
+                if (byte < 6 || byte > LOG_MAX_RECORD) {
+                    crcErrors++;
+                    state = TEXT;
+                    break;
+                }
+                frame[0] = byte;
+                used = 1;
+                needed = 1 + byte + 2;
+                state = BODY;
+                break;
+            case BODY:
+                frame[used++] = byte;
+                if (used == needed) {
+                    state = TEXT;
+                    decode(out);
+                }
+                break;
+        }
+    }
+
+private:
+    void decode(std::string& out) {
+        size_t length = frame[0];
+        uint16_t crc = (uint16_t)(frame[1 + length] | (frame[2 + length] << 8));
+        if (telemetry_crc16(frame, 1 + length) != crc) {
+            crcErrors++;
+            return;
+        }
+        char line[LOG_MAX_LINE];
+        if (!log_format_line(frame + 1, length, line, sizeof(line))) badRecords++;
+        frames++;
+        if (!lineStart) out += '\n';
+        out += line;
+        out += '\n';
+        lineStart = true;
+    }
+};
+
+static int decode_stream(int fd) {
+    LogStreamDecoder decoder;
+    uint8_t chunk[4096];
+    std::string out;
+    ssize_t n;
+    while ((n = read(fd, chunk, sizeof(chunk))) > 0) {
+        out.clear();
+        for (ssize_t i = 0; i < n; i++) decoder.feed(chunk[i], out);
+        fwrite(out.data(), 1, out.size(), stdout);
+        fflush(stdout);
+    }
+    fprintf(stderr, "\nlog_decoder: %lu frames, %lu text bytes, %lu corrupt frames, %lu bad records\n",
+            (unsigned long)decoder.frames, (unsigned long)decoder.textBytes, (unsigned long)decoder.crcErrors,
+            (unsigned long)decoder.badRecords);
+    return decoder.crcErrors == 0 && decoder.badRecords == 0 ? 0 : 1;
+}
+
+// ==================== SELF TEST ====================
+static int failures = 0;
+
+static void collect(const uint8_t* data, size_t length, void* context) {
+    static_cast<std::vector<uint8_t>*>(context)->insert(static_cast<std::vector<uint8_t>*>(context)->end(), data,
+                                                        data + length);
+}
+
+// Message text after the "[timestamp] L " prefix
+static std::string message_of(const std::string& line) {
+    size_t close = line.find("] ");
+    return close == std::string::npos || close + 4 > line.size() ? line : line.substr(close + 4);
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-security"
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+template <typename... Args>
+static void expect(DeferredLog& log, std::vector<std::string>& expected, bool* covered, LogMessageId id,
+                   Args... args) {
+    char text[LOG_MAX_LINE];
+    snprintf(text, sizeof(text), LOG_MESSAGE_FORMATS[id], args...);
+    expected.push_back(text);
+    covered[id] = true;
+    log.write(id, args...);
+}
+#pragma GCC diagnostic pop
+
+static void test_formats() {
+    static DeferredLog log;
+    std::vector<std::string> expected;
+    bool covered[LOG_MESSAGE_COUNT] = {};
+    covered[LOG_MSG_DROPPED] = true;   // Checked by test_drops()
+
+    expect(log, expected, covered, LOG_MSG_PATTERN, "Stormy");
+    expect(log, expected, covered, LOG_MSG_READING, 12UL, 24.5f, 40.25f, 98000.5f, 88.0f, 300.0f);
+    expect(log, expected, covered, LOG_MSG_AVERAGE, 24.123f, 41.5f, 98012.34f, 88.0f, "Indoor", 321.0f, "Good");
+    expect(log, expected, covered, LOG_MSG_PREDICTION, 3UL, "Sunny", 4, 812UL);
+    expect(log, expected, covered, LOG_MSG_PIPELINE_FULL);
+    expect(log, expected, covered, LOG_MSG_RBE_SUPPRESSED);
+    expect(log, expected, covered, LOG_MSG_SINK_RESULT, "ThingSpeak", "ok");
+    expect(log, expected, covered, LOG_MSG_SINK_WAITING, "Firebase", "offline");
+    expect(log, expected, covered, LOG_MSG_TS_NO_WIFI);
+    expect(log, expected, covered, LOG_MSG_TS_OPEN, 30UL);
+    expect(log, expected, covered, LOG_MSG_TS_UPLOAD, " (probe)");
+    expect(log, expected, covered, LOG_MSG_TS_DNS_FAILED);
+    expect(log, expected, covered, LOG_MSG_TS_CONNECT_FAILED);
+    expect(log, expected, covered, LOG_MSG_TS_SEND_FAILED);
+    expect(log, expected, covered, LOG_MSG_TS_NO_RESPONSE);
+    expect(log, expected, covered, LOG_MSG_TS_MALFORMED);
+    expect(log, expected, covered, LOG_MSG_TS_OK, "4711");
+    expect(log, expected, covered, LOG_MSG_TS_HTTP, -11);
+    expect(log, expected, covered, LOG_MSG_FB_QUEUED, 7UL, "Rainy", 1760000000123ULL, 3u, 10u);
+    expect(log, expected, covered, LOG_MSG_FB_NOT_READY);
+    expect(log, expected, covered, LOG_MSG_FB_FLUSH, " (probe)", 10u, 3, 2048u, 812UL, "HTTP", 200);
+    expect(log, expected, covered, LOG_MSG_FB_BOOT, "info node (changed)");
+    expect(log, expected, covered, LOG_MSG_FB_ROLLUP_DROPPED, 2UL, 37UL);
+
+    // Long strings are cut to LOG_MAX_STRING
+    const char* longEntry = "0123456789012345678901234567890123456789";
+    log.write(LOG_MSG_TS_OK, longEntry);
+    expected.push_back(std::string("thingspeak: uploaded, entry ") + std::string(longEntry, LOG_MAX_STRING));
+
+    for (int id = 0; id < LOG_MESSAGE_COUNT; id++) {
+        if (!covered[id]) {
+            printf("   message %d has no format test\n", id);
+            failures++;
+        }
+    }
+
+    // Frames interleaved with text, decoded from one stream
+    std::vector<uint8_t> stream;
+    const char* noise = "📤 text from loop() without a newline ";
+    while (log.drain(collect, &stream, true, 1) > 0) {
+        stream.insert(stream.end(), noise, noise + strlen(noise));
+    }
+    LogStreamDecoder decoder;
+    std::string out;
+    for (uint8_t b : stream) decoder.feed(b, out);
+
+    std::vector<std::string> lines;
+    size_t start = 0;
+    for (size_t nl; (nl = out.find('\n', start)) != std::string::npos; start = nl + 1) {
+        std::string line = out.substr(start, nl - start);
+        if (line.compare(0, 1, "[") == 0) lines.push_back(message_of(line));
+    }
+    size_t mismatches = lines.size() == expected.size() ? 0 : 1;
+    for (size_t i = 0; i < lines.size() && i < expected.size(); i++) {
+        if (lines[i] != expected[i]) {
+            printf("   decoded \"%s\"\n   printf  \"%s\"\n", lines[i].c_str(), expected[i].c_str());
+            mismatches++;
+        }
+    }
+    if (decoder.crcErrors || decoder.badRecords) mismatches++;
+    printf("   Formats: %zu messages decoded from a mixed stream, %zu mismatches vs printf\n", lines.size(),
+           mismatches);
+    failures += (int)mismatches;
+
+    // A wrong argument kind is flagged, not misprinted
+    uint8_t record[1 + LOG_MAX_RECORD];
+    LogRecordWriter w(record, sizeof(record));
+    uint32_t ts = 0;
+    uint16_t id = LOG_MSG_TS_HTTP;
+    w.raw(&ts, 4);
+    w.raw(&id, 2);
+    log_arg(w, "not a number");
+    char line[LOG_MAX_LINE];
+    if (log_format_line(record, w.length(record), line, sizeof(line))) {
+        printf("   mismatched argument accepted: %s\n", line);
+        failures++;
+    }
+}
+
+static void test_drops() {
+    static DeferredLog log;
+    const uint32_t attempts = 1000;
+    for (uint32_t i = 0; i < attempts; i++) log.write(LOG_MSG_PREDICTION, (unsigned long)i, "Cloudy", 0, 700UL);
+    LogStats before = log.getStats();
+
+    std::vector<uint8_t> stream;
+    while (log.drain(collect, &stream, true, 64) > 0) {
+    }
+    LogStreamDecoder decoder;
+    std::string out;
+    for (uint8_t b : stream) decoder.feed(b, out);
+    char dropLine[64];
+    snprintf(dropLine, sizeof(dropLine), "log: %lu records dropped", (unsigned long)before.dropped);
+
+    bool ok = before.dropped > 0 && before.records + before.dropped == attempts &&
+              decoder.frames == before.records + 1 && out.find(dropLine) != std::string::npos &&
+              before.highWater <= LOG_BUFFER_SIZE;
+    printf("   Full ring: %lu kept (%lu B high-water), %lu dropped and reported: %s\n",
+           (unsigned long)before.records, (unsigned long)before.highWater, (unsigned long)before.dropped,
+           ok ? "ok" : "FAIL");
+    if (!ok) failures++;
+}
+
+static void test_threads() {
+    static DeferredLog log;
+    const unsigned long perWriter = 200000;
+    std::atomic<bool> writing(true);
+    std::vector<uint8_t> stream;
+    stream.reserve(16 << 20);
+
+    std::thread drainer([&] {
+        while (writing.load() || log.getDepth() > 0) {
+            if (log.drain(collect, &stream, true, 64) == 0) std::this_thread::yield();
+        }
+        log.drain(collect, &stream, true, 64);   // Final drop report
+    });
+    auto writer = [&](const char* name) {
+        for (unsigned long i = 0; i < perWriter; i++) {
+            log.write(LOG_MSG_PREDICTION, i, name, 1, 0UL);
+            if ((i & 15) == 15) std::this_thread::yield();   // Let the drain run on small hosts
+        }
+    };
+    std::thread a(writer, "A"), b(writer, "B");
+    a.join();
+    b.join();
+    writing.store(false);
+    drainer.join();
+
+    // Each writer's records must arrive in order
+    LogStreamDecoder decoder;
+    std::string out;
+    for (uint8_t byte : stream) decoder.feed(byte, out);
+    long last[2] = { -1, -1 };
+    unsigned long received = 0, reordered = 0, reportedDrops = 0;
+    size_t start = 0;
+    for (size_t nl; (nl = out.find('\n', start)) != std::string::npos; start = nl + 1) {
+        std::string line = message_of(out.substr(start, nl - start));
+        unsigned long seq, dropped;
+        char name[8];
+        if (sscanf(line.c_str(), "predict: #%lu %7s", &seq, name) == 2) {
+            int k = name[0] == 'A' ? 0 : 1;
+            if ((long)seq <= last[k]) reordered++;
+            last[k] = (long)seq;
+            received++;
+        } else if (sscanf(line.c_str(), "log: %lu records dropped", &dropped) == 1) {
+            reportedDrops += dropped;
+        }
+    }
+    LogStats s = log.getStats();
+    bool ok = reordered == 0 && decoder.crcErrors == 0 && received == s.records &&
+              received + s.dropped == 2 * perWriter && reportedDrops == s.dropped;
+    printf("   Two writers + drain thread: %lu written, %lu decoded, %lu dropped (%lu reported), %lu reordered: %s\n",
+           2 * perWriter, received, (unsigned long)s.dropped, reportedDrops, reordered, ok ? "ok" : "FAIL");
+    if (!ok) failures++;
+}
+
+static int evaluations = 0;
+static float counted(float v) {
+    evaluations++;
+    return v;
+}
+
+static void test_levels() {
+    LOG(LOG_MSG_READING, 1UL, counted(1), counted(2), counted(3), counted(4), counted(5));   // DEBUG: stripped
+    int stripped = evaluations;
+    LOG(LOG_MSG_AVERAGE, counted(1), counted(2), counted(3), counted(4), "Dim", counted(5), "Good");   // INFO
+    bool ok = stripped == 0 && evaluations == 5 && deferred_log().getStats().records == 1;
+    printf("   Level stripping (LOG_LEVEL INFO): DEBUG call evaluated %d arguments, INFO call %d: %s\n", stripped,
+           evaluations - stripped, ok ? "ok" : "FAIL");
+    if (!ok) failures++;
+}
+
+static void sink_null(const uint8_t*, size_t, void*) {}
+
+// One 15 s cycle as the sketch logs it: 15 readings (DEBUG builds), one
+// average + prediction, two upload outcomes
+static void cycle(DeferredLog& log, unsigned long n) {
+    for (unsigned long r = 0; r < 15; r++) {
+        log.write(LOG_MSG_READING, n * 15 + r, 24.1f, 40.2f, 98012.0f, 88.0f, 300.0f);
+    }
+    log.write(LOG_MSG_AVERAGE, 24.12f, 40.21f, 98012.34f, 88.02f, "Indoor", 300.5f, "Good");
+    log.write(LOG_MSG_PREDICTION, n, "Cloudy", 0, 812UL);
+    log.write(LOG_MSG_SINK_RESULT, "ThingSpeak", "ok");
+    log.write(LOG_MSG_TS_OK, "4711");
+}
+
+// The same cycle as the sketch printed it before (readings, prediction
+// block, ThingSpeak upload block), for the byte count
+static size_t previous_cycle_bytes() {
+    static const char* const RULE = "═══════════════════════════════════════════════════════════\n";
+    static const char* const THIN = "─────────────────────────────────────────────────────────\n";
+    static const char* const HEAVY = "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n";
+    char line[256];
+    size_t total = 0;
+    auto add = [&](int n) { total += n > 0 ? (size_t)n : 0; };
+    for (unsigned long r = 1; r <= 15; r++) {
+        add(snprintf(line, sizeof(line), "[%02lu:%02lu] Reading #%lu: ", r / 60, r % 60, r));
+        add(snprintf(line, sizeof(line), "🌡️ %.1f°C | 💧 %.1f%% | 🌀 %.0fPa | 💡 %.0flux | 🌫️ %.0fppm\n", 24.1,
+                     40.2, 98012.0, 88.0, 300.0));
+    }
+    add(1);
+    add((int)strlen(RULE));
+    add((int)strlen("🔮 MAKING PREDICTION (15-second averaged data - 15 samples)\n"));
+    add((int)strlen(RULE));
+    add((int)strlen("📊 Averaged Sensor Data:\n"));
+    add((int)strlen(THIN));
+    add(snprintf(line, sizeof(line), "   🌡️  Temperature: %.2f °C\n", 24.12));
+    add(snprintf(line, sizeof(line), "   💧 Humidity:    %.2f %%\n", 40.21));
+    add(snprintf(line, sizeof(line), "   🌀 Pressure:    %.2f Pa (%.2f hPa)\n", 98012.34, 980.12));
+    add(snprintf(line, sizeof(line), "   💡 Light (Lux): %.2f lux (%s)\n", 88.02, "Indoor"));
+    add(snprintf(line, sizeof(line), "   🌫️  Gas (PPM):   %.2f ppm (%s)\n", 300.5, "Good"));
+    add((int)strlen(THIN));
+    add(1);
+    add((int)strlen("🎯 Prediction Result:\n"));
+    add((int)strlen(THIN));
+    add(snprintf(line, sizeof(line), "   Weather:    %s %s\n", "☁️", "Cloudy"));
+    add(snprintf(line, sizeof(line), "   Class ID:   %d\n", 0));
+    add(snprintf(line, sizeof(line), "   Inference:  %lu µs (%.3f ms)\n", 812UL, 0.812));
+    add(snprintf(line, sizeof(line), "   Prediction: #%lu\n", 1UL));
+    add((int)strlen(THIN));
+    add((int)strlen(RULE));
+    add(1);
+    add((int)strlen(HEAVY) * 2);
+    add((int)strlen("☁️  Uploading to ThingSpeak...\n"));
+    add((int)strlen("   🔍 Validating connection...\n"));
+    add(snprintf(line, sizeof(line), "   ✅ DNS OK: %s\n", "184.106.153.149"));
+    add((int)strlen("   📡 Sending data...\n"));
+    add(snprintf(line, sizeof(line), "   📥 Response: HTTP %d\n", 200));
+    add((int)strlen("   ✅ Data uploaded successfully!\n"));
+    add(snprintf(line, sizeof(line), "   Entry ID: %s\n", "4711"));
+    add(1);
+    add(snprintf(line, sizeof(line), "\n📤 Telemetry: %s %s \n", "ThingSpeak", "✅"));
+    return total;
+}
+
+static void bench() {
+    static DeferredLog log;
+    const unsigned long cycles = 20000;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long n = 0; n < cycles; n++) {
+        cycle(log, n);
+        log.drain(sink_null, nullptr, true, 64);   // Keep the ring from filling
+    }
+    double total = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    // Write-only cost (the part the sampling path pays)
+    static DeferredLog writeOnly;
+    start = std::chrono::steady_clock::now();
+    const unsigned long writes = 100;
+    for (unsigned long i = 0; i < writes; i++) {
+        writeOnly.write(LOG_MSG_AVERAGE, 24.12f, 40.21f, 98012.34f, 88.02f, "Indoor", 300.5f, "Good");
+    }
+    double writeNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    char line[LOG_MAX_LINE];
+    start = std::chrono::steady_clock::now();
+    volatile size_t sink = 0;
+    for (unsigned long i = 0; i < writes; i++) {
+        sink = sink + (size_t)snprintf(line, sizeof(line), LOG_MESSAGE_FORMATS[LOG_MSG_AVERAGE], 24.12, 40.21,
+                                       98012.34, 88.02, "Indoor", 300.5, "Good");
+    }
+    double formatNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    // Bytes per cycle: frames vs the same lines as text
+    static DeferredLog sizes;
+    cycle(sizes, 1);
+    std::vector<uint8_t> frames, text;
+    sizes.drain(collect, &frames, true, 64);
+    cycle(sizes, 1);
+    sizes.drain(collect, &text, false, 64);
+    const double uartBytesPerMs = 115200.0 / 10.0 / 1000.0;   // 8N1
+    printf("\n   Cost: LOG() %.0f ns vs snprintf of the same line %.0f ns; %.1f us per logged cycle incl. drain\n",
+           writeNs / writes, formatNs / writes, total / cycles / 1000.0);
+    printf("   Per 15 s cycle (DEBUG build): frames %zu B = %.1f ms of UART, text %zu B = %.1f ms at 115200 baud\n",
+           frames.size(), frames.size() / uartBytesPerMs, text.size(), text.size() / uartBytesPerMs);
+    size_t previous = previous_cycle_bytes();
+    printf("   Previous direct Serial output: %zu B = %.1f ms per cycle, on the sampling/upload path\n", previous,
+           previous / uartBytesPerMs);
+}
+
+static int selftest() {
+    printf("Deferred log self test (ring %d B, record <= %d B, level %s)\n\n", LOG_BUFFER_SIZE, LOG_MAX_RECORD,
+           LOG_LEVEL_NAMES[LOG_LEVEL]);
+    test_formats();
+    test_drops();
+    test_threads();
+    test_levels();
+    bench();
+    printf("\n%s\n", failures == 0 ? "PASS: every record decoded as printf would print it, drops accounted"
+                                   : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
+
+// ==================== MAIN ====================
+static speed_t baud_constant(long baud) {
+    switch (baud) {
+        case 9600: return B9600;
+        case 57600: return B57600;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+        default: return B115200;
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* port = nullptr;
+    const char* file = nullptr;
+    long baud = 115200;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--selftest") == 0) return selftest();
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) port = argv[++i];
+        else if (strcmp(argv[i], "--baud") == 0 && i + 1 < argc) baud = atol(argv[++i]);
+        else if (argv[i][0] != '-' && file == nullptr) file = argv[i];
+        else {
+            fprintf(stderr, "Usage: log_decoder [--port DEV [--baud N] | FILE] | --selftest\n");
+            return 2;
+        }
+    }
+
+    int fd = STDIN_FILENO;
+    if (port || file) {
+        fd = open(port ? port : file, O_RDONLY | O_NOCTTY);
+        if (fd < 0) {
+            perror(port ? port : file);
+            return 1;
+        }
+    }
+    if (port) {
+        struct termios tio;
+        if (tcgetattr(fd, &tio) == 0) {
+            cfmakeraw(&tio);
+            cfsetispeed(&tio, baud_constant(baud));
+            cfsetospeed(&tio, baud_constant(baud));
+            tcsetattr(fd, TCSANOW, &tio);
+        }
+    }
+    int result = decode_stream(fd);
+    if (fd != STDIN_FILENO) close(fd);
+    return result;
+}
@@ -0,0 +1,320 @@
+/*
+ * MQTT Broker Stand-in - Minimal local broker + HTTP endpoint for uplink tests
+ *
+ * Implements just enough MQTT 3.1.1 for MqttUplink (mqtt_uplink.h):
+ * - CONNECT/CONNACK with session-present for known client IDs (clean session 0)
+ * - PUBLISH QoS 0/1 with PUBACK, DUP counting, PINGREQ/PINGRESP, DISCONNECT
+ * - Optional simulated network delay on every ack (pipelined, not serialized)
+ * - Optional ack dropping to exercise QoS 1 retransmission
+ *
+ * Also answers ThingSpeak-style "GET /update?..." requests on a second port
+ * (one request per connection, like api.thingspeak.com) so the HTTP path can
+ * be measured against the same machine.
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread mqtt_broker_standin.cpp -o mqtt_broker_standin
+ *
+ * Usage:
+ *   ./mqtt_broker_standin [--mqtt-port 1883] [--http-port 8080]
+ *                         [--delay-ms 0] [--drop-every 0] [--verbose]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+struct BrokerOptions {
+    int mqttPort = 1883;
+    int httpPort = 8080;
+    int delayMs = 0;
+    int dropEvery = 0;      // Drop every Nth PUBACK (0 = never)
+    bool verbose = false;
+};
+
+static BrokerOptions options;
+
+static std::atomic<unsigned long> mqttConnects(0);
+static std::atomic<unsigned long> mqttPublishes(0);
+static std::atomic<unsigned long> mqttDuplicates(0);
+static std::atomic<unsigned long> mqttBytesIn(0);
+static std::atomic<unsigned long> mqttBytesOut(0);
+static std::atomic<unsigned long> httpRequests(0);
+static std::atomic<unsigned long> httpBytesIn(0);
+static std::atomic<unsigned long> httpBytesOut(0);
+
+static std::mutex sessionsMutex;
+static std::set<std::string> knownSessions;
+
+typedef std::chrono::steady_clock Clock;
+
+// ==================== HELPERS ====================
+static int open_listener(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((uint16_t)port);
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 16) < 0) {
+        perror("bind/listen");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool send_all(int fd, const uint8_t* data, size_t length) {
+    size_t sent = 0;
+    while (sent < length) {
+        ssize_t n = send(fd, data + sent, length - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += (size_t)n;
+    }
+    return true;
+}
+
+// ==================== MQTT ====================
+struct PendingReply {
+    Clock::time_point due;
+    uint8_t bytes[4];
+    size_t length;
+};
+
+static void queue_reply(std::deque<PendingReply>& replies, const uint8_t* bytes, size_t length) {
+    PendingReply reply;
+    reply.due = Clock::now() + std::chrono::milliseconds(options.delayMs);
+    memcpy(reply.bytes, bytes, length);
+    reply.length = length;
+    replies.push_back(reply);
+}
+
+// Returns false when the client disconnected
+static bool handle_mqtt_packet(int fd, const uint8_t* packet, size_t headerLength, size_t remaining,
+                               std::deque<PendingReply>& replies, std::string& clientId) {
+    const uint8_t type = packet[0] & 0xF0;
+    const uint8_t* body = packet + headerLength;
+
+    if (type == 0x10) {   // CONNECT
+        if (remaining < 12) return false;
+        uint8_t flags = body[7];
+        size_t idLength = ((size_t)body[10] << 8) | body[11];
+        clientId.assign((const char*)body + 12, idLength);
+        bool cleanSession = (flags & 0x02) != 0;
+
+        bool present;
+        {
+            std::lock_guard<std::mutex> lock(sessionsMutex);
+            present = !cleanSession && knownSessions.count(clientId) > 0;
+            if (cleanSession) knownSessions.erase(clientId);
+            else knownSessions.insert(clientId);
+        }
+        mqttConnects++;
+        if (options.verbose) {
+            fprintf(stderr, "🔌 CONNECT %s (clean=%d, session present=%d)\n",
+                    clientId.c_str(), cleanSession, present);
+        }
+        const uint8_t connack[4] = { 0x20, 0x02, (uint8_t)(present ? 1 : 0), 0x00 };
+        queue_reply(replies, connack, 4);
+        return true;
+    }
+
+    if (type == 0x30) {   // PUBLISH
+        uint8_t qos = (packet[0] >> 1) & 0x03;
+        bool dup = (packet[0] & 0x08) != 0;
+        size_t topicLength = ((size_t)body[0] << 8) | body[1];
+        mqttPublishes++;
+        if (dup) mqttDuplicates++;
+        if (options.verbose) {
+            fprintf(stderr, "📨 PUBLISH %.*s qos=%u dup=%d %zu B\n", (int)topicLength,
+                    (const char*)body + 2, qos, dup, remaining);
+        }
+        if (qos == 1) {
+            const uint8_t* id = body + 2 + topicLength;
+            if (options.dropEvery > 0 && mqttPublishes % (unsigned long)options.dropEvery == 0) {
+                return true;
+            }
+            const uint8_t puback[4] = { 0x40, 0x02, id[0], id[1] };
+            queue_reply(replies, puback, 4);
+        }
+        return true;
+    }
+
+    if (type == 0xC0) {   // PINGREQ
+        const uint8_t pingresp[2] = { 0xD0, 0x00 };
+        queue_reply(replies, pingresp, 2);
+        return true;
+    }
+
+    if (type == 0xE0) {   // DISCONNECT
+        return false;
+    }
+    (void)fd;
+    return true;
+}
+
+static void serve_mqtt(int fd) {
+    std::vector<uint8_t> buffer;
+    std::deque<PendingReply> replies;
+    std::string clientId;
+    uint8_t chunk[4096];
+    bool open = true;
+
+    while (open || !replies.empty()) {
+        // Send replies whose simulated delay has elapsed
+        Clock::time_point now = Clock::now();
+        while (!replies.empty() && replies.front().due <= now) {
+            if (!send_all(fd, replies.front().bytes, replies.front().length)) {
+                open = false;
+                replies.clear();
+                break;
+            }
+            mqttBytesOut += replies.front().length;
+            replies.pop_front();
+        }
+        if (!open) break;
+
+        int timeout = -1;
+        if (!replies.empty()) {
+            timeout = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+                replies.front().due - now).count();
+            if (timeout < 0) timeout = 0;
+        }
+        pollfd pfd = { fd, POLLIN, 0 };
+        if (poll(&pfd, 1, timeout) <= 0) continue;
+
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) break;
+        mqttBytesIn += (unsigned long)n;
+        buffer.insert(buffer.end(), chunk, chunk + n);
+
+        size_t offset = 0;
+        while (buffer.size() - offset >= 2) {
+            size_t remaining = 0, multiplier = 1, headerLength = 1;
+            bool complete = false;
+            while (offset + headerLength < buffer.size() && headerLength <= 4) {
+                uint8_t digit = buffer[offset + headerLength++];
+                remaining += (digit & 0x7F) * multiplier;
+                multiplier *= 128;
+                if ((digit & 0x80) == 0) { complete = true; break; }
+            }
+            if (!complete || offset + headerLength + remaining > buffer.size()) break;
+            if (!handle_mqtt_packet(fd, buffer.data() + offset, headerLength, remaining,
+                                    replies, clientId)) {
+                open = false;
+            }
+            offset += headerLength + remaining;
+        }
+        buffer.erase(buffer.begin(), buffer.begin() + (long)offset);
+    }
+    if (options.verbose) fprintf(stderr, "🔌 %s disconnected\n", clientId.c_str());
+    close(fd);
+}
+
+// ==================== HTTP ====================
+static void serve_http(int fd) {
+    std::string request;
+    char chunk[2048];
+    while (request.find("\r\n\r\n") == std::string::npos) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            close(fd);
+            return;
+        }
+        request.append(chunk, (size_t)n);
+    }
+    httpBytesIn += request.size();
+    unsigned long entry = ++httpRequests;
+
+    if (options.delayMs > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(options.delayMs));
+    }
+
+    // Same shape as api.thingspeak.com: small body with the new entry id
+    char body[16];
+    int bodyLength = snprintf(body, sizeof(body), "%lu", entry);
+    char response[256];
+    int length = snprintf(response, sizeof(response),
+                          "HTTP/1.1 200 OK\r\n"
+                          "Content-Type: text/plain; charset=utf-8\r\n"
+                          "Content-Length: %d\r\n"
+                          "Connection: close\r\n"
+                          "\r\n%s", bodyLength, body);
+    if (send_all(fd, (const uint8_t*)response, (size_t)length)) {
+        httpBytesOut += (unsigned long)length;
+    }
+    if (options.verbose) {
+        fprintf(stderr, "🌐 %.*s\n", (int)request.find("\r\n"), request.c_str());
+    }
+    close(fd);
+}
+
+static void accept_loop(int listener, void (*serve)(int)) {
+    for (;;) {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) continue;
+        int yes = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        std::thread(serve, fd).detach();
+    }
+}
+
+// ==================== MAIN ====================
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--mqtt-port") == 0 && i + 1 < argc) options.mqttPort = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--http-port") == 0 && i + 1 < argc) options.httpPort = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--delay-ms") == 0 && i + 1 < argc) options.delayMs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--drop-every") == 0 && i + 1 < argc) options.dropEvery = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--verbose") == 0) options.verbose = true;
+        else {
+            fprintf(stderr, "Usage: mqtt_broker_standin [--mqtt-port P] [--http-port P] "
+                            "[--delay-ms D] [--drop-every N] [--verbose]\n");
+            return 2;
+        }
+    }
+
+    int mqttListener = open_listener(options.mqttPort);
+    int httpListener = open_listener(options.httpPort);
+    if (mqttListener < 0 || httpListener < 0) return 1;
+
+    fprintf(stderr, "📡 MQTT stand-in on :%d, HTTP on :%d (delay %d ms, drop every %d)\n",
+            options.mqttPort, options.httpPort, options.delayMs, options.dropEvery);
+
+    std::thread(accept_loop, mqttListener, serve_mqtt).detach();
+    std::thread(accept_loop, httpListener, serve_http).detach();
+
+    unsigned long lastPublishes = 0, lastRequests = 0;
+    for (;;) {
+        std::this_thread::sleep_for(std::chrono::seconds(10));
+        if (mqttPublishes == lastPublishes && httpRequests == lastRequests) continue;
+        lastPublishes = mqttPublishes;
+        lastRequests = httpRequests;
+        fprintf(stderr, "📊 MQTT: %lu connects, %lu publishes (%lu dup), %lu B in / %lu B out | "
+                        "HTTP: %lu requests, %lu B in / %lu B out\n",
+                mqttConnects.load(), mqttPublishes.load(), mqttDuplicates.load(),
+                mqttBytesIn.load(), mqttBytesOut.load(),
+                httpRequests.load(), httpBytesIn.load(), httpBytesOut.load());
+    }
+}
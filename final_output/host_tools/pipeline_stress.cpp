@@ -0,0 +1,201 @@
+/*
+ * Pipeline Stress Test - Dual-core telemetry pipeline on std::thread
+ *
+ * Builds telemetry_pipeline.h against the host backend of task_port.h and
+ * pushes records through it far faster than the device ever does:
+ * - acquire thread (pinned to CPU 1): random scaled features through the
+ *   real 250-tree model, one TelemetryRecord per prediction, submit()
+ * - network thread (pinned to CPU 0): drain() into a handler that checks
+ *   ordering and simulates an upload of --upload-us, with a --stall-ms
+ *   stall every --stall-every records (a TLS handshake, a timeout)
+ *
+ * The same workload then runs sequentially on one thread (predict, then
+ * upload, as the single loop() did) for comparison.
+ *
+ * Reports per-stage throughput and busy time, queue latency p50/p99/max,
+ * depth high-water mark and drops. Exits non-zero if a record arrives out
+ * of order or one is lost without being counted as a drop.
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread -I../esp32_code pipeline_stress.cpp -o pipeline_stress
+ *
+ * Usage:
+ *   ./pipeline_stress [--seconds 5] [--rate 0] [--upload-us 200] [--stall-ms 20] [--stall-every 500]
+ *   (--rate 0 = produce as fast as the model runs)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <random>
+
+#include "weather_model_250.h"
+#include "telemetry_pipeline.h"
+
+struct StressConfig {
+    double seconds;
+    uint32_t rate;          // Records/s, 0 = unpaced
+    uint32_t uploadUs;
+    uint32_t stallMs;
+    uint32_t stallEvery;
+};
+
+static StressConfig config;
+static TelemetryPipeline pipeline;
+static std::atomic<bool> producing(true);
+static std::atomic<bool> consuming(true);
+static uint64_t produced = 0;
+
+struct ConsumerState {
+    uint64_t received;
+    uint64_t nextSeq;
+    uint64_t gaps;          // Missing sequence numbers (must equal drops)
+    uint64_t outOfOrder;
+};
+static ConsumerState consumer;
+
+static void spin_us(uint32_t us) {
+    uint32_t start = port_micros();
+    while (port_micros() - start < us) {
+    }
+}
+
+// Simulated upload: CPU-bound send plus the occasional blocking stall
+static void upload(uint64_t seq) {
+    spin_us(config.uploadUs);
+    if (config.stallEvery > 0 && seq % config.stallEvery == 0) {
+        port_delay_ms(config.stallMs);
+    }
+}
+
+static int predict_one(Eloquent::ML::Port::RandomForest& model, std::mt19937& rng, TelemetryRecord& r,
+                       uint64_t seq) {
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    float x[4] = { unit(rng), unit(rng), unit(rng), unit(rng) };
+    memset(&r, 0, sizeof(r));
+    uint32_t start = port_micros();
+    r.predictedClass = (uint8_t)model.predict(x, r.votes);
+    r.inferenceTime = port_micros() - start;
+    r.timestampMs = seq;    // Sequence number for the ordering check
+    r.temperature = x[0];
+    r.humidity = x[1];
+    r.pressure = x[2];
+    r.lux = x[3];
+    return r.predictedClass;
+}
+
+// ==================== PIPELINE ====================
+static void handle_record(const TelemetryRecord& record, void* context) {
+    ConsumerState& state = *static_cast<ConsumerState*>(context);
+    uint64_t seq = record.timestampMs;
+    if (seq < state.nextSeq) {
+        state.outOfOrder++;
+    } else {
+        state.gaps += seq - state.nextSeq;
+        state.nextSeq = seq + 1;
+    }
+    state.received++;
+    upload(seq);
+}
+
+static void acquire_task(void*) {
+    Eloquent::ML::Port::RandomForest model;
+    std::mt19937 rng(11);
+    uint32_t periodUs = config.rate ? 1000000 / config.rate : 0;
+    uint32_t next = port_micros();
+    while (producing.load()) {
+        uint32_t start = port_micros();
+        TelemetryRecord record;
+        predict_one(model, rng, record, produced);
+        pipeline.submit(record, port_micros() - start);
+        produced++;
+        if (periodUs) {
+            next += periodUs;
+            while ((int32_t)(next - port_micros()) > 0) {
+            }
+        }
+    }
+}
+
+static void network_task(void*) {
+    while (consuming.load() || pipeline.getDepth() > 0) {
+        pipeline.drain(handle_record, &consumer, 10);
+    }
+}
+
+// ==================== SEQUENTIAL ====================
+static uint64_t run_sequential(double seconds) {
+    Eloquent::ML::Port::RandomForest model;
+    std::mt19937 rng(11);
+    uint64_t count = 0;
+    uint32_t startMs = port_millis();
+    while (port_millis() - startMs < (uint32_t)(seconds * 1000.0)) {
+        TelemetryRecord record;
+        predict_one(model, rng, record, count);
+        upload(count);
+        count++;
+    }
+    return count;
+}
+
+int main(int argc, char** argv) {
+    config.seconds = 5.0;
+    config.rate = 0;
+    config.uploadUs = 200;
+    config.stallMs = 20;
+    config.stallEvery = 500;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) config.seconds = atof(argv[++i]);
+        else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) config.rate = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--upload-us") == 0 && i + 1 < argc) config.uploadUs = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--stall-ms") == 0 && i + 1 < argc) config.stallMs = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--stall-every") == 0 && i + 1 < argc) config.stallEvery = (uint32_t)atoi(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: pipeline_stress [--seconds S] [--rate N] [--upload-us N] [--stall-ms N] "
+                            "[--stall-every N]\n");
+            return 2;
+        }
+    }
+
+    printf("Pipeline stress: %.1f s, rate %s, upload %lu us, stall %lu ms every %lu records, queue depth %d\n",
+           config.seconds, config.rate ? "paced" : "unpaced", (unsigned long)config.uploadUs,
+           (unsigned long)config.stallMs, (unsigned long)config.stallEvery, PIPELINE_QUEUE_DEPTH);
+
+    memset(&consumer, 0, sizeof(consumer));
+    pipeline.begin();
+    PortTask acquire, network;
+    network.start("network", network_task, nullptr, 0, 1, 0);
+    acquire.start("acquire", acquire_task, nullptr, 0, 1, 1);
+    port_delay_ms((uint32_t)(config.seconds * 1000.0));
+    producing.store(false);
+    acquire.join();
+    consuming.store(false);
+    network.join();
+
+    const LatencyHistogram& latency = pipeline.getQueueLatency();
+    printf("\n   Stage       items      per s   busy avg   busy max\n");
+    for (int i = 0; i < PIPELINE_STAGE_COUNT; i++) {
+        const PipelineStageStats& s = pipeline.getStage(i);
+        printf("   %-9s %7lu %10.0f %8.1f us %8lu us\n", PIPELINE_STAGE_NAMES[i], (unsigned long)s.items,
+               s.items / config.seconds, TelemetryPipeline::meanBusyUs(s), (unsigned long)s.busyMaxUs);
+    }
+    printf("\n   Queue latency: p50 %lu us | p99 %lu us | max %lu us\n", (unsigned long)latency.percentile(50),
+           (unsigned long)latency.percentile(99), (unsigned long)latency.max());
+    printf("   Queue: high-water %lu/%d, dropped %lu\n", (unsigned long)pipeline.getHighWater(),
+           PIPELINE_QUEUE_DEPTH, (unsigned long)pipeline.getDropped());
+    printf("   Consumer: received %llu of %llu, gaps %llu, out of order %llu\n",
+           (unsigned long long)consumer.received, (unsigned long long)produced,
+           (unsigned long long)consumer.gaps, (unsigned long long)consumer.outOfOrder);
+
+    uint64_t sequential = run_sequential(config.seconds);
+    printf("\n   Sequential (one thread, predict then upload): %.0f records/s\n", sequential / config.seconds);
+    printf("   Pipeline end-to-end (records uploaded):        %.0f records/s\n", consumer.received / config.seconds);
+
+    bool accounted = consumer.received + pipeline.getDropped() == produced && consumer.gaps == pipeline.getDropped();
+    bool ok = accounted && consumer.outOfOrder == 0;
+    printf("\n%s\n", ok ? "PASS: every record delivered in order or counted as dropped"
+                        : "FAIL: records lost or reordered");
+    return ok ? 0 : 1;
+}
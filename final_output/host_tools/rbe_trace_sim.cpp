@@ -0,0 +1,222 @@
+/*
+ * Report-by-Exception Trace Simulator
+ *
+ * Replays a telemetry trace through ReportByException (the same header the
+ * ESP32 uses) and measures:
+ * - records reported vs suppressed (by reason)
+ * - upload bytes saved for ThingSpeak (URL) and Firebase (JSON)
+ * - reconstruction error of a sample-and-hold dashboard vs the true trace
+ *
+ * Traces:
+ * - default: 24 h synthetic day at the device cadence (one record / 15 s):
+ *   diurnal temperature/humidity, pressure fronts, day/night light with
+ *   passing clouds, slow gas drift, sensor noise, classes from the
+ *   training-label rules
+ * - --replay FILE: the LocalFileSink CSV (/telemetry.csv) pulled from a device
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -I../esp32_code rbe_trace_sim.cpp -o rbe_trace_sim
+ *
+ * Usage:
+ *   ./rbe_trace_sim [--hours 24] [--replay telemetry.csv] [--heartbeat-s 300]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <random>
+#include <vector>
+
+#include "telemetry_record.h"
+#include "report_by_exception.h"
+
+static const double PI = 3.14159265358979323846;
+
+// Labelling rules used to build the training set (see sensor_simulate.h)
+static uint8_t label(const TelemetryRecord& r) {
+    if (r.lux > 130.0f) return 4;                                // Sunny
+    if (r.pressure < 97200.0f) return 3;                         // Stormy
+    if (r.humidity > 48.0f && r.lux < 120.0f) return 1;          // Foggy
+    if (r.pressure < 98000.0f && r.humidity > 42.0f) return 2;   // Rainy
+    return 0;                                                    // Cloudy
+}
+
+// ==================== TRACES ====================
+static void synthetic_trace(std::vector<TelemetryRecord>& trace, double hours) {
+    std::mt19937 rng(42);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+    const uint32_t stepMs = 15000;
+    size_t count = (size_t)(hours * 3600.0 * 1000.0 / stepMs);
+    trace.resize(count);
+
+    float front = 0.0f;          // Pressure anomaly from passing fronts (Pa)
+    float frontTarget = 0.0f;
+    float cloud = 0.3f;          // Cloud cover 0..1
+    float gas = 300.0f;
+
+    for (size_t i = 0; i < count; i++) {
+        TelemetryRecord& r = trace[i];
+        memset(&r, 0, sizeof(r));
+        r.timestampMs = (uint64_t)i * stepMs;
+        double hourOfDay = fmod(r.timestampMs / 3600000.0 + 6.0, 24.0);   // Trace starts 06:00
+        double day = sin((hourOfDay - 6.0) / 12.0 * PI);                   // >0 during daylight
+
+        // A new front every few hours, approached slowly
+        if (uniform(rng) < 1.0f / 960.0f) frontTarget = -1600.0f * uniform(rng) + 300.0f;
+        front += (frontTarget - front) * 0.004f;
+        cloud += noise(rng) * 0.02f + (frontTarget < -500.0f ? 0.002f : -0.001f);
+        cloud = cloud < 0.0f ? 0.0f : (cloud > 1.0f ? 1.0f : cloud);
+        gas += noise(rng) * 2.0f + (350.0f - gas) * 0.002f;
+
+        r.temperature = 23.5f + 3.5f * (float)sin((hourOfDay - 9.0) / 24.0 * 2.0 * PI) + noise(rng) * 0.05f;
+        r.humidity = 44.0f - 6.0f * (float)sin((hourOfDay - 9.0) / 24.0 * 2.0 * PI) +
+                     cloud * 6.0f + noise(rng) * 0.2f;
+        r.pressure = 98700.0f + front + noise(rng) * 5.0f;
+        float daylight = day > 0.0 ? (float)day : 0.0f;
+        r.lux = daylight * 520.0f * (1.0f - 0.85f * cloud) + noise(rng) * 3.0f;
+        if (r.lux < 0.0f) r.lux = 0.0f;
+        r.gas = gas + noise(rng) * 10.0f;
+        r.predictedClass = label(r);
+    }
+}
+
+// timestamp_ms,temperature,humidity,pressure,lux,gas_ppm,class_id,votes,inference_us,rssi
+static bool replay_trace(const char* path, std::vector<TelemetryRecord>& trace) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return false;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        TelemetryRecord r;
+        memset(&r, 0, sizeof(r));
+        unsigned long long ts;
+        unsigned cls;
+        if (sscanf(line, "%llu,%f,%f,%f,%f,%f,%u", &ts, &r.temperature, &r.humidity,
+                   &r.pressure, &r.lux, &r.gas, &cls) != 7) {
+            continue;   // Header or malformed line
+        }
+        r.timestampMs = ts;
+        r.predictedClass = (uint8_t)cls;
+        trace.push_back(r);
+    }
+    fclose(file);
+    return !trace.empty();
+}
+
+// ==================== SIMULATION ====================
+struct Preset {
+    const char* name;
+    float deadbands[RBE_NUM_FEATURES];
+};
+
+static void feature_values(const TelemetryRecord& r, float* out) {
+    out[0] = r.temperature;
+    out[1] = r.humidity;
+    out[2] = r.pressure;
+    out[3] = r.lux;
+    out[4] = r.gas;
+}
+
+static void run_preset(const Preset& preset, const std::vector<TelemetryRecord>& trace,
+                       uint32_t heartbeatMs) {
+    ReportByException filter;
+    filter.setDeadbands(preset.deadbands[0], preset.deadbands[1], preset.deadbands[2],
+                        preset.deadbands[3], preset.deadbands[4]);
+    filter.setHeartbeat(heartbeatMs);
+
+    char text[TELEMETRY_MAX_PAYLOAD];
+    const size_t urlOverhead = strlen("http://api.thingspeak.com/update?api_key=XXXXXXXXXXXXXXXX&");
+    size_t tsAll = 0, tsSent = 0, fbAll = 0, fbSent = 0;
+
+    double errorSum[RBE_NUM_FEATURES] = {0};
+    float errorMax[RBE_NUM_FEATURES] = {0};
+    float held[RBE_NUM_FEATURES] = {0};
+    uint8_t heldClass = 0;
+    size_t classMismatch = 0;
+
+    for (const TelemetryRecord& r : trace) {
+        size_t ts = (size_t)telemetry_encode_thingspeak(r, text, sizeof(text)) + urlOverhead;
+        size_t fb = (size_t)telemetry_encode_firebase_json(r, "240AC4123456", text, sizeof(text));
+        tsAll += ts;
+        fbAll += fb;
+
+        float values[RBE_NUM_FEATURES];
+        feature_values(r, values);
+        if (filter.evaluate(r, (uint32_t)r.timestampMs) != RBE_SUPPRESSED) {
+            tsSent += ts;
+            fbSent += fb;
+            memcpy(held, values, sizeof(held));
+            heldClass = r.predictedClass;
+        }
+
+        // Dashboard shows the last reported record (sample-and-hold)
+        for (int f = 0; f < RBE_NUM_FEATURES; f++) {
+            float error = fabsf(values[f] - held[f]);
+            errorSum[f] += error;
+            if (error > errorMax[f]) errorMax[f] = error;
+        }
+        if (heldClass != r.predictedClass) classMismatch++;
+    }
+
+    const RbeStats& st = filter.getStats();
+    printf("\n%s deadbands: T %.2f  H %.2f  P %.0f  L %.0f  G %.0f\n", preset.name,
+           preset.deadbands[0], preset.deadbands[1], preset.deadbands[2],
+           preset.deadbands[3], preset.deadbands[4]);
+    printf("   Reported %lu / %lu records (%.1f%% suppressed)\n",
+           (unsigned long)filter.reported(), (unsigned long)st.evaluated,
+           filter.suppressionRatio() * 100.0f);
+    printf("   Reasons: first %lu, class change %lu, deadband %lu, heartbeat %lu\n",
+           (unsigned long)st.byReason[RBE_FIRST], (unsigned long)st.byReason[RBE_CLASS_CHANGE],
+           (unsigned long)st.byReason[RBE_DEADBAND], (unsigned long)st.byReason[RBE_HEARTBEAT]);
+    printf("   Bytes:   ThingSpeak %zu → %zu (-%.1f%%), Firebase %zu → %zu (-%.1f%%)\n",
+           tsAll, tsSent, 100.0 * (tsAll - tsSent) / tsAll, fbAll, fbSent, 100.0 * (fbAll - fbSent) / fbAll);
+    printf("   Reconstruction (sample-and-hold)   mean err   max err   bound\n");
+    for (int f = 0; f < RBE_NUM_FEATURES; f++) {
+        printf("      %-12s                  %9.3f %9.3f %7.2f %s\n", RBE_FEATURE_NAMES[f],
+               errorSum[f] / trace.size(), errorMax[f], preset.deadbands[f],
+               errorMax[f] <= preset.deadbands[f] + 1e-3f ? "✅" : "❌");
+    }
+    printf("   Class shown wrong: %zu records\n", classMismatch);
+}
+
+int main(int argc, char** argv) {
+    double hours = 24.0;
+    const char* replay = nullptr;
+    uint32_t heartbeatMs = RBE_HEARTBEAT_MS;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--hours") == 0 && i + 1 < argc) hours = atof(argv[++i]);
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) replay = argv[++i];
+        else if (strcmp(argv[i], "--heartbeat-s") == 0 && i + 1 < argc) heartbeatMs = (uint32_t)atoi(argv[++i]) * 1000;
+        else {
+            fprintf(stderr, "Usage: rbe_trace_sim [--hours H] [--replay FILE.csv] [--heartbeat-s S]\n");
+            return 2;
+        }
+    }
+
+    std::vector<TelemetryRecord> trace;
+    if (replay) {
+        if (!replay_trace(replay, trace)) return 1;
+        printf("Replayed %zu records from %s\n", trace.size(), replay);
+    } else {
+        synthetic_trace(trace, hours);
+        printf("Synthetic trace: %.1f h, %zu records (15 s cadence)\n", hours, trace.size());
+    }
+    printf("Heartbeat: %lu s\n", (unsigned long)(heartbeatMs / 1000));
+
+    const Preset presets[] = {
+        { "Tight  ", { 0.1f, 0.5f, 20.0f, 10.0f, 25.0f } },
+        { "Default", { RBE_DEADBAND_TEMPERATURE, RBE_DEADBAND_HUMIDITY, RBE_DEADBAND_PRESSURE,
+                       RBE_DEADBAND_LUX, RBE_DEADBAND_GAS } },
+        { "Loose  ", { 0.5f, 2.0f, 100.0f, 50.0f, 100.0f } },
+    };
+    for (const Preset& p : presets) {
+        run_preset(p, trace, heartbeatMs);
+    }
+    return 0;
+}
@@ -0,0 +1,836 @@
+/*
+ * RTDB Stand-in - Local Firebase Realtime Database REST endpoint
+ *
+ * Answers the REST calls FirebaseManager makes (plain HTTP, keep-alive):
+ * - PUT   /path.json    setJSON (echoes the body like the real RTDB)
+ * - PATCH /path.json    multi-location update ("a/b":{...} keys)
+ * - GET   /path.json    the stored subtree (query parameters are ignored)
+ * - ?print=silent       204 No Content, no echo
+ * and counts requests, connections, bytes and written locations so batched
+ * writes can be measured against one write per reading. Written nodes are
+ * kept in memory by path (no merging inside a written node).
+ *
+ * --bench replays one simulated hour of readings (default cadence 15 s)
+ * through both client strategies against an in-process stand-in:
+ * - per-reading PUT /devices/{id}/readings/{t}.json (status only at boot)
+ * - batched PATCH /devices/{id}.json with readings + status
+ * followed by --boots reboots (firmware updated halfway) comparing the
+ * boot-time writes:
+ * - PUT info + PUT status at every boot
+ * - boot heartbeat folded into the first reading's PATCH, full info node
+ *   only when its content hash changed (FirebaseManager)
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -pthread -I../esp32_code rtdb_standin.cpp -o rtdb_standin
+ *
+ * Usage:
+ *   ./rtdb_standin [--port 8081] [--delay-ms 0] [--verbose]
+ *   ./rtdb_standin --bench [--batch 16] [--flush-s 300] [--cadence-s 15] [--delay-ms 0] [--boots 10]
+ *   ./rtdb_standin --rollup-check [--hours 24] [--outage-min 45] [--cadence-s 15]
+ *
+ * --rollup-check feeds a simulated trace through rollup_aggregator.h with
+ * FirebaseManager's flush rules (readings + status + dirty rollups per
+ * PATCH, a reboot mid-hour at 3/8 of the trace, a network outage in the
+ * middle), then GETs the rollups back, compares every hour/day segment
+ * node with an independent recomputation, checks the segments of each day
+ * add up to every record and reports how many bytes the dashboard
+ * downloads for stats and charts.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "telemetry_record.h"
+#include "rollup_aggregator.h"
+
+struct StandinOptions {
+    int port = 8081;
+    int delayMs = 0;
+    bool verbose = false;
+};
+
+static StandinOptions options;
+
+struct StandinCounters {
+    std::atomic<unsigned long> connections{0};
+    std::atomic<unsigned long> requests{0};
+    std::atomic<unsigned long> puts{0};
+    std::atomic<unsigned long> patches{0};
+    std::atomic<unsigned long> gets{0};
+    std::atomic<unsigned long> locations{0};   // Nodes written (PATCH keys, 1 per PUT)
+    std::atomic<unsigned long> bytesIn{0};
+    std::atomic<unsigned long> bytesOut{0};
+};
+
+static StandinCounters counters;
+
+typedef std::chrono::steady_clock Clock;
+
+// ==================== HELPERS ====================
+static int open_listener(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((uint16_t)port);
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 16) < 0) {
+        perror("bind/listen");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool send_all(int fd, const char* data, size_t length) {
+    size_t sent = 0;
+    while (sent < length) {
+        ssize_t n = send(fd, data + sent, length - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += (size_t)n;
+    }
+    return true;
+}
+
+// Read one HTTP message (headers + Content-Length body) from `buffer`/fd
+static bool read_message(int fd, std::string& buffer, std::string& head, std::string& body) {
+    char chunk[4096];
+    size_t headerEnd;
+    while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buffer.append(chunk, (size_t)n);
+    }
+    head = buffer.substr(0, headerEnd + 4);
+    size_t lengthAt = head.find("Content-Length:");
+    size_t length = lengthAt == std::string::npos ? 0 : (size_t)atol(head.c_str() + lengthAt + 15);
+    while (buffer.size() < headerEnd + 4 + length) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buffer.append(chunk, (size_t)n);
+    }
+    body = buffer.substr(headerEnd + 4, length);
+    buffer.erase(0, headerEnd + 4 + length);
+    return true;
+}
+
+// Members of a JSON object ({"a":1,"b":{..}} → ("a","1"), ("b","{..}")).
+// Keys are taken verbatim (no unescaping; RTDB keys cannot contain quotes).
+static std::vector<std::pair<std::string, std::string>> split_members(const std::string& json) {
+    std::vector<std::pair<std::string, std::string>> members;
+    int depth = 0;
+    bool inString = false;
+    bool expectKey = false;
+    size_t keyStart = 0, valueStart = 0;
+    std::string key;
+    for (size_t i = 0; i < json.size(); i++) {
+        char c = json[i];
+        if (inString) {
+            if (c == '\\') {
+                i++;
+            } else if (c == '"') {
+                inString = false;
+                if (depth == 1 && expectKey) {
+                    key = json.substr(keyStart, i - keyStart);
+                    expectKey = false;
+                }
+            }
+            continue;
+        }
+        if (c == '"') {
+            inString = true;
+            if (depth == 1 && expectKey) keyStart = i + 1;
+        } else if (c == ':' && depth == 1) {
+            valueStart = i + 1;
+        } else if (c == '{' || c == '[') {
+            depth++;
+            if (depth == 1) expectKey = true;
+        } else if (c == '}' || c == ']' || (c == ',' && depth == 1)) {
+            if (depth == 1 && !key.empty()) {
+                members.emplace_back(key, json.substr(valueStart, i - valueStart));
+                key.clear();
+            }
+            if (c == ',') expectKey = true;
+            else depth--;
+        }
+    }
+    return members;
+}
+
+// Top-level keys of a JSON object ({"a":..,"b":..} → 2)
+static unsigned long count_top_level_keys(const std::string& json) {
+    return (unsigned long)split_members(json).size();
+}
+
+// ==================== STORE ====================
+// Written nodes by path ("devices/ID/readings/60" → its JSON)
+static std::mutex storeMutex;
+static std::map<std::string, std::string> store;
+
+// "PUT /devices/ID/status.json?auth=... HTTP/1.1" → "devices/ID/status"
+static std::string request_path(const std::string& head) {
+    size_t start = head.find(' ') + 1;
+    size_t end = head.find_first_of("? ", start);
+    std::string path = head.substr(start, end - start);
+    if (path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0) path.resize(path.size() - 5);
+    while (!path.empty() && path.front() == '/') path.erase(0, 1);
+    while (!path.empty() && path.back() == '/') path.pop_back();
+    return path;
+}
+
+static std::string child_path(const std::string& parent, const std::string& key) {
+    return parent.empty() ? key : parent + "/" + key;
+}
+
+// Replace the node at `path` (and everything below it)
+static void store_write(const std::string& path, const std::string& json) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    std::string below = path + "/";
+    for (auto it = store.lower_bound(below); it != store.end() && it->first.compare(0, below.size(), below) == 0;) {
+        it = store.erase(it);
+    }
+    store[path] = json;
+}
+
+// Rebuild an object from written descendants (relative paths, sorted)
+static std::string assemble(const std::vector<std::pair<std::string, const std::string*>>& nodes,
+                            size_t begin, size_t end, size_t offset) {
+    std::string out = "{";
+    size_t i = begin;
+    while (i < end) {
+        const std::string& path = nodes[i].first;
+        size_t slash = path.find('/', offset);
+        std::string segment = path.substr(offset, slash == std::string::npos ? std::string::npos : slash - offset);
+        size_t j = i + 1;
+        while (j < end && nodes[j].first.compare(offset, segment.size(), segment) == 0 &&
+               (nodes[j].first.size() == offset + segment.size() || nodes[j].first[offset + segment.size()] == '/')) {
+            j++;
+        }
+        if (out.size() > 1) out += ",";
+        out += "\"" + segment + "\":";
+        if (slash == std::string::npos) out += *nodes[i].second;   // Written node wins over later deeper writes
+        else out += assemble(nodes, i, j, offset + segment.size() + 1);
+        i = j;
+    }
+    return out + "}";
+}
+
+// Subtree at `path` as JSON ("null" when nothing was written there)
+static std::string store_read(const std::string& path) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    auto exact = store.find(path);
+    if (exact != store.end()) return exact->second;
+    std::string below = path.empty() ? "" : path + "/";
+    std::vector<std::pair<std::string, const std::string*>> nodes;
+    for (auto it = store.lower_bound(below); it != store.end() && it->first.compare(0, below.size(), below) == 0; ++it) {
+        nodes.emplace_back(it->first.substr(below.size()), &it->second);
+    }
+    return nodes.empty() ? "null" : assemble(nodes, 0, nodes.size(), 0);
+}
+
+// ==================== SERVER ====================
+static void serve_client(int fd) {
+    counters.connections++;
+    std::string buffer, head, body;
+    while (read_message(fd, buffer, head, body)) {
+        counters.requests++;
+        counters.bytesIn += head.size() + body.size();
+
+        bool patch = head.compare(0, 6, "PATCH ") == 0;
+        bool put = head.compare(0, 4, "PUT ") == 0;
+        bool get = head.compare(0, 4, "GET ") == 0;
+        std::string path = request_path(head);
+        bool silent = head.find("print=silent") < head.find("\r\n");
+        bool keepAlive = head.find("Connection: close") == std::string::npos;
+        if (patch) {
+            std::vector<std::pair<std::string, std::string>> members = split_members(body);
+            counters.patches++;
+            counters.locations += members.size();
+            for (const auto& member : members) {
+                store_write(child_path(path, member.first), member.second);
+            }
+        } else if (put) {
+            counters.puts++;
+            counters.locations++;
+            store_write(path, body);
+        } else if (get) {
+            counters.gets++;
+            body = store_read(path);
+        }
+
+        if (options.delayMs > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(options.delayMs));
+        }
+
+        std::string response;
+        char status[160];
+        if (!patch && !put && !get) {
+            snprintf(status, sizeof(status), "HTTP/1.1 405 Method Not Allowed\r\nContent-Length: 0\r\n%s\r\n",
+                     keepAlive ? "" : "Connection: close\r\n");
+            response = status;
+        } else if (silent && !get) {
+            snprintf(status, sizeof(status), "HTTP/1.1 204 No Content\r\n%s\r\n",
+                     keepAlive ? "" : "Connection: close\r\n");
+            response = status;
+        } else {
+            snprintf(status, sizeof(status),
+                     "HTTP/1.1 200 OK\r\nContent-Type: application/json; charset=utf-8\r\n"
+                     "Content-Length: %zu\r\n%s\r\n", body.size(), keepAlive ? "" : "Connection: close\r\n");
+            response = status;
+            response += body;
+        }
+        if (!send_all(fd, response.data(), response.size())) break;
+        counters.bytesOut += response.size();
+
+        if (options.verbose) {
+            fprintf(stderr, "🌐 %.*s (%zu B, %lu locations)\n", (int)head.find(" HTTP/"), head.c_str(),
+                    body.size(), patch ? count_top_level_keys(body) : 1UL);
+        }
+        if (!keepAlive) break;
+    }
+    close(fd);
+}
+
+static void accept_loop(int listener) {
+    for (;;) {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) continue;
+        int yes = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        std::thread(serve_client, fd).detach();
+    }
+}
+
+// ==================== BENCHMARK CLIENT ====================
+class RestClient {
+private:
+    int fd = -1;
+    int port;
+    std::string buffer;
+
+public:
+    explicit RestClient(int serverPort) : port(serverPort) {}
+    ~RestClient() { if (fd >= 0) close(fd); }
+
+    // Returns the HTTP status code (-1 on a network error); the response
+    // body goes to `reply` when given
+    int request(const char* method, const char* path, const std::string& token, const std::string& body,
+                bool silent, std::string* reply = nullptr) {
+        if (fd < 0) {
+            fd = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in addr;
+            memset(&addr, 0, sizeof(addr));
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            addr.sin_port = htons((uint16_t)port);
+            if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+                close(fd);
+                fd = -1;
+                return -1;
+            }
+            int yes = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        }
+        std::string message = std::string(method) + " " + path + "?auth=" + token +
+                              (silent ? "&print=silent" : "") + " HTTP/1.1\r\n"
+                              "Host: rtdb.local\r\nUser-Agent: ESP32\r\nContent-Type: application/json\r\n"
+                              "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                              "Connection: keep-alive\r\n\r\n" + body;
+        std::string head, response;
+        if (!send_all(fd, message.data(), message.size()) || !read_message(fd, buffer, head, response)) {
+            close(fd);
+            fd = -1;
+            return -1;
+        }
+        if (reply != nullptr) *reply = response;
+        return atoi(head.c_str() + 9);
+    }
+};
+
+#define BENCH_EPOCH_MS 1767225600000ULL   // 2026-01-01 00:00 UTC: trace starts at midnight
+
+static void bench_reading(TelemetryRecord& r, unsigned int i, uint32_t cadenceMs) {
+    memset(&r, 0, sizeof(r));
+    r.timestampMs = (uint64_t)i * cadenceMs;
+    r.epochMs = BENCH_EPOCH_MS + r.timestampMs;
+    r.temperature = 22.0f + (i % 40) * 0.05f;
+    r.humidity = 45.0f + (i % 25) * 0.2f;
+    r.pressure = 98650.0f + (i % 60);
+    r.lux = 300.0f + (i % 90);
+    r.gas = 320.0f + (i % 30);
+    r.predictedClass = (uint8_t)((i / 60) % TELEMETRY_NUM_CLASSES);
+    for (int c = 0; c < TELEMETRY_NUM_CLASSES; c++) r.votes[c] = c == r.predictedClass ? 200 : 12;
+    r.inferenceTime = 190;
+    r.rssi = -58;
+}
+
+struct BenchResult {
+    unsigned long requests, connections, locations, bytesIn, bytesOut;
+    double wallMs;
+};
+
+static BenchResult bench_strategy(bool batched, int port, unsigned int readings, uint32_t cadenceMs,
+                                  unsigned int batchSize, uint32_t flushMs) {
+    const char* deviceId = "240AC4123456";
+    const std::string token(920, 'x');   // Typical Firebase ID token (JWT) length
+    unsigned long startRequests = counters.requests, startConnections = counters.connections;
+    unsigned long startLocations = counters.locations;
+    unsigned long startIn = counters.bytesIn, startOut = counters.bytesOut;
+    Clock::time_point start = Clock::now();
+
+    RestClient client(port);
+    TelemetryRecord r;
+    char json[TELEMETRY_MAX_PAYLOAD];
+    char path[96];
+    std::string batch;
+    unsigned int queued = 0;
+    uint64_t batchStartedMs = 0;
+
+    for (unsigned int i = 0; i < readings; i++) {
+        bench_reading(r, i, cadenceMs);
+        telemetry_encode_firebase_json(r, deviceId, json, sizeof(json));
+        unsigned long long t = (unsigned long long)r.epochMs;
+
+        if (!batched) {
+            // setJSON per reading; the library reads the echoed node back
+            snprintf(path, sizeof(path), "/devices/%s/readings/%llu.json", deviceId, t);
+            client.request("PUT", path, token, json, false);
+            continue;
+        }
+
+        batch += queued == 0 ? "{" : ",";
+        batch += "\"readings/" + std::to_string(t) + "\":" + json;
+        if (queued++ == 0) batchStartedMs = r.timestampMs;
+        bool last = i + 1 == readings;
+        if (queued >= batchSize || r.timestampMs + cadenceMs - batchStartedMs > flushMs || last) {
+            batch += ",\"status\":{\"online\":true,\"last_seen\":" + std::to_string(t) + "}}";
+            snprintf(path, sizeof(path), "/devices/%s.json", deviceId);
+            client.request("PATCH", path, token, batch, true);
+            batch.clear();
+            queued = 0;
+        }
+    }
+
+    BenchResult result;
+    result.wallMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    result.requests = counters.requests - startRequests;
+    result.connections = counters.connections - startConnections;
+    result.locations = counters.locations - startLocations;
+    result.bytesIn = counters.bytesIn - startIn;
+    result.bytesOut = counters.bytesOut - startOut;
+    return result;
+}
+
+// Boot-time writes over `boots` reboots; firmware changes at boot boots/2.
+// Legacy: PUT info + PUT status. Folded: the first reading's PATCH carries
+// status and info (whole node if the hash changed, else info/last_boot).
+static BenchResult bench_boots(bool folded, int port, unsigned int boots, unsigned int& infoWrites) {
+    const char* deviceId = "240AC4123456";
+    const std::string token(920, 'x');
+    unsigned long startRequests = counters.requests, startConnections = counters.connections;
+    unsigned long startLocations = counters.locations;
+    unsigned long startIn = counters.bytesIn, startOut = counters.bytesOut;
+    Clock::time_point start = Clock::now();
+
+    DeviceInfo info;
+    info.deviceId = deviceId;
+    info.modelType = "RandomForest-250trees";
+    info.chipModel = "ESP32-S3";
+    info.chipCores = 2;
+    info.cpuFreqMHz = 240;
+    info.flashSizeMB = 8.0f;
+    info.macAddress = "24:0A:C4:12:34:56";
+    uint32_t storedHash = 0;   // NVS
+    char node[384];
+    char json[TELEMETRY_MAX_PAYLOAD];
+    char path[96];
+    infoWrites = 0;
+
+    for (unsigned int b = 0; b < boots; b++) {
+        RestClient client(port);   // Fresh connection per boot
+        info.firmwareVersion = b < boots / 2 ? "v3.0" : "v3.1";
+        uint64_t bootMs = BENCH_EPOCH_MS + (uint64_t)b * 3600000ULL;
+        info.lastBootMs = bootMs;
+        JsonStreamWriter w(node, sizeof(node));
+        json_write_info(w, info);
+        std::string infoJson(node, (size_t)w.length());
+        std::string status = "{\"online\":true,\"last_seen\":" + std::to_string(bootMs + 20000) + "}";
+
+        if (!folded) {
+            snprintf(path, sizeof(path), "/devices/%s/info.json", deviceId);
+            client.request("PUT", path, token, infoJson, true);
+            snprintf(path, sizeof(path), "/devices/%s/status.json", deviceId);
+            client.request("PUT", path, token, status, true);
+            infoWrites++;
+            continue;
+        }
+
+        TelemetryRecord r;
+        bench_reading(r, 0, 15000);
+        r.epochMs = bootMs + 20000;
+        telemetry_encode_firebase_json(r, deviceId, json, sizeof(json));
+        std::string body = "{\"readings/" + std::to_string(r.epochMs) + "\":" + json + ",\"status\":" + status;
+        uint32_t hash = json_info_hash(info, node, sizeof(node));
+        if (hash != storedHash) {
+            body += ",\"info\":" + infoJson;
+            infoWrites++;
+        } else {
+            body += ",\"info/last_boot\":" + std::to_string(bootMs);
+        }
+        body += "}";
+        snprintf(path, sizeof(path), "/devices/%s.json", deviceId);
+        if (client.request("PATCH", path, token, body, true) == 204) storedHash = hash;
+    }
+
+    BenchResult result;
+    result.wallMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    result.requests = counters.requests - startRequests;
+    result.connections = counters.connections - startConnections;
+    result.locations = counters.locations - startLocations;
+    result.bytesIn = counters.bytesIn - startIn;
+    result.bytesOut = counters.bytesOut - startOut;
+    return result;
+}
+
+// In-process stand-in on an ephemeral port; returns the port or -1
+static int start_inprocess_server() {
+    int listener = open_listener(0);
+    if (listener < 0) return -1;
+    sockaddr_in addr;
+    socklen_t length = sizeof(addr);
+    getsockname(listener, (sockaddr*)&addr, &length);
+    std::thread(accept_loop, listener).detach();
+    return ntohs(addr.sin_port);
+}
+
+static int run_bench(unsigned int batchSize, uint32_t flushMs, uint32_t cadenceMs, unsigned int boots) {
+    int port = start_inprocess_server();
+    if (port < 0) return 1;
+
+    unsigned int readings = 3600000u / cadenceMs;
+    printf("One hour of readings: %u (every %lu s), batch %u / flush %lu s, server delay %d ms\n",
+           readings, (unsigned long)(cadenceMs / 1000), batchSize, (unsigned long)(flushMs / 1000),
+           options.delayMs);
+    printf("\n   Strategy             Requests/h   Conns   Nodes   Up B/h    Down B/h   Up B/reading   Wall ms\n");
+    printf("   ─────────────────────────────────────────────────────────────────────────────────────────\n");
+
+    const char* names[2] = { "PUT per reading", "Batched PATCH" };
+    BenchResult results[2];
+    for (int s = 0; s < 2; s++) {
+        results[s] = bench_strategy(s == 1, port, readings, cadenceMs, batchSize, flushMs);
+        const BenchResult& b = results[s];
+        printf("   %-18s %12lu %7lu %7lu %9lu %10lu %14.1f %9.1f\n", names[s], b.requests, b.connections,
+               b.locations, b.bytesIn, b.bytesOut, (double)b.bytesIn / readings, b.wallMs);
+    }
+    printf("   ─────────────────────────────────────────────────────────────────────────────────────────\n");
+    printf("   Round trips: %.1fx fewer | bytes up: %.1fx fewer | bytes down: %.1fx fewer\n",
+           (double)results[0].requests / results[1].requests,
+           (double)results[0].bytesIn / results[1].bytesIn,
+           results[1].bytesOut ? (double)results[0].bytesOut / results[1].bytesOut : 0.0);
+
+    if (boots == 0) return 0;
+    printf("\n%u boots (firmware updated at boot %u): writes before the first regular batch\n", boots, boots / 2 + 1);
+    printf("\n   Boot writes          Requests/boot   Conns   Nodes   Up B/boot   Info rewrites\n");
+    printf("   ──────────────────────────────────────────────────────────────────────────\n");
+    const char* bootNames[2] = { "PUT info + status", "Folded heartbeat" };
+    for (int s = 0; s < 2; s++) {
+        unsigned int infoWrites = 0;
+        BenchResult b = bench_boots(s == 1, port, boots, infoWrites);
+        printf("   %-18s %15.1f %7lu %7lu %11.0f %15u\n", bootNames[s], (double)b.requests / boots,
+               b.connections, b.locations, (double)b.bytesIn / boots, infoWrites);
+    }
+    printf("   ──────────────────────────────────────────────────────────────────────────\n");
+    printf("   Folded: the PATCH carries reading #1 (flushed early instead of waiting for a full\n"
+           "   batch), so a boot costs at most one extra round trip per hour instead of two\n");
+    return 0;
+}
+
+// ==================== ROLLUP CHECK ====================
+// FirebaseManager's limits (firebase_manager.h)
+#define CHECK_BATCH_SIZE 16
+#define CHECK_FLUSH_MS 300000
+#define CHECK_STATUS_RESERVE 64
+#define CHECK_AGGREGATE_RESERVE (8 * 464)
+#define CHECK_BODY_SIZE (CHECK_BATCH_SIZE * (TELEMETRY_MAX_PAYLOAD + 24) + CHECK_STATUS_RESERVE + CHECK_AGGREGATE_RESERVE)
+
+// Plain recomputation of one bucket (no rollup_aggregator.h code)
+struct ReferenceBucket {
+    uint32_t n = 0;
+    float lo[ROLLUP_SENSORS], hi[ROLLUP_SENSORS];
+    double sum[ROLLUP_SENSORS] = { 0 };
+    uint32_t classes[TELEMETRY_NUM_CLASSES] = { 0 };
+};
+
+static std::string reference_json(uint32_t start, const ReferenceBucket& b) {
+    char node[512];
+    int n = snprintf(node, sizeof(node), "{\"start\":%lu,\"n\":%lu", (unsigned long)start, (unsigned long)b.n);
+    static const char* keys[ROLLUP_SENSORS] = { "temperature", "humidity", "pressure", "lux", "gas_ppm" };
+    for (int i = 0; i < ROLLUP_SENSORS; i++) {
+        n += snprintf(node + n, sizeof(node) - n, ",\"%s\":[%.2f,%.2f,%.2f]", keys[i], b.lo[i], b.hi[i],
+                      (float)(b.sum[i] / b.n));
+    }
+    snprintf(node + n, sizeof(node) - n, ",\"classes\":[%lu,%lu,%lu,%lu,%lu]}", (unsigned long)b.classes[0],
+             (unsigned long)b.classes[1], (unsigned long)b.classes[2], (unsigned long)b.classes[3],
+             (unsigned long)b.classes[4]);
+    return node;
+}
+
+// Slow weather drift over the day on top of the bench pattern
+static void rollup_reading(TelemetryRecord& r, unsigned int i, uint32_t cadenceMs) {
+    bench_reading(r, i, cadenceMs);
+    uint32_t hourOfDay = (uint32_t)(r.timestampMs / 3600000) % 24;
+    r.temperature += hourOfDay < 12 ? hourOfDay * 0.5f : (24 - hourOfDay) * 0.5f;
+    r.lux *= hourOfDay >= 6 && hourOfDay < 19 ? 20.0f : 0.01f;
+    r.predictedClass = (uint8_t)((i * 7 + i / 240) % TELEMETRY_NUM_CLASSES);
+}
+
+static int run_rollup_check(unsigned int hours, unsigned int outageMin, uint32_t cadenceMs) {
+    int port = start_inprocess_server();
+    if (port < 0) return 1;
+
+    const char* deviceId = "240AC4123456";
+    const std::string token(920, 'x');
+    char patchPath[64];
+    snprintf(patchPath, sizeof(patchPath), "/devices/%s.json", deviceId);
+    RestClient client(port);
+
+    RollupAggregator rollups;
+    // Keyed by (bucket start, segment): one node per boot under a bucket
+    std::map<std::pair<uint32_t, uint32_t>, ReferenceBucket> reference[ROLLUP_LEVEL_COUNT];
+    uint32_t segment = 0;
+    bool rebooted = false;
+    static char body[CHECK_BODY_SIZE];
+    char json[TELEMETRY_MAX_PAYLOAD];
+    size_t length = 0;
+    unsigned int queued = 0, refused = 0, patches = 0, failed = 0;
+    uint64_t batchStartedMs = 0, lastAttemptMs = 0;
+    uint64_t outageStartMs = (uint64_t)hours * 3600000 / 2;
+    uint64_t outageEndMs = outageStartMs + (uint64_t)outageMin * 60000;
+    uint64_t rebootMs = (uint64_t)hours * 3600000 * 3 / 8;
+
+    // FirebaseManager::flush(): readings, status, dirty rollups in one PATCH
+    auto flush = [&](uint64_t nowMs) {
+        lastAttemptMs = nowMs;
+        if (nowMs >= outageStartMs && nowMs < outageEndMs) {
+            failed++;
+            return false;
+        }
+        size_t readingsLength = length;
+        int n = snprintf(body + length, sizeof(body) - length, "%s\"status\":{\"online\":true,\"last_seen\":%llu}",
+                         queued == 0 ? "{" : ",", (unsigned long long)(BENCH_EPOCH_MS + nowMs));
+        length += (size_t)n;
+        rollups.writeDirty(body, sizeof(body) - 1, length);
+        body[length++] = '}';
+        body[length] = '\0';
+        int code = client.request("PATCH", patchPath, token, std::string(body, length), true);
+        patches++;
+        if (code < 200 || code >= 300) {
+            length = readingsLength;
+            body[length] = '\0';
+            failed++;
+            return false;
+        }
+        rollups.commit();
+        length = 0;
+        queued = 0;
+        return true;
+    };
+
+    unsigned int records = (unsigned int)((uint64_t)hours * 3600000 / cadenceMs);
+    TelemetryRecord r;
+    for (unsigned int i = 0; i < records; i++) {
+        rollup_reading(r, i, cadenceMs);
+        uint64_t nowMs = r.timestampMs;
+
+        // Restart right after an upload (nothing queued): RAM buckets are
+        // gone, the open hour and day continue under a new segment
+        if (!rebooted && nowMs >= rebootMs && queued == 0 && !rollups.hasDirty()) {
+            rollups.reset();
+            segment = 0;
+            rebooted = true;
+        }
+
+        // Dispatcher: observe() every record, then publish()
+        rollups.add(r);
+        uint32_t s = (uint32_t)(r.epochMs / 1000);
+        if (segment == 0) segment = s;
+        float values[ROLLUP_SENSORS] = { r.temperature, r.humidity, r.pressure, r.lux, r.gas };
+        for (int l = 0; l < ROLLUP_LEVEL_COUNT; l++) {
+            ReferenceBucket& b = reference[l][std::make_pair(s - s % ROLLUP_PERIOD_S[l], segment)];
+            for (int k = 0; k < ROLLUP_SENSORS; k++) {
+                if (b.n == 0 || values[k] < b.lo[k]) b.lo[k] = values[k];
+                if (b.n == 0 || values[k] > b.hi[k]) b.hi[k] = values[k];
+                b.sum[k] += values[k];
+            }
+            b.classes[r.predictedClass]++;
+            b.n++;
+        }
+
+        // FirebaseManager::backupRecord()
+        if (queued >= CHECK_BATCH_SIZE && !flush(nowMs)) {
+            refused++;
+        } else {
+            telemetry_encode_firebase_json(r, deviceId, json, sizeof(json));
+            length += (size_t)snprintf(body + length, sizeof(body) - length, "%s\"readings/%llu\":%s",
+                                       queued == 0 ? "{" : ",", (unsigned long long)r.epochMs, json);
+            if (queued++ == 0) batchStartedMs = nowMs;
+            if (queued >= CHECK_BATCH_SIZE) flush(nowMs);
+        }
+
+        // FirebaseManager::poll() between records
+        if (queued > 0 || rollups.hasDirty()) {
+            bool batchDue = queued == 0 || nowMs - batchStartedMs >= CHECK_FLUSH_MS;
+            if (batchDue && nowMs - lastAttemptMs >= CHECK_FLUSH_MS) flush(nowMs);
+        }
+    }
+    uint64_t endMs = (uint64_t)records * cadenceMs;
+    for (int attempt = 0; attempt < 4 && (queued > 0 || rollups.hasDirty()); attempt++) flush(endMs);
+
+    // Dashboard reads: raw history vs rollups
+    struct Read { const char* what; const char* path; size_t bytes; };
+    Read reads[] = {
+        { "Raw readings (stats today)", "readings", 0 },
+        { "Minute rollups", "aggregates/minute", 0 },
+        { "Hour rollups (charts)", "aggregates/hour", 0 },
+        { "Day rollups (stats)", "aggregates/day", 0 },
+    };
+    for (Read& read : reads) {
+        char path[96];
+        std::string reply;
+        snprintf(path, sizeof(path), "/devices/%s/%s.json", deviceId, read.path);
+        client.request("GET", path, token, "", false, &reply);
+        read.bytes = reply.size();
+    }
+
+    // Every stored rollup against the recomputation
+    unsigned int checked[ROLLUP_LEVEL_COUNT] = { 0 }, missing[ROLLUP_LEVEL_COUNT] = { 0 };
+    unsigned int mismatches = 0, split = 0;
+    uint64_t dayTotal = 0;
+    for (int l = 0; l < ROLLUP_LEVEL_COUNT; l++) {
+        uint32_t previousStart = 0;
+        for (const auto& bucket : reference[l]) {
+            char path[96];
+            uint32_t start = bucket.first.first;
+            if (l == ROLLUP_HOUR && start == previousStart) split++;
+            previousStart = start;
+            snprintf(path, sizeof(path), "devices/%s/aggregates/%s/%lu/%lu", deviceId, ROLLUP_LEVEL_NAMES[l],
+                     (unsigned long)start, (unsigned long)bucket.first.second);
+            std::string stored = store_read(path);
+            if (stored == "null") {
+                missing[l]++;
+                continue;
+            }
+            checked[l]++;
+            std::string expected = reference_json(start, bucket.second);
+            if (stored != expected) {
+                if (mismatches++ < 3) fprintf(stderr, "❌ %s\n   stored:   %s\n   expected: %s\n", path,
+                                              stored.c_str(), expected.c_str());
+            }
+            if (l == ROLLUP_DAY) dayTotal += bucket.second.n;
+        }
+    }
+
+    const RollupStats& stats = rollups.getStats();
+    printf("Simulated %u h: %u records every %lu s, %u min outage, %s | %u PATCHes, %u failed offline, "
+           "%u readings refused\n", hours, records, (unsigned long)(cadenceMs / 1000), outageMin,
+           rebooted ? "1 reboot" : "no reboot", patches, failed, refused);
+    printf("\n   Dashboard read                 GET bytes   vs raw\n");
+    printf("   ────────────────────────────────────────────────────\n");
+    for (const Read& read : reads) {
+        printf("   %-28s %11zu %7.1fx\n", read.what, read.bytes,
+               read.bytes ? (double)reads[0].bytes / read.bytes : 0.0);
+    }
+    printf("   ────────────────────────────────────────────────────\n");
+    printf("   Nodes checked: %u minute (%u dropped offline), %u hour (%u split by the reboot), %u day | "
+           "mismatches: %u\n", checked[ROLLUP_MINUTE], missing[ROLLUP_MINUTE], checked[ROLLUP_HOUR], split,
+           checked[ROLLUP_DAY], mismatches);
+    printf("   Day totals: %llu of %u records | aggregator: %lu nodes written, %lu dropped\n",
+           (unsigned long long)dayTotal, records, (unsigned long)stats.nodesWritten,
+           (unsigned long)stats.nodesDropped);
+
+    bool ok = mismatches == 0 && missing[ROLLUP_HOUR] == 0 && missing[ROLLUP_DAY] == 0 &&
+              dayTotal == records && missing[ROLLUP_MINUTE] == stats.nodesDropped && rebooted && split > 0;
+    printf("\n%s\n", ok ? "✅ Rollups exact, hour/day complete through the reboot and the outage"
+                        : "❌ Rollups incomplete or wrong");
+    return ok ? 0 : 1;
+}
+
+// ==================== MAIN ====================
+int main(int argc, char** argv) {
+    bool bench = false;
+    bool rollupCheck = false;
+    unsigned int hours = 24;
+    unsigned int outageMin = 45;
+    unsigned int batchSize = 16;
+    uint32_t flushMs = 300000;
+    uint32_t cadenceMs = 15000;
+    unsigned int boots = 10;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) options.port = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--delay-ms") == 0 && i + 1 < argc) options.delayMs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--verbose") == 0) options.verbose = true;
+        else if (strcmp(argv[i], "--bench") == 0) bench = true;
+        else if (strcmp(argv[i], "--rollup-check") == 0) rollupCheck = true;
+        else if (strcmp(argv[i], "--hours") == 0 && i + 1 < argc) hours = (unsigned int)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--outage-min") == 0 && i + 1 < argc) outageMin = (unsigned int)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) batchSize = (unsigned int)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--flush-s") == 0 && i + 1 < argc) flushMs = (uint32_t)atoi(argv[++i]) * 1000;
+        else if (strcmp(argv[i], "--cadence-s") == 0 && i + 1 < argc) cadenceMs = (uint32_t)atoi(argv[++i]) * 1000;
+        else if (strcmp(argv[i], "--boots") == 0 && i + 1 < argc) boots = (unsigned int)atoi(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: rtdb_standin [--port P] [--delay-ms D] [--verbose]\n"
+                            "       rtdb_standin --bench [--batch N] [--flush-s S] [--cadence-s S] [--delay-ms D] [--boots N]\n"
+                            "       rtdb_standin --rollup-check [--hours H] [--outage-min M] [--cadence-s S]\n");
+            return 2;
+        }
+    }
+    if (batchSize < 1) batchSize = 1;
+    if (cadenceMs < 1000) cadenceMs = 1000;
+
+    if (bench) {
+        return run_bench(batchSize, flushMs, cadenceMs, boots);
+    }
+    if (rollupCheck) {
+        return run_rollup_check(hours < 1 ? 1 : hours, outageMin, cadenceMs);
+    }
+
+    int listener = open_listener(options.port);
+    if (listener < 0) return 1;
+    fprintf(stderr, "🔥 RTDB stand-in on :%d (delay %d ms)\n", options.port, options.delayMs);
+    std::thread(accept_loop, listener).detach();
+
+    unsigned long lastRequests = 0;
+    for (;;) {
+        std::this_thread::sleep_for(std::chrono::seconds(10));
+        if (counters.requests == lastRequests) continue;
+        lastRequests = counters.requests;
+        fprintf(stderr, "📊 RTDB: %lu requests (%lu PUT, %lu PATCH), %lu connections, %lu nodes, "
+                        "%lu B in / %lu B out\n",
+                counters.requests.load(), counters.puts.load(), counters.patches.load(),
+                counters.connections.load(), counters.locations.load(),
+                counters.bytesIn.load(), counters.bytesOut.load());
+    }
+}
@@ -0,0 +1,195 @@
+/*
+ * Scheduler Drift Simulator - Sampling timeline of loop() polling vs the timer wheel
+ *
+ * Runs the sampling/prediction loop in virtual time twice:
+ * - polling: the previous loop, modelled call for call (every iteration
+ *   checks "if (now - last >= INTERVAL) { last = now; ... }" for the 1 s
+ *   reading and the 15 s prediction, then returns; no sleep)
+ * - wheel:   task_scheduler.h as the sketch now runs it (drift-free
+ *   periodic tasks, loop() sleeps until the next deadline, capped)
+ *
+ * Workload per run: a reading costs --read-ms (mostly serial printing),
+ * a prediction costs --predict-ms plus, with probability --upload-p, a
+ * blocking upload of --upload-ms. Each loop iteration costs 1 ms of other
+ * work. Reports readings taken vs the ideal 1 Hz grid, drift of the last
+ * reading against the grid, lateness mean/max, skipped periods and loop
+ * wake-ups. Exits non-zero if the wheel drifts by more than one period.
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -I../esp32_code scheduler_drift_sim.cpp -o scheduler_drift_sim
+ *
+ * Usage:
+ *   ./scheduler_drift_sim [--minutes 60] [--read-ms 9] [--predict-ms 180] [--upload-ms 900] [--upload-p 0.5]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <random>
+
+#include "task_scheduler.h"
+
+#define SIM_SENSOR_INTERVAL 1000
+#define SIM_PREDICTION_INTERVAL 15000
+#define SIM_LOOP_WORK_MS 1
+#define SIM_MAX_SLEEP_MS 20
+
+// ==================== VIRTUAL TIME ====================
+static uint64_t virtualUs = 0;
+static uint32_t sim_millis() { return (uint32_t)(virtualUs / 1000); }
+static uint32_t sim_micros() { return (uint32_t)virtualUs; }
+static void sim_spend(uint32_t ms) { virtualUs += (uint64_t)ms * 1000; }
+
+struct Workload {
+    uint32_t readMs;
+    uint32_t predictMs;
+    uint32_t uploadMs;
+    double uploadP;
+};
+
+struct Result {
+    uint32_t readings;
+    uint32_t predictions;
+    uint32_t wakeups;
+    double lateTotalMs;
+    uint32_t lateMaxMs;
+    int32_t driftMs;        // Last reading minus its slot on the ideal grid
+    uint32_t skipped;
+};
+
+static Workload workload;
+static std::mt19937 rng(7);
+static Result* current = nullptr;
+static uint32_t startMs = 0;
+
+// Lateness against the ideal 1 Hz grid anchored at start
+static void on_reading() {
+    uint32_t now = sim_millis();
+    uint32_t slot = (now - startMs) / SIM_SENSOR_INTERVAL;
+    uint32_t late = (now - startMs) - slot * SIM_SENSOR_INTERVAL;
+    current->readings++;
+    current->lateTotalMs += late;
+    if (late > current->lateMaxMs) current->lateMaxMs = late;
+    // Ideal time of this reading is reading number N, not the nearest slot
+    current->driftMs = (int32_t)((now - startMs) - (current->readings - 1) * SIM_SENSOR_INTERVAL);
+    sim_spend(workload.readMs);
+}
+
+static void on_prediction() {
+    current->predictions++;
+    sim_spend(workload.predictMs);
+    if (std::uniform_real_distribution<double>(0.0, 1.0)(rng) < workload.uploadP) {
+        sim_spend(workload.uploadMs);
+    }
+}
+
+// ==================== POLLING (previous loop) ====================
+static void run_polling(Result& r, uint32_t durationMs) {
+    memset(&r, 0, sizeof(r));
+    current = &r;
+    virtualUs = 0;
+    startMs = sim_millis();
+    unsigned long lastSensorRead = 0;
+    unsigned long lastPrediction = startMs;
+    bool first = true;
+    while (sim_millis() - startMs < durationMs) {
+        r.wakeups++;
+        unsigned long now = sim_millis();
+        if (first || now - lastSensorRead >= SIM_SENSOR_INTERVAL) {
+            first = false;
+            lastSensorRead = now;
+            on_reading();
+        }
+        if (now - lastPrediction >= SIM_PREDICTION_INTERVAL) {
+            lastPrediction = now;
+            on_prediction();
+        }
+        sim_spend(SIM_LOOP_WORK_MS);
+    }
+}
+
+// ==================== TIMER WHEEL ====================
+static void reading_task(void*) { on_reading(); }
+static void prediction_task(void*) { on_prediction(); }
+
+static void run_wheel(Result& r, uint32_t durationMs) {
+    memset(&r, 0, sizeof(r));
+    current = &r;
+    virtualUs = 0;
+    startMs = sim_millis();
+    TaskScheduler scheduler(sim_micros);
+    int sensor = scheduler.every("sensor", SIM_SENSOR_INTERVAL, reading_task, nullptr, startMs, 100, 0);
+    scheduler.every("predict", SIM_PREDICTION_INTERVAL, prediction_task, nullptr, startMs, SIM_SENSOR_INTERVAL);
+    while (sim_millis() - startMs < durationMs) {
+        r.wakeups++;
+        scheduler.run(sim_millis());
+        sim_spend(SIM_LOOP_WORK_MS);
+        uint32_t wait = scheduler.msUntilNext(sim_millis());
+        if (wait > SIM_MAX_SLEEP_MS) wait = SIM_MAX_SLEEP_MS;
+        sim_spend(wait);
+        scheduler.addIdle(wait);
+    }
+    r.skipped = scheduler.getTask(sensor).stats.skipped;
+    // Skipped periods are dropped on purpose: count them as readings on the grid
+    r.driftMs = (int32_t)(r.driftMs - (int32_t)(r.skipped * SIM_SENSOR_INTERVAL));
+
+    printf("\n   Wheel task accounting:\n");
+    for (int i = 0; i < scheduler.getTaskCount(); i++) {
+        const ScheduledTask& t = scheduler.getTask(i);
+        printf("     %-8s runs %6lu  skipped %3lu  misses %4lu  late %.1f/%lu ms  cpu %.0f/%lu us\n", t.name,
+               (unsigned long)t.stats.runs, (unsigned long)t.stats.skipped,
+               (unsigned long)t.stats.deadlineMisses, TaskScheduler::meanLateMs(t.stats),
+               (unsigned long)t.stats.lateMaxMs, TaskScheduler::meanCpuUs(t.stats),
+               (unsigned long)t.stats.cpuMaxUs);
+    }
+    printf("     idle %.1f %% of the run\n", scheduler.getIdleMs() * 100.0 / durationMs);
+}
+
+static void print_result(const char* name, const Result& r, uint32_t durationMs) {
+    uint32_t ideal = durationMs / SIM_SENSOR_INTERVAL;
+    printf("   %-8s readings %6lu/%lu  predictions %4lu  drift %+7.1f s  late %5.1f/%4lu ms  "
+           "skipped %3lu  wake-ups %lu\n",
+           name, (unsigned long)r.readings, (unsigned long)ideal, (unsigned long)r.predictions, r.driftMs / 1000.0,
+           r.readings ? r.lateTotalMs / r.readings : 0.0, (unsigned long)r.lateMaxMs, (unsigned long)r.skipped,
+           (unsigned long)r.wakeups);
+}
+
+int main(int argc, char** argv) {
+    double minutes = 60.0;
+    workload.readMs = 9;        // ~100 chars at 115200 baud
+    workload.predictMs = 180;   // 250-tree predict + ~25 printed lines
+    workload.uploadMs = 900;    // Blocking HTTPS upload
+    workload.uploadP = 0.5;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--minutes") == 0 && i + 1 < argc) minutes = atof(argv[++i]);
+        else if (strcmp(argv[i], "--read-ms") == 0 && i + 1 < argc) workload.readMs = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--predict-ms") == 0 && i + 1 < argc) workload.predictMs = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--upload-ms") == 0 && i + 1 < argc) workload.uploadMs = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--upload-p") == 0 && i + 1 < argc) workload.uploadP = atof(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: scheduler_drift_sim [--minutes M] [--read-ms N] [--predict-ms N] "
+                            "[--upload-ms N] [--upload-p P]\n");
+            return 2;
+        }
+    }
+    uint32_t durationMs = (uint32_t)(minutes * 60000.0);
+
+    printf("Scheduler drift: %.0f min, reading %lu ms, prediction %lu ms, upload %lu ms (p=%.2f)\n", minutes,
+           (unsigned long)workload.readMs, (unsigned long)workload.predictMs, (unsigned long)workload.uploadMs,
+           workload.uploadP);
+
+    Result polling, wheel;
+    rng.seed(7);
+    run_polling(polling, durationMs);
+    rng.seed(7);
+    run_wheel(wheel, durationMs);
+
+    printf("\n");
+    print_result("polling", polling, durationMs);
+    print_result("wheel", wheel, durationMs);
+
+    bool ok = wheel.driftMs < (int32_t)SIM_SENSOR_INTERVAL && wheel.driftMs > -(int32_t)SIM_SENSOR_INTERVAL;
+    printf("\n%s\n", ok ? "PASS: wheel stays on the 1 Hz grid" : "FAIL: wheel drifted");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,250 @@
+/*
+ * Serial Console Bench - Line reader, dispatch table and parser (host build)
+ *
+ * Feeds a host-in-the-loop style input stream (mostly
+ * "temperature,humidity,pressure,lux" lines, some commands) byte by byte
+ * through serial_commands.h, the code all three sketches now use, and
+ * through a std::string model of the previous path (+= per byte, trim and
+ * lower-case copies, an == chain, four substr() + strtof()).
+ *
+ * Reports lines/s, ns/line and heap allocations/line for both, and checks
+ * serial_parse_float() against strtof() on random values over the training
+ * ranges plus edge cases. Exits non-zero if the new path allocates, a line
+ * is misparsed or a value is more than 2 ulp from strtof().
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -I../esp32_code serial_console_bench.cpp -o serial_console_bench
+ *
+ * Usage:
+ *   ./serial_console_bench [--lines 200000]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "serial_commands.h"
+
+// ==================== ALLOCATION COUNTER ====================
+// glibc: wrap the allocator entry points (operator new ends up here too)
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* p, size_t size);
+
+static unsigned long allocations = 0;
+
+extern "C" void* malloc(size_t size) {
+    allocations++;
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    allocations++;
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* p, size_t size) {
+    allocations++;
+    return __libc_realloc(p, size);
+}
+
+// ==================== INPUT ====================
+static const char* const SAMPLE_COMMANDS[] = { "stats", "help", "BOOT JSON", "  tasks  ", "netstats json" };
+
+static std::string make_stream(size_t lines, std::vector<float>& expected) {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> temp(19.0f, 30.0f), hum(29.3f, 56.9f), press(96352.7f, 100301.1f),
+        lux(0.0f, 632.1f);
+    std::string stream;
+    char line[96];
+    for (size_t i = 0; i < lines; i++) {
+        if (i % 10 == 9) {
+            stream += SAMPLE_COMMANDS[(i / 10) % 5];
+            stream += "\r\n";
+            continue;
+        }
+        float v[4] = { temp(rng), hum(rng), press(rng), lux(rng) };
+        snprintf(line, sizeof(line), "%.2f,%.2f,%.2f,%.2f\n", v[0], v[1], v[2], v[3]);
+        stream += line;
+        for (int k = 0; k < 4; k++) expected.push_back(strtof(strtok(k ? nullptr : line, ",\n"), nullptr));
+    }
+    return stream;
+}
+
+// ==================== NEW PATH ====================
+static unsigned long commandsRun = 0;
+static void count_command(const char*) { commandsRun++; }
+
+static const SerialCommand COMMANDS[] = {
+    { "help", count_command, "" },      { "?", count_command, "" },          { "stats", count_command, "" },
+    { "test", count_command, "" },      { "benchmark", count_command, "" }, { "clear", count_command, "" },
+    { "boot", count_command, "" },      { "boot json", count_command, "" }, { "tasks", count_command, "" },
+    { "tasks json", count_command, "" }, { "netstats", count_command, "" }, { "netstats json", count_command, "" },
+};
+
+static size_t run_new(const std::string& stream, std::vector<float>& values) {
+    SerialLineReader reader;
+    size_t bad = 0;
+    float v[4];
+    for (char c : stream) {
+        if (reader.feed(c)) {
+            if (!serial_dispatch(COMMANDS, SERIAL_COMMAND_COUNT(COMMANDS), reader.line())) {
+                if (serial_parse_floats(reader.line(), ',', v, 4)) {
+                    for (int k = 0; k < 4; k++) values.push_back(v[k]);
+                } else {
+                    bad++;
+                }
+            }
+            reader.clear();
+        }
+    }
+    return bad;
+}
+
+// ==================== PREVIOUS PATH (model) ====================
+static size_t run_old(const std::string& stream, std::vector<float>& values) {
+    static const char* const names[] = { "help", "?", "stats", "test", "benchmark", "clear", "boot",
+                                         "boot json", "tasks", "tasks json", "netstats", "netstats json" };
+    std::string input;
+    size_t bad = 0;
+    for (char c : stream) {
+        if (c != '\n' && c != '\r') {
+            input += c;
+            continue;
+        }
+        if (input.empty()) continue;
+        std::string trimmed = input.substr(input.find_first_not_of(' '));
+        trimmed = trimmed.substr(0, trimmed.find_last_not_of(' ') + 1);
+        std::string lower = trimmed;
+        for (char& ch : lower) ch = serial_lower(ch);
+        bool matched = false;
+        for (const char* name : names) {
+            if (lower == name) {
+                commandsRun++;
+                matched = true;
+                break;
+            }
+        }
+        if (!matched) {
+            size_t c1 = trimmed.find(','), c2 = trimmed.find(',', c1 + 1), c3 = trimmed.find(',', c2 + 1);
+            if (c1 == std::string::npos || c2 == std::string::npos || c3 == std::string::npos) {
+                bad++;
+            } else {
+                values.push_back(strtof(trimmed.substr(0, c1).c_str(), nullptr));
+                values.push_back(strtof(trimmed.substr(c1 + 1, c2 - c1 - 1).c_str(), nullptr));
+                values.push_back(strtof(trimmed.substr(c2 + 1, c3 - c2 - 1).c_str(), nullptr));
+                values.push_back(strtof(trimmed.substr(c3 + 1).c_str(), nullptr));
+            }
+        }
+        input.clear();
+        input.shrink_to_fit();   // Arduino: inputString = "" drops the buffer
+    }
+    return bad;
+}
+
+// ==================== PARSER ACCURACY ====================
+static int32_t ulp_distance(float a, float b) {
+    int32_t ia, ib;
+    memcpy(&ia, &a, 4);
+    memcpy(&ib, &b, 4);
+    if ((ia < 0) != (ib < 0)) return a == b ? 0 : INT32_MAX;
+    return ia > ib ? ia - ib : ib - ia;
+}
+
+static int32_t check_parser(size_t samples, size_t& failures) {
+    static const char* const edges[] = { "0", "-0.0", "1e5", "1.0132E+05", "0.000123", "123456789012",
+                                         "3.4e38", "1e-30", "+7.", ".5", "99999.995", "100301.06" };
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<double> value(-1000.0, 110000.0);
+    std::uniform_int_distribution<int> decimals(0, 6);
+    int32_t worst = 0;
+    failures = 0;
+    char text[64];
+    for (size_t i = 0; i < samples + sizeof(edges) / sizeof(edges[0]); i++) {
+        if (i < samples) snprintf(text, sizeof(text), "%.*f", decimals(rng), value(rng));
+        else snprintf(text, sizeof(text), "%s", edges[i - samples]);
+        const char* p = text;
+        float parsed;
+        if (!serial_parse_float(&p, &parsed) || *p != '\0') {
+            failures++;
+            continue;
+        }
+        int32_t d = ulp_distance(parsed, strtof(text, nullptr));
+        if (d > worst) worst = d;
+        if (d > 2) {
+            failures++;
+            if (failures <= 5) printf("   parse %s -> %.9g (strtof %.9g, %d ulp)\n", text, parsed,
+                                      strtof(text, nullptr), d);
+        }
+    }
+    // Malformed input must be rejected
+    float out[4];
+    static const char* const invalid[] = { "", "abc", "1,2,3", "1,2,3,4,5", "1,2,,4", "1,2,3,4x", "-,1,2,3" };
+    for (const char* text : invalid) {
+        if (serial_parse_floats(text, ',', out, 4)) {
+            failures++;
+            printf("   accepted malformed line \"%s\"\n", text);
+        }
+    }
+    return worst;
+}
+
+int main(int argc, char** argv) {
+    size_t lines = 200000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--lines") == 0 && i + 1 < argc) lines = (size_t)atol(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: serial_console_bench [--lines N]\n");
+            return 2;
+        }
+    }
+
+    std::vector<float> expected;
+    std::string stream = make_stream(lines, expected);
+    printf("Serial console: %zu lines (%zu bytes, 1 in 10 a command)\n\n", lines, stream.size());
+
+    std::vector<float> newValues, oldValues;
+    newValues.reserve(expected.size());
+    oldValues.reserve(expected.size());
+
+    commandsRun = 0;
+    unsigned long before = allocations;
+    auto start = std::chrono::steady_clock::now();
+    size_t newBad = run_new(stream, newValues);
+    double newNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    unsigned long newAllocs = allocations - before;
+    unsigned long newCommands = commandsRun;
+
+    commandsRun = 0;
+    before = allocations;
+    start = std::chrono::steady_clock::now();
+    size_t oldBad = run_old(stream, oldValues);
+    double oldNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    unsigned long oldAllocs = allocations - before;
+
+    printf("   Path               lines/s    ns/line   allocs/line   commands   rejected\n");
+    printf("   serial_commands %10.0f %10.1f %13.2f %10lu %10zu\n", lines / (newNs / 1e9), newNs / lines,
+           (double)newAllocs / lines, newCommands, newBad);
+    printf("   String model    %10.0f %10.1f %13.2f %10lu %10zu\n", lines / (oldNs / 1e9), oldNs / lines,
+           (double)oldAllocs / lines, commandsRun, oldBad);
+
+    size_t mismatches = newValues.size() == expected.size() ? 0 : expected.size();
+    for (size_t i = 0; i < newValues.size() && i < expected.size(); i++) {
+        if (ulp_distance(newValues[i], expected[i]) > 2) mismatches++;
+    }
+
+    size_t parserFailures;
+    int32_t worst = check_parser(1000000, parserFailures);
+    printf("\n   Parser vs strtof: worst %d ulp, %zu failures; stream values off by > 2 ulp: %zu\n", worst,
+           parserFailures, mismatches);
+
+    bool ok = newAllocs == 0 && newBad == 0 && mismatches == 0 && parserFailures == 0 &&
+              newCommands == lines / 10;
+    printf("\n%s\n", ok ? "PASS: no allocations, every line parsed" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,413 @@
+/*
+ * Telemetry Collector - Host-side receiver for binary telemetry frames
+ *
+ * Receives frames from CollectorSink (telemetry_codec.h) or Gorilla blocks
+ * (gorilla_block.h) over UDP or TCP, decodes them and re-emits every
+ * record in a cloud-compatible text form:
+ * - thingspeak: field1=..&...&field8=.. (one line per record)
+ * - firebase:   PUT /devices/{id}/readings/{ts}.json {...}
+ * - csv:        same columns as the on-device LittleFS log
+ *
+ * Also benchmarks the binary framing against the text payloads the device
+ * currently sends (bytes per record, encode and decode throughput).
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -I../esp32_code telemetry_collector.cpp -o telemetry_collector
+ *
+ * Usage:
+ *   ./telemetry_collector --udp 5140 [--emit thingspeak|firebase|csv]
+ *   ./telemetry_collector --tcp 5140 [--emit ...]
+ *   ./telemetry_collector --bench 100000
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "telemetry_record.h"
+#include "telemetry_codec.h"
+#include "gorilla_block.h"
+
+#define MAX_FRAME_RECORDS 255
+
+enum EmitFormat { EMIT_THINGSPEAK, EMIT_FIREBASE, EMIT_CSV };
+
+// ==================== RE-EMISSION ====================
+static void format_device_id(const uint8_t mac[6], char* out) {
+    snprintf(out, 13, "%02X%02X%02X%02X%02X%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+}
+
+static void emit_record(const TelemetryRecord& r, const char* deviceId, EmitFormat format) {
+    char text[TELEMETRY_MAX_PAYLOAD];
+    switch (format) {
+        case EMIT_THINGSPEAK:
+            telemetry_encode_thingspeak(r, text, sizeof(text));
+            printf("%s\n", text);
+            break;
+        case EMIT_FIREBASE:
+            telemetry_encode_firebase_json(r, deviceId, text, sizeof(text));
+            printf("PUT /devices/%s/readings/%llu.json %s\n", deviceId,
+                   (unsigned long long)r.epochMs, text);
+            break;
+        case EMIT_CSV:
+            telemetry_encode_csv(r, text, sizeof(text));
+            fputs(text, stdout);
+            break;
+    }
+}
+
+// Frames carry boot-relative timestamps only: the newest record is taken
+// as "now" on the collector's wall clock
+static void stamp_receipt(TelemetryRecord* records, int count) {
+    uint64_t nowMs = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    uint64_t newest = 0;
+    for (int i = 0; i < count; i++) {
+        if (records[i].timestampMs > newest) newest = records[i].timestampMs;
+    }
+    for (int i = 0; i < count; i++) {
+        records[i].epochMs = nowMs - (newest - records[i].timestampMs);
+    }
+}
+
+// Gorilla blocks carry raw samples only (no device id, votes or timing)
+static void handle_gorilla_block(const uint8_t* block, size_t length, EmitFormat format) {
+    GorillaBlockDecoder decoder(block, length);
+    std::vector<TelemetryRecord> samples;
+    TelemetryRecord r;
+    memset(&r, 0, sizeof(r));
+    float values[GORILLA_CHANNELS];
+    while (decoder.next(r.timestampMs, values, r.predictedClass)) {
+        r.temperature = values[0];
+        r.humidity = values[1];
+        r.pressure = values[2];
+        r.lux = values[3];
+        r.gas = values[4];
+        samples.push_back(r);
+    }
+    int count = (int)samples.size();
+    if (count > 0) stamp_receipt(samples.data(), count);
+    for (const TelemetryRecord& sample : samples) {
+        emit_record(sample, "unknown", format);
+    }
+    if (!decoder.isValid()) {
+        fprintf(stderr, "⚠️  Gorilla block (%zu bytes) corrupt after %d samples\n", length, count);
+    } else {
+        fprintf(stderr, "📥 Gorilla block: %d samples, %zu bytes\n", count, length);
+    }
+    fflush(stdout);
+}
+
+static void handle_frame(const uint8_t* frame, size_t length, EmitFormat format) {
+    if (length >= 2 && frame[0] == 'G' && frame[1] == 'B') {
+        handle_gorilla_block(frame, length, format);
+        return;
+    }
+
+    static TelemetryRecord records[MAX_FRAME_RECORDS];
+    TelemetryFrameHeader header;
+    int count = telemetry_decode_frame(frame, length, header, records, MAX_FRAME_RECORDS);
+    if (count < 0) {
+        fprintf(stderr, "⚠️  Dropped frame (%zu bytes): decode error %d\n", length, count);
+        return;
+    }
+
+    char deviceId[13];
+    format_device_id(header.deviceId, deviceId);
+    fprintf(stderr, "📥 Frame #%u from %s: %d records, %zu bytes\n",
+            header.sequence, deviceId, count, length);
+    stamp_receipt(records, count);
+    for (int i = 0; i < count; i++) {
+        emit_record(records[i], deviceId, format);
+    }
+    fflush(stdout);
+}
+
+// ==================== TRANSPORTS ====================
+static int open_listener(int type, uint16_t port) {
+    int fd = socket(AF_INET, type, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        close(fd);
+        return -1;
+    }
+    if (type == SOCK_STREAM && listen(fd, 4) < 0) {
+        perror("listen");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int run_udp(uint16_t port, EmitFormat format) {
+    int fd = open_listener(SOCK_DGRAM, port);
+    if (fd < 0) return 1;
+    fprintf(stderr, "📡 Listening for telemetry frames on UDP %u\n", port);
+
+    uint8_t frame[2048];
+    for (;;) {
+        ssize_t n = recv(fd, frame, sizeof(frame), 0);
+        if (n > 0) handle_frame(frame, (size_t)n, format);
+    }
+}
+
+static bool read_exact(int fd, uint8_t* buffer, size_t length) {
+    size_t got = 0;
+    while (got < length) {
+        ssize_t n = recv(fd, buffer + got, length - got, 0);
+        if (n <= 0) return false;
+        got += (size_t)n;
+    }
+    return true;
+}
+
+static int run_tcp(uint16_t port, EmitFormat format) {
+    int fd = open_listener(SOCK_STREAM, port);
+    if (fd < 0) return 1;
+    fprintf(stderr, "📡 Listening for telemetry frames on TCP %u\n", port);
+
+    uint8_t frame[65536];
+    for (;;) {
+        int conn = accept(fd, nullptr, nullptr);
+        if (conn < 0) continue;
+        fprintf(stderr, "🔌 Device connected\n");
+
+        uint8_t prefix[2];
+        while (read_exact(conn, prefix, 2)) {
+            size_t length = (size_t)prefix[0] | ((size_t)prefix[1] << 8);
+            if (!read_exact(conn, frame, length)) break;
+            handle_frame(frame, length, format);
+        }
+        close(conn);
+        fprintf(stderr, "🔌 Device disconnected\n");
+    }
+}
+
+// ==================== BENCHMARK ====================
+static double elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+// Simulator-like trace: 15 s cadence, values drifting inside the training ranges
+static void make_trace(std::vector<TelemetryRecord>& trace, size_t count) {
+    trace.resize(count);
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < count; i++) {
+        seed = seed * 1103515245u + 12345u;
+        float noise = ((seed >> 16) % 1000) / 1000.0f;
+        TelemetryRecord& r = trace[i];
+        memset(&r, 0, sizeof(r));
+        int pattern = (int)((i / 2) % 5);
+        r.timestampMs = 15000ULL * i + (seed % 7);
+        r.epochMs = 1700000000000ULL + r.timestampMs;
+        r.temperature = 20.0f + pattern + noise * 2.0f;
+        r.humidity = 35.0f + pattern * 3.0f + noise * 4.0f;
+        r.pressure = 97000.0f + pattern * 500.0f + noise * 300.0f;
+        r.lux = 30.0f + pattern * 60.0f + noise * 40.0f;
+        r.gas = 200.0f + noise * 400.0f;
+        r.predictedClass = (uint8_t)pattern;
+        r.votes[pattern] = 230;
+        r.votes[(pattern + 1) % 5] = 20;
+        r.inferenceTime = 150 + (seed % 60);
+        r.rssi = (int8_t)(-50 - (int)(noise * 20));
+    }
+}
+
+// Minimal text decoders (what a collector would need to do for the text formats)
+static int decode_thingspeak(const char* text, TelemetryRecord& r) {
+    int fields = 0;
+    for (const char* p = strstr(text, "field"); p; p = strstr(p, "&field")) {
+        if (*p == '&') p++;
+        int index = p[5] - '0';
+        double value = strtod(p + 7, nullptr);
+        switch (index) {
+            case 1: r.temperature = (float)value; break;
+            case 2: r.humidity = (float)value; break;
+            case 3: r.pressure = (float)value; break;
+            case 4: r.lux = (float)value; break;
+            case 5: r.gas = (float)value; break;
+            case 6: r.predictedClass = (uint8_t)value; break;
+            case 7: r.inferenceTime = (uint32_t)value; break;
+            case 8: r.rssi = (int8_t)value; break;
+        }
+        fields++;
+        p += 7;
+    }
+    return fields;
+}
+
+static double json_number(const char* text, const char* key) {
+    const char* p = strstr(text, key);
+    return p ? strtod(p + strlen(key), nullptr) : 0.0;
+}
+
+static int decode_firebase_json(const char* text, TelemetryRecord& r) {
+    r.temperature = (float)json_number(text, "\"temperature\":");
+    r.humidity = (float)json_number(text, "\"humidity\":");
+    r.pressure = (float)json_number(text, "\"pressure\":");
+    r.lux = (float)json_number(text, "\"lux\":");
+    r.gas = (float)json_number(text, "\"gas_ppm\":");
+    r.predictedClass = (uint8_t)json_number(text, "\"class_id\":");
+    r.inferenceTime = (uint32_t)json_number(text, "\"inference_time\":");
+    r.rssi = (int8_t)json_number(text, "\"rssi\":");
+    r.epochMs = (uint64_t)json_number(text, "\"timestamp\":");
+    return 1;
+}
+
+static int run_bench(size_t count) {
+    std::vector<TelemetryRecord> trace;
+    make_trace(trace, count);
+    std::vector<TelemetryRecord> decoded(count);
+    const uint8_t mac[6] = {0x24, 0x0A, 0xC4, 0x12, 0x34, 0x56};
+    char text[TELEMETRY_MAX_PAYLOAD];
+    volatile size_t guard = 0;
+
+    printf("Telemetry payload benchmark (%zu records)\n", count);
+    printf("──────────────────────────────────────────────────────────────────────\n");
+    printf("Format                     B/record   encode rec/s   decode rec/s\n");
+    printf("──────────────────────────────────────────────────────────────────────\n");
+
+    // ThingSpeak query (+ the fixed URL prefix the device sends)
+    const size_t urlPrefix = strlen("http://api.thingspeak.com/update?api_key=XXXXXXXXXXXXXXXX&");
+    size_t bytes = 0;
+    std::vector<std::string> encoded(count);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i++) {
+        int n = telemetry_encode_thingspeak(trace[i], text, sizeof(text));
+        bytes += (size_t)n + urlPrefix;
+        encoded[i].assign(text, (size_t)n);
+    }
+    double encodeNs = elapsed_ns(start);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i++) guard += decode_thingspeak(encoded[i].c_str(), decoded[i]);
+    double decodeNs = elapsed_ns(start);
+    printf("ThingSpeak URL             %8.1f   %12.0f   %12.0f\n",
+           (double)bytes / count, count / encodeNs * 1e9, count / decodeNs * 1e9);
+
+    // Firebase reading JSON
+    bytes = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i++) {
+        int n = telemetry_encode_firebase_json(trace[i], "240AC4123456", text, sizeof(text));
+        bytes += (size_t)n;
+        encoded[i].assign(text, (size_t)n);
+    }
+    encodeNs = elapsed_ns(start);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i++) guard += decode_firebase_json(encoded[i].c_str(), decoded[i]);
+    decodeNs = elapsed_ns(start);
+    printf("Firebase JSON              %8.1f   %12.0f   %12.0f\n",
+           (double)bytes / count, count / encodeNs * 1e9, count / decodeNs * 1e9);
+
+    // Binary frames at several batch sizes
+    const int batches[] = {1, 4, 16, 64};
+    static TelemetryRecord frameRecords[MAX_FRAME_RECORDS];
+    for (int batch : batches) {
+        std::vector<std::vector<uint8_t>> frames;
+        uint8_t frame[8192];
+        TelemetryFrameEncoder encoder(frame, sizeof(frame));
+        bytes = 0;
+        uint16_t sequence = 0;
+
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i += (size_t)batch) {
+            encoder.begin(mac, sequence++, trace[i].timestampMs);
+            for (size_t j = i; j < i + (size_t)batch && j < count; j++) encoder.add(trace[j]);
+            size_t length = encoder.finish();
+            bytes += length;
+            frames.emplace_back(frame, frame + length);
+        }
+        encodeNs = elapsed_ns(start);
+
+        size_t decodedCount = 0;
+        double maxError = 0.0;
+        start = std::chrono::steady_clock::now();
+        for (const auto& f : frames) {
+            TelemetryFrameHeader header;
+            int n = telemetry_decode_frame(f.data(), f.size(), header, frameRecords, MAX_FRAME_RECORDS);
+            if (n > 0) {
+                double err = fabs(frameRecords[0].pressure - trace[decodedCount].pressure);
+                if (err > maxError) maxError = err;
+                decodedCount += (size_t)n;
+            }
+        }
+        decodeNs = elapsed_ns(start);
+        guard += decodedCount;
+
+        char label[32];
+        snprintf(label, sizeof(label), "Binary frame x%d", batch);
+        printf("%-26s %8.1f   %12.0f   %12.0f\n",
+               label, (double)bytes / count, count / encodeNs * 1e9, count / decodeNs * 1e9);
+        if (decodedCount != count || maxError > 0.06) {
+            printf("   ❌ Round-trip mismatch (%zu/%zu records, max pressure error %.3f Pa)\n",
+                   decodedCount, count, maxError);
+            return 1;
+        }
+    }
+    printf("──────────────────────────────────────────────────────────────────────\n");
+    printf("(UDP/IP adds 28 B per datagram; HTTP adds ~150-300 B of headers per request)\n");
+    return guard == 0;
+}
+
+// ==================== MAIN ====================
+static void print_usage() {
+    fprintf(stderr,
+            "Usage:\n"
+            "  telemetry_collector --udp PORT [--emit thingspeak|firebase|csv]\n"
+            "  telemetry_collector --tcp PORT [--emit thingspeak|firebase|csv]\n"
+            "  telemetry_collector --bench RECORDS\n");
+}
+
+int main(int argc, char** argv) {
+    EmitFormat format = EMIT_THINGSPEAK;
+    int udpPort = -1;
+    int tcpPort = -1;
+    long benchRecords = -1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--udp") == 0 && i + 1 < argc) {
+            udpPort = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--tcp") == 0 && i + 1 < argc) {
+            tcpPort = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc) {
+            benchRecords = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--emit") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (strcmp(name, "firebase") == 0) format = EMIT_FIREBASE;
+            else if (strcmp(name, "csv") == 0) format = EMIT_CSV;
+            else format = EMIT_THINGSPEAK;
+        } else {
+            print_usage();
+            return 2;
+        }
+    }
+
+    if (benchRecords > 0) return run_bench((size_t)benchRecords);
+    if (format == EMIT_CSV) fputs(TELEMETRY_CSV_HEADER, stdout);
+    if (udpPort > 0) return run_udp((uint16_t)udpPort, format);
+    if (tcpPort > 0) return run_tcp((uint16_t)tcpPort, format);
+
+    print_usage();
+    return 2;
+}
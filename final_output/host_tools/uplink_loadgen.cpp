@@ -0,0 +1,313 @@
+/*
+ * Uplink Load Generator - HTTP-per-reading vs MQTT uplink comparison
+ *
+ * Publishes the same telemetry records through:
+ * - HTTP GET per record (ThingSpeak URL + ESP32 HTTPClient headers, new TCP
+ *   connection each time, exactly what CloudManager does)
+ * - MqttUplink (mqtt_uplink.h, the code that runs on the ESP32) at QoS 0,
+ *   QoS 1 stop-and-wait, QoS 1 with the in-flight window, and QoS 1 with
+ *   publish batching (linger)
+ *
+ * Reports messages/sec, application bytes on the wire per record, TCP
+ * connections and latency percentiles. Run against mqtt_broker_standin.
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -I../esp32_code uplink_loadgen.cpp -o uplink_loadgen
+ *
+ * Usage:
+ *   ./mqtt_broker_standin --delay-ms 20 &
+ *   ./uplink_loadgen [--host 127.0.0.1] [--mqtt-port 1883] [--http-port 8080] [--records 500]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "telemetry_record.h"
+#include "mqtt_uplink.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static const Clock::time_point processStart = Clock::now();
+
+static uint32_t host_millis() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        Clock::now() - processStart).count();
+}
+
+static double elapsed_us(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count() / 1000.0;
+}
+
+static int tcp_connect(const char* host, uint16_t port) {
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+    if (getaddrinfo(host, service, &hints, &result) != 0) return -1;
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, result->ai_addr, result->ai_addrlen) < 0) {
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(result);
+    if (fd >= 0) {
+        int yes = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    }
+    return fd;
+}
+
+// ==================== TRANSPORT ====================
+class SocketMqttTransport : public MqttTransport {
+private:
+    int fd = -1;
+
+public:
+    unsigned long connections = 0;
+
+    bool open(const char* host, uint16_t port) override {
+        fd = tcp_connect(host, port);
+        if (fd >= 0) connections++;
+        return fd >= 0;
+    }
+
+    bool isOpen() override { return fd >= 0; }
+
+    size_t write(const uint8_t* data, size_t length) override {
+        if (fd < 0) return 0;
+        size_t sent = 0;
+        while (sent < length) {
+            ssize_t n = send(fd, data + sent, length - sent, MSG_NOSIGNAL);
+            if (n <= 0) break;
+            sent += (size_t)n;
+        }
+        return sent;
+    }
+
+    int read(uint8_t* data, size_t length) override {
+        if (fd < 0) return -1;
+        ssize_t n = recv(fd, data, length, MSG_DONTWAIT);
+        if (n > 0) return (int)n;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+        return -1;
+    }
+
+    void close() override {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+};
+
+// ==================== RESULTS ====================
+struct RunResult {
+    const char* name;
+    unsigned long records;
+    double seconds;
+    unsigned long bytesSent;
+    unsigned long bytesReceived;
+    unsigned long connections;
+    unsigned long writes;
+    std::vector<double> latencyUs;
+};
+
+static double percentile(std::vector<double>& values, double p) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t)(p * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+static void print_result(RunResult& r) {
+    double p50 = percentile(r.latencyUs, 0.50) / 1000.0;
+    double p99 = percentile(r.latencyUs, 0.99) / 1000.0;
+    printf("%-24s %9.0f %9.1f %8.1f %6lu %7lu ",
+           r.name, r.records / r.seconds,
+           (double)r.bytesSent / r.records, (double)r.bytesReceived / r.records,
+           r.connections, r.writes);
+    if (r.latencyUs.empty()) printf("%8s %8s\n", "-", "-");
+    else printf("%8.2f %8.2f\n", p50, p99);
+}
+
+static void make_record(TelemetryRecord& r, unsigned long i) {
+    memset(&r, 0, sizeof(r));
+    r.timestampMs = 15000ULL * i;
+    r.epochMs = 1700000000000ULL + r.timestampMs;
+    r.temperature = 20.0f + (i % 100) * 0.1f;
+    r.humidity = 40.0f + (i % 50) * 0.2f;
+    r.pressure = 98000.0f + (i % 2000);
+    r.lux = (float)(i % 600);
+    r.gas = 150.0f + (i % 800);
+    r.predictedClass = (uint8_t)(i % TELEMETRY_NUM_CLASSES);
+    r.votes[r.predictedClass] = 240;
+    r.inferenceTime = 180 + (uint32_t)(i % 40);
+    r.rssi = -55;
+}
+
+// ==================== HTTP PATH ====================
+static bool run_http(const char* host, uint16_t port, unsigned long records, RunResult& result) {
+    char fields[TELEMETRY_MAX_PAYLOAD];
+    char request[768];
+    char response[512];
+    TelemetryRecord record;
+
+    Clock::time_point start = Clock::now();
+    for (unsigned long i = 0; i < records; i++) {
+        make_record(record, i);
+        telemetry_encode_thingspeak(record, fields, sizeof(fields));
+        int length = snprintf(request, sizeof(request),
+                              "GET /update?api_key=XXXXXXXXXXXXXXXX&%s HTTP/1.1\r\n"
+                              "Host: api.thingspeak.com\r\n"
+                              "User-Agent: ESP32HTTPClient\r\n"
+                              "Connection: close\r\n"
+                              "Accept-Encoding: identity;q=1,chunked;q=0.1,*;q=0\r\n"
+                              "\r\n", fields);
+
+        Clock::time_point sent = Clock::now();
+        int fd = tcp_connect(host, port);
+        if (fd < 0) {
+            fprintf(stderr, "❌ HTTP connect to %s:%u failed\n", host, port);
+            return false;
+        }
+        result.connections++;
+        result.writes++;
+        if (send(fd, request, (size_t)length, MSG_NOSIGNAL) != length) {
+            close(fd);
+            return false;
+        }
+        result.bytesSent += (unsigned long)length;
+
+        ssize_t n;
+        while ((n = recv(fd, response, sizeof(response), 0)) > 0) {
+            result.bytesReceived += (unsigned long)n;
+        }
+        close(fd);
+        result.latencyUs.push_back(elapsed_us(sent));
+    }
+    result.seconds = elapsed_us(start) / 1e6;
+    return true;
+}
+
+// ==================== MQTT PATH ====================
+enum MqttMode { MQTT_QOS0, MQTT_QOS1_STOP_AND_WAIT, MQTT_QOS1_WINDOW, MQTT_QOS1_BATCHED };
+
+static bool run_mqtt(const char* host, uint16_t port, unsigned long records,
+                     MqttMode mode, RunResult& result) {
+    static SocketMqttTransport transport;
+    static MqttUplink mqtt(&transport, host_millis);
+    static char clientId[32];
+
+    transport.connections = 0;
+    snprintf(clientId, sizeof(clientId), "loadgen-%d", (int)mode);
+    mqtt.configure(host, port, clientId);
+    mqtt.setLinger(mode == MQTT_QOS1_BATCHED ? 20 : 0);
+    if (!mqtt.connect()) {
+        fprintf(stderr, "❌ MQTT connect to %s:%u failed\n", host, port);
+        return false;
+    }
+    mqtt.resetStats();
+
+    uint8_t qos = mode == MQTT_QOS0 ? 0 : 1;
+    char payload[TELEMETRY_MAX_PAYLOAD];
+    TelemetryRecord record;
+
+    Clock::time_point start = Clock::now();
+    for (unsigned long i = 0; i < records; i++) {
+        make_record(record, i);
+        int length = telemetry_encode_firebase_json(record, "240AC4123456", payload, sizeof(payload));
+
+        Clock::time_point sent = Clock::now();
+        while (!mqtt.publish("weather/240AC4123456/reading", (const uint8_t*)payload,
+                             (size_t)length, qos)) {
+            mqtt.loop();   // Window full: service acks until a slot frees up
+            if (!mqtt.isConnected()) return false;
+        }
+        if (mode == MQTT_QOS1_STOP_AND_WAIT) {
+            if (!mqtt.waitForAcks(3 * MQTT_RETRY_MS)) return false;
+            result.latencyUs.push_back(elapsed_us(sent));
+        } else {
+            mqtt.loop();
+        }
+    }
+    if (qos == 1 && !mqtt.waitForAcks(3 * MQTT_RETRY_MS)) {
+        fprintf(stderr, "❌ %d publishes never acknowledged\n", mqtt.getInflightCount());
+        return false;
+    }
+    mqtt.flush();
+    result.seconds = elapsed_us(start) / 1e6;
+
+    const MqttStats& stats = mqtt.getStats();
+    result.bytesSent = stats.bytesSent;
+    result.bytesReceived = stats.bytesReceived;
+    result.writes = stats.writes;
+    result.connections = transport.connections;
+    if (mode != MQTT_QOS1_STOP_AND_WAIT && stats.acked > 0) {
+        // Average publish→PUBACK (ms resolution from the uplink itself)
+        result.latencyUs.assign(1, 1000.0 * stats.ackLatencyTotalMs / stats.acked);
+    }
+    mqtt.disconnect();
+    return true;
+}
+
+// ==================== MAIN ====================
+int main(int argc, char** argv) {
+    const char* host = "127.0.0.1";
+    uint16_t mqttPort = 1883;
+    uint16_t httpPort = 8080;
+    unsigned long records = 500;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--host") == 0 && i + 1 < argc) host = argv[++i];
+        else if (strcmp(argv[i], "--mqtt-port") == 0 && i + 1 < argc) mqttPort = (uint16_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--http-port") == 0 && i + 1 < argc) httpPort = (uint16_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--records") == 0 && i + 1 < argc) records = strtoul(argv[++i], nullptr, 10);
+        else {
+            fprintf(stderr, "Usage: uplink_loadgen [--host H] [--mqtt-port P] [--http-port P] [--records N]\n");
+            return 2;
+        }
+    }
+    if (records == 0) records = 1;
+
+    RunResult results[5] = {
+        { "HTTP GET per record", records, 0, 0, 0, 0, 0, {} },
+        { "MQTT QoS0", records, 0, 0, 0, 0, 0, {} },
+        { "MQTT QoS1 stop-and-wait", records, 0, 0, 0, 0, 0, {} },
+        { "MQTT QoS1 window", records, 0, 0, 0, 0, 0, {} },
+        { "MQTT QoS1 batched", records, 0, 0, 0, 0, 0, {} },
+    };
+
+    bool ok = run_http(host, httpPort, records, results[0]);
+    ok = ok && run_mqtt(host, mqttPort, records, MQTT_QOS0, results[1]);
+    ok = ok && run_mqtt(host, mqttPort, records, MQTT_QOS1_STOP_AND_WAIT, results[2]);
+    ok = ok && run_mqtt(host, mqttPort, records, MQTT_QOS1_WINDOW, results[3]);
+    ok = ok && run_mqtt(host, mqttPort, records, MQTT_QOS1_BATCHED, results[4]);
+    if (!ok) return 1;
+
+    printf("Uplink comparison: %lu records to %s (window %d, batch linger 20 ms)\n",
+           records, host, MQTT_INFLIGHT_WINDOW);
+    printf("─────────────────────────────────────────────────────────────────────────────────\n");
+    printf("%-24s %9s %9s %8s %6s %7s %8s %8s\n",
+           "Path", "msg/s", "B out/rec", "B in/rec", "conns", "writes", "p50 ms", "p99 ms");
+    printf("─────────────────────────────────────────────────────────────────────────────────\n");
+    for (RunResult& r : results) print_result(r);
+    printf("─────────────────────────────────────────────────────────────────────────────────\n");
+    printf("Bytes are TCP payload only; every HTTP connection also costs a 3-way handshake\n");
+    printf("and teardown (~7 extra segments). Window/batched latency is the PUBACK average.\n");
+    return 0;
+}
@@ -0,0 +1,421 @@
+/*
+ * WiFi Outage Simulator - Loop latency through access point outages
+ *
+ * Runs the main loop in virtual time against a fake WiFi driver (scripted
+ * access point outages, association delay, beacon-loss detection) with
+ * two connection managers:
+ * - blocking: the previous WiFiManager logic, modelled call for call
+ *   (update() every 10 s → connect() → up to 5 attempts of 20 s polled in
+ *   500 ms delay() steps, 5 s delay() between attempts, gives up after 5)
+ * - link:     wifi_link.h, the state machine WiFiManager now runs
+ *   (event-driven, never waits, backoff 1..30 s with jitter)
+ * - link+cache: the same with the fast-connect cache (wifi_connect_cache.h):
+ *   directed association to the last access point (DHCP still runs)
+ *
+ * Every loop iteration does 1 ms of work (sampling/prediction) plus
+ * whatever the WiFi code blocks for. Reports loop latency, stalls
+ * (iterations >= 100 ms), 1 Hz sample slots missed, time connected and how
+ * long each manager took to come back after the access point did. Exits
+ * non-zero if the state machine ever stalls the loop or fails to recover.
+ *
+ * --boots N reboots the device N times instead and measures boot-to-
+ * connected with and without the cache. The cache persists across boots in
+ * --cache-file (the host stand-in for NVS); halfway through, the access
+ * point moves to another channel, so the fallback and rewrite are exercised.
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -I../esp32_code wifi_outage_sim.cpp -o wifi_outage_sim
+ *
+ * Usage:
+ *   ./wifi_outage_sim [--minutes 60] [--outage-s 600] [--short-outage-s 45] [--assoc-ms 3000]
+ *   ./wifi_outage_sim --boots 20 [--cache-file wifi_cache.bin] [--assoc-ms 3000] [--fast-ms 1000]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "wifi_link.h"
+#include "wifi_connect_cache.h"
+#include "latency_histogram.h"
+
+#define SIM_WORK_MS 1                 // Work per loop iteration
+#define SIM_SAMPLE_MS 1000            // Sensor sampling cadence
+#define SIM_SCAN_MS 2500              // Failed scan (AP missing) before the driver reports it
+#define SIM_DIRECTED_MISS_MS 800      // Directed probe on one channel finds nothing
+#define SIM_BOOT_LIMIT_MS 60000       // Boot bench: give up on a boot after this
+#define SIM_BEACON_TIMEOUT_MS 6000    // Link loss noticed after this many ms of missing beacons
+#define SIM_STALL_MS 100              // Iterations at least this long count as stalls
+
+// ==================== FAKE DRIVER ====================
+struct Outage {
+    uint32_t startMs, endMs;
+};
+
+enum FakeEvent { FAKE_NONE, FAKE_GOT_IP, FAKE_DISCONNECTED };
+
+struct FakeDriver {
+    std::vector<Outage> outages;
+    uint32_t assocMs = 3000;          // Scan all channels + association + DHCP
+    uint32_t fastAssocMs = 1000;      // Known channel/BSSID, then DHCP
+    uint8_t bssid[6] = { 0x24, 0x0A, 0xC4, 0x12, 0x34, 0x56 };
+    uint8_t channel = 6;
+
+    enum { IDLE, ASSOCIATING, CONNECTED } state = IDLE;
+    uint32_t doneAtMs = 0;
+    bool willSucceed = false;
+
+    bool apUp(uint32_t t) const {
+        for (const Outage& o : outages) {
+            if (t >= o.startMs && t < o.endMs) return false;
+        }
+        return true;
+    }
+
+    void begin(uint32_t now) {
+        state = ASSOCIATING;
+        willSucceed = apUp(now);
+        doneAtMs = now + (willSucceed ? assocMs : SIM_SCAN_MS);
+    }
+
+    // WiFi.begin(ssid, pass, channel, bssid) with a static configuration
+    void beginDirected(uint32_t now, uint8_t ch, const uint8_t* id) {
+        state = ASSOCIATING;
+        willSucceed = apUp(now) && ch == channel && memcmp(id, bssid, sizeof(bssid)) == 0;
+        doneAtMs = now + (willSucceed ? fastAssocMs : SIM_DIRECTED_MISS_MS);
+    }
+
+    void disconnect() { state = IDLE; }   // Self-initiated: no event reported
+
+    // Advance to `now`; returns the event the driver task would post
+    FakeEvent advance(uint32_t now) {
+        if (state == ASSOCIATING && now >= doneAtMs) {
+            if (willSucceed && apUp(now)) {
+                state = CONNECTED;
+                return FAKE_GOT_IP;
+            }
+            state = IDLE;
+            return FAKE_DISCONNECTED;
+        }
+        if (state == CONNECTED && !apUp(now) && !apUp(now - SIM_BEACON_TIMEOUT_MS)) {
+            state = IDLE;
+            return FAKE_DISCONNECTED;
+        }
+        return FAKE_NONE;
+    }
+
+    bool connected() const { return state == CONNECTED; }
+};
+
+// ==================== MANAGERS ====================
+// Previous WiFiManager: blocking attempts inside update(); `now` advances
+// while it waits, exactly like delay() stalls loop()
+struct BlockingManager {
+    enum { IDLE, CONNECTED, DISCONNECTED, FAILED } status = IDLE;
+    uint32_t lastCheckMs = 0;
+    int retryCount = 0;
+
+    void connect(FakeDriver& d, uint32_t& now) {
+        retryCount = 0;
+        for (;;) {
+            retryCount++;
+            d.disconnect();
+            now += 100;                                  // delay(100)
+            d.begin(now);
+            uint32_t start = now;
+            while (!d.connected() && now - start < 20000) {
+                now += 500;                              // delay(500)
+                d.advance(now);
+            }
+            if (d.connected()) {
+                status = CONNECTED;
+                return;
+            }
+            if (retryCount >= 5) {
+                status = FAILED;                         // 'reconnect' command needed
+                return;
+            }
+            now += 5000;                                 // delay(WIFI_RETRY_DELAY_MS)
+        }
+    }
+
+    // setup(): connect() blocks before loop() starts
+    void setup(FakeDriver& d, uint32_t& now) { connect(d, now); }
+
+    void update(FakeDriver& d, uint32_t& now) {
+        d.advance(now);
+        if (now - lastCheckMs < 10000) return;
+        lastCheckMs = now;
+        if (status == CONNECTED && !d.connected()) status = DISCONNECTED;
+        if (status == DISCONNECTED) connect(d, now);
+    }
+
+    bool connected(const FakeDriver& d) const { return status == CONNECTED && d.connected(); }
+};
+
+// WiFiManager::update() without the Arduino parts
+struct LinkManager {
+    WiFiLink link;
+    bool fastConnect = false;
+    WiFiConnectCache cache = WiFiConnectCache();
+    const char* cacheFile = nullptr;  // nullptr = cache kept in memory only
+    uint32_t cacheWrites = 0;
+
+    // WiFiManager::loadCache() with a file instead of Preferences
+    void loadCache() {
+        uint8_t blob[WIFI_CACHE_BLOB_SIZE];
+        size_t length = 0;
+        FILE* f = cacheFile ? fopen(cacheFile, "rb") : nullptr;
+        if (f) {
+            length = fread(blob, 1, sizeof(blob), f);
+            fclose(f);
+        }
+        wifi_cache_decode(blob, length, cache);
+        link.setFastConnect(fastConnect && wifi_cache_valid(cache));
+    }
+
+    void storeCache(const FakeDriver& d) {
+        WiFiConnectCache current = WiFiConnectCache();
+        memcpy(current.bssid, d.bssid, sizeof(current.bssid));
+        current.channel = d.channel;
+        if (!fastConnect || wifi_cache_equal(current, cache)) return;
+        uint8_t blob[WIFI_CACHE_BLOB_SIZE];
+        wifi_cache_encode(current, blob);
+        FILE* f = cacheFile ? fopen(cacheFile, "wb") : nullptr;
+        if (f) {
+            fwrite(blob, 1, sizeof(blob), f);
+            fclose(f);
+        }
+        cache = current;
+        cacheWrites++;
+        link.setFastConnect(true);
+    }
+
+    void act(FakeDriver& d, WiFiLinkAction action, uint32_t now) {
+        if (action == WIFI_LINK_BEGIN) d.begin(now);
+        else if (action == WIFI_LINK_BEGIN_FAST) d.beginDirected(now, cache.channel, cache.bssid);
+        else if (action == WIFI_LINK_ABORT) d.disconnect();
+    }
+
+    // setup(): connect() only starts the attempt
+    void setup(FakeDriver& d, uint32_t& now) { act(d, link.start(now), now); }
+
+    void update(FakeDriver& d, uint32_t& now) {
+        FakeEvent e = d.advance(now);
+        if (e == FAKE_GOT_IP) {
+            act(d, link.onConnected(now), now);
+            storeCache(d);
+        }
+        else if (e == FAKE_DISCONNECTED) act(d, link.onDisconnected(now, 201), now);
+        act(d, link.tick(now), now);
+    }
+
+    bool connected(const FakeDriver& d) const { return link.isConnected() && d.connected(); }
+};
+
+// ==================== RUN ====================
+struct SimResult {
+    LatencyHistogram loopUs;
+    uint32_t loops = 0;
+    uint32_t samplesMissed = 0;
+    uint32_t stalls = 0;               // Iterations >= SIM_STALL_MS
+    uint32_t connectedMs = 0;
+    std::vector<long> recoveryMs;      // AP back → connected (-1 = never)
+};
+
+template <typename Manager>
+static SimResult run(Manager& manager, FakeDriver driver, uint32_t durationMs) {
+    SimResult r;
+    uint32_t now = 0;
+    uint32_t nextSampleMs = 0;
+    size_t outageIndex = 0;
+    bool waitingRecovery = false;
+    uint32_t apBackMs = 0;
+
+    manager.setup(driver, now);
+    while (now < durationMs) {
+        uint32_t iterationStart = now;
+        bool wasConnected = manager.connected(driver);
+
+        manager.update(driver, now);
+
+        // Sampling/prediction work for this iteration
+        if (now >= nextSampleMs) {
+            uint32_t late = now - nextSampleMs;
+            r.samplesMissed += late / SIM_SAMPLE_MS;
+            nextSampleMs += (late / SIM_SAMPLE_MS + 1) * SIM_SAMPLE_MS;
+        }
+        now += SIM_WORK_MS;
+
+        uint32_t elapsed = now - iterationStart;
+        r.loopUs.record(elapsed * 1000u);
+        r.loops++;
+        if (elapsed >= SIM_STALL_MS) r.stalls++;
+        if (wasConnected && manager.connected(driver)) r.connectedMs += elapsed;
+
+        // Recovery time after each outage ends
+        if (outageIndex < driver.outages.size() && now >= driver.outages[outageIndex].endMs) {
+            if (waitingRecovery) r.recoveryMs.push_back(-1);   // Still down from the previous one
+            apBackMs = driver.outages[outageIndex].endMs;
+            waitingRecovery = true;
+            outageIndex++;
+        }
+        if (waitingRecovery && manager.connected(driver)) {
+            r.recoveryMs.push_back((long)(now - apBackMs));
+            waitingRecovery = false;
+        }
+    }
+    if (waitingRecovery) r.recoveryMs.push_back(-1);
+    return r;
+}
+
+static void print_result(const char* name, const SimResult& r, uint32_t durationMs) {
+    char p50[12], max[12];
+    printf("   %-10s %9lu %8s %9s %8lu %9lu %9.1f%%  ", name, (unsigned long)r.loops,
+           latency_format_us(r.loopUs.percentile(50), p50, sizeof(p50)),
+           latency_format_us(r.loopUs.max(), max, sizeof(max)),
+           (unsigned long)r.stalls, (unsigned long)r.samplesMissed, r.connectedMs * 100.0 / durationMs);
+    for (size_t i = 0; i < r.recoveryMs.size(); i++) {
+        if (r.recoveryMs[i] < 0) printf("%snever", i ? ", " : "");
+        else printf("%s%.1f s", i ? ", " : "", r.recoveryMs[i] / 1000.0);
+    }
+    printf("\n");
+}
+
+// ==================== BOOT BENCH ====================
+// Boot-to-connected over `boots` reboots; the access point changes channel
+// at boot/2 (router restart), which the cache has to survive
+static int bench_boots(uint32_t boots, const char* cacheFile, uint32_t assocMs, uint32_t fastMs) {
+    printf("WiFi boot bench: %lu boots, full connect %lu ms, directed %lu ms, AP changes channel at boot %lu\n",
+           (unsigned long)boots, (unsigned long)assocMs, (unsigned long)fastMs, (unsigned long)(boots / 2 + 1));
+    printf("\n   Mode          mean       min       max   fast ok  fallbacks  cache writes\n");
+    printf("   ─────────────────────────────────────────────────────────────────────────\n");
+
+    double meanMs[2] = { 0, 0 };
+    bool allConnected = true;
+    for (int mode = 0; mode < 2; mode++) {
+        remove(cacheFile);               // Cold start: first boot has no cache
+        uint32_t minMs = UINT32_MAX, maxMs = 0, fastOk = 0, fallbacks = 0, writes = 0;
+        uint64_t totalMs = 0;
+        for (uint32_t boot = 0; boot < boots; boot++) {
+            FakeDriver driver;
+            driver.assocMs = assocMs;
+            driver.fastAssocMs = fastMs;
+            if (boot >= boots / 2) driver.channel = 11;
+
+            LinkManager m;
+            m.link.setSeed(0x12345678 + boot);
+            m.fastConnect = mode == 1;
+            m.cacheFile = cacheFile;
+            m.loadCache();
+
+            uint32_t now = 0;
+            m.setup(driver, now);
+            while (!m.connected(driver) && now < SIM_BOOT_LIMIT_MS) {
+                m.update(driver, now);
+                now += SIM_WORK_MS;
+            }
+            if (!m.connected(driver)) allConnected = false;
+            const WiFiLinkStats& s = m.link.getStats();
+            fastOk += s.fastConnects;
+            fallbacks += s.fastFailures;
+            writes += m.cacheWrites;
+            totalMs += now;
+            if (now < minMs) minMs = now;
+            if (now > maxMs) maxMs = now;
+        }
+        meanMs[mode] = (double)totalMs / boots;
+        printf("   %-10s %7.2f s %7.2f s %7.2f s %9lu %10lu %13lu\n", mode ? "fast+cache" : "full scan",
+               meanMs[mode] / 1000.0, minMs / 1000.0, maxMs / 1000.0, (unsigned long)fastOk,
+               (unsigned long)fallbacks, (unsigned long)writes);
+    }
+    remove(cacheFile);
+    printf("   ─────────────────────────────────────────────────────────────────────────\n");
+    printf("   Boot-to-connected: %.2f s → %.2f s (%.1fx faster)\n", meanMs[0] / 1000.0, meanMs[1] / 1000.0,
+           meanMs[1] > 0 ? meanMs[0] / meanMs[1] : 0.0);
+
+    bool faster = meanMs[1] < meanMs[0];
+    printf("\n%s\n", allConnected && faster ? "✅ Every boot connected, cache shortened boot-to-connected"
+                                            : "❌ A boot did not connect or the cache did not help");
+    return allConnected && faster ? 0 : 1;
+}
+
+// ==================== MAIN ====================
+int main(int argc, char** argv) {
+    uint32_t minutes = 60;
+    uint32_t outageS = 600;
+    uint32_t shortOutageS = 45;
+    uint32_t assocMs = 3000;
+    uint32_t fastMs = 1000;
+    uint32_t boots = 0;
+    const char* cacheFile = "wifi_cache.bin";
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--minutes") == 0 && i + 1 < argc) minutes = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--outage-s") == 0 && i + 1 < argc) outageS = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--short-outage-s") == 0 && i + 1 < argc) shortOutageS = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--assoc-ms") == 0 && i + 1 < argc) assocMs = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--fast-ms") == 0 && i + 1 < argc) fastMs = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--boots") == 0 && i + 1 < argc) boots = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--cache-file") == 0 && i + 1 < argc) cacheFile = argv[++i];
+        else {
+            fprintf(stderr, "Usage: wifi_outage_sim [--minutes M] [--outage-s S] [--short-outage-s S] [--assoc-ms MS]\n"
+                            "       wifi_outage_sim --boots N [--cache-file PATH] [--assoc-ms MS] [--fast-ms MS]\n");
+            return 2;
+        }
+    }
+    if (boots > 0) {
+        return bench_boots(boots, cacheFile, assocMs, fastMs);
+    }
+    if (minutes < 10) minutes = 10;
+    uint32_t durationMs = minutes * 60000u;
+
+    // Long outage after 5 minutes, a short one in the second half
+    FakeDriver driver;
+    driver.assocMs = assocMs;
+    driver.fastAssocMs = fastMs;
+    driver.outages.push_back({ 5 * 60000u, 5 * 60000u + outageS * 1000u });
+    uint32_t shortStart = durationMs / 2 + 5 * 60000u;
+    driver.outages.push_back({ shortStart, shortStart + shortOutageS * 1000u });
+
+    printf("WiFi outage simulation: %lu min, outages %lu s @ 5 min and %lu s @ %lu min, association %lu ms\n",
+           (unsigned long)minutes, (unsigned long)outageS, (unsigned long)shortOutageS,
+           (unsigned long)(shortStart / 60000), (unsigned long)assocMs);
+    printf("\n   Manager        loops      p50       max   stalls    missed   connected  recovery after AP returns\n");
+    printf("   ─────────────────────────────────────────────────────────────────────────────────────────\n");
+
+    BlockingManager blocking;
+    SimResult before = run(blocking, driver, durationMs);
+    print_result("blocking", before, durationMs);
+
+    LinkManager link;
+    link.link.setSeed(0x12345678);
+    SimResult after = run(link, driver, durationMs);
+    print_result("link", after, durationMs);
+
+    LinkManager cached;
+    cached.link.setSeed(0x12345678);
+    cached.fastConnect = true;        // In-memory cache, filled by the first connect
+    SimResult fast = run(cached, driver, durationMs);
+    print_result("link+cache", fast, durationMs);
+    printf("   ─────────────────────────────────────────────────────────────────────────────────────────\n");
+
+    const WiFiLinkStats& s = link.link.getStats();
+    printf("   link: %lu attempts, %lu connects, %lu failures, %lu drops, longest outage %.1f s\n",
+           (unsigned long)s.attempts, (unsigned long)s.connects, (unsigned long)s.failures,
+           (unsigned long)s.drops, s.outageMaxMs / 1000.0);
+
+    const WiFiLinkStats& f = cached.link.getStats();
+    printf("   link+cache: %lu/%lu fast attempts connected, mean association fast %lu ms vs full %lu ms\n",
+           (unsigned long)f.fastConnects, (unsigned long)f.fastAttempts,
+           (unsigned long)cached.link.meanFastAssocMs(), (unsigned long)cached.link.meanFullAssocMs());
+
+    bool bounded = after.loopUs.max() <= (SIM_WORK_MS + 1) * 1000u && after.samplesMissed == 0 &&
+                   fast.loopUs.max() <= (SIM_WORK_MS + 1) * 1000u && fast.samplesMissed == 0;
+    bool recovered = !after.recoveryMs.empty() && after.recoveryMs.back() >= 0 &&
+                     !fast.recoveryMs.empty() && fast.recoveryMs.back() >= 0;
+    printf("\n%s\n", bounded && recovered ? "✅ Loop latency bounded, link recovered after every outage"
+                                          : "❌ Loop stalled or link did not recover");
+    return bounded && recovered ? 0 : 1;
+}
@@ -556,9 +556,10 @@ class WeatherDashboard {
             // Get device status from Firebase for uptime
             if (firebaseAPI && firebaseAPI.initialized) {
                 const status = await firebaseAPI.getDeviceStatus();
-                if (status && status.last_seen) {
-                    // last_seen is uptime in seconds from ESP32
-                    const uptimeSeconds = status.last_seen;
+                const info = await firebaseAPI.getDeviceInfo();
+                if (status && status.last_seen && info && info.last_boot) {
+                    // last_seen and last_boot are epoch milliseconds (NTP time on the ESP32)
+                    const uptimeSeconds = Math.max(0, (status.last_seen - info.last_boot) / 1000);
                     const uptimeHours = Math.floor(uptimeSeconds / 3600);
                     const uptimeMinutes = Math.floor((uptimeSeconds % 3600) / 60);
                     
@@ -252,19 +252,18 @@ class BackupPage {
             this.updateElement('backupChipModel', info.chip_model || '--');
             this.updateElement('backupMacAddress', info.mac_address || '--');
             
-            // last_seen is seconds since boot, not Unix timestamp
-            if (status.last_seen && status.online) {
-                // If online, show as "Just now" or relative time
-                const secondsAgo = status.last_seen;
+            // last_seen is epoch milliseconds (NTP time on the ESP32)
+            if (status.last_seen) {
+                const secondsAgo = Math.max(0, (Date.now() - status.last_seen) / 1000);
                 if (secondsAgo < 60) {
                     this.updateElement('backupLastSeen', 'Just now');
                 } else if (secondsAgo < 3600) {
-                    this.updateElement('backupLastSeen', `${Math.floor(secondsAgo / 60)} min ago (uptime)`);
+                    this.updateElement('backupLastSeen', `${Math.floor(secondsAgo / 60)} min ago`);
+                } else if (secondsAgo < 86400) {
+                    this.updateElement('backupLastSeen', `${Math.floor(secondsAgo / 3600)} hrs ago`);
                 } else {
-                    this.updateElement('backupLastSeen', `${Math.floor(secondsAgo / 3600)} hrs ago (uptime)`);
+                    this.updateElement('backupLastSeen', new Date(status.last_seen).toLocaleString());
                 }
-            } else if (status.last_seen) {
-                this.updateElement('backupLastSeen', `Uptime: ${Math.floor(status.last_seen / 60)} minutes`);
             } else {
                 this.updateElement('backupLastSeen', 'Never');
             }
@@ -303,10 +302,9 @@ class BackupPage {
         const pageReadings = this.filteredReadings.slice(startIdx, endIdx);
 
         // Render rows
-        tbody.innerHTML = pageReadings.map((reading, index) => {
-            // Use relative time display since timestamp is seconds since boot
-            const timeAgo = this.filteredReadings.length - (startIdx + index);
-            const timeLabel = timeAgo === 1 ? 'Latest' : `${timeAgo} readings ago`;
+        tbody.innerHTML = pageReadings.map((reading) => {
+            // Timestamps are epoch milliseconds (NTP time on the ESP32)
+            const timeLabel = new Date(reading.timestamp).toLocaleString();
             const weatherClass = (reading.prediction || 'unknown').toLowerCase();
             
             return `
@@ -455,7 +453,7 @@ class BackupPage {
         const dataPoints = this.filteredReadings.slice(0, 20).reverse();
         
         const labels = dataPoints.map(r => {
-            const date = new Date(r.timestamp * 1000);
+            const date = new Date(r.timestamp);
             return date.toLocaleTimeString('en-US', { hour: '2-digit', minute: '2-digit' });
         });
 
@@ -141,7 +141,10 @@ class FirebaseAPI {
      * @param {Date} options.endDate - End date
      * @param {number} options.limit - Maximum number of results
      * @param {string} options.deviceId - Device ID (optional)
-     * @returns {Promise<Array>} Array of readings
+     * @param {string} options.resolution - 'raw' (default), or opt-in rollups: 'minute', 'hour',
+     *        'day' or 'auto' (level sized to the range). Rollups come back as aggregate points
+     *        (type 'aggregate', see getAggregates); raw readings if the device writes none
+     * @returns {Promise<Array>} Array of readings (or aggregate points)
      */
     async getHistoricalData(options = {}) {
         try {
@@ -153,20 +156,34 @@ class FirebaseAPI {
                 startDate = new Date(Date.now() - 24 * 60 * 60 * 1000), // Default: last 24 hours
                 endDate = new Date(),
                 limit = 1000,
-                deviceId = this.deviceId
+                deviceId = this.deviceId,
+                resolution = 'raw'
             } = options;
 
             if (!deviceId) {
                 throw new Error('No device ID specified');
             }
 
+            if (resolution !== 'raw') {
+                const level = resolution === 'auto'
+                    ? this.getAggregateLevel(endDate - startDate)
+                    : resolution;
+                const points = await this.getAggregates(level, { startDate, endDate, limit }, deviceId);
+                if (points.length > 0) {
+                    this.cache.lastFetch = new Date();
+                    this.cache.data = points;
+                    return points;
+                }
+            }
+
             const readingsRef = this.db.ref(`devices/${deviceId}/readings`);
             
-            // Query with date range
+            // Keys are epoch milliseconds (13 digits, so string order is time
+            // order): a key range needs no .indexOn rule and reads only the range
             let query = readingsRef
-                .orderByChild('timestamp')
-                .startAt(startDate.getTime())
-                .endAt(endDate.getTime());
+                .orderByKey()
+                .startAt(String(startDate.getTime()))
+                .endAt(String(endDate.getTime()));
 
             if (limit) {
                 query = query.limitToLast(limit);
@@ -210,6 +227,164 @@ class FirebaseAPI {
         }
     }
 
+    /**
+     * Rollup level for a time range: minute buckets up to 6 hours, hour
+     * buckets up to a week, day buckets beyond
+     * @param {number} rangeMs - Range length in milliseconds
+     * @returns {string} 'minute', 'hour' or 'day'
+     */
+    getAggregateLevel(rangeMs) {
+        const hour = 60 * 60 * 1000;
+        if (rangeMs <= 6 * hour) return 'minute';
+        if (rangeMs <= 7 * 24 * hour) return 'hour';
+        return 'day';
+    }
+
+    /**
+     * Get device-side rollups (devices/{id}/aggregates/{level}/{start}/{segment})
+     * Each bucket holds count, [min, max, mean] per sensor and a class
+     * histogram of every reading the device took, so charts and stats read
+     * a few KB instead of the raw history. The device writes one segment
+     * per boot under a bucket; they are merged here.
+     * @param {string} level - 'minute', 'hour' or 'day'
+     * @param {Object} options - Query options
+     * @param {Date} options.startDate - Start date (optional)
+     * @param {Date} options.endDate - End date (optional)
+     * @param {number} options.limit - Maximum number of buckets, newest kept (optional)
+     * @param {number} options.first - Maximum number of buckets, oldest kept (optional)
+     * @param {string} deviceId - Device ID (optional)
+     * @returns {Promise<Array>} Aggregate points (newest first): type 'aggregate', timestamp in
+     *          ms like readings, count readings behind each point, no inference time
+     */
+    async getAggregates(level, options = {}, deviceId = null) {
+        try {
+            if (!this.initialized) {
+                await this.initialize();
+            }
+
+            const id = deviceId || this.deviceId;
+            if (!id) {
+                throw new Error('No device ID specified');
+            }
+
+            // Keys are bucket start times in seconds (ordered numerically)
+            let query = this.db.ref(`devices/${id}/aggregates/${level}`).orderByKey();
+            if (options.startDate) {
+                query = query.startAt(String(Math.floor(options.startDate.getTime() / 1000)));
+            }
+            if (options.endDate) {
+                query = query.endAt(String(Math.floor(options.endDate.getTime() / 1000)));
+            }
+            if (options.limit) {
+                query = query.limitToLast(options.limit);
+            } else if (options.first) {
+                query = query.limitToFirst(options.first);
+            }
+
+            const snapshot = await query.once('value');
+
+            if (!snapshot.exists()) {
+                return [];
+            }
+
+            const buckets = [];
+            snapshot.forEach((child) => {
+                const data = this.mergeAggregateSegments(child.val());
+                if (!data) {
+                    return;
+                }
+                const classes = data.classes || [];
+                const top = classes.length > 0 ? Math.max(...classes) : 0;
+                const dominant = top > 0 ? classes.indexOf(top) : null;
+                const sensor = (values) => ({
+                    min: values ? values[0] : 0,
+                    max: values ? values[1] : 0,
+                    mean: values ? values[2] : 0
+                });
+                const temperature = sensor(data.temperature);
+                const humidity = sensor(data.humidity);
+                const pressure = sensor(data.pressure);
+                const lux = sensor(data.lux);
+                const gas = sensor(data.gas_ppm);
+                buckets.push({
+                    type: 'aggregate',
+                    id: child.key,
+                    start: data.start,
+                    timestamp: data.start * 1000,
+                    date: new Date(data.start * 1000),
+                    count: data.n,
+                    temperature: temperature.mean,
+                    humidity: humidity.mean,
+                    pressure: pressure.mean,
+                    lux: lux.mean,
+                    gas: gas.mean,
+                    min: { temperature: temperature.min, humidity: humidity.min, pressure: pressure.min, lux: lux.min, gas: gas.min },
+                    max: { temperature: temperature.max, humidity: humidity.max, pressure: pressure.max, lux: lux.max, gas: gas.max },
+                    classes: classes,
+                    prediction: dominant,
+                    predictionName: this.getPredictionName(dominant),
+                    inferenceTime: null
+                });
+            });
+
+            // Sort by timestamp descending (newest first)
+            buckets.sort((a, b) => b.timestamp - a.timestamp);
+
+            return buckets;
+        } catch (error) {
+            console.error('Error fetching aggregates:', error);
+            return [];
+        }
+    }
+
+    /**
+     * Merge the per-boot segments of one rollup bucket
+     * Sums n and classes, keeps the min of mins and max of maxes and weights
+     * each segment's mean by its n. Nodes written before segments existed
+     * ({start, n, ...} directly) are returned as they are.
+     * @param {Object} node - devices/{id}/aggregates/{level}/{start}
+     * @returns {Object|null} Bucket in the device's node layout, null if empty
+     */
+    mergeAggregateSegments(node) {
+        if (!node || typeof node !== 'object') {
+            return null;
+        }
+        if (node.n !== undefined) {
+            return node;
+        }
+
+        const segments = Object.values(node).filter(s => s && s.n > 0);
+        if (segments.length === 0) {
+            return null;
+        }
+        const merged = { start: segments[0].start, n: 0, classes: [] };
+        const sensors = ['temperature', 'humidity', 'pressure', 'lux', 'gas_ppm'];
+        const sums = {};
+        segments.forEach(segment => {
+            merged.n += segment.n;
+            (segment.classes || []).forEach((count, classId) => {
+                merged.classes[classId] = (merged.classes[classId] || 0) + count;
+            });
+            sensors.forEach(key => {
+                const values = segment[key];
+                if (!values) {
+                    return;
+                }
+                const current = merged[key];
+                merged[key] = current
+                    ? [Math.min(current[0], values[0]), Math.max(current[1], values[1]), 0]
+                    : [values[0], values[1], 0];
+                sums[key] = (sums[key] || 0) + values[2] * segment.n;
+            });
+        });
+        sensors.forEach(key => {
+            if (merged[key]) {
+                merged[key][2] = sums[key] / merged.n;
+            }
+        });
+        return merged;
+    }
+
     /**
      * Get latest N readings
      * @param {number} count - Number of readings to fetch
@@ -229,7 +404,7 @@ class FirebaseAPI {
 
             const readingsRef = this.db.ref(`devices/${id}/readings`);
             const snapshot = await readingsRef
-                .orderByChild('timestamp')
+                .orderByKey()
                 .limitToLast(count)
                 .once('value');
 
@@ -284,15 +459,28 @@ class FirebaseAPI {
             };
         }
 
+        // Aggregate points stand for `count` readings each
+        const weight = (r) => r.type === 'aggregate' ? r.count : 1;
+        const total = readings.reduce((sum, r) => sum + weight(r), 0);
+
         // Calculate averages
-        const avgTemp = readings.reduce((sum, r) => sum + r.temperature, 0) / readings.length;
-        const avgHumid = readings.reduce((sum, r) => sum + r.humidity, 0) / readings.length;
-        const avgPress = readings.reduce((sum, r) => sum + r.pressure, 0) / readings.length;
-        const avgLux = readings.reduce((sum, r) => sum + r.lux, 0) / readings.length;
+        const avgTemp = readings.reduce((sum, r) => sum + r.temperature * weight(r), 0) / total;
+        const avgHumid = readings.reduce((sum, r) => sum + r.humidity * weight(r), 0) / total;
+        const avgPress = readings.reduce((sum, r) => sum + r.pressure * weight(r), 0) / total;
+        const avgLux = readings.reduce((sum, r) => sum + r.lux * weight(r), 0) / total;
 
         // Weather distribution
         const weatherCount = {};
         readings.forEach(r => {
+            if (r.type === 'aggregate') {
+                r.classes.forEach((count, classId) => {
+                    if (count > 0) {
+                        const name = this.getPredictionName(classId);
+                        weatherCount[name] = (weatherCount[name] || 0) + count;
+                    }
+                });
+                return;
+            }
             const name = r.predictionName;
             weatherCount[name] = (weatherCount[name] || 0) + 1;
         });
@@ -313,7 +501,7 @@ class FirebaseAPI {
         const dateRange = `${this.formatDate(oldest)} - ${this.formatDate(newest)}`;
 
         return {
-            totalReadings: readings.length,
+            totalReadings: total,
             dateRange,
             avgTemperature: avgTemp.toFixed(1),
             avgHumidity: avgHumid.toFixed(1),
@@ -420,7 +608,7 @@ class FirebaseAPI {
             r.lux,
             r.gas,
             r.predictionName,
-            r.inferenceTime
+            r.inferenceTime ?? ''
         ]);
 
         // Combine headers and rows
@@ -563,6 +751,14 @@ class FirebaseAPI {
      */
     async getReadingsStats(deviceId = null) {
         try {
+            // Day rollups: a handful of nodes instead of every reading
+            const days = await this.getAggregates('day', {}, deviceId);
+            if (days.length > 0) {
+                const firstHour = await this.getAggregates('hour', { first: 1 }, deviceId);
+                return this.getStatsFromAggregates(days, firstHour.length > 0 ? firstHour[0] : null);
+            }
+
+            // Older firmware (no rollups): count the raw readings
             const readings = await this.getAllReadings(deviceId);
             
             if (readings.length === 0) {
@@ -578,11 +774,11 @@ class FirebaseAPI {
             const now = Date.now();
             const todayStart = new Date();
             todayStart.setHours(0, 0, 0, 0);
-            const todayCount = readings.filter(r => (r.timestamp * 1000) >= todayStart.getTime()).length;
+            const todayCount = readings.filter(r => r.timestamp >= todayStart.getTime()).length;
 
             // Calculate average per hour
             const oldestReading = readings[readings.length - 1];
-            const hoursElapsed = (now - (oldestReading.timestamp * 1000)) / (1000 * 60 * 60);
+            const hoursElapsed = (now - oldestReading.timestamp) / (1000 * 60 * 60);
             const avgPerHour = hoursElapsed > 0 ? (readings.length / hoursElapsed).toFixed(1) : 0;
 
             // Weather distribution
@@ -609,6 +805,45 @@ class FirebaseAPI {
         }
     }
 
+    /**
+     * Readings statistics from day rollups
+     * @param {Array} days - Day buckets from getAggregates('day')
+     * @param {Object} oldestHour - Oldest hour bucket (start of the history), optional
+     * @returns {Object} Statistics object (same shape as getReadingsStats)
+     */
+    getStatsFromAggregates(days, oldestHour) {
+        const todayStart = new Date();
+        todayStart.setHours(0, 0, 0, 0);
+
+        let total = 0;
+        let today = 0;
+        const weatherDist = {};
+        days.forEach(day => {
+            total += day.count;
+            // Day buckets are UTC days: count the ones that overlap local today
+            if (day.timestamp + 24 * 60 * 60 * 1000 > todayStart.getTime()) {
+                today += day.count;
+            }
+            day.classes.forEach((count, classId) => {
+                if (count > 0) {
+                    const weather = this.getPredictionName(classId);
+                    weatherDist[weather] = (weatherDist[weather] || 0) + count;
+                }
+            });
+        });
+
+        const oldest = oldestHour || days[days.length - 1];
+        const hoursElapsed = (Date.now() - oldest.timestamp) / (1000 * 60 * 60);
+        const avgPerHour = hoursElapsed > 0 ? (total / hoursElapsed).toFixed(1) : 0;
+
+        return {
+            total: total,
+            today: today,
+            avgPerHour: avgPerHour,
+            weatherDistribution: weatherDist
+        };
+    }
+
     /**
      * Get device status
      * @param {string} deviceId - Device ID
@@ -664,7 +899,7 @@ class FirebaseAPI {
 
         const headers = ['Timestamp', 'Date/Time', 'Temperature', 'Humidity', 'Pressure', 'Lux', 'Prediction', 'Inference Time'];
         const rows = readings.map(r => {
-            const date = new Date(r.timestamp * 1000);
+            const date = new Date(r.timestamp);
             return [
                 r.timestamp,
                 this.formatDateTime(date),
@@ -672,8 +907,8 @@ class FirebaseAPI {
                 r.humidity?.toFixed(2) || '',
                 r.pressure?.toFixed(2) || '',
                 r.lux?.toFixed(2) || '',
-                r.prediction || '',
-                r.inference_time || ''
+                r.prediction ?? '',
+                r.inferenceTime ?? r.inference_time ?? ''
             ];
         });
 